@@ -800,8 +800,8 @@ main (int argc, char *argv[])
 	Ptr<Socket> recvSink = Socket::CreateSocket (AP1NodeContainer.Get(0), tid);
 	InetSocketAddress local = InetSocketAddress (APInterfaces.GetAddress (0), 80);
 	recvSink->Bind (local);
-	recvSink->SetRecvCallback (MakeCallback (&ReceivePacket));
-	AP1NodeContainer.Get(0)->AggregateObject (recvSink);
+	/* The synchronization services of AP and STA are installed before any time is sent */
+	InstallClockSync (AP1NodeContainer.Get(0), recvSink, wifi1StaNodeContainer.Get(0));
 
 	Ptr<Socket> source = Socket::CreateSocket (switchNodeContainer.Get(0), tid);
 	switchNodeContainer.Get(0)->AggregateObject (source);
@@ -102,14 +102,6 @@ void SleepCycleSetup(Ptr<ns3::Node> Node, int StaID, Time StartTime, Time StopTi
  in src/tsnwifi/helper/ftm_sync.h in 3.34
  */
 void sendtime(Ptr<Socket> socket, Ipv4Address &ipv4address, uint32_t port, Ptr<LocalClock> clock_0, Ptr<LocalClock> clock_1);
-/**
- * ReceivePacket - Receive the time sent from switch to AP.
- *
- * \param socket socket to receive.
- in src/tsnwifi/helper/ftm_sync.h in 3.34
- */
-void ReceivePacket (Ptr<Socket> socket);
-
 /**
  * printTimes - Prints the local clock values of AP, STA and the Switch.
  *
@@ -835,8 +827,8 @@ main (int argc, char *argv[])
 	Ptr<Socket> recvSink = Socket::CreateSocket (AP1NodeContainer.Get(0), tid);
 	InetSocketAddress local = InetSocketAddress (APInterfaces.GetAddress (0), 80);
 	recvSink->Bind (local);
-	recvSink->SetRecvCallback (MakeCallback (&ReceivePacket));
-	AP1NodeContainer.Get(0)->AggregateObject (recvSink);
+	/* The synchronization services of AP and STA are installed before any time is sent */
+	InstallClockSync (AP1NodeContainer.Get(0), recvSink, wifi1StaNodeContainer.Get(0));
 
 	Ptr<Socket> source = Socket::CreateSocket (switchNodeContainer.Get(0), tid);
 	switchNodeContainer.Get(0)->AggregateObject (source);
@@ -1107,45 +1099,4 @@ void printTimes(Ptr<LocalClock> clock_0, Ptr<LocalClock> clock_3, Ptr<LocalClock
 
 }
 
-// in src/tsnwifi/helper/ftm_sync.cc in 3.34
-void ReceivePacket (Ptr<Socket> socket)
-{
-        Ptr<Packet> packet;
-        Address from;
-	Ptr<Node> node;
-	Ptr<LocalClock> clk_AP;
-        Time off;
-        TimestampTag timestamp;
-	
-	/* Search for the clock of AP from list of nodes */
-	for (uint32_t i = 0; i < NodeList::GetNNodes (); i++)
-	{
-		node = NodeList::GetNode (i);
-		if(socket == node->GetObject<Socket>())
-		{
-			clk_AP = node->GetObject<LocalClock>();
-		}
-	}
-
-	while ((packet = socket->RecvFrom (from))) 
-	{
-		if (InetSocketAddress::IsMatchingType (from)) 
-		{
-			//NS_LOG_UNCOND ("Received " << packet->GetSize () << " bytes from " <<
-			//               InetSocketAddress::ConvertFrom (from).GetIpv4 ());
-		}
-		if (packet->FindFirstMatchingByteTag (timestamp)) 
-		{
-			Time tx = timestamp.GetTimestamp ();
-			off = timestamp.GetTimestamp () - clk_AP->GetLocalTime();
-			//NS_LOG_UNCOND (" received ts " << timestamp.GetTimestamp ().GetPicoSeconds() << " clock0 " << clock0->GetLocalTime().GetPicoSeconds() << " offset " << timestamp.GetTimestamp () - clock0->GetLocalTime() << " clock1 " << clock1->GetLocalTime().GetPicoSeconds());
-
-		}
-	}
-
-	Ptr<PerfectClockModelImpl> clockImpl = CreateObject<PerfectClockModelImpl> ();
-	/* Set the clock of AP after receiving timestamp as bytetag from switch*/
-	clockImpl->SetAttribute ("Offset", TimeValue (off));
-	clk_AP->SetClock (clockImpl);
-}
 
@@ -28,6 +28,9 @@
 #include "ns3/object-vector.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace ns3
 {
 
@@ -84,6 +87,37 @@ class BuildingListPriv : public Object
      */
     static Ptr<BuildingListPriv> Get();
 
+    /**
+     * Mark the bounding volume hierarchy as outdated.
+     */
+    void NotifyBoundariesChanged();
+
+    /**
+     * \param position a position
+     * \returns the buildings containing the position, in the order of the list
+     */
+    std::vector<Ptr<Building>> GetBuildingsAt(const Vector& position);
+
+    /**
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \returns true if the line segment intersects a building
+     */
+    bool IsIntersect(const Vector& l1, const Vector& l2);
+
+    /**
+     * \param segments the ends of the line segments
+     * \returns for each segment, true if it intersects a building
+     */
+    std::vector<bool> IsIntersect(const std::vector<std::pair<Vector, Vector>>& segments);
+
+    /**
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \returns the buildings intersecting the line segment, in the order of the list
+     */
+    std::vector<Ptr<Building>> GetIntersectingBuildings(const Vector& l1, const Vector& l2);
+
   private:
     void DoDispose() override;
     /**
@@ -98,7 +132,72 @@ class BuildingListPriv : public Object
      *
      */
     static void Delete();
+
+    /**
+     * Build the bounding volume hierarchy if it is outdated.
+     */
+    void UpdateBvh();
+
+    /**
+     * Build the subtree of the buildings m_bvhIndices[first, last).
+     *
+     * \param first the first building
+     * \param last past the last building
+     */
+    void BuildBvhNode(uint32_t first, uint32_t last);
+
+    /**
+     * Conservative test of the overlap of a line segment with a box, which
+     * may report an overlap when the segment passes very close to the box.
+     *
+     * \param box the box
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \returns false if the line segment does not intersect the box
+     */
+    static bool MayIntersect(const Box& box, const Vector& l1, const Vector& l2);
+
+    /**
+     * Call a function for each building whose box may intersect a line
+     * segment, until it returns true.
+     *
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \param f the function, called with the index of the building
+     * \returns true if the function returned true
+     */
+    template <typename F>
+    bool VisitIntersecting(const Vector& l1, const Vector& l2, F f);
+
+    /**
+     * Test the segments m_bvhRays[begin, end) against the subtree of a node.
+     *
+     * \param node the node
+     * \param begin the first segment
+     * \param end past the last segment
+     * \param segments the ends of the line segments
+     * \param blocked the result of each segment
+     */
+    void IntersectBatch(uint32_t node,
+                        size_t begin,
+                        size_t end,
+                        const std::vector<std::pair<Vector, Vector>>& segments,
+                        std::vector<bool>& blocked);
+
+    /// A node of the bounding volume hierarchy
+    struct BvhNode
+    {
+        Box bounds;     //!< the union of the boundaries of the buildings of the subtree
+        uint32_t first; //!< the first building of a leaf, or the right child of an inner node
+        uint32_t count; //!< the number of buildings of a leaf, or 0 for an inner node
+    };
+
     std::vector<Ptr<Building>> m_buildings; //!< Container of Building
+    bool m_bvhValid;                        //!< the hierarchy is up to date
+    std::vector<BvhNode> m_bvh; //!< the hierarchy, the left child of a node is the next one
+    std::vector<uint32_t> m_bvhIndices; //!< the buildings, in the order of the leaves
+    std::vector<Box> m_bvhBoxes;        //!< the boundaries of the buildings, by index
+    std::vector<uint32_t> m_bvhRays;    //!< the segments of the batch being tested
 };
 
 NS_OBJECT_ENSURE_REGISTERED(BuildingListPriv);
@@ -146,6 +245,7 @@ BuildingListPriv::Delete()
 }
 
 BuildingListPriv::BuildingListPriv()
+    : m_bvhValid(false)
 {
     NS_LOG_FUNCTION_NOARGS();
 }
@@ -165,6 +265,8 @@ BuildingListPriv::DoDispose()
         *i = nullptr;
     }
     m_buildings.erase(m_buildings.begin(), m_buildings.end());
+    m_bvh.clear();
+    m_bvhValid = false;
     Object::DoDispose();
 }
 
@@ -173,6 +275,7 @@ BuildingListPriv::Add(Ptr<Building> building)
 {
     uint32_t index = m_buildings.size();
     m_buildings.push_back(building);
+    m_bvhValid = false;
     Simulator::ScheduleWithContext(index, TimeStep(0), &Building::Initialize, building);
     return index;
 }
@@ -204,6 +307,310 @@ BuildingListPriv::GetBuilding(uint32_t n)
     return m_buildings.at(n);
 }
 
+void
+BuildingListPriv::NotifyBoundariesChanged()
+{
+    m_bvhValid = false;
+}
+
+void
+BuildingListPriv::UpdateBvh()
+{
+    if (m_bvhValid)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << m_buildings.size());
+    m_bvh.clear();
+    m_bvhIndices.resize(m_buildings.size());
+    m_bvhBoxes.resize(m_buildings.size());
+    for (uint32_t i = 0; i < m_buildings.size(); ++i)
+    {
+        m_bvhIndices[i] = i;
+        m_bvhBoxes[i] = m_buildings[i]->GetBoundaries();
+    }
+    if (!m_buildings.empty())
+    {
+        m_bvh.reserve(2 * m_buildings.size());
+        BuildBvhNode(0, m_buildings.size());
+    }
+    m_bvhValid = true;
+}
+
+void
+BuildingListPriv::BuildBvhNode(uint32_t first, uint32_t last)
+{
+    const uint32_t maxLeafSize = 4;
+
+    uint32_t node = m_bvh.size();
+    m_bvh.push_back(BvhNode());
+    Box bounds = m_bvhBoxes[m_bvhIndices[first]];
+    Box centers(bounds.xMin + bounds.xMax,
+                bounds.xMin + bounds.xMax,
+                bounds.yMin + bounds.yMax,
+                bounds.yMin + bounds.yMax,
+                bounds.zMin + bounds.zMax,
+                bounds.zMin + bounds.zMax); // the bounds of the centers, times 2
+    for (uint32_t i = first + 1; i < last; ++i)
+    {
+        const Box& box = m_bvhBoxes[m_bvhIndices[i]];
+        bounds.xMin = std::min(bounds.xMin, box.xMin);
+        bounds.xMax = std::max(bounds.xMax, box.xMax);
+        bounds.yMin = std::min(bounds.yMin, box.yMin);
+        bounds.yMax = std::max(bounds.yMax, box.yMax);
+        bounds.zMin = std::min(bounds.zMin, box.zMin);
+        bounds.zMax = std::max(bounds.zMax, box.zMax);
+        centers.xMin = std::min(centers.xMin, box.xMin + box.xMax);
+        centers.xMax = std::max(centers.xMax, box.xMin + box.xMax);
+        centers.yMin = std::min(centers.yMin, box.yMin + box.yMax);
+        centers.yMax = std::max(centers.yMax, box.yMin + box.yMax);
+        centers.zMin = std::min(centers.zMin, box.zMin + box.zMax);
+        centers.zMax = std::max(centers.zMax, box.zMin + box.zMax);
+    }
+    m_bvh[node].bounds = bounds;
+
+    if (last - first <= maxLeafSize)
+    {
+        m_bvh[node].first = first;
+        m_bvh[node].count = last - first;
+        return;
+    }
+
+    // split at the median of the centers along their longest extent
+    double dx = centers.xMax - centers.xMin;
+    double dy = centers.yMax - centers.yMin;
+    double dz = centers.zMax - centers.zMin;
+    auto center = [this, dx, dy, dz](uint32_t i) {
+        const Box& box = m_bvhBoxes[i];
+        if (dx >= dy && dx >= dz)
+        {
+            return box.xMin + box.xMax;
+        }
+        return dy >= dz ? box.yMin + box.yMax : box.zMin + box.zMax;
+    };
+    uint32_t middle = first + (last - first) / 2;
+    std::nth_element(m_bvhIndices.begin() + first,
+                     m_bvhIndices.begin() + middle,
+                     m_bvhIndices.begin() + last,
+                     [&center](uint32_t a, uint32_t b) { return center(a) < center(b); });
+    BuildBvhNode(first, middle);
+    m_bvh[node].first = m_bvh.size();
+    m_bvh[node].count = 0;
+    BuildBvhNode(middle, last);
+}
+
+bool
+BuildingListPriv::MayIntersect(const Box& box, const Vector& l1, const Vector& l2)
+{
+    // slab test against the box enlarged by a margin larger than the rounding
+    // errors, so that no building found by Box::IsIntersect is missed
+    double t0 = 0;
+    double t1 = 1;
+    const double lo[3] = {box.xMin, box.yMin, box.zMin};
+    const double hi[3] = {box.xMax, box.yMax, box.zMax};
+    const double p[3] = {l1.x, l1.y, l1.z};
+    const double d[3] = {l2.x - l1.x, l2.y - l1.y, l2.z - l1.z};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        double margin = 1e-9 * (1 + std::abs(lo[axis]) + std::abs(hi[axis]) + std::abs(p[axis]) +
+                                std::abs(d[axis]));
+        double min = lo[axis] - margin;
+        double max = hi[axis] + margin;
+        if (d[axis] == 0)
+        {
+            if (p[axis] < min || p[axis] > max)
+            {
+                return false;
+            }
+            continue;
+        }
+        double ta = (min - p[axis]) / d[axis];
+        double tb = (max - p[axis]) / d[axis];
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+        if (t0 > t1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename F>
+bool
+BuildingListPriv::VisitIntersecting(const Vector& l1, const Vector& l2, F f)
+{
+    UpdateBvh();
+    if (m_bvh.empty())
+    {
+        return false;
+    }
+    uint32_t stack[64];
+    uint32_t size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const BvhNode& node = m_bvh[stack[--size]];
+        if (!MayIntersect(node.bounds, l1, l2))
+        {
+            continue;
+        }
+        if (node.count > 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (f(m_bvhIndices[i]))
+                {
+                    return true;
+                }
+            }
+        }
+        else
+        {
+            stack[size++] = node.first;
+            stack[size++] = &node - m_bvh.data() + 1;
+        }
+    }
+    return false;
+}
+
+std::vector<Ptr<Building>>
+BuildingListPriv::GetBuildingsAt(const Vector& position)
+{
+    UpdateBvh();
+    std::vector<uint32_t> found;
+    if (!m_bvh.empty())
+    {
+        uint32_t stack[64];
+        uint32_t size = 0;
+        stack[size++] = 0;
+        while (size > 0)
+        {
+            const BvhNode& node = m_bvh[stack[--size]];
+            if (!node.bounds.IsInside(position))
+            {
+                continue;
+            }
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                {
+                    if (m_bvhBoxes[m_bvhIndices[i]].IsInside(position))
+                    {
+                        found.push_back(m_bvhIndices[i]);
+                    }
+                }
+            }
+            else
+            {
+                stack[size++] = node.first;
+                stack[size++] = &node - m_bvh.data() + 1;
+            }
+        }
+    }
+    std::sort(found.begin(), found.end());
+    std::vector<Ptr<Building>> buildings;
+    for (auto i : found)
+    {
+        buildings.push_back(m_buildings[i]);
+    }
+    return buildings;
+}
+
+bool
+BuildingListPriv::IsIntersect(const Vector& l1, const Vector& l2)
+{
+    return VisitIntersecting(l1, l2, [this, &l1, &l2](uint32_t i) {
+        return m_bvhBoxes[i].IsIntersect(l1, l2);
+    });
+}
+
+std::vector<Ptr<Building>>
+BuildingListPriv::GetIntersectingBuildings(const Vector& l1, const Vector& l2)
+{
+    std::vector<uint32_t> found;
+    VisitIntersecting(l1, l2, [this, &l1, &l2, &found](uint32_t i) {
+        if (m_bvhBoxes[i].IsIntersect(l1, l2))
+        {
+            found.push_back(i);
+        }
+        return false;
+    });
+    std::sort(found.begin(), found.end());
+    std::vector<Ptr<Building>> buildings;
+    for (auto i : found)
+    {
+        buildings.push_back(m_buildings[i]);
+    }
+    return buildings;
+}
+
+std::vector<bool>
+BuildingListPriv::IsIntersect(const std::vector<std::pair<Vector, Vector>>& segments)
+{
+    UpdateBvh();
+    std::vector<bool> blocked(segments.size(), false);
+    if (m_bvh.empty())
+    {
+        return blocked;
+    }
+    m_bvhRays.resize(segments.size());
+    for (uint32_t i = 0; i < segments.size(); ++i)
+    {
+        m_bvhRays[i] = i;
+    }
+    IntersectBatch(0, 0, segments.size(), segments, blocked);
+    m_bvhRays.clear();
+    return blocked;
+}
+
+void
+BuildingListPriv::IntersectBatch(uint32_t node,
+                                 size_t begin,
+                                 size_t end,
+                                 const std::vector<std::pair<Vector, Vector>>& segments,
+                                 std::vector<bool>& blocked)
+{
+    // the segments not blocked yet which may cross the node are appended to
+    // m_bvhRays, and removed once its subtree is done
+    const BvhNode& bvhNode = m_bvh[node];
+    size_t first = m_bvhRays.size();
+    for (size_t i = begin; i < end; ++i)
+    {
+        uint32_t ray = m_bvhRays[i];
+        if (!blocked[ray] &&
+            MayIntersect(bvhNode.bounds, segments[ray].first, segments[ray].second))
+        {
+            m_bvhRays.push_back(ray);
+        }
+    }
+    size_t last = m_bvhRays.size();
+    if (first == last)
+    {
+        return;
+    }
+    if (bvhNode.count > 0)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            uint32_t ray = m_bvhRays[i];
+            for (uint32_t b = bvhNode.first; b < bvhNode.first + bvhNode.count && !blocked[ray];
+                 ++b)
+            {
+                blocked[ray] = m_bvhBoxes[m_bvhIndices[b]].IsIntersect(segments[ray].first,
+                                                                       segments[ray].second);
+            }
+        }
+    }
+    else
+    {
+        uint32_t right = bvhNode.first;
+        IntersectBatch(node + 1, first, last, segments, blocked);
+        IntersectBatch(right, first, last, segments, blocked);
+    }
+    m_bvhRays.resize(first);
+}
+
 } // namespace ns3
 
 /**
@@ -244,4 +651,34 @@ BuildingList::GetNBuildings()
     return BuildingListPriv::Get()->GetNBuildings();
 }
 
+void
+BuildingList::NotifyBoundariesChanged()
+{
+    BuildingListPriv::Get()->NotifyBoundariesChanged();
+}
+
+std::vector<Ptr<Building>>
+BuildingList::GetBuildingsAt(const Vector& position)
+{
+    return BuildingListPriv::Get()->GetBuildingsAt(position);
+}
+
+bool
+BuildingList::IsIntersect(const Vector& l1, const Vector& l2)
+{
+    return BuildingListPriv::Get()->IsIntersect(l1, l2);
+}
+
+std::vector<bool>
+BuildingList::IsIntersect(const std::vector<std::pair<Vector, Vector>>& segments)
+{
+    return BuildingListPriv::Get()->IsIntersect(segments);
+}
+
+std::vector<Ptr<Building>>
+BuildingList::GetIntersectingBuildings(const Vector& l1, const Vector& l2)
+{
+    return BuildingListPriv::Get()->GetIntersectingBuildings(l1, l2);
+}
+
 } // namespace ns3
@@ -23,7 +23,9 @@
 #define BUILDING_LIST_H_
 
 #include "ns3/ptr.h"
+#include "ns3/vector.h"
 
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -67,6 +69,45 @@ class BuildingList
      * \returns the number of buildings currently in the list.
      */
     static uint32_t GetNBuildings();
+
+    /**
+     * Notify the list that the boundaries of a building changed.
+     *
+     * The spatial queries below use a bounding volume hierarchy over the
+     * boundaries of the buildings, built at the first query after a building
+     * is added or moved. This method is called automatically from
+     * Building::SetBoundaries.
+     */
+    static void NotifyBoundariesChanged();
+
+    /**
+     * \param position a position
+     * \returns the buildings containing the position, in the order of the list.
+     */
+    static std::vector<Ptr<Building>> GetBuildingsAt(const Vector& position);
+
+    /**
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \returns true if the line segment intersects a building
+     */
+    static bool IsIntersect(const Vector& l1, const Vector& l2);
+
+    /**
+     * Test a batch of line segments against the buildings, sharing the
+     * traversal of the bounding volume hierarchy among the segments.
+     *
+     * \param segments the ends of the line segments
+     * \returns for each segment, true if it intersects a building
+     */
+    static std::vector<bool> IsIntersect(const std::vector<std::pair<Vector, Vector>>& segments);
+
+    /**
+     * \param l1 an end of the line segment
+     * \param l2 the other end of the line segment
+     * \returns the buildings intersecting the line segment, in the order of the list.
+     */
+    static std::vector<Ptr<Building>> GetIntersectingBuildings(const Vector& l1, const Vector& l2);
 };
 
 } // namespace ns3
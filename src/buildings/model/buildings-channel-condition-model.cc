@@ -60,6 +60,60 @@ BuildingsChannelConditionModel::GetChannelCondition(Ptr<const MobilityModel> a,
     Ptr<MobilityBuildingInfo> b1 = b->GetObject<MobilityBuildingInfo>();
     NS_ASSERT_MSG(a1 && b1, "BuildingsChannelConditionModel only works with MobilityBuildingInfo");
 
+    bool blocked = false;
+    if (!a1->IsIndoor() && !b1->IsIndoor())
+    {
+        blocked = IsLineOfSightBlocked(a->GetPosition(), b->GetPosition());
+    }
+    return CreateChannelCondition(a1, b1, blocked);
+}
+
+std::vector<Ptr<ChannelCondition>>
+BuildingsChannelConditionModel::GetChannelConditions(
+    const std::vector<std::pair<Ptr<const MobilityModel>, Ptr<const MobilityModel>>>& pairs) const
+{
+    NS_LOG_FUNCTION(this << pairs.size());
+    std::vector<Ptr<MobilityBuildingInfo>> infos;
+    infos.reserve(2 * pairs.size());
+    std::vector<std::pair<Vector, Vector>> segments;
+    std::vector<uint32_t> outdoor; // the pairs of the segments
+    for (uint32_t i = 0; i < pairs.size(); ++i)
+    {
+        Ptr<MobilityBuildingInfo> a1 = pairs[i].first->GetObject<MobilityBuildingInfo>();
+        Ptr<MobilityBuildingInfo> b1 = pairs[i].second->GetObject<MobilityBuildingInfo>();
+        NS_ASSERT_MSG(a1 && b1,
+                      "BuildingsChannelConditionModel only works with MobilityBuildingInfo");
+        if (!a1->IsIndoor() && !b1->IsIndoor())
+        {
+            segments.emplace_back(pairs[i].first->GetPosition(), pairs[i].second->GetPosition());
+            outdoor.push_back(i);
+        }
+        infos.push_back(a1);
+        infos.push_back(b1);
+    }
+
+    // the line of sight of all the outdoor pairs is checked in a single pass
+    std::vector<bool> blocked(pairs.size(), false);
+    std::vector<bool> segmentBlocked = BuildingList::IsIntersect(segments);
+    for (uint32_t i = 0; i < outdoor.size(); ++i)
+    {
+        blocked[outdoor[i]] = segmentBlocked[i];
+    }
+
+    std::vector<Ptr<ChannelCondition>> conditions;
+    conditions.reserve(pairs.size());
+    for (uint32_t i = 0; i < pairs.size(); ++i)
+    {
+        conditions.push_back(CreateChannelCondition(infos[2 * i], infos[2 * i + 1], blocked[i]));
+    }
+    return conditions;
+}
+
+Ptr<ChannelCondition>
+BuildingsChannelConditionModel::CreateChannelCondition(Ptr<MobilityBuildingInfo> a1,
+                                                       Ptr<MobilityBuildingInfo> b1,
+                                                       bool blocked) const
+{
     Ptr<ChannelCondition> cond = CreateObject<ChannelCondition>();
 
     bool isAIndoor = a1->IsIndoor();
@@ -72,7 +126,6 @@ BuildingsChannelConditionModel::GetChannelCondition(Ptr<const MobilityModel> a,
         // The outdoor case, determine LOS/NLOS
         // The channel condition should be LOS if the line of sight is not blocked,
         // otherwise NLOS
-        bool blocked = IsLineOfSightBlocked(a->GetPosition(), b->GetPosition());
         NS_LOG_DEBUG("a and b are outdoor, blocked " << blocked);
         if (!blocked)
         {
@@ -116,19 +169,9 @@ bool
 BuildingsChannelConditionModel::IsLineOfSightBlocked(const ns3::Vector& l1,
                                                      const ns3::Vector& l2) const
 {
-    for (BuildingList::Iterator bit = BuildingList::Begin(); bit != BuildingList::End(); ++bit)
-    {
-        if ((*bit)->IsIntersect(l1, l2))
-        {
-            // The line of sight should be blocked if the line-segment between
-            // l1 and l2 intersects one of the buildings.
-            return true;
-        }
-    }
-
-    // The line of sight should not be blocked if the line-segment between
-    // l1 and l2 did not intersect any building.
-    return false;
+    // The line of sight should be blocked if the line-segment between
+    // l1 and l2 intersects one of the buildings.
+    return BuildingList::IsIntersect(l1, l2);
 }
 
 int64_t
@@ -23,10 +23,14 @@
 
 #include "ns3/channel-condition-model.h"
 
+#include <utility>
+#include <vector>
+
 namespace ns3
 {
 
 class MobilityModel;
+class MobilityBuildingInfo;
 
 /**
  * \ingroup buildings
@@ -66,6 +70,18 @@ class BuildingsChannelConditionModel : public ChannelConditionModel
     Ptr<ChannelCondition> GetChannelCondition(Ptr<const MobilityModel> a,
                                               Ptr<const MobilityModel> b) const override;
 
+    /**
+     * Computes the conditions of the channels of several pairs of nodes,
+     * checking the line of sight of all the outdoor pairs in a single pass
+     * over the buildings.
+     *
+     * \param pairs the mobility models of the pairs of nodes
+     * \return the condition of the channel of each pair
+     */
+    std::vector<Ptr<ChannelCondition>> GetChannelConditions(
+        const std::vector<std::pair<Ptr<const MobilityModel>, Ptr<const MobilityModel>>>& pairs)
+        const;
+
     /**
      * If this model uses objects of type RandomVariableStream,
      * set the stream numbers to the integers starting with the offset
@@ -78,6 +94,18 @@ class BuildingsChannelConditionModel : public ChannelConditionModel
     int64_t AssignStreams(int64_t stream) override;
 
   private:
+    /**
+     * \brief Creates the condition of the channel between two nodes.
+     *
+     * \param a1 the building information of the first node
+     * \param b1 the building information of the second node
+     * \param blocked whether the line of sight is blocked, used if both are outdoor
+     * \return the condition of the channel
+     */
+    Ptr<ChannelCondition> CreateChannelCondition(Ptr<MobilityBuildingInfo> a1,
+                                                 Ptr<MobilityBuildingInfo> b1,
+                                                 bool blocked) const;
+
     /**
      * \brief Checks if the line of sight between position l1 and position l2 is
      *        blocked by a building.
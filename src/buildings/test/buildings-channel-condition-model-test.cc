@@ -22,6 +22,7 @@
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 
@@ -145,6 +146,168 @@ BuildingsChannelConditionModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup building-test
+ * \ingroup tests
+ *
+ * Test case for the spatial queries of the BuildingList. It compares them,
+ * and the batch BuildingsChannelConditionModel::GetChannelConditions, with
+ * a linear scan of the buildings, in a random scenario where buildings are
+ * also moved between the queries.
+ */
+class BuildingListQueriesTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    BuildingListQueriesTestCase();
+
+  private:
+    /**
+     * Builds the simulation scenario and perform the tests
+     */
+    void DoRun() override;
+
+    /**
+     * Compare the queries with a linear scan of the buildings.
+     *
+     * \param segments the line segments to test
+     */
+    void CheckQueries(const std::vector<std::pair<Vector, Vector>>& segments);
+};
+
+BuildingListQueriesTestCase::BuildingListQueriesTestCase()
+    : TestCase("Test case for the spatial queries of the BuildingList")
+{
+}
+
+void
+BuildingListQueriesTestCase::CheckQueries(const std::vector<std::pair<Vector, Vector>>& segments)
+{
+    std::vector<bool> batch = BuildingList::IsIntersect(segments);
+    NS_TEST_ASSERT_MSG_EQ(batch.size(), segments.size(), "wrong number of results");
+    for (uint32_t i = 0; i < segments.size(); ++i)
+    {
+        const Vector& l1 = segments[i].first;
+        const Vector& l2 = segments[i].second;
+        std::vector<Ptr<Building>> intersecting;
+        std::vector<Ptr<Building>> inside;
+        for (auto bit = BuildingList::Begin(); bit != BuildingList::End(); ++bit)
+        {
+            if ((*bit)->IsIntersect(l1, l2))
+            {
+                intersecting.push_back(*bit);
+            }
+            if ((*bit)->IsInside(l1))
+            {
+                inside.push_back(*bit);
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(BuildingList::IsIntersect(l1, l2),
+                              !intersecting.empty(),
+                              "wrong intersection of " << l1 << " " << l2);
+        NS_TEST_ASSERT_MSG_EQ(batch[i],
+                              !intersecting.empty(),
+                              "wrong batch intersection of " << l1 << " " << l2);
+        NS_TEST_ASSERT_MSG_EQ((BuildingList::GetIntersectingBuildings(l1, l2) == intersecting),
+                              true,
+                              "wrong buildings intersecting " << l1 << " " << l2);
+        NS_TEST_ASSERT_MSG_EQ((BuildingList::GetBuildingsAt(l1) == inside),
+                              true,
+                              "wrong buildings at " << l1);
+    }
+}
+
+void
+BuildingListQueriesTestCase::DoRun()
+{
+    Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+    rv->SetStream(1);
+
+    // random buildings in every other cell of a grid, some of them towers
+    std::vector<Ptr<Building>> buildings;
+    auto randomBoundaries = [&rv](uint32_t cell, double height) {
+        double x = (cell % 20) * 50.0 + rv->GetValue(0, 10);
+        double y = (cell / 20) * 50.0 + rv->GetValue(0, 10);
+        return Box(x, x + rv->GetValue(5, 40), y, y + rv->GetValue(5, 40), 0.0, height);
+    };
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        Ptr<Building> building = CreateObject<Building>();
+        building->SetBoundaries(randomBoundaries(2 * i, rv->GetValue(3, i % 10 == 0 ? 100 : 20)));
+        buildings.push_back(building);
+    }
+
+    auto randomPosition = [&rv]() {
+        return Vector(rv->GetValue(-50, 1050), rv->GetValue(-50, 1050), rv->GetValue(0, 30));
+    };
+    std::vector<std::pair<Vector, Vector>> segments;
+    for (uint32_t i = 0; i < 500; ++i)
+    {
+        Vector l1 = randomPosition();
+        Vector l2 = randomPosition();
+        if (i % 5 == 0)
+        {
+            // short segments
+            l2 = Vector(l1.x + rv->GetValue(-20, 20), l1.y + rv->GetValue(-20, 20), l1.z);
+        }
+        else if (i % 5 == 1)
+        {
+            // vertical segments, and segments parallel to the axes
+            l2 = i % 2 ? Vector(l1.x, l1.y, l2.z) : Vector(l2.x, l1.y, l1.z);
+        }
+        segments.emplace_back(l1, l2);
+    }
+    CheckQueries(segments);
+
+    // move some of the buildings within their cells
+    for (uint32_t i = 0; i < buildings.size(); i += 3)
+    {
+        buildings[i]->SetBoundaries(
+            randomBoundaries(2 * i, buildings[i]->GetBoundaries().zMax));
+    }
+    CheckQueries(segments);
+
+    // compare the batch channel conditions with the ones of each pair
+    NodeContainer nodes;
+    nodes.Create(100);
+    std::vector<Ptr<MobilityModel>> mobility;
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        Ptr<MobilityModel> mm = CreateObject<ConstantPositionMobilityModel>();
+        mm->SetPosition(Vector(rv->GetValue(0, 1000), rv->GetValue(0, 1000), 1.5));
+        nodes.Get(i)->AggregateObject(mm);
+        mobility.push_back(mm);
+    }
+    BuildingsHelper::Install(nodes);
+
+    Ptr<BuildingsChannelConditionModel> condModel = CreateObject<BuildingsChannelConditionModel>();
+    std::vector<std::pair<Ptr<const MobilityModel>, Ptr<const MobilityModel>>> pairs;
+    for (uint32_t i = 0; i < mobility.size(); ++i)
+    {
+        for (uint32_t j = i + 1; j < mobility.size(); j += 7)
+        {
+            pairs.emplace_back(mobility[i], mobility[j]);
+        }
+    }
+    std::vector<Ptr<ChannelCondition>> conditions = condModel->GetChannelConditions(pairs);
+    NS_TEST_ASSERT_MSG_EQ(conditions.size(), pairs.size(), "wrong number of conditions");
+    for (uint32_t i = 0; i < pairs.size(); ++i)
+    {
+        Ptr<ChannelCondition> cond =
+            condModel->GetChannelCondition(pairs[i].first, pairs[i].second);
+        NS_TEST_ASSERT_MSG_EQ(conditions[i]->GetLosCondition(),
+                              cond->GetLosCondition(),
+                              "wrong LOS condition of pair " << i);
+        NS_TEST_ASSERT_MSG_EQ(conditions[i]->GetO2iCondition(),
+                              cond->GetO2iCondition(),
+                              "wrong O2I condition of pair " << i);
+    }
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup building-test
  * \ingroup tests
@@ -160,6 +323,7 @@ BuildingsChannelConditionModelsTestSuite::BuildingsChannelConditionModelsTestSui
     : TestSuite("buildings-channel-condition-model", UNIT)
 {
     AddTestCase(new BuildingsChannelConditionModelTestCase, TestCase::QUICK);
+    AddTestCase(new BuildingListQueriesTestCase, TestCase::QUICK);
 }
 
 /// Static variable for test initialization
@@ -74,6 +74,7 @@ LocalTimeSimulatorImpl::LocalTimeSimulatorImpl ()
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self ();
+  m_profiler = EventProfiler::Create ();
 }
 
 LocalTimeSimulatorImpl::~LocalTimeSimulatorImpl ()
@@ -110,6 +111,11 @@ LocalTimeSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler)
+    {
+      m_profiler->Write ();
+      m_profiler.reset ();
+    }
 }
 
 void
@@ -177,7 +183,14 @@ LocalTimeSimulatorImpl::ProcessOneEvent (void)
     }
   m_currentUid = next.key.m_uid;
   NS_LOG_DEBUG ("EXECUTING EVENT ID " << m_currentUid);
-  next.impl->Invoke ();
+  if (m_profiler)
+    {
+      m_profiler->Invoke (next.impl, next.key.m_context);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
   ProcessEventsWithContext ();
 }
@@ -22,10 +22,12 @@
 #define LOCALTIME_SIMULATOR_IMPL_H
 
 #include "ns3/default-simulator-impl.h"
+#include "ns3/event-profiler.h"
 #include "ns3/local-clock.h"
 #include "ns3/system-mutex.h"
 #include "ns3/system-thread.h"
 #include <map>
+#include <memory>
 
 
 
@@ -202,6 +204,9 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event handler profiler, if enabled by the EventProfilePrefix global value. */
+  std::unique_ptr<EventProfiler> m_profiler;
 };
 
 }// namespace ns3
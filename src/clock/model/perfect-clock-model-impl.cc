@@ -117,4 +117,23 @@ PerfectClockModelImpl::LocalToGlobalDelay (Time localDelay)
   NS_LOG_DEBUG ("RETURNED TIME " << globalDelay);
   return globalDelay;
 }
+
+void
+PerfectClockModelImpl::SetOffset (Time offset)
+{
+  NS_LOG_FUNCTION (this << offset);
+  m_offset = offset;
+}
+
+Time
+PerfectClockModelImpl::GetOffset (void) const
+{
+  return m_offset;
+}
+
+double
+PerfectClockModelImpl::GetFrequency (void) const
+{
+  return m_frequency;
+}
 }
@@ -52,6 +52,21 @@ public:
   Time GlobalToLocalDelay (Time globaldDelay);
   Time LocalToGlobalDelay (Time localdelay);
 
+  /**
+   * \brief Change the offset of the clock in place. The LocalClock using this model
+   * has to be notified through LocalClock::SetClock so that its events are rescheduled.
+   * \param offset the new offset
+   */
+  void SetOffset (Time offset);
+  /**
+   * \return the offset of the clock
+   */
+  Time GetOffset (void) const;
+  /**
+   * \return the frequency of the clock
+   */
+  double GetFrequency (void) const;
+
 private:
 //Frequency of the clock
   double m_frequency;
@@ -248,6 +248,106 @@ EventSchedulTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Check that the offset of a PerfectClockModelImpl can be read and changed in place,
+ * and that the events of a LocalClock are rescheduled when it is notified of the update.
+ */
+class ClockOffsetUpdateTestCase : public TestCase
+{
+public:
+  ClockOffsetUpdateTestCase ();
+  virtual ~ClockOffsetUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Changes the offset of the clock model in place and notifies the local clock.
+   * \param offset the new offset
+   */
+  void UpdateOffset (Time offset);
+  /**
+   * Event scheduled in local time, records when it is executed.
+   */
+  void LocalEvent (void);
+
+  Ptr<LocalClock> m_localClock; //!< the clock of the node
+  Ptr<PerfectClockModelImpl> m_model; //!< the model of the clock
+  uint32_t m_executed; //!< number of executions of LocalEvent
+  Time m_globalTime; //!< simulation time at which LocalEvent was executed
+  Time m_localTime; //!< local time at which LocalEvent was executed
+};
+
+ClockOffsetUpdateTestCase::ClockOffsetUpdateTestCase ()
+  : TestCase ("Check in place offset updates of a perfect clock"),
+    m_executed (0)
+{}
+
+ClockOffsetUpdateTestCase::~ClockOffsetUpdateTestCase ()
+{}
+
+void
+ClockOffsetUpdateTestCase::UpdateOffset (Time offset)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_localClock->GetLocalTime (), Seconds (1), "Wrong local time before the update");
+  m_model->SetOffset (offset);
+  m_localClock->SetClock (m_model);
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetOffset (), offset, "Offset not updated");
+  NS_TEST_EXPECT_MSG_EQ (m_localClock->GetLocalTime (), Seconds (4), "Wrong local time after the update");
+}
+
+void
+ClockOffsetUpdateTestCase::LocalEvent (void)
+{
+  m_executed++;
+  m_globalTime = Simulator::Now ();
+  m_localTime = m_localClock->GetLocalTime ();
+}
+
+void
+ClockOffsetUpdateTestCase::DoRun (void)
+{
+  // LT = f*GT + offset
+  m_model = CreateObject<PerfectClockModelImpl> ();
+  m_model->SetAttribute ("Frequency", DoubleValue (0.5));
+  m_model->SetAttribute ("Offset", TimeValue (Seconds (1)));
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetFrequency (), 0.5, "Wrong frequency");
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetOffset (), Seconds (1), "Wrong offset");
+  NS_TEST_EXPECT_MSG_EQ (m_model->GlobalToLocalTime (Seconds (4)), Seconds (3), "Wrong local time");
+  m_model->SetOffset (Seconds (0));
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetOffset (), Seconds (0), "Offset not updated");
+  NS_TEST_EXPECT_MSG_EQ (m_model->GlobalToLocalTime (Seconds (4)), Seconds (2), "Wrong local time");
+  NS_TEST_EXPECT_MSG_EQ (m_model->LocalToGlobalTime (Seconds (2)), Seconds (4), "Wrong global time");
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetFrequency (), 0.5, "Frequency changed by the offset");
+
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue ("ns3::LocalTimeSimulatorImpl"));
+  Ptr<Node> node = CreateObject<Node> ();
+  m_localClock = CreateObject<LocalClock> ();
+  m_localClock->SetAttribute ("ClockModel", PointerValue (m_model));
+  node->AggregateObject (m_localClock);
+
+  // 2 s of local time are 4 s of simulation time
+  EventId event;
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (0), [this, &event] ()
+    {
+      event = Simulator::Schedule (Seconds (2), &ClockOffsetUpdateTestCase::LocalEvent, this);
+    });
+  // at 2 s the local time jumps from 1 s to 4 s, the remaining local delay of the event
+  // is still converted with the frequency of the clock
+  Simulator::ScheduleWithContext (node->GetId (), Seconds (2),
+                                  &ClockOffsetUpdateTestCase::UpdateOffset, this, Seconds (3));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_executed, 1, "Rescheduled event not executed once");
+  NS_TEST_EXPECT_MSG_EQ (m_globalTime, Seconds (4), "Rescheduled event executed at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_localTime, Seconds (5), "Wrong local time after the update");
+  NS_TEST_EXPECT_MSG_EQ (event.IsExpired (), true, "Original event still pending");
+  Simulator::Destroy ();
+  m_localClock = 0;
+  m_model = 0;
+}
+
 class LocalSimulatorTestSuite : public TestSuite
 {
 public:
@@ -258,5 +358,6 @@ public:
     factory.SetTypeId (ListScheduler::GetTypeId ());
 
     AddTestCase (new EventSchedulTestCase ("Check basic event handling is working", factory), TestCase::QUICK);
+    AddTestCase (new ClockOffsetUpdateTestCase (), TestCase::QUICK);
   }
 } g_localSimulatorTestSuite;
\ No newline at end of file
@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+
+#include "abort.h"
+#include "assert.h"
+#include "config.h"
+#include "log.h"
+#include "random-variable-stream.h"
+#include "rng-seed-manager.h"
+#include "simulator-impl.h"
+#include "simulator.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Checkpoint");
+
+Checkpoint::Checkpoint()
+    : m_maxParallel(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+Checkpoint::AddBranch(uint64_t run, std::string output)
+{
+    NS_LOG_FUNCTION(this << run << output);
+    m_branches.push_back({run, output, {}, -1});
+    return m_branches.size() - 1;
+}
+
+void
+Checkpoint::SetBranchConfig(uint32_t branch, std::string path, const AttributeValue& value)
+{
+    NS_LOG_FUNCTION(this << branch << path << &value);
+    NS_ASSERT_MSG(branch < m_branches.size(), "unknown branch " << branch);
+    m_branches[branch].config.emplace_back(path, value.Copy());
+}
+
+void
+Checkpoint::SetMaxParallel(uint32_t maxParallel)
+{
+    NS_LOG_FUNCTION(this << maxParallel);
+    m_maxParallel = maxParallel;
+}
+
+int
+Checkpoint::Fork(Time time)
+{
+    NS_LOG_FUNCTION(this << time);
+    NS_ABORT_MSG_IF(Simulator::GetImplementation()->GetInstanceTypeId().GetName() !=
+                        "ns3::DefaultSimulatorImpl",
+                    "only the ns3::DefaultSimulatorImpl can be forked");
+    NS_ABORT_MSG_IF(time < Simulator::Now(), "the checkpoint is in the past");
+
+    Simulator::Stop(time - Simulator::Now());
+    Simulator::Run();
+    NS_LOG_LOGIC("checkpoint at " << Simulator::Now().As(Time::S) << ", "
+                                  << Simulator::GetEventCount() << " events");
+
+    std::map<pid_t, uint32_t> children;
+    auto wait = [this, &children]() {
+        int status;
+        pid_t pid;
+        do
+        {
+            pid = waitpid(-1, &status, 0);
+        } while (pid < 0 && errno == EINTR);
+        NS_ABORT_MSG_IF(pid < 0, "waitpid failed: " << std::strerror(errno));
+        auto it = children.find(pid);
+        NS_ASSERT(it != children.end());
+        Branch& branch = m_branches[it->second];
+        branch.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        NS_LOG_LOGIC("branch " << it->second << " exited with " << branch.status);
+        children.erase(it);
+    };
+
+    for (uint32_t i = 0; i < m_branches.size(); ++i)
+    {
+        if (m_maxParallel > 0 && children.size() >= m_maxParallel)
+        {
+            wait();
+        }
+        // the buffered output would be written by the child too
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+        pid_t pid = fork();
+        NS_ABORT_MSG_IF(pid < 0, "fork failed: " << std::strerror(errno));
+        if (pid == 0)
+        {
+            StartBranch(i);
+            return i;
+        }
+        NS_LOG_LOGIC("branch " << i << " forked as process " << pid);
+        children[pid] = i;
+    }
+    while (!children.empty())
+    {
+        wait();
+    }
+    return PARENT;
+}
+
+void
+Checkpoint::StartBranch(uint32_t branch) const
+{
+    NS_LOG_FUNCTION(this << branch);
+    const Branch& b = m_branches[branch];
+    if (!b.output.empty())
+    {
+        NS_ABORT_MSG_IF(std::freopen(b.output.c_str(), "w", stdout) == nullptr,
+                        "cannot open " << b.output << ": " << std::strerror(errno));
+    }
+    RngSeedManager::SetRun(b.run);
+    RandomVariableStream::ResetRun();
+    for (const auto& [path, value] : b.config)
+    {
+        Config::Set(path, *value);
+    }
+}
+
+uint32_t
+Checkpoint::GetNBranches() const
+{
+    return m_branches.size();
+}
+
+std::string
+Checkpoint::GetOutput(uint32_t branch) const
+{
+    NS_ASSERT_MSG(branch < m_branches.size(), "unknown branch " << branch);
+    return m_branches[branch].output;
+}
+
+int
+Checkpoint::GetExitStatus(uint32_t branch) const
+{
+    NS_ASSERT_MSG(branch < m_branches.size(), "unknown branch " << branch);
+    return m_branches[branch].status;
+}
+
+} // namespace ns3
@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "attribute.h"
+#include "nstime.h"
+#include "ptr.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Warm start of several simulations from a common state.
+ *
+ * Fork() runs the simulation up to the checkpoint, then forks one process
+ * per branch. Each child process is a copy-on-write clone of the simulation
+ * at the checkpoint: it sets the run number of its branch, restarts every
+ * RandomVariableStream from that run with RandomVariableStream::ResetRun(),
+ * applies the Config::Set overrides of its branch, redirects its standard
+ * output to the output file of its branch, and returns from Fork() with
+ * the index of its branch to continue the simulation. The parent process
+ * waits for the children and returns Checkpoint::PARENT, after which the
+ * exit statuses of the branches are available.
+ *
+ * A sweep thus pays once for the setup of the scenario, such as the attach
+ * phase of the UEs, and only for the rest of the simulation in each branch:
+ *
+ * \code
+ *   Checkpoint checkpoint;
+ *   for (uint64_t run = 1; run <= 8; ++run)
+ *   {
+ *       checkpoint.AddBranch(run, "run-" + std::to_string(run) + ".txt");
+ *   }
+ *   if (checkpoint.Fork(Seconds(2)) == Checkpoint::PARENT)
+ *   {
+ *       Simulator::Destroy();
+ *       return 0;
+ *   }
+ *   Simulator::Stop(Seconds(10));
+ *   Simulator::Run();
+ *   Simulator::Destroy();
+ * \endcode
+ *
+ * The state is cloned as is: the files opened before the checkpoint are
+ * shared by the branches, and the data buffered in their streams when
+ * Fork() is called is written by every branch, so the trace files should be
+ * flushed before the checkpoint and opened after it. The values drawn
+ * after the checkpoint differ from those of a simulation started with the
+ * run number of the branch, since the random variables created before the
+ * checkpoint restart at the beginning of their new substream.
+ *
+ * Only the single-threaded ns3::DefaultSimulatorImpl can be forked, and
+ * only on POSIX systems.
+ */
+class Checkpoint
+{
+  public:
+    /** The value returned by Fork() in the parent process. */
+    static const int PARENT = -1;
+
+    /** Constructor. */
+    Checkpoint();
+
+    /**
+     * Add a branch.
+     *
+     * \param [in] run The run number of the branch.
+     * \param [in] output The file receiving the standard output of the
+     *             branch, or an empty string to keep the output of the parent.
+     * \returns The index of the branch.
+     */
+    uint32_t AddBranch(uint64_t run, std::string output = "");
+
+    /**
+     * Add a Config::Set override to a branch, applied at the checkpoint.
+     *
+     * \param [in] branch The index of the branch.
+     * \param [in] path The path of the attributes.
+     * \param [in] value The value of the attributes.
+     */
+    void SetBranchConfig(uint32_t branch, std::string path, const AttributeValue& value);
+
+    /**
+     * Set the number of branches run at the same time.
+     *
+     * \param [in] maxParallel The maximum number of child processes, or 0
+     *             to run all the branches at the same time.
+     */
+    void SetMaxParallel(uint32_t maxParallel);
+
+    /**
+     * Run the simulation up to the checkpoint and fork the branches.
+     *
+     * \param [in] time The absolute simulation time of the checkpoint.
+     * \returns The index of the branch in the child processes, or
+     *          Checkpoint::PARENT in the parent process once all the
+     *          branches have exited.
+     */
+    int Fork(Time time);
+
+    /**
+     * \returns The number of branches.
+     */
+    uint32_t GetNBranches() const;
+
+    /**
+     * \param [in] branch The index of the branch.
+     * \returns The output file of the branch.
+     */
+    std::string GetOutput(uint32_t branch) const;
+
+    /**
+     * Get the exit status of a branch, in the parent process after Fork().
+     *
+     * \param [in] branch The index of the branch.
+     * \returns The exit status of the branch, or 128 plus the number of
+     *          the signal which terminated it.
+     */
+    int GetExitStatus(uint32_t branch) const;
+
+  private:
+    /**
+     * Set up the child process of a branch.
+     *
+     * \param [in] branch The index of the branch.
+     */
+    void StartBranch(uint32_t branch) const;
+
+    /** A branch of the simulation. */
+    struct Branch
+    {
+        uint64_t run;       //!< The run number.
+        std::string output; //!< The file receiving the standard output.
+        /** The Config::Set overrides. */
+        std::vector<std::pair<std::string, Ptr<AttributeValue>>> config;
+        int status; //!< The exit status.
+    };
+
+    std::vector<Branch> m_branches; //!< The branches.
+    uint32_t m_maxParallel;         //!< The maximum number of child processes.
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
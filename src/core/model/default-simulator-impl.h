@@ -20,9 +20,11 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "event-profiler.h"
 #include "simulator-impl.h"
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -135,6 +137,9 @@ class DefaultSimulatorImpl : public SimulatorImpl
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
+
+    /** The event handler profiler, if enabled by the EventProfilePrefix global value. */
+    std::unique_ptr<EventProfiler> m_profiler;
 };
 
 } // namespace ns3
@@ -0,0 +1,487 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-allocator.h"
+
+#include "assert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventAllocator implementation.
+ */
+
+#if defined(__SANITIZE_ADDRESS__)
+#define NS3_EVENT_ALLOCATOR_BYPASS
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NS3_EVENT_ALLOCATOR_BYPASS
+#endif
+#endif
+
+namespace ns3
+{
+
+namespace
+{
+
+/** Number of size classes, shorthand. */
+const std::size_t N_CLASSES = EventAllocator::NUM_SIZE_CLASSES;
+
+/** A released object, linked in the free list of its size class. */
+struct FreeBlock
+{
+    FreeBlock* m_next; //!< Next free object.
+};
+
+/** Allocation counters of a thread. */
+struct Counters
+{
+    std::atomic<uint64_t> m_allocations[N_CLASSES];   //!< Objects allocated.
+    std::atomic<uint64_t> m_deallocations[N_CLASSES]; //!< Objects released.
+    std::atomic<uint64_t> m_reused[N_CLASSES];        //!< Allocations served by a free object.
+    std::atomic<uint64_t> m_unpooled;                 //!< Allocations forwarded to ::operator new.
+
+    Counters()
+        : m_unpooled(0)
+    {
+        for (std::size_t i = 0; i < N_CLASSES; ++i)
+        {
+            m_allocations[i] = 0;
+            m_deallocations[i] = 0;
+            m_reused[i] = 0;
+        }
+    }
+};
+
+/**
+ * Increment a counter only ever written by the current thread.
+ *
+ * \param [in,out] counter The counter.
+ */
+inline void
+Increment(std::atomic<uint64_t>& counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/** State shared by all the threads, protected by m_mutex. */
+struct Depot
+{
+    std::mutex m_mutex;                    //!< Protects all the fields.
+    FreeBlock* m_free[N_CLASSES];          //!< Free objects returned by the threads.
+    std::size_t m_freeCount[N_CLASSES];    //!< Length of the m_free lists.
+    uint64_t m_slabs[N_CLASSES];           //!< Number of slabs carved for each class.
+    std::vector<void*> m_slabList;         //!< All the slabs, kept reachable.
+    std::vector<const Counters*> m_active; //!< Counters of the running threads.
+    uint64_t m_retiredAllocations[N_CLASSES];   //!< Allocations of the terminated threads.
+    uint64_t m_retiredDeallocations[N_CLASSES]; //!< Deallocations of the terminated threads.
+    uint64_t m_retiredReused[N_CLASSES];        //!< Reuses of the terminated threads.
+    uint64_t m_retiredUnpooled;                 //!< Unpooled allocations of the terminated threads.
+
+    Depot()
+        : m_retiredUnpooled(0)
+    {
+        for (std::size_t i = 0; i < N_CLASSES; ++i)
+        {
+            m_free[i] = nullptr;
+            m_freeCount[i] = 0;
+            m_slabs[i] = 0;
+            m_retiredAllocations[i] = 0;
+            m_retiredDeallocations[i] = 0;
+            m_retiredReused[i] = 0;
+        }
+    }
+
+    /**
+     * Allocate a new slab. The caller must hold m_mutex.
+     *
+     * \param [in] sizeClass The size class the slab is carved for.
+     * \returns The slab.
+     */
+    char* NewSlab(std::size_t sizeClass)
+    {
+        char* slab = static_cast<char*>(::operator new(EventAllocator::SLAB_SIZE));
+        m_slabList.push_back(slab);
+        m_slabs[sizeClass]++;
+        return slab;
+    }
+};
+
+/**
+ * The depot is never destroyed, as events may be released by static
+ * destructors running after any other static object is gone.
+ *
+ * \returns The depot.
+ */
+Depot&
+GetDepot()
+{
+    static Depot* depot = new Depot();
+    return *depot;
+}
+
+/** Free lists and counters private to a thread. */
+class ThreadCache
+{
+  public:
+    ThreadCache();
+    ~ThreadCache();
+
+    /**
+     * \param [in] sizeClass The size class.
+     * \returns An object of the size class.
+     */
+    void* Allocate(std::size_t sizeClass);
+
+    /**
+     * \param [in] p An object of the size class.
+     * \param [in] sizeClass The size class.
+     */
+    void Deallocate(void* p, std::size_t sizeClass);
+
+    Counters m_counters; //!< Allocation counters.
+
+  private:
+    /**
+     * Refill an empty free list from the depot or from the current slab.
+     *
+     * \param [in] sizeClass The size class.
+     * \returns An object of the size class.
+     */
+    void* Refill(std::size_t sizeClass);
+
+    /**
+     * Return half of a free list to the depot.
+     *
+     * \param [in] sizeClass The size class.
+     */
+    void Spill(std::size_t sizeClass);
+
+    FreeBlock* m_free[N_CLASSES];       //!< Free objects of each class.
+    std::size_t m_freeCount[N_CLASSES]; //!< Length of the m_free lists.
+    char* m_slabNext[N_CLASSES];        //!< Next uncarved byte of the current slab.
+    char* m_slabEnd[N_CLASSES];         //!< End of the current slab.
+};
+
+/** Whether the ThreadCache of this thread has been destroyed. */
+thread_local bool t_cacheDestroyed = false;
+
+/** The ThreadCache of this thread. */
+thread_local ThreadCache t_cache;
+
+ThreadCache::ThreadCache()
+{
+    for (std::size_t i = 0; i < N_CLASSES; ++i)
+    {
+        m_free[i] = nullptr;
+        m_freeCount[i] = 0;
+        m_slabNext[i] = nullptr;
+        m_slabEnd[i] = nullptr;
+    }
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    depot.m_active.push_back(&m_counters);
+}
+
+ThreadCache::~ThreadCache()
+{
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    for (std::size_t i = 0; i < N_CLASSES; ++i)
+    {
+        // the objects left in the current slab are lost until the slab is reused, which is
+        // never: return them to the depot as well
+        std::size_t size = (i + 1) * EventAllocator::GRANULARITY;
+        while (m_slabNext[i] != nullptr && m_slabNext[i] + size <= m_slabEnd[i])
+        {
+            auto block = reinterpret_cast<FreeBlock*>(m_slabNext[i]);
+            block->m_next = m_free[i];
+            m_free[i] = block;
+            m_freeCount[i]++;
+            m_slabNext[i] += size;
+        }
+        while (m_free[i] != nullptr)
+        {
+            FreeBlock* block = m_free[i];
+            m_free[i] = block->m_next;
+            block->m_next = depot.m_free[i];
+            depot.m_free[i] = block;
+        }
+        depot.m_freeCount[i] += m_freeCount[i];
+        depot.m_retiredAllocations[i] += m_counters.m_allocations[i];
+        depot.m_retiredDeallocations[i] += m_counters.m_deallocations[i];
+        depot.m_retiredReused[i] += m_counters.m_reused[i];
+    }
+    depot.m_retiredUnpooled += m_counters.m_unpooled;
+    depot.m_active.erase(std::find(depot.m_active.begin(), depot.m_active.end(), &m_counters));
+    t_cacheDestroyed = true;
+}
+
+inline void*
+ThreadCache::Allocate(std::size_t sizeClass)
+{
+    Increment(m_counters.m_allocations[sizeClass]);
+    FreeBlock* block = m_free[sizeClass];
+    if (block == nullptr)
+    {
+        return Refill(sizeClass);
+    }
+    Increment(m_counters.m_reused[sizeClass]);
+    m_free[sizeClass] = block->m_next;
+    m_freeCount[sizeClass]--;
+    return block;
+}
+
+inline void
+ThreadCache::Deallocate(void* p, std::size_t sizeClass)
+{
+    Increment(m_counters.m_deallocations[sizeClass]);
+    auto block = static_cast<FreeBlock*>(p);
+    block->m_next = m_free[sizeClass];
+    m_free[sizeClass] = block;
+    if (++m_freeCount[sizeClass] > EventAllocator::MAX_CACHED_BLOCKS)
+    {
+        Spill(sizeClass);
+    }
+}
+
+void*
+ThreadCache::Refill(std::size_t sizeClass)
+{
+    std::size_t size = (sizeClass + 1) * EventAllocator::GRANULARITY;
+    if (m_slabNext[sizeClass] == nullptr || m_slabNext[sizeClass] + size > m_slabEnd[sizeClass])
+    {
+        Depot& depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.m_mutex);
+        if (depot.m_free[sizeClass] != nullptr)
+        {
+            // take up to half of the thread limit from the objects released by other threads
+            std::size_t count = 0;
+            while (depot.m_free[sizeClass] != nullptr &&
+                   count < EventAllocator::MAX_CACHED_BLOCKS / 2)
+            {
+                FreeBlock* block = depot.m_free[sizeClass];
+                depot.m_free[sizeClass] = block->m_next;
+                block->m_next = m_free[sizeClass];
+                m_free[sizeClass] = block;
+                count++;
+            }
+            depot.m_freeCount[sizeClass] -= count;
+            Increment(m_counters.m_reused[sizeClass]);
+            FreeBlock* block = m_free[sizeClass];
+            m_free[sizeClass] = block->m_next;
+            m_freeCount[sizeClass] = count - 1;
+            return block;
+        }
+        m_slabNext[sizeClass] = depot.NewSlab(sizeClass);
+        m_slabEnd[sizeClass] = m_slabNext[sizeClass] + EventAllocator::SLAB_SIZE;
+    }
+    void* p = m_slabNext[sizeClass];
+    m_slabNext[sizeClass] += size;
+    return p;
+}
+
+void
+ThreadCache::Spill(std::size_t sizeClass)
+{
+    std::size_t count = m_freeCount[sizeClass] / 2;
+    FreeBlock* first = m_free[sizeClass];
+    FreeBlock* last = first;
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        last = last->m_next;
+    }
+    m_free[sizeClass] = last->m_next;
+    m_freeCount[sizeClass] -= count;
+
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    last->m_next = depot.m_free[sizeClass];
+    depot.m_free[sizeClass] = first;
+    depot.m_freeCount[sizeClass] += count;
+}
+
+/**
+ * Allocate from the depot, for threads whose cache is gone.
+ *
+ * \param [in] sizeClass The size class.
+ * \returns An object of the size class.
+ */
+void*
+DepotAllocate(std::size_t sizeClass)
+{
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    depot.m_retiredAllocations[sizeClass]++;
+    if (depot.m_free[sizeClass] == nullptr)
+    {
+        // carve a whole slab into the depot list
+        std::size_t size = (sizeClass + 1) * EventAllocator::GRANULARITY;
+        char* slab = depot.NewSlab(sizeClass);
+        for (char* p = slab; p + size <= slab + EventAllocator::SLAB_SIZE; p += size)
+        {
+            auto block = reinterpret_cast<FreeBlock*>(p);
+            block->m_next = depot.m_free[sizeClass];
+            depot.m_free[sizeClass] = block;
+            depot.m_freeCount[sizeClass]++;
+        }
+    }
+    else
+    {
+        depot.m_retiredReused[sizeClass]++;
+    }
+    FreeBlock* block = depot.m_free[sizeClass];
+    depot.m_free[sizeClass] = block->m_next;
+    depot.m_freeCount[sizeClass]--;
+    return block;
+}
+
+/**
+ * Release to the depot, for threads whose cache is gone.
+ *
+ * \param [in] p An object of the size class.
+ * \param [in] sizeClass The size class.
+ */
+void
+DepotDeallocate(void* p, std::size_t sizeClass)
+{
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    depot.m_retiredDeallocations[sizeClass]++;
+    auto block = static_cast<FreeBlock*>(p);
+    block->m_next = depot.m_free[sizeClass];
+    depot.m_free[sizeClass] = block;
+    depot.m_freeCount[sizeClass]++;
+}
+
+} // unnamed namespace
+
+void*
+EventAllocator::Allocate(std::size_t size)
+{
+#ifndef NS3_EVENT_ALLOCATOR_BYPASS
+    if (size <= MAX_POOLED_SIZE)
+    {
+        NS_ASSERT(size > 0);
+        std::size_t sizeClass = (size - 1) / GRANULARITY;
+        if (t_cacheDestroyed)
+        {
+            return DepotAllocate(sizeClass);
+        }
+        return t_cache.Allocate(sizeClass);
+    }
+    if (!t_cacheDestroyed)
+    {
+        Increment(t_cache.m_counters.m_unpooled);
+    }
+#endif
+    return ::operator new(size);
+}
+
+void
+EventAllocator::Deallocate(void* p, std::size_t size)
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+#ifndef NS3_EVENT_ALLOCATOR_BYPASS
+    if (size <= MAX_POOLED_SIZE)
+    {
+        std::size_t sizeClass = (size - 1) / GRANULARITY;
+        if (t_cacheDestroyed)
+        {
+            DepotDeallocate(p, sizeClass);
+            return;
+        }
+        t_cache.Deallocate(p, sizeClass);
+        return;
+    }
+#endif
+    ::operator delete(p);
+}
+
+uint64_t
+EventAllocator::Stats::GetLiveObjects() const
+{
+    return m_allocations - m_deallocations;
+}
+
+EventAllocator::Stats
+EventAllocator::GetStats()
+{
+    Stats stats;
+    stats.m_allocations = 0;
+    stats.m_deallocations = 0;
+    stats.m_reused = 0;
+    stats.m_slabBytes = 0;
+
+    Depot& depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.m_mutex);
+    stats.m_unpooledAllocations = depot.m_retiredUnpooled;
+    for (const Counters* counters : depot.m_active)
+    {
+        stats.m_unpooledAllocations += counters->m_unpooled.load(std::memory_order_relaxed);
+    }
+    for (std::size_t i = 0; i < N_CLASSES; ++i)
+    {
+        SizeClassStats sizeClass;
+        sizeClass.m_size = (i + 1) * GRANULARITY;
+        sizeClass.m_allocations = depot.m_retiredAllocations[i];
+        sizeClass.m_deallocations = depot.m_retiredDeallocations[i];
+        sizeClass.m_reused = depot.m_retiredReused[i];
+        sizeClass.m_slabs = depot.m_slabs[i];
+        for (const Counters* counters : depot.m_active)
+        {
+            sizeClass.m_allocations += counters->m_allocations[i].load(std::memory_order_relaxed);
+            sizeClass.m_deallocations +=
+                counters->m_deallocations[i].load(std::memory_order_relaxed);
+            sizeClass.m_reused += counters->m_reused[i].load(std::memory_order_relaxed);
+        }
+        stats.m_allocations += sizeClass.m_allocations;
+        stats.m_deallocations += sizeClass.m_deallocations;
+        stats.m_reused += sizeClass.m_reused;
+        stats.m_sizeClasses.push_back(sizeClass);
+    }
+    stats.m_slabBytes = depot.m_slabList.size() * SLAB_SIZE;
+    return stats;
+}
+
+void
+EventAllocator::PrintStats(std::ostream& os)
+{
+    Stats stats = GetStats();
+    os << "events allocated " << stats.m_allocations << " released " << stats.m_deallocations
+       << " reused " << stats.m_reused << " live " << stats.GetLiveObjects() << " unpooled "
+       << stats.m_unpooledAllocations << " slab bytes " << stats.m_slabBytes << std::endl;
+    for (const SizeClassStats& sizeClass : stats.m_sizeClasses)
+    {
+        if (sizeClass.m_allocations == 0)
+        {
+            continue;
+        }
+        os << "  size " << sizeClass.m_size << " allocated " << sizeClass.m_allocations
+           << " released " << sizeClass.m_deallocations << " reused " << sizeClass.m_reused
+           << " slabs " << sizeClass.m_slabs << std::endl;
+    }
+}
+
+} // namespace ns3
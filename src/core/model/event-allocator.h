@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_ALLOCATOR_H
+#define EVENT_ALLOCATOR_H
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventAllocator declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup events
+ * \brief Size-class slab allocator for the EventImpl instances.
+ *
+ * Every event created by MakeEvent (and hence by Simulator::Schedule and
+ * friends) is an EventImpl subclass holding the bound function and a copy
+ * of its arguments, so that a simulation allocates and releases one small
+ * object per event. EventImpl routes these allocations here.
+ *
+ * Objects up to MAX_POOLED_SIZE bytes are rounded up to a multiple of
+ * GRANULARITY bytes and carved from slabs of SLAB_SIZE bytes. Released
+ * objects are kept on a free list of their size class and reused by the
+ * next event of the same size class. Free lists are private to each
+ * thread, so that neither allocating nor releasing an event takes a lock;
+ * a thread holding more than MAX_CACHED_BLOCKS free objects of a size
+ * class returns half of them to a shared depot, from which the other
+ * threads refill their lists. Slabs are never returned to the system.
+ *
+ * Larger objects, and all objects in builds with AddressSanitizer, use
+ * the global allocator.
+ */
+class EventAllocator
+{
+  public:
+    /** Size classes are multiples of this many bytes. */
+    static const std::size_t GRANULARITY = 16;
+    /** Largest object served from the slabs. */
+    static const std::size_t MAX_POOLED_SIZE = 256;
+    /** Number of size classes. */
+    static const std::size_t NUM_SIZE_CLASSES = MAX_POOLED_SIZE / GRANULARITY;
+    /** Size of the slabs. */
+    static const std::size_t SLAB_SIZE = 64 * 1024;
+    /** Number of free objects of a size class a thread keeps for itself. */
+    static const std::size_t MAX_CACHED_BLOCKS = 4096;
+
+    /** Statistics of a size class. */
+    struct SizeClassStats
+    {
+        std::size_t m_size;       //!< Size of the objects of this class, in bytes.
+        uint64_t m_allocations;   //!< Number of objects allocated.
+        uint64_t m_deallocations; //!< Number of objects released.
+        uint64_t m_reused;        //!< Number of allocations served by a released object.
+        uint64_t m_slabs;         //!< Number of slabs carved for this class.
+    };
+
+    /** Allocator statistics. */
+    struct Stats
+    {
+        uint64_t m_allocations;          //!< Number of objects allocated.
+        uint64_t m_deallocations;        //!< Number of objects released.
+        uint64_t m_reused;               //!< Number of allocations served by a released object.
+        uint64_t m_unpooledAllocations;  //!< Allocations forwarded to the global allocator.
+        uint64_t m_slabBytes;            //!< Memory held by the slabs, in bytes.
+        std::vector<SizeClassStats> m_sizeClasses; //!< Statistics of each size class.
+
+        /** \returns The number of objects currently allocated. */
+        uint64_t GetLiveObjects() const;
+    };
+
+    /**
+     * Allocate memory for an event.
+     *
+     * \param [in] size The size of the event, in bytes.
+     * \returns The memory, aligned for any fundamental type.
+     */
+    static void* Allocate(std::size_t size);
+
+    /**
+     * Release memory obtained from Allocate().
+     *
+     * \param [in] p The memory.
+     * \param [in] size The size passed to Allocate().
+     */
+    static void Deallocate(void* p, std::size_t size);
+
+    /**
+     * \returns The statistics of all the threads, past and present.
+     */
+    static Stats GetStats();
+
+    /**
+     * Print the statistics.
+     *
+     * \param [in] os The output stream.
+     */
+    static void PrintStats(std::ostream& os);
+};
+
+} // namespace ns3
+
+#endif /* EVENT_ALLOCATOR_H */
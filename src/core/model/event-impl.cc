@@ -19,6 +19,7 @@
 
 #include "event-impl.h"
 
+#include "event-allocator.h"
 #include "log.h"
 
 /**
@@ -67,4 +68,34 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+const void*
+EventImpl::GetHandlerAddress() const
+{
+    return nullptr;
+}
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    return EventAllocator::Allocate(size);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    EventAllocator::Deallocate(p, size);
+}
+
+void*
+EventImpl::operator new(std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size, std::align_val_t alignment)
+{
+    ::operator delete(p, size, alignment);
+}
+
 } // namespace ns3
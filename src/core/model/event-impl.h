@@ -21,6 +21,8 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
+#include <new>
 #include <stdint.h>
 
 /**
@@ -66,6 +68,46 @@ class EventImpl : public SimpleRefCount<EventImpl>
      * Checked by the simulation engine before calling Invoke().
      */
     bool IsCancelled();
+    /**
+     * Get the address of the function called by this event, for profiling.
+     *
+     * The class instance of a class method is looked up, so this must be
+     * called before the event is invoked.
+     *
+     * \returns The address of the function, or \c nullptr if it is not known.
+     */
+    virtual const void* GetHandlerAddress() const;
+
+    /**
+     * Allocate an event from the EventAllocator pools.
+     *
+     * \param [in] size The size of the event.
+     * \returns The memory for the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release an event to the EventAllocator pools.
+     *
+     * \param [in] p The event.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+    /**
+     * Allocate an over-aligned event with the global allocator.
+     *
+     * \param [in] size The size of the event.
+     * \param [in] alignment The alignment of the event.
+     * \returns The memory for the event.
+     */
+    static void* operator new(std::size_t size, std::align_val_t alignment);
+    /**
+     * Release an over-aligned event.
+     *
+     * \param [in] p The event.
+     * \param [in] size The size of the event.
+     * \param [in] alignment The alignment of the event.
+     */
+    static void operator delete(void* p, std::size_t size, std::align_val_t alignment);
 
   protected:
     /**
@@ -0,0 +1,300 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "abort.h"
+#include "event-impl.h"
+#include "global-value.h"
+#include "log.h"
+#include "simulator.h"
+#include "string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <typeinfo>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#define NS3_EVENT_PROFILER_DLADDR
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+/**
+ * \ingroup simulator
+ * \anchor GlobalValueEventProfilePrefix
+ * The prefix of the files written by the event handler profiler.
+ */
+static GlobalValue g_eventProfilePrefix =
+    GlobalValue("EventProfilePrefix",
+                "The prefix of the files written by the event handler profiler at "
+                "Simulator::Destroy, or an empty string to disable the profiler",
+                StringValue(""),
+                MakeStringChecker());
+
+namespace
+{
+
+/**
+ * \ingroup simulator
+ * Demangle a C++ symbol or type name.
+ *
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \p mangled if it cannot be demangled.
+ */
+std::string
+Demangle(const char* mangled)
+{
+    std::string name = mangled;
+#if (__GNUC__ >= 3)
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0)
+    {
+        name = demangled;
+    }
+    std::free(demangled);
+#endif
+    return name;
+}
+
+} // unnamed namespace
+
+void
+EventProfiler::Histogram::Add(uint64_t value)
+{
+    uint32_t index;
+    if (value < HISTOGRAM_SUB_BUCKETS)
+    {
+        index = value;
+    }
+    else
+    {
+        // the sub-bucket is given by the bits following the most significant one
+        uint32_t exponent = 63 - __builtin_clzll(value);
+        uint32_t shift = exponent - 4;
+        index = (exponent - 3) * HISTOGRAM_SUB_BUCKETS + ((value >> shift) & 15);
+    }
+    if (index >= m_counts.size())
+    {
+        m_counts.resize(index + 1, 0);
+    }
+    m_counts[index]++;
+    m_total++;
+}
+
+uint64_t
+EventProfiler::Histogram::GetPercentile(double percentile) const
+{
+    uint64_t rank = std::max<uint64_t>(1, std::ceil(percentile / 100 * m_total));
+    uint64_t count = 0;
+    for (uint32_t index = 0; index < m_counts.size(); ++index)
+    {
+        count += m_counts[index];
+        if (count >= rank)
+        {
+            if (index < HISTOGRAM_SUB_BUCKETS)
+            {
+                return index;
+            }
+            uint32_t exponent = index / HISTOGRAM_SUB_BUCKETS + 3;
+            uint64_t sub = index % HISTOGRAM_SUB_BUCKETS;
+            return (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 4);
+        }
+    }
+    return 0;
+}
+
+std::unique_ptr<EventProfiler>
+EventProfiler::Create()
+{
+    StringValue prefix;
+    g_eventProfilePrefix.GetValue(prefix);
+    if (prefix.Get().empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<EventProfiler>(prefix.Get());
+}
+
+EventProfiler::EventProfiler(std::string prefix)
+    : m_prefix(prefix)
+{
+    NS_LOG_FUNCTION(this << prefix);
+}
+
+void
+EventProfiler::Invoke(EventImpl* event, uint32_t context)
+{
+    if (event->IsCancelled())
+    {
+        return;
+    }
+    uint32_t index = GetHandler(event);
+
+    auto start = std::chrono::steady_clock::now();
+    event->Invoke();
+    auto end = std::chrono::steady_clock::now();
+    uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    Handler& handler = m_handlers[index];
+    handler.m_count++;
+    handler.m_time += time;
+    handler.m_max = std::max(handler.m_max, time);
+    handler.m_histogram.Add(time);
+    Totals& totals = m_contexts[(static_cast<uint64_t>(context) << 32) | index];
+    totals.m_count++;
+    totals.m_time += time;
+}
+
+uint32_t
+EventProfiler::GetHandler(EventImpl* event)
+{
+    const void* address = event->GetHandlerAddress();
+    const void* key = address ? address : static_cast<const void*>(&typeid(*event));
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        return it->second;
+    }
+    uint32_t index = m_handlers.size();
+    m_handlers.emplace_back();
+    m_handlers.back().m_name = GetName(event, address);
+    m_index.emplace(key, index);
+    return index;
+}
+
+std::string
+EventProfiler::GetName(EventImpl* event, const void* address)
+{
+#ifdef NS3_EVENT_PROFILER_DLADDR
+    Dl_info info;
+    if (address && dladdr(address, &info) && info.dli_sname)
+    {
+        return Demangle(info.dli_sname);
+    }
+#endif
+    // the type of the event holds the signature of the function, or the lambda
+    std::ostringstream oss;
+    oss << Demangle(typeid(*event).name());
+    if (address)
+    {
+        oss << " at " << address;
+    }
+    return oss.str();
+}
+
+std::string
+EventProfiler::GetContextLabel(uint32_t context)
+{
+    if (context == Simulator::NO_CONTEXT)
+    {
+        return "no context";
+    }
+    return "node " + std::to_string(context);
+}
+
+void
+EventProfiler::Write() const
+{
+    NS_LOG_FUNCTION(this);
+
+    std::vector<uint32_t> order(m_handlers.size());
+    uint64_t count = 0;
+    uint64_t time = 0;
+    for (uint32_t i = 0; i < m_handlers.size(); ++i)
+    {
+        order[i] = i;
+        count += m_handlers[i].m_count;
+        time += m_handlers[i].m_time;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_handlers[a].m_time > m_handlers[b].m_time;
+    });
+
+    std::map<uint32_t, Totals> contexts;
+    for (const auto& [key, totals] : m_contexts)
+    {
+        Totals& context = contexts[key >> 32];
+        context.m_count += totals.m_count;
+        context.m_time += totals.m_time;
+    }
+    std::vector<std::pair<uint32_t, Totals>> contextOrder(contexts.begin(), contexts.end());
+    std::stable_sort(contextOrder.begin(), contextOrder.end(), [](const auto& a, const auto& b) {
+        return a.second.m_time > b.second.m_time;
+    });
+
+    std::string reportName = m_prefix + ".txt";
+    std::ofstream report(reportName);
+    NS_ABORT_MSG_UNLESS(report.is_open(), "Unable to open " << reportName);
+    report << "# " << count << " events, " << time * 1e-9 << " s in event handlers" << std::endl;
+    report << "# total(s) share(%) count mean(us) p50(us) p99(us) p99.9(us) max(us) handler"
+           << std::endl;
+    report << std::fixed;
+    for (uint32_t i : order)
+    {
+        const Handler& handler = m_handlers[i];
+        report << std::setprecision(6) << handler.m_time * 1e-9 << " " << std::setprecision(2)
+               << (time ? 100.0 * handler.m_time / time : 0) << " " << handler.m_count << " "
+               << std::setprecision(3) << 1e-3 * handler.m_time / handler.m_count << " "
+               << handler.m_histogram.GetPercentile(50) * 1e-3 << " "
+               << handler.m_histogram.GetPercentile(99) * 1e-3 << " "
+               << handler.m_histogram.GetPercentile(99.9) * 1e-3 << " " << handler.m_max * 1e-3
+               << " " << handler.m_name << std::endl;
+    }
+    report << std::endl;
+    report << "# total(s) share(%) count context" << std::endl;
+    for (const auto& [context, totals] : contextOrder)
+    {
+        report << std::setprecision(6) << totals.m_time * 1e-9 << " " << std::setprecision(2)
+               << (time ? 100.0 * totals.m_time / time : 0) << " " << totals.m_count << " "
+               << GetContextLabel(context) << std::endl;
+    }
+
+    std::string foldedName = m_prefix + ".folded";
+    std::ofstream folded(foldedName);
+    NS_ABORT_MSG_UNLESS(folded.is_open(), "Unable to open " << foldedName);
+    std::map<uint64_t, Totals> sorted(m_contexts.begin(), m_contexts.end());
+    for (const auto& [key, totals] : sorted)
+    {
+        // frames are separated by semicolons
+        std::string name = m_handlers[key & 0xffffffff].m_name;
+        std::replace(name.begin(), name.end(), ';', ',');
+        folded << GetContextLabel(key >> 32) << ";" << name << " " << totals.m_time
+               << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Wall clock time profiler of the event handlers.
+ *
+ * The simulator implementations hand the events to Invoke() when the
+ * profiler is enabled, which measures the wall clock time spent in each
+ * event. The time is attributed to the function called by the event, as
+ * given by EventImpl::GetHandlerAddress(), and to the context of the event.
+ * The name of a function is looked up and demangled once, the first time
+ * one of its events is invoked; the events of lambdas and other function
+ * objects are named after their type.
+ *
+ * The profiler is enabled by setting the \c EventProfilePrefix global
+ * value, e.g. with `--EventProfilePrefix=run` on the command line. Two files
+ * are written by Write() at Simulator::Destroy:
+ *
+ * - `<prefix>.txt`: a report of the handlers sorted by decreasing total
+ *   time, with their event count and latency percentiles, followed by the
+ *   totals of each context;
+ * - `<prefix>.folded`: the time in nanoseconds of each handler in each
+ *   context, as `node <context>;<handler> <time>` lines which can be fed to
+ *   `flamegraph.pl`.
+ *
+ * The latencies are kept in histograms with logarithmic buckets split in
+ * HISTOGRAM_SUB_BUCKETS linear sub-buckets, so that the percentiles are
+ * accurate to 1 / HISTOGRAM_SUB_BUCKETS whatever their magnitude.
+ */
+class EventProfiler
+{
+  public:
+    /**
+     * Create a profiler if the \c EventProfilePrefix global value is set.
+     *
+     * \returns The profiler, or \c nullptr if profiling is disabled.
+     */
+    static std::unique_ptr<EventProfiler> Create();
+
+    /**
+     * Constructor.
+     *
+     * \param [in] prefix The prefix of the files written by Write().
+     */
+    EventProfiler(std::string prefix);
+
+    /**
+     * Invoke an event and account for its wall clock time.
+     *
+     * \param [in] event The event.
+     * \param [in] context The context of the event.
+     */
+    void Invoke(EventImpl* event, uint32_t context);
+
+    /** Write the report and the folded stacks. */
+    void Write() const;
+
+    /** Number of linear sub-buckets of each power of two of the histograms. */
+    static constexpr uint32_t HISTOGRAM_SUB_BUCKETS = 16;
+
+  private:
+    /** Latency histogram with logarithmic buckets and linear sub-buckets. */
+    class Histogram
+    {
+      public:
+        /**
+         * Add a sample.
+         *
+         * \param [in] value The sample.
+         */
+        void Add(uint64_t value);
+        /**
+         * Get a percentile of the samples.
+         *
+         * \param [in] percentile The percentile, in [0, 100].
+         * \returns The lower bound of the bucket holding the percentile.
+         */
+        uint64_t GetPercentile(double percentile) const;
+
+      private:
+        std::vector<uint64_t> m_counts; //!< Number of samples in each bucket.
+        uint64_t m_total{0};            //!< Number of samples.
+    };
+
+    /** Accounting of a handler. */
+    struct Handler
+    {
+        std::string m_name;    //!< Demangled name.
+        uint64_t m_count{0};   //!< Number of events.
+        uint64_t m_time{0};    //!< Wall clock time, in nanoseconds.
+        uint64_t m_max{0};     //!< Longest event, in nanoseconds.
+        Histogram m_histogram; //!< Latencies of the events.
+    };
+
+    /** Accounting of a handler in a context. */
+    struct Totals
+    {
+        uint64_t m_count{0}; //!< Number of events.
+        uint64_t m_time{0};  //!< Wall clock time, in nanoseconds.
+    };
+
+    /**
+     * Get the index of the handler of an event, adding it if needed.
+     *
+     * \param [in] event The event, not yet invoked.
+     * \returns The index of the handler in m_handlers.
+     */
+    uint32_t GetHandler(EventImpl* event);
+
+    /**
+     * Get the name of the handler of an event.
+     *
+     * \param [in] event The event.
+     * \param [in] address The address of the function called by the event.
+     * \returns The demangled name.
+     */
+    static std::string GetName(EventImpl* event, const void* address);
+
+    /**
+     * Get the label of a context.
+     *
+     * \param [in] context The context.
+     * \returns The label.
+     */
+    static std::string GetContextLabel(uint32_t context);
+
+    std::string m_prefix;                              //!< Prefix of the output files.
+    std::vector<Handler> m_handlers;                   //!< Accounting of the handlers.
+    std::unordered_map<const void*, uint32_t> m_index; //!< Handler index by function.
+    std::unordered_map<uint64_t, Totals> m_contexts;   //!< Totals by context and handler.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,331 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+namespace
+{
+
+/**
+ * \ingroup scheduler
+ * Order events by EventKey.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a is earlier than \c b.
+ */
+bool
+EventLess(const Scheduler::Event& a, const Scheduler::Event& b)
+{
+    return a.key < b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LadderScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<LadderScheduler>();
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(0),
+      m_topMax(0),
+      m_topStart(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_qSize(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+LadderScheduler::FindRung(uint64_t ts, uint32_t& bucket) const
+{
+    for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+        const Rung& rung = m_rungs[i];
+        if (ts < rung.m_start)
+        {
+            continue;
+        }
+        uint64_t index = (ts - rung.m_start) / rung.m_width;
+        if (index >= rung.m_current)
+        {
+            NS_ASSERT(index < rung.m_nBuckets);
+            bucket = static_cast<uint32_t>(index);
+            return i;
+        }
+    }
+    return m_nRungs;
+}
+
+void
+LadderScheduler::InsertBottom(const Event& ev)
+{
+    // new events are usually the latest ones of the bottom
+    if (m_bottomHead == m_bottom.size() || m_bottom.back().key < ev.key)
+    {
+        m_bottom.push_back(ev);
+        return;
+    }
+    auto it = std::upper_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev, EventLess);
+    m_bottom.insert(it, ev);
+}
+
+void
+LadderScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        if (m_top.empty())
+        {
+            m_topMin = ts;
+            m_topMax = ts;
+        }
+        else
+        {
+            m_topMin = std::min(m_topMin, ts);
+            m_topMax = std::max(m_topMax, ts);
+        }
+        m_top.push_back(ev);
+    }
+    else
+    {
+        uint32_t bucket = 0;
+        uint32_t rung = FindRung(ts, bucket);
+        if (rung < m_nRungs)
+        {
+            m_rungs[rung].m_buckets[bucket].push_back(ev);
+            m_rungs[rung].m_count++;
+        }
+        else
+        {
+            InsertBottom(ev);
+        }
+    }
+    m_qSize++;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom[m_bottomHead++];
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+    NS_LOG_LOGIC("remove ts=" << ev.key.m_ts << ", uid=" << ev.key.m_uid);
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        // discarded when the top is spread on the first rung
+        m_topRemoved.insert(ev.key.m_uid);
+    }
+    else
+    {
+        uint32_t bucket = 0;
+        uint32_t rung = FindRung(ts, bucket);
+        if (rung < m_nRungs)
+        {
+            Bucket& events = m_rungs[rung].m_buckets[bucket];
+            auto it = std::find_if(events.begin(), events.end(), [&ev](const Event& e) {
+                return e.key == ev.key;
+            });
+            NS_ASSERT_MSG(it != events.end(), "event not found");
+            events.erase(it);
+            m_rungs[rung].m_count--;
+        }
+        else
+        {
+            auto it = std::lower_bound(m_bottom.begin() + m_bottomHead,
+                                       m_bottom.end(),
+                                       ev,
+                                       EventLess);
+            NS_ASSERT_MSG(it != m_bottom.end() && it->key == ev.key, "event not found");
+            m_bottom.erase(it);
+        }
+    }
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+}
+
+void
+LadderScheduler::Spawn(Bucket& events, uint64_t start, uint64_t span)
+{
+    NS_LOG_FUNCTION(this << events.size() << start << span);
+    NS_ASSERT(m_nRungs < MAX_RUNGS);
+    NS_ASSERT(!events.empty() && span > 0);
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t nBuckets = std::min<uint64_t>(events.size(), span);
+    rung.m_start = start;
+    rung.m_width = (span - 1) / nBuckets + 1;
+    rung.m_nBuckets = static_cast<uint32_t>((span - 1) / rung.m_width + 1);
+    rung.m_current = 0;
+    rung.m_count = events.size();
+    if (rung.m_buckets.size() < rung.m_nBuckets)
+    {
+        rung.m_buckets.resize(rung.m_nBuckets);
+    }
+    for (const auto& ev : events)
+    {
+        uint64_t index = (ev.key.m_ts - start) / rung.m_width;
+        rung.m_buckets[std::min<uint64_t>(index, rung.m_nBuckets - 1)].push_back(ev);
+    }
+    events.clear();
+}
+
+void
+LadderScheduler::SpawnFromTop()
+{
+    NS_LOG_FUNCTION(this << m_top.size() << m_topRemoved.size());
+    NS_ASSERT(m_nRungs == 0);
+    if (!m_topRemoved.empty())
+    {
+        auto end = std::remove_if(m_top.begin(), m_top.end(), [this](const Event& ev) {
+            return m_topRemoved.erase(ev.key.m_uid) > 0;
+        });
+        m_top.erase(end, m_top.end());
+        m_topRemoved.clear();
+    }
+    NS_ASSERT(!m_top.empty());
+
+    // a span of 0 means the whole time range, which cannot be represented
+    uint64_t span = m_topMax - m_topMin + 1;
+    Spawn(m_top, m_topMin, span == 0 ? UINT64_MAX : span);
+
+    const Rung& rung = m_rungs[0];
+    if (rung.m_width > (UINT64_MAX - rung.m_start) / rung.m_nBuckets)
+    {
+        m_topStart = UINT64_MAX;
+    }
+    else
+    {
+        m_topStart = rung.m_start + rung.m_nBuckets * rung.m_width;
+    }
+}
+
+void
+LadderScheduler::Refill()
+{
+    NS_LOG_FUNCTION(this);
+    m_bottom.clear();
+    m_bottomHead = 0;
+    while (m_qSize > 0)
+    {
+        if (m_nRungs == 0)
+        {
+            SpawnFromTop();
+        }
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.m_count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.m_buckets[rung.m_current].empty())
+        {
+            rung.m_current++;
+        }
+        Bucket& bucket = rung.m_buckets[rung.m_current];
+        uint64_t bucketStart = rung.m_start + rung.m_current * rung.m_width;
+        rung.m_current++;
+        rung.m_count -= bucket.size();
+
+        if (bucket.size() > SPAWN_THRESHOLD && rung.m_width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            auto [first, last] = std::minmax_element(bucket.begin(), bucket.end(), EventLess);
+            if (first->key.m_ts != last->key.m_ts)
+            {
+                Spawn(bucket, bucketStart, rung.m_width);
+                continue;
+            }
+        }
+
+        // events with equal time stamps are usually inserted in uid order
+        m_bottom.swap(bucket);
+        if (!std::is_sorted(m_bottom.begin(), m_bottom.end(), EventLess))
+        {
+            std::sort(m_bottom.begin(), m_bottom.end(), EventLess);
+        }
+        return;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are stored in three tiers:
+ *
+ * - the *top* is an unsorted `std::vector` which receives all the events
+ *   later than the range covered by the rungs; far-future timers stay there
+ *   until the rungs are exhausted;
+ * - the *rungs* are arrays of unsorted buckets of uniform width. The first
+ *   rung is built from the top when it is needed, with about one event per
+ *   bucket. A bucket holding more than SPAWN_THRESHOLD events with distinct
+ *   time stamps is spread on a finer rung instead of being sorted;
+ * - the *bottom* is a sorted `std::vector` holding the events of the last
+ *   bucket dequeued, from which the events are removed.
+ *
+ * Each event is thus copied a bounded number of times before being
+ * dequeued, and only small buckets are ever sorted. A bucket in which all
+ * the events share the same time stamp, like the burst of events of a slot
+ * boundary, is moved to the bottom as is: its events are inserted in
+ * increasing uid order, so it is already sorted.
+ *
+ * Events with equal time stamps are dequeued in increasing uid order,
+ * which is the order in which they were scheduled, like with the other
+ * schedulers.
+ *
+ * Events removed from the top are only marked as removed, and discarded when
+ * the top is spread on the first rung, so that cancelling a far-future timer
+ * does not search the whole top.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to the top or to a bucket
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | First event of the bottom
+ * Remove()     | ~Constant       | Mark in top, search within bucket
+ * RemoveNext() | ~Constant       | Spread top and buckets; sort small buckets
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | ~400 bytes                       | Tiers, up to MAX_RUNGS rungs
+ * Per Event | 24 bytes + 24 bytes per bucket   | `std::vector`
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+    /** Maximum number of rungs. */
+    static constexpr uint32_t MAX_RUNGS = 8;
+    /** Number of events above which a bucket is spread on a new rung. */
+    static constexpr uint32_t SPAWN_THRESHOLD = 50;
+
+  private:
+    /** Bucket type: an unsorted vector of Events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung: buckets of uniform width covering a contiguous time range. */
+    struct Rung
+    {
+        uint64_t m_start;              //!< Time stamp of the start of the first bucket.
+        uint64_t m_width;              //!< Width of the buckets, in dimensionless time units.
+        uint32_t m_nBuckets;           //!< Number of buckets in use.
+        uint32_t m_current;            //!< Index of the next bucket to dequeue.
+        uint32_t m_count;              //!< Number of events in the rung.
+        std::vector<Bucket> m_buckets; //!< The buckets; only the first m_nBuckets are in use.
+    };
+
+    /**
+     * Get the rung which holds the time stamp.
+     *
+     * \param [in] ts The dimensionless time stamp, earlier than m_topStart.
+     * \param [out] bucket The index of the bucket holding the time stamp.
+     * \returns The index of the rung, or m_nRungs if the time stamp
+     *          belongs to the bottom.
+     */
+    uint32_t FindRung(uint64_t ts, uint32_t& bucket) const;
+    /**
+     * Insert an event in the bottom, keeping it sorted.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /**
+     * Spread events on a new rung.
+     *
+     * \param [in] events The events; they are all in the range
+     *             [\p start, \p start + \p span - 1].
+     * \param [in] start The start of the range.
+     * \param [in] span The length of the range, at least 1.
+     */
+    void Spawn(Bucket& events, uint64_t start, uint64_t span);
+    /** Spread the top on the first rung. */
+    void SpawnFromTop();
+    /** Move the next bucket to the bottom, once it is empty and the queue is not. */
+    void Refill();
+
+    /** Events later than m_topStart. */
+    Bucket m_top;
+    /** Earliest time stamp in the top. */
+    uint64_t m_topMin;
+    /** Latest time stamp in the top. */
+    uint64_t m_topMax;
+    /** Time stamp from which events are inserted in the top. */
+    uint64_t m_topStart;
+    /** Uids of the events removed from the top. */
+    std::unordered_set<uint32_t> m_topRemoved;
+    /** The rungs; only the first m_nRungs are in use. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+    /** Sorted events, from m_bottomHead on. */
+    Bucket m_bottom;
+    /** Index of the first event of the bottom. */
+    std::size_t m_bottomHead;
+    /** Number of events in queue. */
+    uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
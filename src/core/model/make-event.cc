@@ -20,6 +20,9 @@
 
 #include "log.h"
 
+#include <cstdint>
+#include <cstring>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +34,45 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("MakeEvent");
 
+const void*
+GetMemberFunctionAddress(const void* object, const void* memPtr, std::size_t size)
+{
+#if defined(__GNUC__)
+    // a function address or a vtable offset, and an adjustment of the object address
+    struct MemberPointer
+    {
+        uintptr_t ptr;
+        ptrdiff_t adj;
+    };
+
+    if (size != sizeof(MemberPointer))
+    {
+        return nullptr;
+    }
+    MemberPointer mem;
+    std::memcpy(&mem, memPtr, sizeof(mem));
+#if defined(__arm__) || defined(__aarch64__)
+    // the ARM variant flags virtual methods in the adjustment
+    bool isVirtual = mem.adj & 1;
+    ptrdiff_t adj = mem.adj >> 1;
+    uintptr_t offset = mem.ptr;
+#else
+    bool isVirtual = mem.ptr & 1;
+    ptrdiff_t adj = mem.adj;
+    uintptr_t offset = mem.ptr - 1;
+#endif
+    if (!isVirtual)
+    {
+        return reinterpret_cast<const void*>(mem.ptr);
+    }
+    const char* self = static_cast<const char*>(object) + adj;
+    const char* vtable = *reinterpret_cast<const char* const*>(self);
+    return *reinterpret_cast<const void* const*>(vtable + offset);
+#else
+    return nullptr;
+#endif
+}
+
 // This is the only non-templated version of MakeEvent.
 EventImpl*
 MakeEvent(void (*f)())
@@ -58,6 +100,11 @@ MakeEvent(void (*f)())
             (*m_function)();
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
       private:
         F m_function;
     }* ev = new EventFunctionImpl0(f);
@@ -353,6 +353,9 @@ EventImpl* MakeEvent(T function);
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <cstddef>
+#include <utility>
+
 namespace ns3
 {
 
@@ -392,6 +395,65 @@ struct EventMemberImplObjTraits<T*>
     }
 };
 
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the generic template declaration (with empty body).
+ *
+ * \tparam MEM \explicit The class method type.
+ */
+template <typename MEM>
+struct EventMemberClass;
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the specialization for pointers to class methods.
+ *
+ * \tparam F \deduced The method signature.
+ * \tparam C \deduced The class which declares the method.
+ */
+template <typename F, typename C>
+struct EventMemberClass<F C::*>
+{
+    typedef C Type; /**< The class which declares the method. */
+};
+
+/**
+ * \ingroup makeeventmemptr
+ * Get the address of the function called through a class method pointer.
+ *
+ * Only the Itanium C++ ABI layout of method pointers is supported;
+ * virtual methods are resolved with the vtable of the object.
+ *
+ * \param [in] object The object, converted to the class which declares the method.
+ * \param [in] memPtr The class method pointer.
+ * \param [in] size The size of the class method pointer.
+ * \returns The address of the function, or \c nullptr if it is not known.
+ */
+const void* GetMemberFunctionAddress(const void* object, const void* memPtr, std::size_t size);
+
+/**
+ * \ingroup makeeventmemptr
+ * Get the address of the class method called by a MakeEvent event.
+ *
+ * \tparam MEM \deduced The class method type.
+ * \tparam OBJ \deduced The class instance type.
+ * \param [in] mem The class method pointer.
+ * \param [in] obj The class instance.
+ * \returns The address of the function, or \c nullptr if it is not known.
+ */
+template <typename MEM, typename OBJ>
+const void*
+GetEventMemberAddress(MEM mem, const OBJ& obj)
+{
+    const typename EventMemberClass<MEM>::Type& object =
+        EventMemberImplObjTraits<OBJ>::GetReference(obj);
+    return GetMemberFunctionAddress(&object, &mem, sizeof(mem));
+}
+
 template <typename MEM, typename OBJ>
 EventImpl*
 MakeEvent(MEM mem_ptr, OBJ obj)
@@ -401,7 +463,7 @@ MakeEvent(MEM mem_ptr, OBJ obj)
     {
       public:
         EventMemberImpl0(OBJ obj, MEM function)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function)
         {
         }
@@ -416,9 +478,14 @@ MakeEvent(MEM mem_ptr, OBJ obj)
             (EventMemberImplObjTraits<OBJ>::GetReference(m_obj).*m_function)();
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
-    }* ev = new EventMemberImpl0(obj, mem_ptr);
+    }* ev = new EventMemberImpl0(std::move(obj), mem_ptr);
 
     return ev;
 }
@@ -432,9 +499,9 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1)
     {
       public:
         EventMemberImpl1(OBJ obj, MEM function, T1 a1)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1)
+              m_a1(std::move(a1))
         {
         }
 
@@ -449,10 +516,15 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1)
             (EventMemberImplObjTraits<OBJ>::GetReference(m_obj).*m_function)(m_a1);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
-    }* ev = new EventMemberImpl1(obj, mem_ptr, a1);
+    }* ev = new EventMemberImpl1(std::move(obj), mem_ptr, std::move(a1));
 
     return ev;
 }
@@ -466,10 +538,10 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     {
       public:
         EventMemberImpl2(OBJ obj, MEM function, T1 a1, T2 a2)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1),
-              m_a2(a2)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2))
         {
         }
 
@@ -484,11 +556,16 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
             (EventMemberImplObjTraits<OBJ>::GetReference(m_obj).*m_function)(m_a1, m_a2);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
-    }* ev = new EventMemberImpl2(obj, mem_ptr, a1, a2);
+    }* ev = new EventMemberImpl2(std::move(obj), mem_ptr, std::move(a1), std::move(a2));
 
     return ev;
 }
@@ -502,11 +579,11 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     {
       public:
         EventMemberImpl3(OBJ obj, MEM function, T1 a1, T2 a2, T3 a3)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3))
         {
         }
 
@@ -521,12 +598,21 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
             (EventMemberImplObjTraits<OBJ>::GetReference(m_obj).*m_function)(m_a1, m_a2, m_a3);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
         typename TypeTraits<T3>::ReferencedType m_a3;
-    }* ev = new EventMemberImpl3(obj, mem_ptr, a1, a2, a3);
+    }* ev = new EventMemberImpl3(std::move(obj),
+                                 mem_ptr,
+                                 std::move(a1),
+                                 std::move(a2),
+                                 std::move(a3));
 
     return ev;
 }
@@ -540,12 +626,12 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     {
       public:
         EventMemberImpl4(OBJ obj, MEM function, T1 a1, T2 a2, T3 a3, T4 a4)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4))
         {
         }
 
@@ -561,13 +647,23 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
              m_function)(m_a1, m_a2, m_a3, m_a4);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
         typename TypeTraits<T3>::ReferencedType m_a3;
         typename TypeTraits<T4>::ReferencedType m_a4;
-    }* ev = new EventMemberImpl4(obj, mem_ptr, a1, a2, a3, a4);
+    }* ev = new EventMemberImpl4(std::move(obj),
+                                 mem_ptr,
+                                 std::move(a1),
+                                 std::move(a2),
+                                 std::move(a3),
+                                 std::move(a4));
 
     return ev;
 }
@@ -587,13 +683,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
     {
       public:
         EventMemberImpl5(OBJ obj, MEM function, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4),
-              m_a5(a5)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4)),
+              m_a5(std::move(a5))
         {
         }
 
@@ -609,6 +705,11 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
              m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
@@ -616,7 +717,13 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
         typename TypeTraits<T3>::ReferencedType m_a3;
         typename TypeTraits<T4>::ReferencedType m_a4;
         typename TypeTraits<T5>::ReferencedType m_a5;
-    }* ev = new EventMemberImpl5(obj, mem_ptr, a1, a2, a3, a4, a5);
+    }* ev = new EventMemberImpl5(std::move(obj),
+                                 mem_ptr,
+                                 std::move(a1),
+                                 std::move(a2),
+                                 std::move(a3),
+                                 std::move(a4),
+                                 std::move(a5));
 
     return ev;
 }
@@ -637,14 +744,14 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
     {
       public:
         EventMemberImpl6(OBJ obj, MEM function, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
-            : m_obj(obj),
+            : m_obj(std::move(obj)),
               m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4),
-              m_a5(a5),
-              m_a6(a6)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4)),
+              m_a5(std::move(a5)),
+              m_a6(std::move(a6))
         {
         }
 
@@ -660,6 +767,11 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
              m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return GetEventMemberAddress(m_function, m_obj);
+        }
+
         OBJ m_obj;
         MEM m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
@@ -668,7 +780,14 @@ MakeEvent(MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
         typename TypeTraits<T4>::ReferencedType m_a4;
         typename TypeTraits<T5>::ReferencedType m_a5;
         typename TypeTraits<T6>::ReferencedType m_a6;
-    }* ev = new EventMemberImpl6(obj, mem_ptr, a1, a2, a3, a4, a5, a6);
+    }* ev = new EventMemberImpl6(std::move(obj),
+                                 mem_ptr,
+                                 std::move(a1),
+                                 std::move(a2),
+                                 std::move(a3),
+                                 std::move(a4),
+                                 std::move(a5),
+                                 std::move(a6));
 
     return ev;
 }
@@ -685,7 +804,7 @@ MakeEvent(void (*f)(U1), T1 a1)
 
         EventFunctionImpl1(F function, T1 a1)
             : m_function(function),
-              m_a1(a1)
+              m_a1(std::move(a1))
         {
         }
 
@@ -700,9 +819,14 @@ MakeEvent(void (*f)(U1), T1 a1)
             (*m_function)(m_a1);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
-    }* ev = new EventFunctionImpl1(f, a1);
+    }* ev = new EventFunctionImpl1(f, std::move(a1));
 
     return ev;
 }
@@ -719,8 +843,8 @@ MakeEvent(void (*f)(U1, U2), T1 a1, T2 a2)
 
         EventFunctionImpl2(F function, T1 a1, T2 a2)
             : m_function(function),
-              m_a1(a1),
-              m_a2(a2)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2))
         {
         }
 
@@ -735,10 +859,15 @@ MakeEvent(void (*f)(U1, U2), T1 a1, T2 a2)
             (*m_function)(m_a1, m_a2);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
-    }* ev = new EventFunctionImpl2(f, a1, a2);
+    }* ev = new EventFunctionImpl2(f, std::move(a1), std::move(a2));
 
     return ev;
 }
@@ -755,9 +884,9 @@ MakeEvent(void (*f)(U1, U2, U3), T1 a1, T2 a2, T3 a3)
 
         EventFunctionImpl3(F function, T1 a1, T2 a2, T3 a3)
             : m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3))
         {
         }
 
@@ -772,11 +901,16 @@ MakeEvent(void (*f)(U1, U2, U3), T1 a1, T2 a2, T3 a3)
             (*m_function)(m_a1, m_a2, m_a3);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
         typename TypeTraits<T3>::ReferencedType m_a3;
-    }* ev = new EventFunctionImpl3(f, a1, a2, a3);
+    }* ev = new EventFunctionImpl3(f, std::move(a1), std::move(a2), std::move(a3));
 
     return ev;
 }
@@ -800,10 +934,10 @@ MakeEvent(void (*f)(U1, U2, U3, U4), T1 a1, T2 a2, T3 a3, T4 a4)
 
         EventFunctionImpl4(F function, T1 a1, T2 a2, T3 a3, T4 a4)
             : m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4))
         {
         }
 
@@ -818,12 +952,17 @@ MakeEvent(void (*f)(U1, U2, U3, U4), T1 a1, T2 a2, T3 a3, T4 a4)
             (*m_function)(m_a1, m_a2, m_a3, m_a4);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
         typename TypeTraits<T3>::ReferencedType m_a3;
         typename TypeTraits<T4>::ReferencedType m_a4;
-    }* ev = new EventFunctionImpl4(f, a1, a2, a3, a4);
+    }* ev = new EventFunctionImpl4(f, std::move(a1), std::move(a2), std::move(a3), std::move(a4));
 
     return ev;
 }
@@ -849,11 +988,11 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
 
         EventFunctionImpl5(F function, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
             : m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4),
-              m_a5(a5)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4)),
+              m_a5(std::move(a5))
         {
         }
 
@@ -868,13 +1007,23 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5)
             (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
         typename TypeTraits<T3>::ReferencedType m_a3;
         typename TypeTraits<T4>::ReferencedType m_a4;
         typename TypeTraits<T5>::ReferencedType m_a5;
-    }* ev = new EventFunctionImpl5(f, a1, a2, a3, a4, a5);
+    }* ev = new EventFunctionImpl5(f,
+                                   std::move(a1),
+                                   std::move(a2),
+                                   std::move(a3),
+                                   std::move(a4),
+                                   std::move(a5));
 
     return ev;
 }
@@ -902,12 +1051,12 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5, U6), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,
 
         EventFunctionImpl6(F function, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6)
             : m_function(function),
-              m_a1(a1),
-              m_a2(a2),
-              m_a3(a3),
-              m_a4(a4),
-              m_a5(a5),
-              m_a6(a6)
+              m_a1(std::move(a1)),
+              m_a2(std::move(a2)),
+              m_a3(std::move(a3)),
+              m_a4(std::move(a4)),
+              m_a5(std::move(a5)),
+              m_a6(std::move(a6))
         {
         }
 
@@ -922,6 +1071,11 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5, U6), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,
             (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
         }
 
+        const void* GetHandlerAddress() const override
+        {
+            return reinterpret_cast<const void*>(m_function);
+        }
+
         F m_function;
         typename TypeTraits<T1>::ReferencedType m_a1;
         typename TypeTraits<T2>::ReferencedType m_a2;
@@ -929,7 +1083,13 @@ MakeEvent(void (*f)(U1, U2, U3, U4, U5, U6), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5,
         typename TypeTraits<T4>::ReferencedType m_a4;
         typename TypeTraits<T5>::ReferencedType m_a5;
         typename TypeTraits<T6>::ReferencedType m_a6;
-    }* ev = new EventFunctionImpl6(f, a1, a2, a3, a4, a5, a6);
+    }* ev = new EventFunctionImpl6(f,
+                                   std::move(a1),
+                                   std::move(a2),
+                                   std::move(a3),
+                                   std::move(a4),
+                                   std::move(a5),
+                                   std::move(a6));
 
     return ev;
 }
@@ -942,7 +1102,7 @@ MakeEvent(T function)
     {
       public:
         EventImplFunctional(T function)
-            : m_function(function)
+            : m_function(std::move(function))
         {
         }
 
@@ -957,7 +1117,7 @@ MakeEvent(T function)
         }
 
         T m_function;
-    }* ev = new EventImplFunctional(function);
+    }* ev = new EventImplFunctional(std::move(function));
 
     return ev;
 }
@@ -37,6 +37,7 @@
 #include <algorithm> // upper_bound
 #include <cmath>
 #include <iostream>
+#include <unordered_set>
 
 /**
  * \file
@@ -49,6 +50,20 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("RandomVariableStream");
 
+/**
+ * \ingroup randomvariable
+ * Get the existing RandomVariableStream instances, restarted by
+ * RandomVariableStream::ResetRun().
+ *
+ * \returns The set of instances.
+ */
+static std::unordered_set<RandomVariableStream*>&
+GetStreams()
+{
+    static std::unordered_set<RandomVariableStream*> streams;
+    return streams;
+}
+
 NS_OBJECT_ENSURE_REGISTERED(RandomVariableStream);
 
 TypeId
@@ -77,14 +92,17 @@ RandomVariableStream::GetTypeId()
 }
 
 RandomVariableStream::RandomVariableStream()
-    : m_rng(nullptr)
+    : m_rng(nullptr),
+      m_rngStream(0)
 {
     NS_LOG_FUNCTION(this);
+    GetStreams().insert(this);
 }
 
 RandomVariableStream::~RandomVariableStream()
 {
     NS_LOG_FUNCTION(this);
+    GetStreams().erase(this);
     delete m_rng;
 }
 
@@ -122,16 +140,16 @@ RandomVariableStream::SetStream(int64_t stream)
         // number assignment.
         uint64_t nextStream = RngSeedManager::GetNextStreamIndex();
         NS_ASSERT(nextStream <= ((1ULL) << 63));
-        m_rng = new RngStream(RngSeedManager::GetSeed(), nextStream, RngSeedManager::GetRun());
+        m_rngStream = nextStream;
     }
     else
     {
         // The last 2^63 streams are reserved for deterministic stream
         // number assignment.
         uint64_t base = ((1ULL) << 63);
-        uint64_t target = base + stream;
-        m_rng = new RngStream(RngSeedManager::GetSeed(), target, RngSeedManager::GetRun());
+        m_rngStream = base + stream;
     }
+    m_rng = new RngStream(RngSeedManager::GetSeed(), m_rngStream, RngSeedManager::GetRun());
     m_stream = stream;
 }
 
@@ -142,6 +160,22 @@ RandomVariableStream::GetStream() const
     return m_stream;
 }
 
+void
+RandomVariableStream::ResetRun()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    for (RandomVariableStream* stream : GetStreams())
+    {
+        if (stream->m_rng != nullptr)
+        {
+            delete stream->m_rng;
+            stream->m_rng = new RngStream(RngSeedManager::GetSeed(),
+                                          stream->m_rngStream,
+                                          RngSeedManager::GetRun());
+        }
+    }
+}
+
 RngStream*
 RandomVariableStream::Peek() const
 {
@@ -130,6 +130,16 @@ class RandomVariableStream : public Object
      */
     int64_t GetStream() const;
 
+    /**
+     * \brief Restart every RandomVariableStream from the current run number.
+     *
+     * The RngStream of each existing RandomVariableStream is recreated from
+     * the seed and the run number of the RngSeedManager, keeping its stream
+     * number, as if it had been created after RngSeedManager::SetRun(). This
+     * lets the branches of a Checkpoint draw independent values.
+     */
+    static void ResetRun();
+
     /**
      * \brief Specify whether antithetic values should be generated.
      * \param [in] isAntithetic If \c true antithetic value will be generated.
@@ -169,6 +179,9 @@ class RandomVariableStream : public Object
     /** The stream number for the RngStream. */
     int64_t m_stream;
 
+    /** The index of the RngStream, after the automatic stream numbers. */
+    uint64_t m_rngStream;
+
 }; // class RandomVariableStream
 
 /**
@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/checkpoint.h"
+#include "ns3/double.h"
+#include "ns3/names.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup simulator
+ * Checkpoint test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup checkpoint-tests Checkpoint test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup checkpoint-tests
+ * Fork two branches and check their events, random values and overrides.
+ */
+class CheckpointTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    CheckpointTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Count an event and reschedule. */
+    void Tick();
+
+    uint32_t m_ticks; //!< Number of events.
+};
+
+CheckpointTestCase::CheckpointTestCase()
+    : TestCase("Check the branches of a checkpoint")
+{
+}
+
+void
+CheckpointTestCase::Tick()
+{
+    m_ticks++;
+    Simulator::Schedule(MilliSeconds(100), &CheckpointTestCase::Tick, this);
+}
+
+void
+CheckpointTestCase::DoRun()
+{
+    uint64_t run = RngSeedManager::GetRun();
+    m_ticks = 0;
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    Names::Add("checkpoint-test-rng", rng);
+    Simulator::Schedule(MilliSeconds(50), &CheckpointTestCase::Tick, this);
+
+    Checkpoint checkpoint;
+    checkpoint.AddBranch(run + 1, CreateTempDirFilename("checkpoint-0.txt"));
+    checkpoint.AddBranch(run + 2, CreateTempDirFilename("checkpoint-1.txt"));
+    checkpoint.SetBranchConfig(1, "/Names/checkpoint-test-rng/Min", DoubleValue(10));
+    checkpoint.SetBranchConfig(1, "/Names/checkpoint-test-rng/Max", DoubleValue(11));
+    checkpoint.SetMaxParallel(1);
+    int branch = checkpoint.Fork(Seconds(1));
+    if (branch != Checkpoint::PARENT)
+    {
+        // the child must not return to the test framework
+        Simulator::Stop(Seconds(1));
+        Simulator::Run();
+        std::cout << m_ticks << " " << rng->GetValue() << std::endl;
+        Simulator::Destroy();
+        std::fflush(nullptr);
+        _exit(0);
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(checkpoint.GetNBranches(), 2, "wrong number of branches");
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), Seconds(1), "wrong checkpoint time");
+    NS_TEST_EXPECT_MSG_EQ(m_ticks, 10, "wrong number of events before the checkpoint");
+    double values[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(checkpoint.GetExitStatus(i), 0, "branch " << i << " failed");
+        std::ifstream output(checkpoint.GetOutput(i));
+        uint32_t ticks = 0;
+        output >> ticks >> values[i];
+        NS_TEST_ASSERT_MSG_EQ(output.fail(), false, "no output in branch " << i);
+        NS_TEST_EXPECT_MSG_EQ(ticks, 20, "wrong number of events in branch " << i);
+    }
+    NS_TEST_EXPECT_MSG_LT(values[0], 1, "wrong value in branch 0");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(values[1], 10, "override not applied in branch 1");
+    NS_TEST_EXPECT_MSG_LT(values[1], 11, "override not applied in branch 1");
+    NS_TEST_EXPECT_MSG_EQ(RngSeedManager::GetRun(), run, "run changed in the parent");
+
+    Names::Clear();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup checkpoint-tests
+ * Check RandomVariableStream::ResetRun().
+ */
+class CheckpointResetRunTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    CheckpointResetRunTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CheckpointResetRunTestCase::CheckpointResetRunTestCase()
+    : TestCase("Check the restart of the random variables from a run number")
+{
+}
+
+void
+CheckpointResetRunTestCase::DoRun()
+{
+    uint64_t run = RngSeedManager::GetRun();
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(7);
+    double first = rng->GetValue();
+    rng->GetValue();
+
+    RngSeedManager::SetRun(run + 1);
+    RandomVariableStream::ResetRun();
+    double other = rng->GetValue();
+    NS_TEST_EXPECT_MSG_NE(other, first, "same value in another run");
+    Ptr<UniformRandomVariable> fresh = CreateObject<UniformRandomVariable>();
+    fresh->SetStream(7);
+    NS_TEST_EXPECT_MSG_EQ(fresh->GetValue(), other, "not restarted from the run");
+
+    RngSeedManager::SetRun(run);
+    RandomVariableStream::ResetRun();
+    NS_TEST_EXPECT_MSG_EQ(rng->GetValue(), first, "not restarted from the run");
+}
+
+/**
+ * \ingroup checkpoint-tests
+ * Checkpoint test suite.
+ */
+class CheckpointTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    CheckpointTestSuite();
+};
+
+CheckpointTestSuite::CheckpointTestSuite()
+    : TestSuite("checkpoint", UNIT)
+{
+    AddTestCase(new CheckpointResetRunTestCase(), TestCase::QUICK);
+    AddTestCase(new CheckpointTestCase(), TestCase::QUICK);
+}
+
+/**
+ * \ingroup checkpoint-tests
+ * CheckpointTestSuite instance variable.
+ */
+static CheckpointTestSuite g_checkpointTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-allocator.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup events
+ * EventAllocator test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup event-allocator-tests EventAllocator test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup event-allocator-tests
+ * Check that released events are reused and accounted for.
+ */
+class EventAllocatorReuseTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventAllocatorReuseTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Event target.
+     * \param [in] t A bound argument.
+     */
+    void Target(Time t);
+
+    Time m_total; //!< Sum of the arguments of the invoked events.
+};
+
+EventAllocatorReuseTestCase::EventAllocatorReuseTestCase()
+    : TestCase("Check that released events are reused")
+{
+}
+
+void
+EventAllocatorReuseTestCase::Target(Time t)
+{
+    m_total += t;
+}
+
+void
+EventAllocatorReuseTestCase::DoRun()
+{
+    EventImpl* first = MakeEvent(&EventAllocatorReuseTestCase::Target, this, Seconds(1));
+    first->Invoke();
+    first->Unref();
+
+    EventAllocator::Stats before = EventAllocator::GetStats();
+    EventImpl* second = MakeEvent(&EventAllocatorReuseTestCase::Target, this, Seconds(2));
+    NS_TEST_ASSERT_MSG_EQ(second, first, "the released event has not been reused");
+    second->Invoke();
+    second->Unref();
+    EventAllocator::Stats after = EventAllocator::GetStats();
+
+    NS_TEST_ASSERT_MSG_EQ(m_total, Seconds(3), "wrong arguments");
+    NS_TEST_ASSERT_MSG_EQ(after.m_allocations - before.m_allocations, 1, "allocation not counted");
+    NS_TEST_ASSERT_MSG_EQ(after.m_deallocations - before.m_deallocations,
+                          1,
+                          "deallocation not counted");
+    NS_TEST_ASSERT_MSG_EQ(after.m_reused - before.m_reused, 1, "reuse not counted");
+
+    // events of the simulator are all released once it has run
+    uint64_t live = EventAllocator::GetStats().GetLiveObjects();
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        Simulator::Schedule(MicroSeconds(i),
+                            &EventAllocatorReuseTestCase::Target,
+                            this,
+                            Seconds(1));
+    }
+    Simulator::Schedule(Seconds(1), [this]() { m_total = Seconds(0); });
+    Simulator::Run();
+    Simulator::Destroy();
+    NS_TEST_ASSERT_MSG_EQ(m_total, Seconds(0), "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(EventAllocator::GetStats().GetLiveObjects(), live, "events leaked");
+}
+
+/**
+ * \ingroup event-allocator-tests
+ * Check events created and released by different threads.
+ */
+class EventAllocatorThreadTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventAllocatorThreadTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventAllocatorThreadTestCase::EventAllocatorThreadTestCase()
+    : TestCase("Check events released by another thread")
+{
+}
+
+void
+EventAllocatorThreadTestCase::DoRun()
+{
+    const uint32_t count = 3 * EventAllocator::MAX_CACHED_BLOCKS;
+    uint64_t live = EventAllocator::GetStats().GetLiveObjects();
+    uint32_t invoked = 0;
+    std::vector<EventImpl*> events;
+    events.reserve(count);
+
+    std::thread producer([&events, &invoked]() {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            events.push_back(MakeEvent([&invoked]() { invoked++; }));
+        }
+    });
+    producer.join();
+    NS_TEST_ASSERT_MSG_EQ(EventAllocator::GetStats().GetLiveObjects(),
+                          live + count,
+                          "allocations of a terminated thread not accounted for");
+
+    for (EventImpl* event : events)
+    {
+        event->Invoke();
+        event->Unref();
+    }
+    NS_TEST_ASSERT_MSG_EQ(invoked, count, "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(EventAllocator::GetStats().GetLiveObjects(), live, "events leaked");
+
+    // the objects spilled to the depot are reused by another thread
+    events.clear();
+    std::thread consumer([&invoked]() {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            EventImpl* event = MakeEvent([&invoked]() { invoked++; });
+            event->Invoke();
+            event->Unref();
+        }
+    });
+    consumer.join();
+    NS_TEST_ASSERT_MSG_EQ(invoked, 2 * count, "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(EventAllocator::GetStats().GetLiveObjects(), live, "events leaked");
+}
+
+/**
+ * \ingroup event-allocator-tests
+ * EventAllocator test suite.
+ */
+class EventAllocatorTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    EventAllocatorTestSuite();
+};
+
+EventAllocatorTestSuite::EventAllocatorTestSuite()
+    : TestSuite("event-allocator")
+{
+    AddTestCase(new EventAllocatorReuseTestCase());
+    AddTestCase(new EventAllocatorThreadTestCase());
+}
+
+/**
+ * \ingroup event-allocator-tests
+ * EventAllocatorTestSuite instance variable.
+ */
+static EventAllocatorTestSuite g_eventAllocatorTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -0,0 +1,244 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-profiler.h"
+#include "ns3/global-value.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup simulator
+ * EventProfiler test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup event-profiler-tests EventProfiler test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup event-profiler-tests
+ * Base class of the virtual event handlers.
+ */
+class EventProfilerTarget
+{
+  public:
+    /** Destructor. */
+    virtual ~EventProfilerTarget() = default;
+    /** Virtual event handler. */
+    virtual void Handle() = 0;
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * First implementation of the virtual event handler.
+ */
+class EventProfilerTargetA : public EventProfilerTarget
+{
+  public:
+    void Handle() override
+    {
+        m_count++;
+    }
+
+    uint32_t m_count{0}; //!< Number of events handled.
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * Second implementation of the virtual event handler.
+ */
+class EventProfilerTargetB : public EventProfilerTarget
+{
+  public:
+    void Handle() override
+    {
+        m_count++;
+    }
+
+    uint32_t m_count{0}; //!< Number of events handled.
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * Free function event handler.
+ */
+static void
+EventProfilerFunction()
+{
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * Check the attribution of the events to their handlers and contexts.
+ */
+class EventProfilerTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventProfilerTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Non-virtual event handler. */
+    void Handle();
+
+    uint32_t m_count{0}; //!< Number of events handled.
+};
+
+EventProfilerTestCase::EventProfilerTestCase()
+    : TestCase("Check the attribution of events to handlers and contexts")
+{
+}
+
+void
+EventProfilerTestCase::Handle()
+{
+    m_count++;
+}
+
+void
+EventProfilerTestCase::DoRun()
+{
+    std::string prefix = CreateTempDirFilename("event-profiler");
+    GlobalValue::Bind("EventProfilePrefix", StringValue(prefix));
+
+    EventProfilerTargetA a;
+    EventProfilerTargetB b;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        Simulator::ScheduleWithContext(1, MicroSeconds(i), &EventProfilerTestCase::Handle, this);
+    }
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        Simulator::ScheduleWithContext(2, MicroSeconds(i), &EventProfilerTarget::Handle, &a);
+    }
+    for (uint32_t i = 0; i < 7; ++i)
+    {
+        Simulator::ScheduleWithContext(2, MicroSeconds(i), &EventProfilerTarget::Handle, &b);
+    }
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        Simulator::Schedule(MicroSeconds(i), &EventProfilerFunction);
+    }
+    Simulator::Schedule(MicroSeconds(1), [this]() { m_count++; });
+    EventId cancelled = Simulator::Schedule(MicroSeconds(2), &EventProfilerFunction);
+    cancelled.Cancel();
+    Simulator::Run();
+    Simulator::Destroy();
+    GlobalValue::Bind("EventProfilePrefix", StringValue(""));
+
+    NS_TEST_ASSERT_MSG_EQ(m_count, 11, "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(a.m_count, 5, "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(b.m_count, 7, "events not invoked");
+
+    // handler lines: total share count mean p50 p99 p99.9 max name
+    std::ifstream report(prefix + ".txt");
+    NS_TEST_ASSERT_MSG_EQ(report.is_open(), true, "no report");
+    std::map<uint64_t, std::string> handlers;
+    std::string line;
+    std::getline(report, line);
+    NS_TEST_ASSERT_MSG_EQ(line.find("# 26 events,"), 0, "wrong number of events: " << line);
+    std::getline(report, line);
+    while (std::getline(report, line) && !line.empty())
+    {
+        std::istringstream iss(line);
+        double value;
+        uint64_t count;
+        iss >> value >> value >> count >> value >> value >> value >> value >> value;
+        std::getline(iss, handlers[count]);
+    }
+    NS_TEST_ASSERT_MSG_EQ(handlers.size(), 5, "wrong number of handlers");
+    for (uint64_t count : {1, 3, 5, 7, 10})
+    {
+        NS_TEST_EXPECT_MSG_EQ(handlers.count(count), 1, "no handler with " << count << " events");
+    }
+    NS_TEST_EXPECT_MSG_NE(handlers[1].find("lambda"), std::string::npos, "lambda not named");
+
+    // context lines: total share count context
+    std::map<std::string, uint64_t> contexts;
+    while (std::getline(report, line))
+    {
+        if (line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream iss(line);
+        double value;
+        uint64_t count;
+        std::string context;
+        iss >> value >> value >> count;
+        std::getline(iss, context);
+        contexts[context] = count;
+    }
+    NS_TEST_EXPECT_MSG_EQ(contexts[" node 1"], 10, "wrong count of context 1");
+    NS_TEST_EXPECT_MSG_EQ(contexts[" node 2"], 12, "wrong count of context 2");
+
+    std::ifstream folded(prefix + ".folded");
+    uint32_t stacks = 0;
+    while (std::getline(folded, line))
+    {
+        bool context = line.find("node ") == 0 || line.find("no context;") == 0;
+        NS_TEST_EXPECT_MSG_EQ(context, true, "not a folded stack: " << line);
+        stacks++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(stacks, 5, "wrong number of stacks");
+
+    std::remove((prefix + ".txt").c_str());
+    std::remove((prefix + ".folded").c_str());
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfiler test suite.
+ */
+class EventProfilerTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    EventProfilerTestSuite();
+};
+
+EventProfilerTestSuite::EventProfilerTestSuite()
+    : TestSuite("event-profiler")
+{
+    AddTestCase(new EventProfilerTestCase());
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfilerTestSuite instance variable.
+ */
+static EventProfilerTestSuite g_eventProfilerTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -0,0 +1,214 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ladder-scheduler.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/test.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup scheduler
+ * LadderScheduler test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup ladder-scheduler-tests LadderScheduler test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup ladder-scheduler-tests
+ * Check that equal time stamps are dequeued in insertion order.
+ */
+class LadderSchedulerFifoTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    LadderSchedulerFifoTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LadderSchedulerFifoTestCase::LadderSchedulerFifoTestCase()
+    : TestCase("Check FIFO order of events with equal time stamps")
+{
+}
+
+void
+LadderSchedulerFifoTestCase::DoRun()
+{
+    Ptr<LadderScheduler> scheduler = CreateObject<LadderScheduler>();
+    Scheduler::Event ev;
+    ev.impl = nullptr;
+    ev.key.m_context = 0;
+    uint32_t uid = 0;
+
+    // a far-future timer, then bursts at two slot boundaries inserted in turn
+    ev.key.m_ts = 1000000;
+    ev.key.m_uid = uid++;
+    scheduler->Insert(ev);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        ev.key.m_ts = (i % 2 == 0) ? 125000 : 250000;
+        ev.key.m_uid = uid++;
+        scheduler->Insert(ev);
+    }
+
+    Scheduler::EventKey last = scheduler->RemoveNext().key;
+    NS_TEST_ASSERT_MSG_EQ(last.m_ts, 125000, "wrong first event");
+    NS_TEST_ASSERT_MSG_EQ(last.m_uid, 1, "wrong first uid");
+    // a late event for the current time stamp goes after the burst
+    ev.key.m_ts = 125000;
+    ev.key.m_uid = uid++;
+    scheduler->Insert(ev);
+
+    uint32_t count = 1;
+    while (!scheduler->IsEmpty())
+    {
+        Scheduler::EventKey key = scheduler->RemoveNext().key;
+        NS_TEST_ASSERT_MSG_EQ((last < key), true, "events out of order at " << key.m_ts);
+        last = key;
+        count++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(count, uid, "wrong number of events");
+    NS_TEST_ASSERT_MSG_EQ(last.m_ts, 1000000, "the timer is not the last event");
+}
+
+/**
+ * \ingroup ladder-scheduler-tests
+ * Check a random mix of operations against the MapScheduler.
+ */
+class LadderSchedulerRandomTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    LadderSchedulerRandomTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LadderSchedulerRandomTestCase::LadderSchedulerRandomTestCase()
+    : TestCase("Check random operations against the MapScheduler")
+{
+}
+
+void
+LadderSchedulerRandomTestCase::DoRun()
+{
+    Ptr<LadderScheduler> ladder = CreateObject<LadderScheduler>();
+    Ptr<MapScheduler> map = CreateObject<MapScheduler>();
+    std::mt19937_64 rng(42);
+    std::vector<Scheduler::Event> live;
+    Scheduler::Event ev;
+    ev.impl = nullptr;
+    ev.key.m_context = 0;
+    uint32_t uid = 0;
+    uint64_t now = 0;
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        uint32_t op = rng() % 10;
+        if (op < 5 || map->IsEmpty())
+        {
+            // slot boundaries, short delays and far-future timers
+            uint64_t delay = rng() % 4;
+            if (delay == 0)
+            {
+                delay = 125000 - now % 125000;
+            }
+            else if (delay == 1)
+            {
+                delay = 200000000 + rng() % 1000;
+            }
+            else
+            {
+                delay = rng() % 10000;
+            }
+            ev.key.m_ts = now + delay;
+            ev.key.m_uid = uid++;
+            ladder->Insert(ev);
+            map->Insert(ev);
+            live.push_back(ev);
+        }
+        else if (op < 9)
+        {
+            Scheduler::EventKey expected = map->RemoveNext().key;
+            NS_TEST_ASSERT_MSG_EQ((ladder->PeekNext().key == expected), true, "wrong next event");
+            Scheduler::EventKey key = ladder->RemoveNext().key;
+            NS_TEST_ASSERT_MSG_EQ((key == expected), true, "wrong event at step " << step);
+            now = key.m_ts;
+        }
+        else
+        {
+            // remove a random event, which may have been dequeued already
+            std::size_t index = rng() % live.size();
+            Scheduler::Event removed = live[index];
+            live[index] = live.back();
+            live.pop_back();
+            if (!map->IsEmpty() && !(removed.key < map->PeekNext().key))
+            {
+                map->Remove(removed);
+                ladder->Remove(removed);
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(ladder->IsEmpty(), map->IsEmpty(), "wrong size");
+    }
+    while (!map->IsEmpty())
+    {
+        Scheduler::EventKey expected = map->RemoveNext().key;
+        NS_TEST_ASSERT_MSG_EQ((ladder->RemoveNext().key == expected), true, "wrong event");
+    }
+    NS_TEST_ASSERT_MSG_EQ(ladder->IsEmpty(), true, "events left");
+}
+
+/**
+ * \ingroup ladder-scheduler-tests
+ * LadderScheduler test suite.
+ */
+class LadderSchedulerTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    LadderSchedulerTestSuite();
+};
+
+LadderSchedulerTestSuite::LadderSchedulerTestSuite()
+    : TestSuite("ladder-scheduler")
+{
+    AddTestCase(new LadderSchedulerFifoTestCase());
+    AddTestCase(new LadderSchedulerRandomTestCase());
+}
+
+/**
+ * \ingroup ladder-scheduler-tests
+ * LadderSchedulerTestSuite instance variable.
+ */
+static LadderSchedulerTestSuite g_ladderSchedulerTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
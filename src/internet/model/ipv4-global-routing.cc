@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
@@ -64,7 +65,8 @@ Ipv4GlobalRouting::GetTypeId()
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_triesValid(false)
 {
     NS_LOG_FUNCTION(this);
 
@@ -83,6 +85,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_triesValid = false;
 }
 
 void
@@ -92,6 +95,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_triesValid = false;
 }
 
 void
@@ -104,6 +108,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_triesValid = false;
 }
 
 void
@@ -113,6 +118,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_triesValid = false;
 }
 
 void
@@ -125,6 +131,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_triesValid = false;
 }
 
 Ptr<Ipv4Route>
@@ -136,67 +143,59 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     // store all available routes that bring packets to their destination
     typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
     RouteVec_t allRoutes;
+    RouteVec_t matches;
+    BuildTries();
 
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    m_hostTrie.Lookup(dest, matches);
+    for (Ipv4RoutingTableEntry* route : matches)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        NS_ASSERT(route->IsHost());
+        if (oif)
         {
-            if (oif)
+            if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
         }
+        allRoutes.push_back(route);
+        NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
     }
     if (allRoutes.empty()) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        m_networkTrie.Lookup(dest, matches);
+        for (Ipv4RoutingTableEntry* route : matches)
         {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            if (oif)
             {
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
             }
+            allRoutes.push_back(route);
+            NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << route);
         }
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        m_ASexternalTrie.Lookup(dest, matches);
+        for (Ipv4RoutingTableEntry* route : matches)
         {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            NS_LOG_LOGIC("Found external route" << route);
+            if (oif)
             {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*k);
-                break;
             }
+            allRoutes.push_back(route);
+            break;
         }
     }
     if (!allRoutes.empty()) // if route(s) is found
@@ -230,6 +229,105 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::BuildTries()
+{
+    if (m_triesValid)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    m_hostTrie.Build(m_hostRoutes, true);
+    m_networkTrie.Build(m_networkRoutes, false);
+    m_ASexternalTrie.Build(m_ASexternalRoutes, false);
+    m_triesValid = true;
+}
+
+Ipv4GlobalRouting::RouteTrie::RouteTrie()
+    : m_nodes(1, Node{{0, 0}, {}})
+{
+}
+
+void
+Ipv4GlobalRouting::RouteTrie::Build(const std::list<Ipv4RoutingTableEntry*>& routes, bool host)
+{
+    m_routes.assign(routes.begin(), routes.end());
+    m_nodes.assign(1, Node{{0, 0}, {}});
+    m_irregular.clear();
+    for (uint32_t i = 0; i < m_routes.size(); ++i)
+    {
+        if (host)
+        {
+            Add(m_routes[i]->GetDest().Get(), 0xffffffff, i);
+        }
+        else
+        {
+            uint32_t mask = m_routes[i]->GetDestNetworkMask().Get();
+            Add(m_routes[i]->GetDestNetwork().Get() & mask, mask, i);
+        }
+    }
+}
+
+void
+Ipv4GlobalRouting::RouteTrie::Add(uint32_t network, uint32_t mask, uint32_t position)
+{
+    // a contiguous mask is a run of ones followed by a run of zeros
+    if ((~mask & (~mask + 1)) != 0)
+    {
+        m_irregular.push_back({network, mask, position});
+        return;
+    }
+    uint32_t node = 0;
+    for (uint32_t bit = 0; bit < 32 && (mask << bit) != 0; ++bit)
+    {
+        uint32_t b = (network >> (31 - bit)) & 1;
+        if (m_nodes[node].child[b] == 0)
+        {
+            m_nodes[node].child[b] = m_nodes.size();
+            m_nodes.push_back(Node{{0, 0}, {}});
+        }
+        node = m_nodes[node].child[b];
+    }
+    m_nodes[node].position.push_back(position);
+}
+
+void
+Ipv4GlobalRouting::RouteTrie::Lookup(Ipv4Address dest,
+                                     std::vector<Ipv4RoutingTableEntry*>& routes) const
+{
+    uint32_t address = dest.Get();
+    m_matches.clear();
+    uint32_t node = 0;
+    for (uint32_t bit = 0;; ++bit)
+    {
+        const Node& n = m_nodes[node];
+        m_matches.insert(m_matches.end(), n.position.begin(), n.position.end());
+        if (bit == 32)
+        {
+            break;
+        }
+        node = n.child[(address >> (31 - bit)) & 1];
+        if (node == 0)
+        {
+            break;
+        }
+    }
+    for (const auto& irregular : m_irregular)
+    {
+        if ((address & irregular.mask) == irregular.network)
+        {
+            m_matches.push_back(irregular.position);
+        }
+    }
+    // the routes must be considered in the order of the list
+    std::sort(m_matches.begin(), m_matches.end());
+    routes.clear();
+    for (uint32_t position : m_matches)
+    {
+        routes.push_back(m_routes[position]);
+    }
+}
+
 uint32_t
 Ipv4GlobalRouting::GetNRoutes() const
 {
@@ -289,6 +387,7 @@ void
 Ipv4GlobalRouting::RemoveRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
+    m_triesValid = false;
     if (index < m_hostRoutes.size())
     {
         uint32_t tmp = 0;
@@ -365,6 +464,7 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_triesValid = false;
 
     Ipv4RoutingProtocol::DoDispose();
 }
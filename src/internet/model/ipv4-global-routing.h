@@ -28,6 +28,7 @@
 
 #include <list>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -65,6 +66,13 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * The lookups do not walk the route lists: on the first lookup after the
+ * routes change, the host, network and external routes are compiled into
+ * a binary trie each, whose nodes hold the routes to their prefix. A lookup
+ * then collects the routes matching the destination along the path of the
+ * destination in the trie, and selects among them in the order of the lists,
+ * as the linear search did.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -273,10 +281,75 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ptr<Ipv4Route> LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
+    /**
+     * \brief Binary trie of the destinations of a list of routes.
+     *
+     * Each node of the trie holds the positions in the list of the routes to
+     * its prefix. The routes whose mask is not contiguous are kept aside and
+     * matched one by one.
+     */
+    class RouteTrie
+    {
+      public:
+        RouteTrie();
+        /**
+         * \brief Compile a list of routes.
+         * \param routes the routes, in the order of the list
+         * \param host true to match the destination of the routes, false to
+         * match their network
+         */
+        void Build(const std::list<Ipv4RoutingTableEntry*>& routes, bool host);
+        /**
+         * \brief Get the routes matching a destination.
+         * \param dest destination address
+         * \param routes the matching routes, in the order of the list
+         */
+        void Lookup(Ipv4Address dest, std::vector<Ipv4RoutingTableEntry*>& routes) const;
+
+      private:
+        /**
+         * \brief Add a route.
+         * \param network the network of the route
+         * \param mask the mask of the route
+         * \param position the position of the route in the list
+         */
+        void Add(uint32_t network, uint32_t mask, uint32_t position);
+
+        /// A node of the trie
+        struct Node
+        {
+            uint32_t child[2];              //!< index of the children, 0 if none
+            std::vector<uint32_t> position; //!< positions of the routes to the prefix
+        };
+
+        /// A route with a non contiguous mask
+        struct Irregular
+        {
+            uint32_t network;  //!< network of the route, masked
+            uint32_t mask;     //!< mask of the route
+            uint32_t position; //!< position of the route in the list
+        };
+
+        std::vector<Ipv4RoutingTableEntry*> m_routes; //!< routes in the order of the list
+        std::vector<Node> m_nodes;                    //!< nodes of the trie, the root first
+        std::vector<Irregular> m_irregular;           //!< routes with a non contiguous mask
+        mutable std::vector<uint32_t> m_matches;      //!< positions of the last lookup
+    };
+
+    /**
+     * \brief Compile the routes into the tries, if they changed.
+     */
+    void BuildTries();
+
     HostRoutes m_hostRoutes;             //!< Routes to hosts
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    RouteTrie m_hostTrie;       //!< Compiled routes to hosts
+    RouteTrie m_networkTrie;    //!< Compiled routes to networks
+    RouteTrie m_ASexternalTrie; //!< Compiled external routes
+    bool m_triesValid;          //!< True if the tries match the routes
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
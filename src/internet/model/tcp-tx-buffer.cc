@@ -176,7 +176,7 @@ TcpTxBuffer::SetHeadSequence(const SequenceNumber32& seq)
 
     // if you change the head with data already sent, something bad will happen
     NS_ASSERT(m_sentList.empty());
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = std::make_pair(nullptr, SequenceNumber32(0));
 }
 
 bool
@@ -191,7 +191,7 @@ TcpTxBuffer::Add(Ptr<Packet> p)
         {
             TcpTxItem* item = new TcpTxItem();
             item->m_packet = p->Copy();
-            m_appList.insert(m_appList.end(), item);
+            m_appList.push_back(item);
             m_size += p->GetSize();
 
             NS_LOG_LOGIC("Updated size=" << m_size << ", lastSeq="
@@ -297,7 +297,7 @@ TcpTxBuffer::GetNewSegment(uint32_t numBytes)
     NS_ASSERT(it != m_appList.end());
 
     m_appList.erase(it);
-    m_sentList.insert(m_sentList.end(), item);
+    m_sentList.push_back(item);
     m_sentSize += item->m_packet->GetSize();
 
     return item;
@@ -311,37 +311,33 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
     NS_ASSERT(numBytes <= m_sentSize);
     NS_ASSERT(!m_sentList.empty());
 
-    auto it = m_sentList.begin();
+    auto it = FindSentItem(seq);
     bool listEdited = false;
     uint32_t s = numBytes;
 
     // Avoid to merge different packet for this retransmission if flags are
     // different.
-    for (; it != m_sentList.end(); ++it)
+    if (it != m_sentList.end() && (*it)->m_startSeq == seq)
     {
-        if ((*it)->m_startSeq == seq)
+        auto next = it;
+        next++;
+        if (next != m_sentList.end())
         {
-            auto next = it;
-            next++;
-            if (next != m_sentList.end())
+            // Next is not sacked and have the same value for m_lost ... there is the
+            // possibility to merge
+            if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-                // Next is not sacked and have the same value for m_lost ... there is the
-                // possibility to merge
-                if ((!(*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                    s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
-                }
-                else
-                {
-                    // Next is sacked... better to retransmit only the first segment
-                    s = std::min(s, (*it)->m_packet->GetSize());
-                }
+                s = std::min(s, (*it)->m_packet->GetSize() + (*next)->m_packet->GetSize());
             }
             else
             {
+                // Next is sacked... better to retransmit only the first segment
                 s = std::min(s, (*it)->m_packet->GetSize());
             }
-            break;
+        }
+        else
+        {
+            s = std::min(s, (*it)->m_packet->GetSize());
         }
     }
 
@@ -356,6 +352,38 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
     return item;
 }
 
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem(const SequenceNumber32& seq) const
+{
+    auto it = std::upper_bound(m_sentList.begin(),
+                               m_sentList.end(),
+                               seq,
+                               [](const SequenceNumber32& s, const TcpTxItem* item) {
+                                   return s < item->m_startSeq;
+                               });
+    if (it == m_sentList.begin())
+    {
+        return m_sentList.end();
+    }
+    --it;
+    if (seq >= (*it)->m_startSeq + (*it)->m_packet->GetSize())
+    {
+        return m_sentList.end();
+    }
+    return it;
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindFirstSentItemFrom(const SequenceNumber32& seq) const
+{
+    return std::lower_bound(m_sentList.begin(),
+                            m_sentList.end(),
+                            seq,
+                            [](const TcpTxItem* item, const SequenceNumber32& s) {
+                                return item->m_startSeq < s;
+                            });
+}
+
 std::pair<TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
 TcpTxBuffer::FindHighestSacked() const
 {
@@ -440,11 +468,21 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
     PacketList::iterator it = list.begin();
     SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+    if (&list == &m_sentList)
+    {
+        // The sent items are contiguous: start from the one holding seq
+        it += FindSentItem(seq) - m_sentList.cbegin();
+        if (it != list.end())
+        {
+            beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
+
     while (it != list.end())
     {
         currentItem = *it;
         currentPacket = currentItem->m_packet;
-        NS_ASSERT_MSG(list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+        NS_ASSERT_MSG(&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                       "start: " << m_firstByteSeq
                                 << " currentItem start: " << currentItem->m_startSeq);
 
@@ -652,16 +690,15 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked(const SequenceNumber32& ack) const
 {
     NS_LOG_FUNCTION(this);
-    for (const auto& it : m_sentList)
+    // Only the item ending at ack can match
+    auto it = FindSentItem(ack - 1);
+    if (it == m_sentList.end())
     {
-        TcpTxItem* item = it;
-        Ptr<Packet> p = item->m_packet;
-        if (item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    TcpTxItem* item = *it;
+    Ptr<Packet> p = item->m_packet;
+    return item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -769,7 +806,7 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
 
     if (m_highestSack.second <= m_firstByteSeq)
     {
-        m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+        m_highestSack = std::make_pair(nullptr, SequenceNumber32(0));
     }
 
     NS_LOG_DEBUG("Discarded up to " << seq << " lost: " << m_lostOut << " retrans: " << m_retrans
@@ -790,15 +827,20 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
 
     for (auto option_it = list.begin(); option_it != list.end(); ++option_it)
     {
-        PacketList::iterator item_it = m_sentList.begin();
-        SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
         if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
             NS_LOG_INFO("Not updating scoreboard, the option block is outside the sent list");
             return bytesSacked;
         }
 
+        // The items before the block cannot be sacked by it
+        auto item_it = FindFirstSentItemFrom((*option_it).first);
+        SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+        if (item_it != m_sentList.end())
+        {
+            beginOfCurrentPacket = (*item_it)->m_startSeq;
+        }
+
         while (item_it != m_sentList.end())
         {
             uint32_t pktSize = (*item_it)->m_packet->GetSize();
@@ -830,10 +872,10 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
                     m_sackedOut += (*item_it)->m_packet->GetSize();
                     bytesSacked += (*item_it)->m_packet->GetSize();
 
-                    if (m_highestSack.first == m_sentList.end() ||
+                    if (m_highestSack.first == nullptr ||
                         m_highestSack.second <= beginOfCurrentPacket + pktSize)
                     {
-                        m_highestSack = std::make_pair(item_it, beginOfCurrentPacket);
+                        m_highestSack = std::make_pair(*item_it, beginOfCurrentPacket);
                     }
 
                     NS_LOG_INFO("Received block "
@@ -862,7 +904,7 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
 
     if (bytesSacked > 0)
     {
-        NS_ASSERT_MSG(m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+        NS_ASSERT_MSG(m_highestSack.first != nullptr, "Buffer status: " << *this);
         UpdateLostCount();
     }
 
@@ -880,7 +922,8 @@ TcpTxBuffer::UpdateLostCount()
     NS_LOG_FUNCTION(this);
     uint32_t sacked = 0;
     SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-    if (m_highestSack.first == m_sentList.end())
+    PacketList::const_iterator highestSack = m_sentList.end();
+    if (m_highestSack.first == nullptr)
     {
         NS_LOG_INFO("Status before the update: " << *this
                                                  << ", will start from the latest sent item");
@@ -888,10 +931,12 @@ TcpTxBuffer::UpdateLostCount()
     else
     {
         NS_LOG_INFO("Status before the update: " << *this << ", will start from item "
-                                                 << *(*m_highestSack.first));
+                                                 << *m_highestSack.first);
+        highestSack = FindSentItem(m_highestSack.first->m_startSeq);
+        NS_ASSERT(highestSack != m_sentList.end() && *highestSack == m_highestSack.first);
     }
 
-    for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+    for (auto it = highestSack; it != m_sentList.begin(); --it)
     {
         TcpTxItem* item = *it;
         if (item->m_sacked)
@@ -928,35 +973,25 @@ TcpTxBuffer::IsLost(const SequenceNumber32& seq) const
 {
     NS_LOG_FUNCTION(this << seq);
 
-    SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-    PacketList::const_iterator it;
-
     if (seq >= m_highestSack.second)
     {
         return false;
     }
 
-    // In theory, using a map and hints when inserting elements can improve
-    // performance
-    for (it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    // Only the items starting at or after seq are checked
+    for (auto it = FindFirstSentItemFrom(seq); it != m_sentList.end(); ++it)
     {
-        // Search for the right iterator before calling IsLost()
-        if (beginOfCurrentPacket >= seq)
+        if ((*it)->m_lost == true)
         {
-            if ((*it)->m_lost == true)
-            {
-                NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
-                return true;
-            }
-
-            if ((*it)->m_sacked == true)
-            {
-                NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
-                return false;
-            }
+            NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
+            return true;
         }
 
-        beginOfCurrentPacket += (*it)->m_packet->GetSize();
+        if ((*it)->m_sacked == true)
+        {
+            NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
+            return false;
+        }
     }
 
     return false;
@@ -1206,7 +1241,7 @@ TcpTxBuffer::IsLostRFC(const SequenceNumber32& seq, const PacketList::const_iter
 
         beginOfCurrentPacket += current->GetSize();
     }
-    if (it == m_highestSack.first)
+    if (m_highestSack.first == nullptr)
     {
         NS_LOG_INFO("seq=" << seq << " is not lost because there are no sacked segment ahead "
                            << m_highestSack.second);
@@ -1225,7 +1260,7 @@ TcpTxBuffer::ResetRenoSack()
         (*it)->m_sacked = false;
     }
 
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = std::make_pair(nullptr, SequenceNumber32(0));
 }
 
 void
@@ -1254,7 +1289,7 @@ TcpTxBuffer::ResetSentList()
     m_lostOut = 0;
     m_retrans = 0;
     m_sackedOut = 0;
-    m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+    m_highestSack = std::make_pair(nullptr, SequenceNumber32(0));
 }
 
 void
@@ -1271,7 +1306,7 @@ TcpTxBuffer::ResetLastSegmentSent()
         {
             m_retrans -= item->m_packet->GetSize();
         }
-        m_appList.insert(m_appList.begin(), item);
+        m_appList.push_front(item);
     }
     ConsistencyCheck();
 }
@@ -1286,7 +1321,7 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
     {
         m_sackedOut = 0;
         m_lostOut = m_sentSize;
-        m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
+        m_highestSack = std::make_pair(nullptr, SequenceNumber32(0));
     }
     else
     {
@@ -1413,7 +1448,7 @@ TcpTxBuffer::AddRenoSack()
     {
         (*it)->m_sacked = true;
         m_sackedOut += (*it)->m_packet->GetSize();
-        m_highestSack = std::make_pair(it, (*it)->m_startSeq);
+        m_highestSack = std::make_pair(*it, (*it)->m_startSeq);
         NS_LOG_INFO("Added a Reno SACK, status: " << *this);
     }
     else
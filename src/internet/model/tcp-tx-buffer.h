@@ -27,6 +27,8 @@
 #include "ns3/tcp-tx-item.h"
 #include "ns3/traced-value.h"
 
+#include <deque>
+
 namespace ns3
 {
 class Packet;
@@ -73,6 +75,13 @@ class Packet;
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * The items are kept in double-ended queues, so that the items are appended
+ * and discarded at the ends of the lists in constant time. Since the items of
+ * the SentList are contiguous and ordered by their starting sequence number,
+ * the item holding a sequence number (e.g., the one to retransmit, or the
+ * first one covered by a SACK block) is found by a binary search instead of a
+ * walk from the head of the list.
+ *
  * Item properties
  * ---------------
  *
@@ -410,7 +419,22 @@ class TcpTxBuffer : public Object
   private:
     friend std::ostream& operator<<(std::ostream& os, const TcpTxBuffer& tcpTxBuf);
 
-    typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+    typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+
+    /**
+     * \brief Find the item of the SentList holding a sequence number
+     * \param seq Sequence
+     * \return an iterator to the item, or to the end of the SentList if seq is
+     * not in the SentList
+     */
+    PacketList::const_iterator FindSentItem(const SequenceNumber32& seq) const;
+
+    /**
+     * \brief Find the first item of the SentList starting at or after a sequence number
+     * \param seq Sequence
+     * \return an iterator to the item, or to the end of the SentList if there is none
+     */
+    PacketList::const_iterator FindFirstSentItemFrom(const SequenceNumber32& seq) const;
 
     /**
      * \brief Update the lost count
@@ -610,7 +634,8 @@ class TcpTxBuffer : public Object
 
     TracedValue<SequenceNumber32>
         m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-    std::pair<PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+    std::pair<TcpTxItem*, SequenceNumber32>
+        m_highestSack; //!< Highest SACK item (nullptr if none) and its first byte
 
     uint32_t m_lostOut{0};   //!< Number of lost bytes
     uint32_t m_sackedOut{0}; //!< Number of sacked bytes
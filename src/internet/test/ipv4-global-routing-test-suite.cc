@@ -31,6 +31,7 @@
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/simple-channel.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/simple-net-device.h"
@@ -41,6 +42,7 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace ns3;
@@ -1313,6 +1315,243 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting lookup test
+ *
+ * Fill a routing table with random host, network and external routes, and
+ * check the routes returned by RouteOutput against a linear search of the
+ * table, with and without an output interface, before and after removing
+ * routes.
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingLookupTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Get the routes to a destination by a linear search of the table.
+     * \param dest The destination.
+     * \param interface The output interface, or 0 for any.
+     * \return The gateways of the eligible routes, in the order of the table.
+     */
+    std::vector<Ipv4Address> GetExpectedGateways(Ipv4Address dest, uint32_t interface) const;
+
+    /**
+     * \brief Check the route to a destination.
+     * \param dest The destination.
+     * \param interface The output interface, or 0 for any.
+     */
+    void CheckRoute(Ipv4Address dest, uint32_t interface);
+
+    Ptr<Ipv4> m_ipv4;                 //!< The IPv4 stack of the node.
+    Ptr<Ipv4GlobalRouting> m_routing; //!< The global routing of the node.
+    uint32_t m_nHostRoutes;           //!< The number of host routes.
+    uint32_t m_nNetworkRoutes;        //!< The number of network routes.
+    bool m_randomEcmp;                //!< True if the ECMP routes are selected at random.
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase()
+    : TestCase("Global routing lookup of host, network and external routes"),
+      m_nHostRoutes(0),
+      m_nNetworkRoutes(0),
+      m_randomEcmp(false)
+{
+}
+
+std::vector<Ipv4Address>
+Ipv4GlobalRoutingLookupTestCase::GetExpectedGateways(Ipv4Address dest, uint32_t interface) const
+{
+    std::vector<Ipv4Address> gateways;
+    uint32_t nRoutes = m_routing->GetNRoutes();
+    for (uint32_t i = 0; i < nRoutes; ++i)
+    {
+        if (i == m_nHostRoutes && !gateways.empty())
+        {
+            break;
+        }
+        if (i == m_nHostRoutes + m_nNetworkRoutes && !gateways.empty())
+        {
+            break;
+        }
+        Ipv4RoutingTableEntry* route = m_routing->GetRoute(i);
+        bool match = i < m_nHostRoutes
+                         ? route->GetDest() == dest
+                         : route->GetDestNetworkMask().IsMatch(dest, route->GetDestNetwork());
+        if (match && (interface == 0 || route->GetInterface() == interface))
+        {
+            gateways.push_back(route->GetGateway());
+            if (i >= m_nHostRoutes + m_nNetworkRoutes)
+            {
+                // only the first external route is eligible
+                break;
+            }
+        }
+    }
+    return gateways;
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::CheckRoute(Ipv4Address dest, uint32_t interface)
+{
+    std::vector<Ipv4Address> gateways = GetExpectedGateways(dest, interface);
+    Ipv4Header header;
+    header.SetDestination(dest);
+    Socket::SocketErrno sockerr;
+    Ptr<NetDevice> oif = interface != 0 ? m_ipv4->GetNetDevice(interface) : nullptr;
+    Ptr<Ipv4Route> route = m_routing->RouteOutput(nullptr, header, oif, sockerr);
+    if (gateways.empty())
+    {
+        NS_TEST_EXPECT_MSG_EQ(route, nullptr, "unexpected route to " << dest);
+        NS_TEST_EXPECT_MSG_EQ(sockerr, Socket::ERROR_NOROUTETOHOST, "wrong error");
+        return;
+    }
+    NS_TEST_ASSERT_MSG_NE(route, nullptr, "no route to " << dest);
+    if (m_randomEcmp)
+    {
+        NS_TEST_EXPECT_MSG_EQ((std::find(gateways.begin(), gateways.end(), route->GetGateway()) !=
+                               gateways.end()),
+                              true,
+                              "route to " << dest << " not among the ECMP routes");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_EQ(route->GetGateway(), gateways[0], "wrong route to " << dest);
+    }
+    if (interface != 0)
+    {
+        NS_TEST_EXPECT_MSG_EQ(route->GetOutputDevice(), oif, "wrong interface to " << dest);
+    }
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(node);
+    m_ipv4 = node->GetObject<Ipv4>();
+    const uint32_t nInterfaces = 3;
+    for (uint32_t i = 0; i < nInterfaces; ++i)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device);
+        int32_t interface = m_ipv4->AddInterface(device);
+        m_ipv4->AddAddress(interface,
+                           Ipv4InterfaceAddress(Ipv4Address(0x0a000001 + (i << 8)),
+                                                Ipv4Mask("255.255.255.0")));
+        m_ipv4->SetUp(interface);
+    }
+    m_routing = m_ipv4->GetRoutingProtocol()->GetObject<Ipv4GlobalRouting>();
+    NS_TEST_ASSERT_MSG_NE(m_routing, nullptr, "Error-- no Ipv4GlobalRouting object");
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+    auto randomInterface = [&rng, nInterfaces]() { return rng->GetInteger(1, nInterfaces); };
+    // the networks are drawn in a few /8 so that the routes overlap, and the
+    // gateways are unique to identify the routes
+    auto randomAddress = [&rng]() {
+        return Ipv4Address((rng->GetInteger(20, 23) << 24) | rng->GetInteger(0, 0xffffff));
+    };
+    uint32_t nextGateway = 0xc0000001;
+    std::vector<Ipv4Address> destinations;
+    for (uint32_t i = 0; i < 30; ++i)
+    {
+        Ipv4Address dest = randomAddress();
+        uint32_t copies = rng->GetInteger(1, 3);
+        for (uint32_t j = 0; j < copies; ++j)
+        {
+            m_routing->AddHostRouteTo(dest, Ipv4Address(nextGateway++), randomInterface());
+            m_nHostRoutes++;
+        }
+        destinations.push_back(dest);
+    }
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        uint32_t mask = 0xffffffff << (32 - rng->GetInteger(8, 32));
+        if (i % 20 == 0)
+        {
+            // non contiguous mask
+            mask = 0xff00ff00;
+        }
+        Ipv4Address network = randomAddress();
+        uint32_t copies = rng->GetInteger(1, 2);
+        for (uint32_t j = 0; j < copies; ++j)
+        {
+            m_routing->AddNetworkRouteTo(network,
+                                         Ipv4Mask(mask),
+                                         Ipv4Address(nextGateway++),
+                                         randomInterface());
+            m_nNetworkRoutes++;
+        }
+        destinations.push_back(Ipv4Address(network.Get() ^ (rng->GetInteger(0, 255) & ~mask)));
+    }
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        uint32_t length = rng->GetInteger(0, 24);
+        uint32_t mask = length == 0 ? 0 : 0xffffffff << (32 - length);
+        Ipv4Address network(randomAddress().Get() & mask);
+        m_routing->AddASExternalRouteTo(network,
+                                        Ipv4Mask(mask),
+                                        Ipv4Address(nextGateway++),
+                                        randomInterface());
+    }
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        destinations.push_back(randomAddress());
+    }
+
+    for (bool randomEcmp : {false, true})
+    {
+        m_randomEcmp = randomEcmp;
+        m_routing->SetAttribute("RandomEcmpRouting", BooleanValue(randomEcmp));
+        for (const auto& dest : destinations)
+        {
+            for (uint32_t interface = 0; interface <= nInterfaces; ++interface)
+            {
+                CheckRoute(dest, interface);
+            }
+        }
+    }
+
+    // remove some routes of each kind, then add one
+    m_randomEcmp = false;
+    m_routing->SetAttribute("RandomEcmpRouting", BooleanValue(false));
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        uint32_t index = rng->GetInteger(0, m_routing->GetNRoutes() - 1);
+        if (index < m_nHostRoutes)
+        {
+            m_nHostRoutes--;
+        }
+        else if (index < m_nHostRoutes + m_nNetworkRoutes)
+        {
+            m_nNetworkRoutes--;
+        }
+        m_routing->RemoveRoute(index);
+    }
+    m_routing->AddNetworkRouteTo(Ipv4Address("21.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    m_nNetworkRoutes++;
+    for (const auto& dest : destinations)
+    {
+        for (uint32_t interface = 0; interface <= nInterfaces; ++interface)
+        {
+            CheckRoute(dest, interface);
+        }
+    }
+
+    m_routing = nullptr;
+    m_ipv4 = nullptr;
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1335,6 +1574,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
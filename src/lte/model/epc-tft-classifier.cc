@@ -27,6 +27,7 @@
 
 #include "epc-tft.h"
 
+#include "ns3/hash.h"
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/ipv4-header.h"
@@ -40,6 +41,8 @@
 #include "ns3/udp-header.h"
 #include "ns3/udp-l4-protocol.h"
 
+#include <cstring>
+
 namespace ns3
 {
 
@@ -58,6 +61,7 @@ EpcTftClassifier::Add(Ptr<EpcTft> tft, uint32_t id)
 
     // simple sanity check: there shouldn't be more than 16 bearers (hence TFTs) per UE
     NS_ASSERT(m_tftMap.size() <= 16);
+    Compile();
 }
 
 void
@@ -65,56 +69,183 @@ EpcTftClassifier::Delete(uint32_t id)
 {
     NS_LOG_FUNCTION(this << id);
     m_tftMap.erase(id);
+    Compile();
 }
 
-uint32_t
-EpcTftClassifier::Classify(Ptr<Packet> p, EpcTft::Direction direction, uint16_t protocolNumber)
+bool
+EpcTftClassifier::FlowKey::operator==(const FlowKey& other) const
 {
-    NS_LOG_FUNCTION(this << p << p->GetSize() << direction);
-
-    Ptr<Packet> pCopy = p->Copy();
+    return remoteAddress == other.remoteAddress && localAddress == other.localAddress &&
+           remotePort == other.remotePort && localPort == other.localPort &&
+           typeOfService == other.typeOfService && direction == other.direction &&
+           ipv6 == other.ipv6;
+}
 
-    Ipv4Address localAddressIpv4;
-    Ipv4Address remoteAddressIpv4;
+std::size_t
+EpcTftClassifier::FlowKeyHash::operator()(const FlowKey& key) const
+{
+    char buffer[39];
+    std::memcpy(buffer, key.remoteAddress.data(), 16);
+    std::memcpy(buffer + 16, key.localAddress.data(), 16);
+    std::memcpy(buffer + 32, &key.remotePort, 2);
+    std::memcpy(buffer + 34, &key.localPort, 2);
+    buffer[36] = key.typeOfService;
+    buffer[37] = key.direction;
+    buffer[38] = key.ipv6;
+    return Hash64(buffer, sizeof(buffer));
+}
 
-    Ipv6Address localAddressIpv6;
-    Ipv6Address remoteAddressIpv6;
+void
+EpcTftClassifier::Compile()
+{
+    NS_LOG_FUNCTION(this);
+    m_filters.clear();
+    m_flowCache.clear();
 
-    uint8_t protocol;
-    uint8_t tos;
+    // we use a reverse iterator since filter priority is not implemented properly.
+    // This way, since the default bearer is expected to be added first, it will be evaluated
+    // last.
+    for (auto it = m_tftMap.rbegin(); it != m_tftMap.rend(); ++it)
+    {
+        for (const auto& f : it->second->GetPacketFilters())
+        {
+            CompiledFilter c;
+            c.id = it->first;
+            c.direction = f.direction;
+            c.remoteMask = f.remoteMask.Get();
+            c.remoteAddress = f.remoteAddress.Get() & c.remoteMask;
+            c.localMask = f.localMask.Get();
+            c.localAddress = f.localAddress.Get() & c.localMask;
+            f.remoteIpv6Address.GetBytes(c.remoteIpv6Address.data());
+            f.remoteIpv6Prefix.GetBytes(c.remoteIpv6Mask.data());
+            f.localIpv6Address.GetBytes(c.localIpv6Address.data());
+            f.localIpv6Prefix.GetBytes(c.localIpv6Mask.data());
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                c.remoteIpv6Address[i] &= c.remoteIpv6Mask[i];
+                c.localIpv6Address[i] &= c.localIpv6Mask[i];
+            }
+            c.remotePortStart = f.remotePortStart;
+            c.remotePortEnd = f.remotePortEnd;
+            c.localPortStart = f.localPortStart;
+            c.localPortEnd = f.localPortEnd;
+            c.typeOfServiceMask = f.typeOfServiceMask;
+            c.typeOfService = f.typeOfService & f.typeOfServiceMask;
+            m_filters.push_back(c);
+        }
+    }
+    NS_LOG_LOGIC("compiled " << m_filters.size() << " filters of " << m_tftMap.size() << " TFTs");
+}
 
-    uint16_t localPort = 0;
-    uint16_t remotePort = 0;
+/**
+ * \param buffer the address in network byte order
+ * \return the IPv4 address in host byte order
+ */
+static uint32_t
+ReadIpv4Address(const uint8_t* buffer)
+{
+    return (uint32_t(buffer[0]) << 24) | (uint32_t(buffer[1]) << 16) |
+           (uint32_t(buffer[2]) << 8) | uint32_t(buffer[3]);
+}
 
-    if (protocolNumber == Ipv4L3Protocol::PROT_NUMBER)
+/**
+ * \param address the IPv6 address
+ * \param prefix the masked IPv6 address of the filter
+ * \param mask the IPv6 prefix mask of the filter
+ * \return true if the address matches the prefix
+ */
+static bool
+MatchesIpv6Prefix(const std::array<uint8_t, 16>& address,
+                  const std::array<uint8_t, 16>& prefix,
+                  const std::array<uint8_t, 16>& mask)
+{
+    for (uint32_t i = 0; i < 16; i++)
     {
-        Ipv4Header ipv4Header;
-        pCopy->RemoveHeader(ipv4Header);
+        if ((address[i] & mask[i]) != prefix[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-        if (direction == EpcTft::UPLINK)
+uint32_t
+EpcTftClassifier::Match(const FlowKey& key) const
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t remoteAddress = ReadIpv4Address(key.remoteAddress.data());
+    uint32_t localAddress = ReadIpv4Address(key.localAddress.data());
+    for (const auto& f : m_filters)
+    {
+        if (!(key.direction & f.direction) || key.remotePort < f.remotePortStart ||
+            key.remotePort > f.remotePortEnd || key.localPort < f.localPortStart ||
+            key.localPort > f.localPortEnd ||
+            (key.typeOfService & f.typeOfServiceMask) != f.typeOfService)
         {
-            localAddressIpv4 = ipv4Header.GetSource();
-            remoteAddressIpv4 = ipv4Header.GetDestination();
+            continue;
         }
-        else
+        if (key.ipv6)
+        {
+            if (!MatchesIpv6Prefix(key.remoteAddress, f.remoteIpv6Address, f.remoteIpv6Mask) ||
+                !MatchesIpv6Prefix(key.localAddress, f.localIpv6Address, f.localIpv6Mask))
+            {
+                continue;
+            }
+        }
+        else if ((remoteAddress & f.remoteMask) != f.remoteAddress ||
+                 (localAddress & f.localMask) != f.localAddress)
         {
-            NS_ASSERT(direction == EpcTft::DOWNLINK);
-            remoteAddressIpv4 = ipv4Header.GetSource();
-            localAddressIpv4 = ipv4Header.GetDestination();
+            continue;
         }
-        NS_LOG_INFO("local address: " << localAddressIpv4
-                                      << " remote address: " << remoteAddressIpv4);
+        NS_LOG_LOGIC("matches with TFT ID = " << f.id);
+        return f.id; // the id of the matching TFT
+    }
+    NS_LOG_LOGIC("no match");
+    return 0; // no match
+}
 
-        uint16_t payloadSize = ipv4Header.GetPayloadSize();
-        uint16_t fragmentOffset = ipv4Header.GetFragmentOffset();
-        bool isLastFragment = ipv4Header.IsLastFragment();
+uint32_t
+EpcTftClassifier::Classify(Ptr<Packet> p, EpcTft::Direction direction, uint16_t protocolNumber)
+{
+    NS_LOG_FUNCTION(this << p << p->GetSize() << direction);
+
+    // The fields are read from the first bytes of the packet: the IP header, with the IPv4
+    // options, and the ports at the beginning of the UDP/TCP header
+    uint8_t buffer[64] = {};
+    uint32_t size = p->CopyData(buffer, sizeof(buffer));
 
-        // NS_LOG_DEBUG ("PayloadSize = " << payloadSize);
-        // NS_LOG_DEBUG ("fragmentOffset " << fragmentOffset << " isLastFragment " <<
-        // isLastFragment);
+    FlowKey key;
+    key.remoteAddress.fill(0);
+    key.localAddress.fill(0);
+    key.remotePort = 0;
+    key.localPort = 0;
+    key.direction = direction;
 
-        protocol = ipv4Header.GetProtocol();
-        tos = ipv4Header.GetTos();
+    const uint8_t* source = buffer;
+    const uint8_t* destination = buffer;
+    uint32_t addressSize = 0;
+    uint32_t portsOffset = 0; // the offset of the ports, 0 if they are not available
+
+    if (protocolNumber == Ipv4L3Protocol::PROT_NUMBER)
+    {
+        uint16_t headerSize = (buffer[0] & 0x0f) * 4;
+        uint16_t payloadSize = ((buffer[2] << 8) | buffer[3]) - headerSize;
+        uint16_t identification = (buffer[4] << 8) | buffer[5];
+        uint16_t fragmentOffset = (((buffer[6] & 0x1f) << 8) | buffer[7]) << 3;
+        bool isLastFragment = !(buffer[6] & (1 << 5));
+        uint8_t protocol = buffer[9];
+
+        key.typeOfService = buffer[1];
+        key.ipv6 = false;
+        source = buffer + 12;
+        destination = buffer + 16;
+        addressSize = 4;
+
+        std::tuple<uint32_t, uint32_t, uint8_t, uint16_t> fragmentKey =
+            std::make_tuple(ReadIpv4Address(source),
+                            ReadIpv4Address(destination),
+                            protocol,
+                            identification);
 
         // Port info only can be get if it is the first fragment and
         // there is enough data in the payload
@@ -122,58 +253,12 @@ EpcTftClassifier::Classify(Ptr<Packet> p, EpcTft::Direction direction, uint16_t
         // i.e. it is the first one but it is not the last one
         if (fragmentOffset == 0)
         {
-            if (protocol == UdpL4Protocol::PROT_NUMBER && payloadSize >= 8)
+            if (((protocol == UdpL4Protocol::PROT_NUMBER && payloadSize >= 8) ||
+                 (protocol == TcpL4Protocol::PROT_NUMBER && payloadSize >= 20)) &&
+                size >= headerSize + 4u)
             {
-                UdpHeader udpHeader;
-                pCopy->RemoveHeader(udpHeader);
-                if (direction == EpcTft::UPLINK)
-                {
-                    localPort = udpHeader.GetSourcePort();
-                    remotePort = udpHeader.GetDestinationPort();
-                }
-                else
-                {
-                    remotePort = udpHeader.GetSourcePort();
-                    localPort = udpHeader.GetDestinationPort();
-                }
-                if (!isLastFragment)
-                {
-                    std::tuple<uint32_t, uint32_t, uint8_t, uint16_t> fragmentKey =
-                        std::make_tuple(ipv4Header.GetSource().Get(),
-                                        ipv4Header.GetDestination().Get(),
-                                        protocol,
-                                        ipv4Header.GetIdentification());
-
-                    m_classifiedIpv4Fragments[fragmentKey] = std::make_pair(localPort, remotePort);
-                }
+                portsOffset = headerSize;
             }
-            else if (protocol == TcpL4Protocol::PROT_NUMBER && payloadSize >= 20)
-            {
-                TcpHeader tcpHeader;
-                pCopy->RemoveHeader(tcpHeader);
-                if (direction == EpcTft::UPLINK)
-                {
-                    localPort = tcpHeader.GetSourcePort();
-                    remotePort = tcpHeader.GetDestinationPort();
-                }
-                else
-                {
-                    remotePort = tcpHeader.GetSourcePort();
-                    localPort = tcpHeader.GetDestinationPort();
-                }
-
-                if (!isLastFragment)
-                {
-                    std::tuple<uint32_t, uint32_t, uint8_t, uint16_t> fragmentKey =
-                        std::make_tuple(ipv4Header.GetSource().Get(),
-                                        ipv4Header.GetDestination().Get(),
-                                        protocol,
-                                        ipv4Header.GetIdentification());
-
-                    m_classifiedIpv4Fragments[fragmentKey] = std::make_pair(localPort, remotePort);
-                }
-            }
-
             // else
             //   First fragment but not enough data for port info or not UDP/TCP protocol.
             //   Nothing can be done, i.e. we cannot get port info from packet.
@@ -182,80 +267,50 @@ EpcTftClassifier::Classify(Ptr<Packet> p, EpcTft::Direction direction, uint16_t
         {
             // Not first fragment, so port info is not available but
             // port info should already be known (if there is not fragment reordering)
-            std::tuple<uint32_t, uint32_t, uint8_t, uint16_t> fragmentKey =
-                std::make_tuple(ipv4Header.GetSource().Get(),
-                                ipv4Header.GetDestination().Get(),
-                                protocol,
-                                ipv4Header.GetIdentification());
-
-            std::map<std::tuple<uint32_t, uint32_t, uint8_t, uint16_t>,
-                     std::pair<uint32_t, uint32_t>>::iterator it =
-                m_classifiedIpv4Fragments.find(fragmentKey);
+            auto it = m_classifiedIpv4Fragments.find(fragmentKey);
 
             if (it != m_classifiedIpv4Fragments.end())
             {
-                localPort = it->second.first;
-                remotePort = it->second.second;
+                key.localPort = it->second.first;
+                key.remotePort = it->second.second;
 
                 if (isLastFragment)
                 {
-                    m_classifiedIpv4Fragments.erase(fragmentKey);
+                    m_classifiedIpv4Fragments.erase(it);
                 }
             }
         }
-    }
-    else if (protocolNumber == Ipv6L3Protocol::PROT_NUMBER)
-    {
-        Ipv6Header ipv6Header;
-        pCopy->RemoveHeader(ipv6Header);
 
-        if (direction == EpcTft::UPLINK)
+        if (portsOffset > 0)
         {
-            localAddressIpv6 = ipv6Header.GetSource();
-            remoteAddressIpv6 = ipv6Header.GetDestination();
-        }
-        else
-        {
-            NS_ASSERT(direction == EpcTft::DOWNLINK);
-            remoteAddressIpv6 = ipv6Header.GetSource();
-            localAddressIpv6 = ipv6Header.GetDestination();
+            uint16_t sourcePort = (buffer[portsOffset] << 8) | buffer[portsOffset + 1];
+            uint16_t destinationPort = (buffer[portsOffset + 2] << 8) | buffer[portsOffset + 3];
+            key.localPort = direction == EpcTft::UPLINK ? sourcePort : destinationPort;
+            key.remotePort = direction == EpcTft::UPLINK ? destinationPort : sourcePort;
+            if (!isLastFragment)
+            {
+                m_classifiedIpv4Fragments[fragmentKey] =
+                    std::make_pair(key.localPort, key.remotePort);
+            }
         }
-        NS_LOG_INFO("local address: " << localAddressIpv6
-                                      << " remote address: " << remoteAddressIpv6);
+    }
+    else if (protocolNumber == Ipv6L3Protocol::PROT_NUMBER)
+    {
+        uint8_t protocol = buffer[6];
 
-        protocol = ipv6Header.GetNextHeader();
-        tos = ipv6Header.GetTrafficClass();
+        key.typeOfService = ((buffer[0] & 0x0f) << 4) | (buffer[1] >> 4);
+        key.ipv6 = true;
+        source = buffer + 8;
+        destination = buffer + 24;
+        addressSize = 16;
 
-        if (protocol == UdpL4Protocol::PROT_NUMBER)
+        if ((protocol == UdpL4Protocol::PROT_NUMBER || protocol == TcpL4Protocol::PROT_NUMBER) &&
+            size >= 44)
         {
-            UdpHeader udpHeader;
-            pCopy->RemoveHeader(udpHeader);
-
-            if (direction == EpcTft::UPLINK)
-            {
-                localPort = udpHeader.GetSourcePort();
-                remotePort = udpHeader.GetDestinationPort();
-            }
-            else
-            {
-                remotePort = udpHeader.GetSourcePort();
-                localPort = udpHeader.GetDestinationPort();
-            }
-        }
-        else if (protocol == TcpL4Protocol::PROT_NUMBER)
-        {
-            TcpHeader tcpHeader;
-            pCopy->RemoveHeader(tcpHeader);
-            if (direction == EpcTft::UPLINK)
-            {
-                localPort = tcpHeader.GetSourcePort();
-                remotePort = tcpHeader.GetDestinationPort();
-            }
-            else
-            {
-                remotePort = tcpHeader.GetSourcePort();
-                localPort = tcpHeader.GetDestinationPort();
-            }
+            uint16_t sourcePort = (buffer[40] << 8) | buffer[41];
+            uint16_t destinationPort = (buffer[42] << 8) | buffer[43];
+            key.localPort = direction == EpcTft::UPLINK ? sourcePort : destinationPort;
+            key.remotePort = direction == EpcTft::UPLINK ? destinationPort : sourcePort;
         }
     }
     else
@@ -263,70 +318,50 @@ EpcTftClassifier::Classify(Ptr<Packet> p, EpcTft::Direction direction, uint16_t
         NS_ABORT_MSG("EpcTftClassifier::Classify - Unknown IP type...");
     }
 
-    if (protocolNumber == Ipv4L3Protocol::PROT_NUMBER)
+    if (direction == EpcTft::UPLINK)
+    {
+        std::memcpy(key.localAddress.data(), source, addressSize);
+        std::memcpy(key.remoteAddress.data(), destination, addressSize);
+    }
+    else
+    {
+        NS_ASSERT(direction == EpcTft::DOWNLINK);
+        std::memcpy(key.remoteAddress.data(), source, addressSize);
+        std::memcpy(key.localAddress.data(), destination, addressSize);
+    }
+
+    if (key.ipv6)
     {
         NS_LOG_INFO("Classifying packet:"
-                    << " localAddr=" << localAddressIpv4 << " remoteAddr=" << remoteAddressIpv4
-                    << " localPort=" << localPort << " remotePort=" << remotePort << " tos=0x"
-                    << (uint16_t)tos);
-
-        // now it is possible to classify the packet!
-        // we use a reverse iterator since filter priority is not implemented properly.
-        // This way, since the default bearer is expected to be added first, it will be evaluated
-        // last.
-        std::map<uint32_t, Ptr<EpcTft>>::const_reverse_iterator it;
-        NS_LOG_LOGIC("TFT MAP size: " << m_tftMap.size());
-
-        for (it = m_tftMap.rbegin(); it != m_tftMap.rend(); ++it)
-        {
-            NS_LOG_LOGIC("TFT id: " << it->first);
-            NS_LOG_LOGIC(" Ptr<EpcTft>: " << it->second);
-            Ptr<EpcTft> tft = it->second;
-            if (tft->Matches(direction,
-                             remoteAddressIpv4,
-                             localAddressIpv4,
-                             remotePort,
-                             localPort,
-                             tos))
-            {
-                NS_LOG_LOGIC("matches with TFT ID = " << it->first);
-                return it->first; // the id of the matching TFT
-            }
-        }
+                    << " localAddr=" << Ipv6Address(key.localAddress.data())
+                    << " remoteAddr=" << Ipv6Address(key.remoteAddress.data())
+                    << " localPort=" << key.localPort << " remotePort=" << key.remotePort
+                    << " tos=0x" << (uint16_t)key.typeOfService);
     }
-    else if (protocolNumber == Ipv6L3Protocol::PROT_NUMBER)
+    else
     {
         NS_LOG_INFO("Classifying packet:"
-                    << " localAddr=" << localAddressIpv6 << " remoteAddr=" << remoteAddressIpv6
-                    << " localPort=" << localPort << " remotePort=" << remotePort << " tos=0x"
-                    << (uint16_t)tos);
-
-        // now it is possible to classify the packet!
-        // we use a reverse iterator since filter priority is not implemented properly.
-        // This way, since the default bearer is expected to be added first, it will be evaluated
-        // last.
-        std::map<uint32_t, Ptr<EpcTft>>::const_reverse_iterator it;
-        NS_LOG_LOGIC("TFT MAP size: " << m_tftMap.size());
-
-        for (it = m_tftMap.rbegin(); it != m_tftMap.rend(); ++it)
-        {
-            NS_LOG_LOGIC("TFT id: " << it->first);
-            NS_LOG_LOGIC(" Ptr<EpcTft>: " << it->second);
-            Ptr<EpcTft> tft = it->second;
-            if (tft->Matches(direction,
-                             remoteAddressIpv6,
-                             localAddressIpv6,
-                             remotePort,
-                             localPort,
-                             tos))
-            {
-                NS_LOG_LOGIC("matches with TFT ID = " << it->first);
-                return it->first; // the id of the matching TFT
-            }
-        }
+                    << " localAddr=" << Ipv4Address(ReadIpv4Address(key.localAddress.data()))
+                    << " remoteAddr=" << Ipv4Address(ReadIpv4Address(key.remoteAddress.data()))
+                    << " localPort=" << key.localPort << " remotePort=" << key.remotePort
+                    << " tos=0x" << (uint16_t)key.typeOfService);
     }
-    NS_LOG_LOGIC("no match");
-    return 0; // no match
+
+    auto it = m_flowCache.find(key);
+    if (it != m_flowCache.end())
+    {
+        NS_LOG_LOGIC("cached flow of TFT ID = " << it->second);
+        return it->second;
+    }
+
+    // now it is possible to classify the packet!
+    uint32_t id = Match(key);
+    if (m_flowCache.size() >= MAX_CACHED_FLOWS)
+    {
+        m_flowCache.clear();
+    }
+    m_flowCache.emplace(key, id);
+    return id;
 }
 
 } // namespace ns3
@@ -25,7 +25,10 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 
+#include <array>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -48,6 +51,13 @@ class Packet;
  *
  * When we cannot cache the port info, the TFT of the default bearer is used. This may happen
  * if there is reordering or losses of IP packets.
+ *
+ * The packet filters of the TFTs are compiled, when a TFT is added or deleted, into a flat
+ * array of integer comparisons in the order in which they are evaluated. The addresses,
+ * ports and type of service are read from the first bytes of the packet, which is not copied,
+ * and the result of the classification of each flow is cached, so that the filters are only
+ * evaluated for the first packet of a flow. A TFT must thus not be changed after it has been
+ * added to the classifier.
  */
 class EpcTftClassifier : public SimpleRefCount<EpcTftClassifier>
 {
@@ -93,6 +103,74 @@ class EpcTftClassifier : public SimpleRefCount<EpcTftClassifier>
                                    ///<   not first fragment or not enough payload data for TCP/UDP
                                    ///< An entry is removed when the last fragment is classified
                                    ///<   Note: If last fragment is lost, entry is not removed
+
+  private:
+    /// A packet filter compiled to integer comparisons
+    struct CompiledFilter
+    {
+        uint32_t id;                               //!< the ID of the bearer of the TFT
+        uint8_t direction;                         //!< the directions of the filter
+        uint32_t remoteAddress;                    //!< the masked IPv4 remote address
+        uint32_t remoteMask;                       //!< the IPv4 remote mask
+        uint32_t localAddress;                     //!< the masked IPv4 local address
+        uint32_t localMask;                        //!< the IPv4 local mask
+        std::array<uint8_t, 16> remoteIpv6Address; //!< the masked IPv6 remote address
+        std::array<uint8_t, 16> remoteIpv6Mask;    //!< the IPv6 remote mask
+        std::array<uint8_t, 16> localIpv6Address;  //!< the masked IPv6 local address
+        std::array<uint8_t, 16> localIpv6Mask;     //!< the IPv6 local mask
+        uint16_t remotePortStart;                  //!< the start of the remote port range
+        uint16_t remotePortEnd;                    //!< the end of the remote port range
+        uint16_t localPortStart;                   //!< the start of the local port range
+        uint16_t localPortEnd;                     //!< the end of the local port range
+        uint8_t typeOfService;                     //!< the masked type of service
+        uint8_t typeOfServiceMask;                 //!< the type of service mask
+    };
+
+    /// The fields of a packet which are matched by the filters
+    struct FlowKey
+    {
+        std::array<uint8_t, 16> remoteAddress; //!< the remote address, IPv4 in the first bytes
+        std::array<uint8_t, 16> localAddress;  //!< the local address, IPv4 in the first bytes
+        uint16_t remotePort;                   //!< the remote port
+        uint16_t localPort;                    //!< the local port
+        uint8_t typeOfService;                 //!< the type of service
+        uint8_t direction;                     //!< the direction
+        bool ipv6;                             //!< whether the addresses are IPv6 addresses
+
+        /**
+         * \param other the other key
+         * \return true if the keys are equal
+         */
+        bool operator==(const FlowKey& other) const;
+    };
+
+    /// Hash function of the flow keys
+    struct FlowKeyHash
+    {
+        /**
+         * \param key the flow key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const FlowKey& key) const;
+    };
+
+    /// Compile the packet filters of the TFTs into m_filters and clear the flow cache
+    void Compile();
+
+    /**
+     * Evaluate the compiled filters
+     *
+     * \param key the fields of the packet
+     * \return the identifier of the first TFT that matches; 0 if no TFT matched
+     */
+    uint32_t Match(const FlowKey& key) const;
+
+    /// The maximum number of flows in the cache, which is cleared when it is full
+    static constexpr std::size_t MAX_CACHED_FLOWS = 4096;
+
+    std::vector<CompiledFilter> m_filters; //!< the compiled filters, in order of evaluation
+    std::unordered_map<FlowKey, uint32_t, FlowKeyHash>
+        m_flowCache; //!< the TFT identifier of the classified flows
 };
 
 } // namespace ns3
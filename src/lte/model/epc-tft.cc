@@ -306,4 +306,10 @@ EpcTft::Matches(Direction direction,
     return false;
 }
 
+std::list<EpcTft::PacketFilter>
+EpcTft::GetPacketFilters() const
+{
+    return m_filters;
+}
+
 } // namespace ns3
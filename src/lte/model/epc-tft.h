@@ -188,6 +188,11 @@ class EpcTft : public SimpleRefCount<EpcTft>
                  uint16_t localPort,
                  uint8_t typeOfService);
 
+    /**
+     * \return the PacketFilters of the TFT, in the order in which they are evaluated
+     */
+    std::list<PacketFilter> GetPacketFilters() const;
+
   private:
     std::list<PacketFilter> m_filters; ///< packet filter list
     uint8_t m_numFilters;              ///< number of packet filters applied to this TFT
@@ -0,0 +1,333 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Microbenchmark of the mmWave MAC schedulers.
+ *
+ * The scheduler is driven directly through its SAP interfaces, without PHY, channel or
+ * simulator events: every slot the benchmark feeds it synthetic DL RLC buffer updates,
+ * wideband DL CQIs, BSRs, UL CQIs of the previous UL allocations and HARQ feedback for the
+ * previous DL/UL transmissions, then triggers the scheduling of the slot. The wall clock
+ * time per slot is reported for an increasing number of UEs, together with a checksum of
+ * the allocations which can be used to check that two builds of a scheduler take the same
+ * decisions, e.g.
+ *
+ * ./ns3 run "mmwave-scheduler-benchmark --minUes=10 --maxUes=500 --slots=20000"
+ * ./ns3 run "mmwave-scheduler-benchmark --scheduler=ns3::MmWaveFlexTtiPfMacScheduler"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-mac-csched-sap.h"
+#include "ns3/mmwave-mac-sched-sap.h"
+#include "ns3/mmwave-mac-scheduler.h"
+#include "ns3/mmwave-phy-mac-common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * Collects the scheduling decisions and turns them into the feedback of the next slots
+ */
+class BenchSchedSapUser : public MmWaveMacSchedSapUser
+{
+  public:
+    BenchSchedSapUser()
+        : m_checksum(14695981039346656037ULL),
+          m_dataTtis(0)
+    {
+    }
+
+    void SchedConfigInd(const struct SchedConfigIndParameters& params) override
+    {
+        for (const TtiAllocInfo& tti : params.m_slotAllocInfo.m_ttiAllocInfo)
+        {
+            if (tti.m_ttiType == TtiAllocInfo::CTRL)
+            {
+                continue;
+            }
+            const DciInfoElementTdma& dci = tti.m_dci;
+            Hash(tti.m_tddMode);
+            Hash(dci.m_rnti);
+            Hash(dci.m_symStart);
+            Hash(dci.m_numSym);
+            Hash(dci.m_mcs);
+            Hash(dci.m_tbSize);
+            Hash(dci.m_harqProcess);
+            Hash(dci.m_rv);
+            m_dataTtis++;
+            if (tti.m_tddMode == TtiAllocInfo::DL_slotAllocInfo)
+            {
+                m_dlDci.push_back(dci);
+            }
+            else
+            {
+                m_ulDci.push_back(dci);
+            }
+        }
+    }
+
+    /**
+     * Mixes a value into the checksum (FNV-1a)
+     *
+     * \param value the value
+     */
+    void Hash(uint64_t value)
+    {
+        m_checksum = (m_checksum ^ value) * 1099511628211ULL;
+    }
+
+    uint64_t m_checksum;                    //!< checksum of the allocations
+    uint64_t m_dataTtis;                    //!< number of data TTIs allocated
+    std::vector<DciInfoElementTdma> m_dlDci; //!< DL DCIs waiting for HARQ feedback
+    std::vector<DciInfoElementTdma> m_ulDci; //!< UL DCIs waiting for HARQ feedback and UL CQI
+};
+
+/**
+ * Ignores the CSCHED confirmations
+ */
+class BenchCschedSapUser : public MmWaveMacCschedSapUser
+{
+  public:
+    void CschedCellConfigCnf(const struct CschedCellConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedUeConfigCnf(const struct CschedUeConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedLcConfigCnf(const struct CschedLcConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedLcReleaseCnf(const struct CschedLcReleaseCnfParameters& params) override
+    {
+    }
+
+    void CschedUeReleaseCnf(const struct CschedUeReleaseCnfParameters& params) override
+    {
+    }
+
+    void CschedUeConfigUpdateInd(const struct CschedUeConfigUpdateIndParameters& params) override
+    {
+    }
+
+    void CschedCellConfigUpdateInd(
+        const struct CschedCellConfigUpdateIndParameters& params) override
+    {
+    }
+};
+
+/**
+ * Runs the benchmark for a given number of UEs
+ *
+ * \param schedulerType the TypeId name of the scheduler
+ * \param numUes the number of UEs
+ * \param numSlots the number of slots to schedule
+ * \param nackProbability the probability of a HARQ NACK
+ */
+static void
+RunBenchmark(std::string schedulerType, uint16_t numUes, uint32_t numSlots, double nackProbability)
+{
+    Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon>();
+    ObjectFactory factory;
+    factory.SetTypeId(schedulerType);
+    Ptr<MmWaveMacScheduler> scheduler = factory.Create<MmWaveMacScheduler>();
+
+    BenchSchedSapUser schedSapUser;
+    BenchCschedSapUser cschedSapUser;
+    scheduler->ConfigureCommonParameters(config);
+    scheduler->SetMacSchedSapUser(&schedSapUser);
+    scheduler->SetMacCschedSapUser(&cschedSapUser);
+    MmWaveMacSchedSapProvider* sched = scheduler->GetMacSchedSapProvider();
+    MmWaveMacCschedSapProvider* csched = scheduler->GetMacCschedSapProvider();
+
+    // same random streams for every scheduler and UE count
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    MmWaveMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    csched->CschedCellConfigReq(cellConfig);
+    for (uint16_t rnti = 1; rnti <= numUes; rnti++)
+    {
+        MmWaveMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+    }
+
+    const uint32_t slotsPerSubframe = config->GetSlotsPerSubframe();
+    const uint32_t subframesPerFrame = config->GetSubframesPerFrame();
+    const uint32_t cqiPeriod = 40; // slots between two DL CQIs of the same UE
+    const uint32_t numRb = config->GetNumRb();
+
+    std::vector<DciInfoElementTdma> dlFeedback;
+    std::vector<DciInfoElementTdma> ulFeedback;
+    SfnSf prevSfn;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t slot = 0; slot < numSlots; slot++)
+    {
+        SfnSf sfn(slot / (slotsPerSubframe * subframesPerFrame),
+                  (slot / slotsPerSubframe) % subframesPerFrame,
+                  slot % slotsPerSubframe);
+
+        // new DL data for a few UEs
+        for (uint16_t i = 0; i < 1 + numUes / 20; i++)
+        {
+            MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rng->GetInteger(1, numUes);
+            rlc.m_logicalChannelIdentity = 3 + rng->GetInteger(0, 1);
+            rlc.m_rlcTransmissionQueueSize = rng->GetInteger(100, 20000);
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = rng->GetValue() < 0.1 ? 4 : 0;
+            rlc.m_arrivalRate = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+
+        // periodic wideband DL CQIs, staggered between the UEs
+        MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = sfn;
+        for (uint16_t rnti = 1 + slot % cqiPeriod; rnti <= numUes; rnti += cqiPeriod)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = rng->GetInteger(1, 15);
+            cqi.m_wbPmi = 0;
+            dlCqi.m_cqiList.push_back(cqi);
+        }
+        if (!dlCqi.m_cqiList.empty())
+        {
+            sched->SchedDlCqiInfoReq(dlCqi);
+        }
+
+        // BSRs of a few UEs
+        MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = sfn;
+        for (uint16_t i = 0; i < 1 + numUes / 20; i++)
+        {
+            MacCeElement ce;
+            ce.m_rnti = rng->GetInteger(1, numUes);
+            ce.m_macCeType = MacCeElement::BSR;
+            for (uint8_t lcg = 0; lcg < 4; lcg++)
+            {
+                ce.m_macCeValue.m_bufferStatus.push_back(lcg == 0 ? rng->GetInteger(0, 40) : 0);
+            }
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedUlMacCtrlInfoReq(bsr);
+
+        // UL CQIs of the UL transmissions scheduled in the previous slot
+        MmWaveMacSchedSapProvider::SchedTriggerReqParameters trigger;
+        trigger.m_snfSf = sfn;
+        for (const DciInfoElementTdma& dci : ulFeedback)
+        {
+            MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+            ulCqi.m_sfnSf = prevSfn;
+            ulCqi.m_sfnSf.m_symStart = dci.m_symStart;
+            ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+            double sinr = rng->GetValue(1.0, 1000.0);
+            ulCqi.m_ulCqi.m_sinr.assign(numRb, sinr);
+            sched->SchedUlCqiInfoReq(ulCqi);
+
+            UlHarqInfo harq;
+            harq.m_rnti = dci.m_rnti;
+            harq.m_harqProcessId = dci.m_harqProcess;
+            harq.m_numRetx = dci.m_rv;
+            harq.m_receptionStatus =
+                rng->GetValue() < nackProbability ? UlHarqInfo::NotOk : UlHarqInfo::Ok;
+            trigger.m_ulHarqInfoList.push_back(harq);
+        }
+
+        // HARQ feedback of the DL transmissions scheduled in the previous slot
+        for (const DciInfoElementTdma& dci : dlFeedback)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci.m_rnti;
+            harq.m_harqProcessId = dci.m_harqProcess;
+            harq.m_numRetx = dci.m_rv;
+            harq.m_harqStatus =
+                rng->GetValue() < nackProbability ? DlHarqInfo::NACK : DlHarqInfo::ACK;
+            trigger.m_dlHarqInfoList.push_back(harq);
+        }
+
+        schedSapUser.m_dlDci.clear();
+        schedSapUser.m_ulDci.clear();
+        sched->SchedTriggerReq(trigger);
+        dlFeedback.swap(schedSapUser.m_dlDci);
+        ulFeedback.swap(schedSapUser.m_ulDci);
+        prevSfn = sfn;
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double, std::micro>(stop - start).count();
+
+    std::cout << std::setw(6) << numUes << std::setw(10) << numSlots << std::setw(14)
+              << std::fixed << std::setprecision(3) << elapsed / numSlots << std::setw(12)
+              << schedSapUser.m_dataTtis << "  " << std::hex << schedSapUser.m_checksum
+              << std::dec << std::endl;
+
+    scheduler->Dispose();
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string scheduler = "ns3::MmWaveFlexTtiMacScheduler";
+    uint32_t minUes = 10;
+    uint32_t maxUes = 500;
+    uint32_t slots = 10000;
+    double nackProbability = 0.1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("scheduler", "TypeId of the scheduler", scheduler);
+    cmd.AddValue("minUes", "Smallest number of UEs", minUes);
+    cmd.AddValue("maxUes", "Largest number of UEs", maxUes);
+    cmd.AddValue("slots", "Number of slots to schedule for each number of UEs", slots);
+    cmd.AddValue("nackProbability", "Probability of a HARQ NACK", nackProbability);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(minUes == 0 || minUes > maxUes || maxUes > 65000, "Invalid number of UEs");
+
+    std::cout << scheduler << std::endl;
+    std::cout << std::setw(6) << "UEs" << std::setw(10) << "slots" << std::setw(14) << "us/slot"
+              << std::setw(12) << "data TTIs"
+              << "  checksum" << std::endl;
+
+    const uint32_t steps[] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+    for (uint32_t numUes : steps)
+    {
+        if (numUes >= minUes && numUes <= maxUes)
+        {
+            RunBenchmark(scheduler, numUes, slots, nackProbability);
+        }
+    }
+    if (std::find(std::begin(steps), std::end(steps), maxUes) == std::end(steps))
+    {
+        RunBenchmark(scheduler, maxUes, slots, nackProbability);
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Converts the binary traces written by MmWavePhyTrace and MmWaveMacTrace when their
+ * BinaryOutput attribute is set, e.g.
+ *
+ * ./ns3 run "mmwave-trace-export --input=RxPacketTrace.txt.bin --output=RxPacketTrace.txt"
+ * ./ns3 run "mmwave-trace-export --input=RxPacketTrace.txt.bin --output=rx --columnar=1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-trace-writer.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+using namespace mmwave;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    bool columnar = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Binary trace to convert", input);
+    cmd.AddValue("output", "Output text file, or prefix of the column files", output);
+    cmd.AddValue("columnar", "Write one binary file per column instead of text", columnar);
+    cmd.Parse(argc, argv);
+
+    MmWaveTraceReader reader;
+    if (input.empty() || !reader.Open(input))
+    {
+        std::cerr << "Cannot read binary trace " << input << std::endl;
+        return 1;
+    }
+
+    if (columnar)
+    {
+        reader.ExportColumns(output.empty() ? input : output);
+    }
+    else if (output.empty())
+    {
+        reader.ExportCsv(std::cout);
+    }
+    else
+    {
+        std::ofstream os(output.c_str());
+        reader.ExportCsv(os);
+    }
+    return 0;
+}
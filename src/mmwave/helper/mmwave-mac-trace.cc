@@ -20,7 +20,9 @@
 
 #include "mmwave-mac-trace.h"
 
+#include <ns3/boolean.h>
 #include <ns3/log.h>
+#include <ns3/uinteger.h>
 
 namespace ns3
 {
@@ -34,6 +36,10 @@ NS_OBJECT_ENSURE_REGISTERED(MmWaveMacTrace);
 
 std::ofstream MmWaveMacTrace::m_schedAllocTraceFile{};
 std::string MmWaveMacTrace::m_schedAllocTraceFilename{};
+MmWaveTraceWriter MmWaveMacTrace::m_schedAllocTraceWriter{};
+bool MmWaveMacTrace::m_binaryOutput = false;
+bool MmWaveMacTrace::m_compressBinaryOutput = false;
+uint32_t MmWaveMacTrace::m_binaryBlockSize = 1 << 20;
 
 MmWaveMacTrace::MmWaveMacTrace()
 {
@@ -45,6 +51,7 @@ MmWaveMacTrace::~MmWaveMacTrace()
     {
         m_schedAllocTraceFile.close();
     }
+    m_schedAllocTraceWriter.Close();
 }
 
 TypeId
@@ -58,7 +65,28 @@ MmWaveMacTrace::GetTypeId(void)
                                           "the scheduler will be saved.",
                                           StringValue("EnbSchedAllocTraces.txt"),
                                           MakeStringAccessor(&MmWaveMacTrace::SetOutputFilename),
-                                          MakeStringChecker());
+                                          MakeStringChecker())
+                            .AddAttribute("BinaryOutput",
+                                          "If true, the allocation info is written as fixed width "
+                                          "binary records to the configured filename with a .bin "
+                                          "suffix.",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&MmWaveMacTrace::SetBinaryOutput),
+                                          MakeBooleanChecker())
+                            .AddAttribute(
+                                "CompressBinaryOutput",
+                                "If true, the blocks of the binary trace are compressed, when "
+                                "supported by the build.",
+                                BooleanValue(false),
+                                MakeBooleanAccessor(&MmWaveMacTrace::SetCompressBinaryOutput),
+                                MakeBooleanChecker())
+                            .AddAttribute(
+                                "BinaryBlockSize",
+                                "Size in bytes of the blocks handed over to the background "
+                                "writer of the binary trace.",
+                                UintegerValue(1 << 20),
+                                MakeUintegerAccessor(&MmWaveMacTrace::SetBinaryBlockSize),
+                                MakeUintegerChecker<uint32_t>(64));
     return tid;
 }
 
@@ -66,6 +94,38 @@ void
 MmWaveMacTrace::ReportEnbSchedulingInfo(Ptr<MmWaveMacTrace> enbStats,
                                         MmWaveEnbMac::MmWaveSchedTraceInfo schedParams)
 {
+    SlotAllocInfo& allocInfo = schedParams.m_indParam.m_slotAllocInfo;
+    SfnSf dlSfn =
+        schedParams.m_indParam.m_sfnSf; // Holds the intended slot, subframe and frame info
+
+    if (m_binaryOutput)
+    {
+        if (!m_schedAllocTraceWriter.IsOpen())
+        {
+            m_schedAllocTraceWriter.Open(m_schedAllocTraceFilename + ".bin",
+                                         SCHED_ALLOC_TRACE,
+                                         sizeof(PhyTxTraceRecord),
+                                         m_binaryBlockSize,
+                                         m_compressBinaryOutput);
+        }
+        for (const auto& iTti : allocInfo.m_ttiAllocInfo)
+        {
+            PhyTxTraceRecord record = {};
+            record.m_frameNum = dlSfn.m_frameNum;
+            record.m_rnti = iTti.m_dci.m_rnti;
+            record.m_sfNum = dlSfn.m_sfNum;
+            record.m_slotNum = dlSfn.m_slotNum;
+            record.m_symStart = iTti.m_dci.m_symStart;
+            record.m_numSym = iTti.m_dci.m_numSym;
+            record.m_ttiType = iTti.m_ttiType;
+            record.m_tddMode = iTti.m_tddMode;
+            record.m_rv = iTti.m_dci.m_rv;
+            record.m_ccId = schedParams.m_ccId;
+            m_schedAllocTraceWriter.Write(record);
+        }
+        return;
+    }
+
     // Open the output file if it is not open yet
     if (!m_schedAllocTraceFile.is_open())
     {
@@ -79,21 +139,35 @@ MmWaveMacTrace::ReportEnbSchedulingInfo(Ptr<MmWaveMacTrace> enbStats,
             << std::endl;
     }
 
-    SlotAllocInfo allocInfo = schedParams.m_indParam.m_slotAllocInfo;
-    SfnSf dlSfn =
-        schedParams.m_indParam.m_sfnSf; // Holds the intended slot, subframe and frame info
-
-    for (auto iTti : allocInfo.m_ttiAllocInfo)
+    for (const auto& iTti : allocInfo.m_ttiAllocInfo)
     {
         // Trace the incoming alloc info
         m_schedAllocTraceFile << +dlSfn.m_frameNum << "\t" << +dlSfn.m_sfNum << "\t"
                               << +dlSfn.m_slotNum << "\t" << +iTti.m_dci.m_rnti << "\t"
                               << +iTti.m_dci.m_symStart << "\t" << +iTti.m_dci.m_numSym << "\t"
                               << iTti.m_ttiType << "\t" << iTti.m_tddMode << "\t"
-                              << +iTti.m_dci.m_rv << "\t" << +schedParams.m_ccId << std::endl;
+                              << +iTti.m_dci.m_rv << "\t" << +schedParams.m_ccId << "\n";
     }
 }
 
+void
+MmWaveMacTrace::SetBinaryOutput(bool binary)
+{
+    m_binaryOutput = binary;
+}
+
+void
+MmWaveMacTrace::SetCompressBinaryOutput(bool compress)
+{
+    m_compressBinaryOutput = compress;
+}
+
+void
+MmWaveMacTrace::SetBinaryBlockSize(uint32_t size)
+{
+    m_binaryBlockSize = size;
+}
+
 void
 MmWaveMacTrace::SetOutputFilename(std::string fileName)
 {
@@ -23,6 +23,7 @@
 
 #include <ns3/mmwave-enb-mac.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-trace-writer.h>
 #include <ns3/object.h>
 
 #include <fstream>
@@ -54,6 +55,27 @@ class MmWaveMacTrace : public Object
      */
     void SetOutputFilename(std::string fileName);
 
+    /**
+     * Selects the fixed width binary output instead of the text one. The binary trace is
+     * written to the configured filename with a ".bin" suffix.
+     *
+     * \param binary true to write a binary trace
+     */
+    void SetBinaryOutput(bool binary);
+
+    /**
+     * Enables the compression of the blocks of the binary trace
+     *
+     * \param compress true to compress the binary trace
+     */
+    void SetCompressBinaryOutput(bool compress);
+
+    /**
+     * Sets the size of the in-memory blocks of the binary trace
+     * \param size the block size in bytes
+     */
+    void SetBinaryBlockSize(uint32_t size);
+
     /**
      * Callback used to trace the reception of a scheduling decision by the eNB and from the
      * scheduler itself.
@@ -69,6 +91,11 @@ class MmWaveMacTrace : public Object
         m_schedAllocTraceFile; //!< Output stream for the scheduling allocations trace
     static std::string
         m_schedAllocTraceFilename; //!< Output filename for the scheduling allocations trace
+    static MmWaveTraceWriter
+        m_schedAllocTraceWriter; //!< Binary output for the scheduling allocations trace
+    static bool m_binaryOutput;         //!< Whether the trace is written in binary form
+    static bool m_compressBinaryOutput; //!< Whether the binary trace is compressed
+    static uint32_t m_binaryBlockSize;  //!< Size of the blocks of the binary trace
 };
 
 } // namespace mmwave
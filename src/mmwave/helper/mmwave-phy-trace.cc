@@ -34,8 +34,10 @@
 
 #include "mmwave-phy-trace.h"
 
+#include <ns3/boolean.h>
 #include <ns3/log.h>
 #include <ns3/simulator.h>
+#include <ns3/uinteger.h>
 
 #include <stdio.h>
 
@@ -58,6 +60,14 @@ std::string MmWavePhyTrace::m_ulPhyTraceFilename{};
 std::ofstream MmWavePhyTrace::m_dlPhyTraceFile{};
 std::string MmWavePhyTrace::m_dlPhyTraceFilename{};
 
+MmWaveTraceWriter MmWavePhyTrace::m_rxPacketTraceWriter{};
+MmWaveTraceWriter MmWavePhyTrace::m_ulPhyTraceWriter{};
+MmWaveTraceWriter MmWavePhyTrace::m_dlPhyTraceWriter{};
+
+bool MmWavePhyTrace::m_binaryOutput = false;
+bool MmWavePhyTrace::m_compressBinaryOutput = false;
+uint32_t MmWavePhyTrace::m_binaryBlockSize = 1 << 20;
+
 MmWavePhyTrace::MmWavePhyTrace()
 {
 }
@@ -68,6 +78,9 @@ MmWavePhyTrace::~MmWavePhyTrace()
     {
         m_rxPacketTraceFile.close();
     }
+    m_rxPacketTraceWriter.Close();
+    m_ulPhyTraceWriter.Close();
+    m_dlPhyTraceWriter.Close();
 }
 
 TypeId
@@ -92,6 +105,24 @@ MmWavePhyTrace::GetTypeId(void)
                           StringValue("DlPhyTransmissionTrace.txt"),
                           MakeStringAccessor(&MmWavePhyTrace::SetDlPhyTxOutputFilename),
                           MakeStringChecker())
+            .AddAttribute("BinaryOutput",
+                          "If true, the traces are written as fixed width binary records "
+                          "to the configured filenames with a .bin suffix.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&MmWavePhyTrace::SetBinaryOutput),
+                          MakeBooleanChecker())
+            .AddAttribute("CompressBinaryOutput",
+                          "If true, the blocks of the binary traces are compressed, "
+                          "when supported by the build.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&MmWavePhyTrace::SetCompressBinaryOutput),
+                          MakeBooleanChecker())
+            .AddAttribute("BinaryBlockSize",
+                          "Size in bytes of the blocks handed over to the background writer "
+                          "of the binary traces.",
+                          UintegerValue(1 << 20),
+                          MakeUintegerAccessor(&MmWavePhyTrace::SetBinaryBlockSize),
+                          MakeUintegerChecker<uint32_t>(64))
 
         ;
     return tid;
@@ -118,6 +149,24 @@ MmWavePhyTrace::SetDlPhyTxOutputFilename(std::string fileName)
     m_dlPhyTraceFilename = fileName;
 }
 
+void
+MmWavePhyTrace::SetBinaryOutput(bool binary)
+{
+    m_binaryOutput = binary;
+}
+
+void
+MmWavePhyTrace::SetCompressBinaryOutput(bool compress)
+{
+    m_compressBinaryOutput = compress;
+}
+
+void
+MmWavePhyTrace::SetBinaryBlockSize(uint32_t size)
+{
+    m_binaryBlockSize = size;
+}
+
 void
 MmWavePhyTrace::ReportCurrentCellRsrpSinrCallback(Ptr<MmWavePhyTrace> phyStats,
                                                   std::string path,
@@ -193,49 +242,107 @@ unsigned) tbSize); fflush(log_file); fclose(log_file);
 }
 */
 void
-MmWavePhyTrace::ReportUlPhyTransmissionCallback(Ptr<MmWavePhyTrace> phyStats,
-                                                PhyTransmissionTraceParams param)
+MmWavePhyTrace::WritePhyTransmission(std::ofstream& file,
+                                     MmWaveTraceWriter& writer,
+                                     const std::string& fileName,
+                                     MmWaveTraceRecordType type,
+                                     const PhyTransmissionTraceParams& param)
 {
-    if (!m_ulPhyTraceFile.is_open())
+    if (m_binaryOutput)
     {
-        m_ulPhyTraceFile.open(m_ulPhyTraceFilename.c_str());
-        if (!m_ulPhyTraceFile.is_open())
+        if (!writer.IsOpen())
+        {
+            writer.Open(fileName + ".bin",
+                        type,
+                        sizeof(PhyTxTraceRecord),
+                        m_binaryBlockSize,
+                        m_compressBinaryOutput);
+        }
+        PhyTxTraceRecord record = {};
+        record.m_frameNum = param.m_frameNum;
+        record.m_rnti = param.m_rnti;
+        record.m_sfNum = param.m_sfNum;
+        record.m_slotNum = param.m_slotNum;
+        record.m_symStart = param.m_symStart;
+        record.m_numSym = param.m_numSym;
+        record.m_ttiType = param.m_ttiType;
+        record.m_tddMode = param.m_tddMode;
+        record.m_rv = param.m_rv;
+        record.m_ccId = param.m_ccId;
+        writer.Write(record);
+        return;
+    }
+
+    if (!file.is_open())
+    {
+        file.open(fileName.c_str());
+        if (!file.is_open())
         {
             NS_FATAL_ERROR("Could not open tracefile");
         }
-        m_ulPhyTraceFile
-            << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId"
-            << std::endl;
+        file << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId"
+             << std::endl;
     }
 
+    file << +param.m_frameNum << "\t" << +param.m_sfNum << "\t" << +param.m_slotNum << "\t"
+         << +param.m_rnti << "\t" << +param.m_symStart << "\t" << +param.m_numSym << "\t"
+         << +param.m_ttiType << "\t" << +param.m_tddMode << "\t" << +param.m_rv << "\t"
+         << +param.m_ccId << "\n";
+}
+
+void
+MmWavePhyTrace::ReportUlPhyTransmissionCallback(Ptr<MmWavePhyTrace> phyStats,
+                                                PhyTransmissionTraceParams param)
+{
     // Trace the UL PHY transmission info
-    m_ulPhyTraceFile << +param.m_frameNum << "\t" << +param.m_sfNum << "\t" << +param.m_slotNum
-                     << "\t" << +param.m_rnti << "\t" << +param.m_symStart << "\t"
-                     << +param.m_numSym << "\t" << +param.m_ttiType << "\t" << +param.m_tddMode
-                     << "\t" << +param.m_rv << "\t" << +param.m_ccId << std::endl;
+    WritePhyTransmission(m_ulPhyTraceFile,
+                         m_ulPhyTraceWriter,
+                         m_ulPhyTraceFilename,
+                         UL_PHY_TX_TRACE,
+                         param);
 }
 
 void
 MmWavePhyTrace::ReportDlPhyTransmissionCallback(Ptr<MmWavePhyTrace> phyStats,
                                                 PhyTransmissionTraceParams param)
 {
-    if (!m_dlPhyTraceFile.is_open())
+    // Trace the DL PHY transmission info
+    WritePhyTransmission(m_dlPhyTraceFile,
+                         m_dlPhyTraceWriter,
+                         m_dlPhyTraceFilename,
+                         DL_PHY_TX_TRACE,
+                         param);
+}
+
+void
+MmWavePhyTrace::WriteRxPacketRecord(bool uplink, const RxPacketTraceParams& params)
+{
+    if (!m_rxPacketTraceWriter.IsOpen())
     {
-        m_dlPhyTraceFile.open(m_dlPhyTraceFilename.c_str());
-        if (!m_dlPhyTraceFile.is_open())
-        {
-            NS_FATAL_ERROR("Could not open tracefile");
-        }
-        m_dlPhyTraceFile
-            << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId"
-            << std::endl;
+        m_rxPacketTraceWriter.Open(m_rxPacketTraceFilename + ".bin",
+                                   RX_PACKET_TRACE,
+                                   sizeof(RxPacketTraceRecord),
+                                   m_binaryBlockSize,
+                                   m_compressBinaryOutput);
     }
-
-    // Trace the DL PHY transmission info
-    m_dlPhyTraceFile << +param.m_frameNum << "\t" << +param.m_sfNum << "\t" << +param.m_slotNum
-                     << "\t" << +param.m_rnti << "\t" << +param.m_symStart << "\t"
-                     << +param.m_numSym << "\t" << +param.m_ttiType << "\t" << +param.m_tddMode
-                     << "\t" << +param.m_rv << "\t" << +param.m_ccId << std::endl;
+    RxPacketTraceRecord record = {};
+    record.m_time = Simulator::Now().GetSeconds();
+    record.m_sinrDb = 10 * std::log10(params.m_sinr);
+    record.m_tbler = params.m_tbler;
+    record.m_cellId = params.m_cellId;
+    record.m_frameNum = params.m_frameNum;
+    record.m_tbSize = params.m_tbSize;
+    record.m_rnti = params.m_rnti;
+    record.m_uplink = uplink;
+    record.m_ccId = params.m_ccId;
+    record.m_sfNum = params.m_sfNum;
+    record.m_slotNum = params.m_slotNum;
+    record.m_symStart = params.m_symStart;
+    record.m_numSym = params.m_numSym;
+    record.m_mcs = params.m_mcs;
+    record.m_rv = params.m_rv;
+    record.m_corrupt = params.m_corrupt;
+    m_rxPacketTraceWriter.Write(record);
 }
 
 void
@@ -243,25 +350,34 @@ MmWavePhyTrace::RxPacketTraceUeCallback(Ptr<MmWavePhyTrace> phyStats,
                                         std::string path,
                                         RxPacketTraceParams params)
 {
-    if (!m_rxPacketTraceFile.is_open())
+    if (m_binaryOutput)
+    {
+        WriteRxPacketRecord(false, params);
+    }
+    else
     {
-        m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str());
-        m_rxPacketTraceFile << "DL/"
-                               "UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#"
-                               "\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler"
-                            << std::endl;
         if (!m_rxPacketTraceFile.is_open())
         {
-            NS_FATAL_ERROR("Could not open tracefile");
+            m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str());
+            m_rxPacketTraceFile
+                << "DL/"
+                   "UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#"
+                   "\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler"
+                << std::endl;
+            if (!m_rxPacketTraceFile.is_open())
+            {
+                NS_FATAL_ERROR("Could not open tracefile");
+            }
         }
+        m_rxPacketTraceFile << "DL\t" << Simulator::Now().GetSeconds() << "\t"
+                            << params.m_frameNum << "\t" << +params.m_sfNum << "\t"
+                            << +params.m_slotNum << "\t" << +params.m_symStart << "\t"
+                            << +params.m_numSym << "\t" << params.m_cellId << "\t"
+                            << params.m_rnti << "\t" << +params.m_ccId << "\t" << params.m_tbSize
+                            << "\t" << +params.m_mcs << "\t" << +params.m_rv << "\t"
+                            << 10 * std::log10(params.m_sinr) << "\t" << params.m_corrupt
+                            << "\t" << params.m_tbler << "\n";
     }
-    m_rxPacketTraceFile << "DL\t" << Simulator::Now().GetSeconds() << "\t" << params.m_frameNum
-                        << "\t" << +params.m_sfNum << "\t" << +params.m_slotNum << "\t"
-                        << +params.m_symStart << "\t" << +params.m_numSym << "\t" << params.m_cellId
-                        << "\t" << params.m_rnti << "\t" << +params.m_ccId << "\t"
-                        << params.m_tbSize << "\t" << +params.m_mcs << "\t" << +params.m_rv << "\t"
-                        << 10 * std::log10(params.m_sinr) << "\t" << params.m_corrupt << "\t"
-                        << params.m_tbler << std::endl;
 
     if (params.m_corrupt)
     {
@@ -280,25 +396,34 @@ MmWavePhyTrace::RxPacketTraceEnbCallback(Ptr<MmWavePhyTrace> phyStats,
                                          std::string path,
                                          RxPacketTraceParams params)
 {
-    if (!m_rxPacketTraceFile.is_open())
+    if (m_binaryOutput)
+    {
+        WriteRxPacketRecord(true, params);
+    }
+    else
     {
-        m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str());
-        m_rxPacketTraceFile << "DL/"
-                               "UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#"
-                               "\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler"
-                            << std::endl;
         if (!m_rxPacketTraceFile.is_open())
         {
-            NS_FATAL_ERROR("Could not open tracefile");
+            m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str());
+            m_rxPacketTraceFile
+                << "DL/"
+                   "UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#"
+                   "\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler"
+                << std::endl;
+            if (!m_rxPacketTraceFile.is_open())
+            {
+                NS_FATAL_ERROR("Could not open tracefile");
+            }
         }
+        m_rxPacketTraceFile << "UL\t" << Simulator::Now().GetSeconds() << "\t"
+                            << params.m_frameNum << "\t" << +params.m_sfNum << "\t"
+                            << +params.m_slotNum << "\t" << +params.m_symStart << "\t"
+                            << +params.m_numSym << "\t" << params.m_cellId << "\t"
+                            << params.m_rnti << "\t" << +params.m_ccId << "\t" << params.m_tbSize
+                            << "\t" << +params.m_mcs << "\t" << +params.m_rv << "\t"
+                            << 10 * std::log10(params.m_sinr) << " \t" << params.m_corrupt
+                            << "\t" << params.m_tbler << "\n";
     }
-    m_rxPacketTraceFile << "UL\t" << Simulator::Now().GetSeconds() << "\t" << params.m_frameNum
-                        << "\t" << +params.m_sfNum << "\t" << +params.m_slotNum << "\t"
-                        << +params.m_symStart << "\t" << +params.m_numSym << "\t" << params.m_cellId
-                        << "\t" << params.m_rnti << "\t" << +params.m_ccId << "\t"
-                        << params.m_tbSize << "\t" << +params.m_mcs << "\t" << +params.m_rv << "\t"
-                        << 10 * std::log10(params.m_sinr) << " \t" << params.m_corrupt << "\t"
-                        << params.m_tbler << std::endl;
 
     if (params.m_corrupt)
     {
@@ -33,6 +33,7 @@
 #ifndef SRC_MMWAVE_HELPER_MMWAVE_PHY_TRACE_H_
 #define SRC_MMWAVE_HELPER_MMWAVE_PHY_TRACE_H_
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-trace-writer.h>
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 
@@ -97,7 +98,48 @@ class MmWavePhyTrace : public Object
      */
     void SetDlPhyTxOutputFilename(std::string fileName);
 
+    /**
+     * Selects the fixed width binary output instead of the text one. Binary traces are
+     * written to the configured filenames with a ".bin" suffix by a background thread,
+     * and can be converted back to text with MmWaveTraceReader.
+     * \param binary true to write binary traces
+     */
+    void SetBinaryOutput(bool binary);
+
+    /**
+     * Enables the compression of the blocks of the binary traces
+     * \param compress true to compress the binary traces
+     */
+    void SetCompressBinaryOutput(bool compress);
+
+    /**
+     * Sets the size of the in-memory blocks of the binary traces
+     * \param size the block size in bytes
+     */
+    void SetBinaryBlockSize(uint32_t size);
+
   private:
+    /**
+     * Writes a PHY transmission trace entry
+     * \param file the text output stream
+     * \param writer the binary output
+     * \param fileName the output filename
+     * \param type the type of the binary records
+     * \param param the transmission info
+     */
+    static void WritePhyTransmission(std::ofstream& file,
+                                     MmWaveTraceWriter& writer,
+                                     const std::string& fileName,
+                                     MmWaveTraceRecordType type,
+                                     const PhyTransmissionTraceParams& param);
+
+    /**
+     * Writes a PHY reception trace entry to the binary output
+     * \param uplink true for UL receptions
+     * \param params the reception info
+     */
+    static void WriteRxPacketRecord(bool uplink, const RxPacketTraceParams& params);
+
     // void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
     // void ReportDLTbSize (uint64_t imsi, uint64_t tbSize);
     static std::ofstream m_rxPacketTraceFile;   //!< Output stream for the PHY reception trace
@@ -108,6 +150,14 @@ class MmWavePhyTrace : public Object
 
     static std::ofstream m_dlPhyTraceFile;   //!< Output stream for the DL PHY transmission trace
     static std::string m_dlPhyTraceFilename; //!< Output filename for the DL PHY transmission trace
+
+    static MmWaveTraceWriter m_rxPacketTraceWriter; //!< Binary output for the PHY reception trace
+    static MmWaveTraceWriter m_ulPhyTraceWriter; //!< Binary output for the UL PHY transmission trace
+    static MmWaveTraceWriter m_dlPhyTraceWriter; //!< Binary output for the DL PHY transmission trace
+
+    static bool m_binaryOutput;         //!< Whether the traces are written in binary form
+    static bool m_compressBinaryOutput; //!< Whether the binary traces are compressed
+    static uint32_t m_binaryBlockSize;  //!< Size of the blocks of the binary traces
 };
 
 } // namespace mmwave
@@ -0,0 +1,558 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mmwave-trace-writer.h"
+
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+#include <ns3/log.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MmWaveTraceWriter");
+
+namespace mmwave
+{
+
+namespace
+{
+
+/**
+ * Description of a field of a binary trace record, used to export records
+ */
+struct TraceField
+{
+    /// How the field is rendered
+    enum Kind
+    {
+        UNSIGNED,  //!< unsigned integer of the given size
+        REAL,      //!< double
+        DIRECTION, //!< uint8_t rendered as DL/UL
+    };
+
+    const char* m_header; //!< column header in the text export
+    const char* m_column; //!< column name in the columnar export
+    std::size_t m_offset; //!< offset of the field in the record
+    std::size_t m_size;   //!< size of the field in bytes
+    Kind m_kind;          //!< how the field is rendered
+};
+
+#define MMWAVE_TRACE_FIELD(header, column, type, member, kind)                                     \
+    {                                                                                              \
+        header, column, offsetof(type, member), sizeof(type::member), TraceField::kind             \
+    }
+
+/// Fields of RxPacketTraceRecord, in the order of the text trace
+const TraceField g_rxPacketFields[] = {
+    MMWAVE_TRACE_FIELD("DL/UL", "direction", RxPacketTraceRecord, m_uplink, DIRECTION),
+    MMWAVE_TRACE_FIELD("time", "time", RxPacketTraceRecord, m_time, REAL),
+    MMWAVE_TRACE_FIELD("frame", "frame", RxPacketTraceRecord, m_frameNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("subF", "subF", RxPacketTraceRecord, m_sfNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("slot", "slot", RxPacketTraceRecord, m_slotNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("1stSym", "firstSym", RxPacketTraceRecord, m_symStart, UNSIGNED),
+    MMWAVE_TRACE_FIELD("symbol#", "numSym", RxPacketTraceRecord, m_numSym, UNSIGNED),
+    MMWAVE_TRACE_FIELD("cellId", "cellId", RxPacketTraceRecord, m_cellId, UNSIGNED),
+    MMWAVE_TRACE_FIELD("rnti", "rnti", RxPacketTraceRecord, m_rnti, UNSIGNED),
+    MMWAVE_TRACE_FIELD("ccId", "ccId", RxPacketTraceRecord, m_ccId, UNSIGNED),
+    MMWAVE_TRACE_FIELD("tbSize", "tbSize", RxPacketTraceRecord, m_tbSize, UNSIGNED),
+    MMWAVE_TRACE_FIELD("mcs", "mcs", RxPacketTraceRecord, m_mcs, UNSIGNED),
+    MMWAVE_TRACE_FIELD("rv", "rv", RxPacketTraceRecord, m_rv, UNSIGNED),
+    MMWAVE_TRACE_FIELD("SINR(dB)", "sinrDb", RxPacketTraceRecord, m_sinrDb, REAL),
+    MMWAVE_TRACE_FIELD("corrupt", "corrupt", RxPacketTraceRecord, m_corrupt, UNSIGNED),
+    MMWAVE_TRACE_FIELD("TBler", "tbler", RxPacketTraceRecord, m_tbler, REAL),
+};
+
+/// Fields of PhyTxTraceRecord, in the order of the text trace
+const TraceField g_phyTxFields[] = {
+    MMWAVE_TRACE_FIELD("frame", "frame", PhyTxTraceRecord, m_frameNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("subF", "subF", PhyTxTraceRecord, m_sfNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("slot", "slot", PhyTxTraceRecord, m_slotNum, UNSIGNED),
+    MMWAVE_TRACE_FIELD("rnti", "rnti", PhyTxTraceRecord, m_rnti, UNSIGNED),
+    MMWAVE_TRACE_FIELD("firstSym", "firstSym", PhyTxTraceRecord, m_symStart, UNSIGNED),
+    MMWAVE_TRACE_FIELD("numSym", "numSym", PhyTxTraceRecord, m_numSym, UNSIGNED),
+    MMWAVE_TRACE_FIELD("type", "type", PhyTxTraceRecord, m_ttiType, UNSIGNED),
+    MMWAVE_TRACE_FIELD("tddMode", "tddMode", PhyTxTraceRecord, m_tddMode, UNSIGNED),
+    MMWAVE_TRACE_FIELD("retxNum", "retxNum", PhyTxTraceRecord, m_rv, UNSIGNED),
+    MMWAVE_TRACE_FIELD("ccId", "ccId", PhyTxTraceRecord, m_ccId, UNSIGNED),
+};
+
+#undef MMWAVE_TRACE_FIELD
+
+/**
+ * Returns the fields of a record type
+ *
+ * \param type the record type
+ * \param count filled with the number of fields
+ * \return the fields
+ */
+const TraceField*
+GetTraceFields(MmWaveTraceRecordType type, std::size_t& count)
+{
+    switch (type)
+    {
+    case RX_PACKET_TRACE:
+        count = sizeof(g_rxPacketFields) / sizeof(g_rxPacketFields[0]);
+        return g_rxPacketFields;
+    case UL_PHY_TX_TRACE:
+    case DL_PHY_TX_TRACE:
+    case SCHED_ALLOC_TRACE:
+        count = sizeof(g_phyTxFields) / sizeof(g_phyTxFields[0]);
+        return g_phyTxFields;
+    }
+    NS_FATAL_ERROR("Unknown trace record type " << type);
+    return nullptr;
+}
+
+/**
+ * Reads an unsigned integer field
+ *
+ * \param record the record
+ * \param field the field
+ * \return the value of the field
+ */
+uint64_t
+ReadUnsigned(const char* record, const TraceField& field)
+{
+    switch (field.m_size)
+    {
+    case 1:
+        return *reinterpret_cast<const uint8_t*>(record + field.m_offset);
+    case 2: {
+        uint16_t v;
+        std::memcpy(&v, record + field.m_offset, sizeof(v));
+        return v;
+    }
+    case 4: {
+        uint32_t v;
+        std::memcpy(&v, record + field.m_offset, sizeof(v));
+        return v;
+    }
+    default: {
+        uint64_t v;
+        std::memcpy(&v, record + field.m_offset, sizeof(v));
+        return v;
+    }
+    }
+}
+
+} // unnamed namespace
+
+constexpr char MmWaveTraceWriter::MAGIC[8];
+
+MmWaveTraceWriter::MmWaveTraceWriter()
+    : m_blockSize(0),
+      m_compress(false),
+      m_stop(false),
+      m_failed(false)
+{
+}
+
+MmWaveTraceWriter::~MmWaveTraceWriter()
+{
+    Close();
+}
+
+bool
+MmWaveTraceWriter::IsCompressionSupported()
+{
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t
+MmWaveTraceWriter::GetRecordSize(MmWaveTraceRecordType recordType)
+{
+    switch (recordType)
+    {
+    case RX_PACKET_TRACE:
+        return sizeof(RxPacketTraceRecord);
+    case UL_PHY_TX_TRACE:
+    case DL_PHY_TX_TRACE:
+    case SCHED_ALLOC_TRACE:
+        return sizeof(PhyTxTraceRecord);
+    }
+    return 0;
+}
+
+void
+MmWaveTraceWriter::Open(std::string fileName,
+                        MmWaveTraceRecordType recordType,
+                        uint32_t recordSize,
+                        uint32_t blockSize,
+                        bool compress)
+{
+    NS_LOG_FUNCTION(this << fileName << recordType << recordSize << blockSize << compress);
+    NS_ASSERT_MSG(!IsOpen(), "Trace file already open");
+
+    m_file.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        NS_FATAL_ERROR("Could not open tracefile " << fileName);
+    }
+    if (compress && !IsCompressionSupported())
+    {
+        NS_LOG_WARN("Compression of binary traces is not supported by this build");
+        compress = false;
+    }
+
+    FileHeader header;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.m_magic);
+    header.m_recordType = recordType;
+    header.m_recordSize = recordSize;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!m_file)
+    {
+        NS_FATAL_ERROR("Could not write tracefile " << fileName);
+    }
+
+    m_fileName = fileName;
+    m_blockSize = std::max(blockSize, recordSize);
+    m_compress = compress;
+    m_stop = false;
+    m_failed = false;
+    m_active.reserve(m_blockSize);
+    m_thread = std::thread(&MmWaveTraceWriter::Run, this);
+}
+
+bool
+MmWaveTraceWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+void
+MmWaveTraceWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    SubmitActiveBlock();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    m_file.close();
+    m_free.clear();
+    m_compressed.clear();
+    CheckWriteError();
+}
+
+void
+MmWaveTraceWriter::CheckWriteError()
+{
+    if (m_failed)
+    {
+        NS_FATAL_ERROR("Could not write binary trace " << m_fileName
+                                                       << ", the trace is incomplete");
+    }
+}
+
+void
+MmWaveTraceWriter::SubmitActiveBlock()
+{
+    if (m_active.empty())
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // bound the memory used by the traces if the disk cannot keep up
+    m_cv.wait(lock, [this] { return m_pending.size() < MAX_PENDING_BLOCKS; });
+    if (m_failed)
+    {
+        lock.unlock();
+        CheckWriteError();
+    }
+    m_pending.push_back(std::move(m_active));
+    if (!m_free.empty())
+    {
+        m_active = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    else
+    {
+        m_active = std::vector<char>();
+        m_active.reserve(m_blockSize);
+    }
+    m_active.clear();
+    lock.unlock();
+    m_cv.notify_all();
+}
+
+void
+MmWaveTraceWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty())
+        {
+            break;
+        }
+        std::vector<char> block = std::move(m_pending.front());
+        m_pending.pop_front();
+        lock.unlock();
+        m_cv.notify_all();
+
+        // once a block is lost the following ones are dropped, the simulation thread
+        // reports the error at its next block or when the file is closed
+        bool written = !m_failed && WriteBlock(block);
+        block.clear();
+
+        lock.lock();
+        m_failed = m_failed || !written;
+        m_free.push_back(std::move(block));
+    }
+    m_file.flush();
+    if (!m_file)
+    {
+        NS_LOG_ERROR("Could not flush binary trace " << m_fileName);
+        m_failed = true;
+    }
+}
+
+bool
+MmWaveTraceWriter::WriteBlock(const std::vector<char>& block)
+{
+    BlockHeader header;
+    header.m_rawSize = block.size();
+    header.m_storedSize = block.size();
+    const char* payload = block.data();
+
+#ifdef HAVE_ZLIB
+    if (m_compress)
+    {
+        uLongf compressedSize = compressBound(block.size());
+        m_compressed.resize(compressedSize);
+        if (compress2(reinterpret_cast<Bytef*>(m_compressed.data()),
+                      &compressedSize,
+                      reinterpret_cast<const Bytef*>(block.data()),
+                      block.size(),
+                      Z_BEST_SPEED) == Z_OK &&
+            compressedSize < block.size())
+        {
+            header.m_storedSize = compressedSize;
+            payload = m_compressed.data();
+        }
+    }
+#endif
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.write(payload, header.m_storedSize);
+    if (!m_file)
+    {
+        NS_LOG_ERROR("Could not write a block of " << header.m_storedSize
+                                                   << " bytes to binary trace " << m_fileName);
+        return false;
+    }
+    return true;
+}
+
+MmWaveTraceReader::MmWaveTraceReader()
+    : m_offset(0),
+      m_recordType(RX_PACKET_TRACE),
+      m_recordSize(0)
+{
+}
+
+bool
+MmWaveTraceReader::Open(std::string fileName)
+{
+    m_file.open(fileName.c_str(), std::ios::binary);
+    MmWaveTraceWriter::FileHeader header;
+    if (!m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !std::equal(header.m_magic,
+                    header.m_magic + MmWaveTraceWriter::MAGIC_PREFIX_SIZE,
+                    MmWaveTraceWriter::MAGIC))
+    {
+        NS_LOG_ERROR(fileName << " is not a binary mmWave trace");
+        m_file.close();
+        return false;
+    }
+    if (!std::equal(header.m_magic + MmWaveTraceWriter::MAGIC_PREFIX_SIZE,
+                    header.m_magic + sizeof(header.m_magic),
+                    MmWaveTraceWriter::MAGIC + MmWaveTraceWriter::MAGIC_PREFIX_SIZE))
+    {
+        NS_LOG_ERROR(fileName << " has an unsupported version");
+        m_file.close();
+        return false;
+    }
+    auto recordType = static_cast<MmWaveTraceRecordType>(header.m_recordType);
+    uint32_t recordSize = MmWaveTraceWriter::GetRecordSize(recordType);
+    if (recordSize == 0 || header.m_recordSize != recordSize)
+    {
+        NS_LOG_ERROR(fileName << " has records of type " << header.m_recordType << " and size "
+                              << header.m_recordSize << ", which are not supported");
+        m_file.close();
+        return false;
+    }
+    m_recordType = recordType;
+    m_recordSize = recordSize;
+    m_block.clear();
+    m_offset = 0;
+    return true;
+}
+
+MmWaveTraceRecordType
+MmWaveTraceReader::GetRecordType() const
+{
+    return m_recordType;
+}
+
+uint32_t
+MmWaveTraceReader::GetRecordSize() const
+{
+    return m_recordSize;
+}
+
+bool
+MmWaveTraceReader::ReadBlock()
+{
+    MmWaveTraceWriter::BlockHeader header;
+    if (!m_file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return false;
+    }
+    m_block.resize(header.m_rawSize);
+    m_offset = 0;
+    if (header.m_storedSize == header.m_rawSize)
+    {
+        return static_cast<bool>(m_file.read(m_block.data(), header.m_rawSize));
+    }
+#ifdef HAVE_ZLIB
+    std::vector<char> compressed(header.m_storedSize);
+    if (!m_file.read(compressed.data(), header.m_storedSize))
+    {
+        return false;
+    }
+    uLongf rawSize = header.m_rawSize;
+    if (uncompress(reinterpret_cast<Bytef*>(m_block.data()),
+                   &rawSize,
+                   reinterpret_cast<const Bytef*>(compressed.data()),
+                   compressed.size()) != Z_OK ||
+        rawSize != header.m_rawSize)
+    {
+        NS_FATAL_ERROR("Corrupted block in binary trace");
+    }
+    return true;
+#else
+    NS_FATAL_ERROR("Compressed binary traces cannot be read by this build");
+    return false;
+#endif
+}
+
+bool
+MmWaveTraceReader::Read(void* record)
+{
+    while (m_offset + m_recordSize > m_block.size())
+    {
+        if (!ReadBlock())
+        {
+            return false;
+        }
+    }
+    std::memcpy(record, m_block.data() + m_offset, m_recordSize);
+    m_offset += m_recordSize;
+    return true;
+}
+
+void
+MmWaveTraceReader::ExportCsv(std::ostream& os)
+{
+    std::size_t count;
+    const TraceField* fields = GetTraceFields(m_recordType, count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        os << (i ? "\t" : "") << fields[i].m_header;
+    }
+    os << "\n";
+
+    std::vector<char> record(m_recordSize);
+    while (Read(record.data()))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const TraceField& field = fields[i];
+            if (i)
+            {
+                os << "\t";
+            }
+            switch (field.m_kind)
+            {
+            case TraceField::UNSIGNED:
+                os << ReadUnsigned(record.data(), field);
+                break;
+            case TraceField::REAL: {
+                double v;
+                std::memcpy(&v, record.data() + field.m_offset, sizeof(v));
+                os << v;
+                break;
+            }
+            case TraceField::DIRECTION:
+                os << (ReadUnsigned(record.data(), field) ? "UL" : "DL");
+                break;
+            }
+        }
+        os << "\n";
+    }
+}
+
+void
+MmWaveTraceReader::ExportColumns(std::string prefix)
+{
+    std::size_t count;
+    const TraceField* fields = GetTraceFields(m_recordType, count);
+    std::vector<std::unique_ptr<std::ofstream>> columns;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string name = prefix + "." + fields[i].m_column;
+        columns.emplace_back(new std::ofstream(name.c_str(), std::ios::binary | std::ios::trunc));
+        if (!columns.back()->is_open())
+        {
+            NS_FATAL_ERROR("Could not open column file " << name);
+        }
+    }
+
+    std::vector<char> record(m_recordSize);
+    while (Read(record.data()))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            columns[i]->write(record.data() + fields[i].m_offset, fields[i].m_size);
+        }
+    }
+}
+
+} // namespace mmwave
+
+} // namespace ns3
@@ -0,0 +1,298 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SRC_MMWAVE_HELPER_MMWAVE_TRACE_WRITER_H_
+#define SRC_MMWAVE_HELPER_MMWAVE_TRACE_WRITER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+namespace mmwave
+{
+
+/**
+ * Types of the records stored in a binary mmWave trace file
+ */
+enum MmWaveTraceRecordType : uint32_t
+{
+    RX_PACKET_TRACE = 1,      //!< RxPacketTraceRecord, see MmWavePhyTrace
+    UL_PHY_TX_TRACE = 2,      //!< PhyTxTraceRecord, see MmWavePhyTrace
+    DL_PHY_TX_TRACE = 3,      //!< PhyTxTraceRecord, see MmWavePhyTrace
+    SCHED_ALLOC_TRACE = 4,    //!< PhyTxTraceRecord, see MmWaveMacTrace
+};
+
+/**
+ * Fixed width record of the PHY reception trace
+ */
+struct RxPacketTraceRecord
+{
+    double m_time;       //!< simulation time in seconds
+    double m_sinrDb;     //!< the average SINR in dB
+    double m_tbler;      //!< the transport block error rate
+    uint64_t m_cellId;   //!< the cell ID
+    uint32_t m_frameNum; //!< frame index
+    uint32_t m_tbSize;   //!< transport block size
+    uint16_t m_rnti;     //!< the RNTI
+    uint8_t m_uplink;    //!< 1 for UL receptions, 0 for DL receptions
+    uint8_t m_ccId;      //!< the component carrier ID
+    uint8_t m_sfNum;     //!< subframe index
+    uint8_t m_slotNum;   //!< slot index
+    uint8_t m_symStart;  //!< index of the first OFDM symbol
+    uint8_t m_numSym;    //!< number of OFDM symbols
+    uint8_t m_mcs;       //!< the MCS
+    uint8_t m_rv;        //!< the number of retransmissions
+    uint8_t m_corrupt;   //!< 1 if the TB has failed
+    uint8_t m_reserved[5]; //!< padding, always 0
+};
+
+/**
+ * Fixed width record of the PHY transmission and scheduling allocation traces
+ */
+struct PhyTxTraceRecord
+{
+    uint32_t m_frameNum; //!< frame index
+    uint16_t m_rnti;     //!< the RNTI
+    uint8_t m_sfNum;     //!< subframe index
+    uint8_t m_slotNum;   //!< slot index
+    uint8_t m_symStart;  //!< index of the first OFDM symbol
+    uint8_t m_numSym;    //!< number of OFDM symbols
+    uint8_t m_ttiType;   //!< TTI type
+    uint8_t m_tddMode;   //!< TDD mode
+    uint8_t m_rv;        //!< the number of retransmissions
+    uint8_t m_ccId;      //!< the component carrier ID
+    uint8_t m_reserved[2]; //!< padding, always 0
+};
+
+static_assert(sizeof(RxPacketTraceRecord) == 56, "unexpected RxPacketTraceRecord layout");
+static_assert(sizeof(PhyTxTraceRecord) == 16, "unexpected PhyTxTraceRecord layout");
+
+/**
+ * Writes fixed width records to a binary trace file.
+ *
+ * Records are appended to an in-memory block owned by the simulation thread. Full blocks
+ * are handed over to a background thread which (optionally) compresses them and writes them
+ * to disk, so that the simulation never waits for the file system unless the writer falls
+ * behind by more than MAX_PENDING_BLOCKS blocks.
+ *
+ * The file starts with a FileHeader followed by a sequence of blocks, each one made of a
+ * BlockHeader and of its payload. A block is compressed with zlib when the module is built
+ * with zlib support and its compressed size is smaller than its raw size. Files can be read
+ * back with MmWaveTraceReader.
+ */
+class MmWaveTraceWriter
+{
+  public:
+    /// Magic identifying binary mmWave trace files, the last two characters are the version
+    static constexpr char MAGIC[8] = {'M', 'M', 'W', 'T', 'R', 'C', '0', '1'};
+    /// Number of characters of MAGIC which precede the version
+    static const std::size_t MAGIC_PREFIX_SIZE = 6;
+    /// Maximum number of full blocks waiting to be written
+    static const std::size_t MAX_PENDING_BLOCKS = 4;
+
+    /**
+     * Header of a binary trace file
+     */
+    struct FileHeader
+    {
+        char m_magic[8];       //!< always MAGIC
+        uint32_t m_recordType; //!< an MmWaveTraceRecordType
+        uint32_t m_recordSize; //!< size of a record in bytes
+    };
+
+    /**
+     * Header of a block of records
+     */
+    struct BlockHeader
+    {
+        uint32_t m_rawSize;    //!< size of the records in the block
+        uint32_t m_storedSize; //!< size of the payload, m_rawSize if not compressed
+    };
+
+    MmWaveTraceWriter();
+    ~MmWaveTraceWriter();
+
+    /**
+     * Opens the output file and starts the background writer
+     *
+     * \param fileName the output file
+     * \param recordType the type of the records
+     * \param recordSize the size of a record in bytes
+     * \param blockSize the size of the in-memory blocks in bytes
+     * \param compress whether blocks are compressed, if supported
+     */
+    void Open(std::string fileName,
+              MmWaveTraceRecordType recordType,
+              uint32_t recordSize,
+              uint32_t blockSize,
+              bool compress);
+
+    /**
+     * \return true if the file is open
+     */
+    bool IsOpen() const;
+
+    /**
+     * Writes the pending records and closes the file
+     */
+    void Close();
+
+    /**
+     * Appends a record
+     *
+     * \param record the record, of the size given to Open
+     */
+    template <class T>
+    void Write(const T& record)
+    {
+        if (m_active.size() + sizeof(T) > m_blockSize)
+        {
+            SubmitActiveBlock();
+        }
+        const char* data = reinterpret_cast<const char*>(&record);
+        m_active.insert(m_active.end(), data, data + sizeof(T));
+    }
+
+    /**
+     * \return whether compression is available in this build
+     */
+    static bool IsCompressionSupported();
+
+    /**
+     * \param recordType a record type
+     * \return the size of the records of the given type, 0 if the type is unknown
+     */
+    static uint32_t GetRecordSize(MmWaveTraceRecordType recordType);
+
+  private:
+    /**
+     * Hands the active block over to the background thread
+     */
+    void SubmitActiveBlock();
+
+    /**
+     * Body of the background thread
+     */
+    void Run();
+
+    /**
+     * Writes a block to the file, compressing it if requested
+     *
+     * \param block the records to write
+     * \return false if the block could not be written
+     */
+    bool WriteBlock(const std::vector<char>& block);
+
+    /**
+     * Aborts the simulation if the background writer failed to write a block
+     */
+    void CheckWriteError();
+
+    std::ofstream m_file;                    //!< the output file
+    std::string m_fileName;                  //!< name of the output file
+    std::vector<char> m_active;              //!< block being filled by the simulation
+    std::deque<std::vector<char>> m_pending; //!< full blocks waiting to be written
+    std::vector<std::vector<char>> m_free;   //!< written blocks, kept for reuse
+    std::vector<char> m_compressed;          //!< compression scratch buffer
+    std::mutex m_mutex;                      //!< protects m_pending, m_free, m_stop, m_failed
+    std::condition_variable m_cv;            //!< signals changes of m_pending and m_free
+    std::thread m_thread;                    //!< the background writer
+    uint32_t m_blockSize;                    //!< size of the blocks
+    bool m_compress;                         //!< whether blocks are compressed
+    bool m_stop;                             //!< asks the background writer to terminate
+    bool m_failed;                           //!< set when a block could not be written
+};
+
+/**
+ * Reads binary trace files written by MmWaveTraceWriter and exports them to text
+ */
+class MmWaveTraceReader
+{
+  public:
+    MmWaveTraceReader();
+
+    /**
+     * Opens a binary trace file
+     *
+     * \param fileName the file
+     * \return false if the file cannot be opened, is not a binary trace, has an unsupported
+     *         version or its records do not match the size expected for their type
+     */
+    bool Open(std::string fileName);
+
+    /**
+     * \return the type of the records
+     */
+    MmWaveTraceRecordType GetRecordType() const;
+
+    /**
+     * \return the size of a record
+     */
+    uint32_t GetRecordSize() const;
+
+    /**
+     * Reads the next record
+     *
+     * \param record buffer of GetRecordSize () bytes
+     * \return false at the end of the file
+     */
+    bool Read(void* record);
+
+    /**
+     * Writes all the remaining records as tab separated values, with the same columns as
+     * the text traces
+     *
+     * \param os the output stream
+     */
+    void ExportCsv(std::ostream& os);
+
+    /**
+     * Writes all the remaining records in a columnar layout: one file per column named
+     * prefix.<column>, each one holding the values of the column as a contiguous array
+     * of native integers or doubles
+     *
+     * \param prefix the prefix of the output files
+     */
+    void ExportColumns(std::string prefix);
+
+  private:
+    /**
+     * Loads the next block of the file
+     *
+     * \return false at the end of the file
+     */
+    bool ReadBlock();
+
+    std::ifstream m_file;        //!< the input file
+    std::vector<char> m_block;   //!< the current block
+    std::size_t m_offset;        //!< offset of the next record in m_block
+    MmWaveTraceRecordType m_recordType; //!< type of the records
+    uint32_t m_recordSize;       //!< size of the records
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_HELPER_MMWAVE_TRACE_WRITER_H_ */
@@ -36,6 +36,7 @@
 #include <ns3/log.h>
 #include <ns3/lte-common.h>
 
+#include <algorithm>
 #include <cmath>
 #include <stdlib.h> /* abs */
 
@@ -194,9 +195,12 @@ const unsigned MmWaveFlexTtiMacScheduler::m_rlcHdrSize = 3;
 
 const double MmWaveFlexTtiMacScheduler::m_berDl = 0.001;
 
+const uint16_t MmWaveFlexTtiMacScheduler::NO_SLOT;
+
 MmWaveFlexTtiMacScheduler::MmWaveFlexTtiMacScheduler()
     : m_nextRnti(0),
       m_tbUid(0),
+      m_numRb(0),
       m_macSchedSapUser(0),
       m_macCschedSapUser(0)
 {
@@ -214,15 +218,30 @@ void
 MmWaveFlexTtiMacScheduler::DoDispose(void)
 {
     NS_LOG_FUNCTION(this);
-    m_wbCqiRxed.clear();
-    m_dlHarqProcessesDciInfoMap.clear();
-    m_dlHarqProcessesTimer.clear();
-    m_dlHarqProcessesRlcPduMap.clear();
+    m_ueSlot.clear();
+    m_ueRnti.clear();
+    m_ueFlags.clear();
+    m_freeSlots.clear();
+    m_activeRntis.clear();
+    m_wbCqi.clear();
+    m_wbCqiTimer.clear();
+    m_ulCqi.clear();
+    m_ulCqiTimer.clear();
+    m_bsr.clear();
+    m_rlcLcCount.clear();
+    m_dlHarqStatus.clear();
+    m_dlHarqTimer.clear();
+    m_dlHarqDci.clear();
+    m_dlHarqRlcPdu.clear();
+    m_ulHarqStatus.clear();
+    m_ulHarqTimer.clear();
+    m_ulHarqDci.clear();
+    m_rlcBufferReq.clear();
+    m_ulAllocations.clear();
+    m_ueSchedInfo.clear();
     m_dlHarqInfoList.clear();
-    m_ulHarqCurrentProcessId.clear();
-    m_ulHarqProcessesStatus.clear();
-    m_ulHarqProcessesTimer.clear();
-    m_ulHarqProcessesDciInfoMap.clear();
+    m_ulHarqInfoList.clear();
+    m_ulSinr = nullptr;
     delete m_macCschedSapProvider;
     delete m_macSchedSapProvider;
 }
@@ -321,6 +340,92 @@ MmWaveFlexTtiMacScheduler::ConfigureCommonParameters(Ptr<MmWavePhyMacCommon> con
     m_harqTimeout = m_phyMacConfig->GetHarqTimeout();
     m_numDataSymbols = m_phyMacConfig->GetSymbPerSlot() - m_phyMacConfig->GetDlCtrlSymbols() -
                        m_phyMacConfig->GetUlCtrlSymbols();
+    m_numRb = m_phyMacConfig->GetNumRb();
+    m_ulSinr = Create<SpectrumValue>(MmWaveSpectrumValueHelper::GetSpectrumModel(m_phyMacConfig));
+    NS_ASSERT(m_ulSinr->GetSpectrumModel()->GetNumBands() >= m_numRb);
+}
+
+uint16_t
+MmWaveFlexTtiMacScheduler::AddUeSlot(uint16_t rnti)
+{
+    uint16_t slot = GetUeSlot(rnti);
+    if (slot != NO_SLOT)
+    {
+        return slot;
+    }
+
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        NS_ABORT_MSG_IF(m_ueRnti.size() >= NO_SLOT, "Too many UEs in the scheduler");
+        slot = m_ueRnti.size();
+        m_ueRnti.push_back(0);
+        m_ueFlags.push_back(0);
+        m_wbCqi.push_back(0);
+        m_wbCqiTimer.push_back(0);
+        m_ulCqi.resize(m_ulCqi.size() + m_numRb);
+        m_ulCqiTimer.push_back(0);
+        m_bsr.push_back(0);
+        m_rlcLcCount.push_back(0);
+        m_dlHarqStatus.resize(m_dlHarqStatus.size() + m_numHarqProcess);
+        m_dlHarqTimer.resize(m_dlHarqTimer.size() + m_numHarqProcess);
+        m_dlHarqDci.resize(m_dlHarqDci.size() + m_numHarqProcess);
+        m_dlHarqRlcPdu.resize(m_dlHarqRlcPdu.size() + m_numHarqProcess);
+        m_ulHarqStatus.resize(m_ulHarqStatus.size() + m_numHarqProcess);
+        m_ulHarqTimer.resize(m_ulHarqTimer.size() + m_numHarqProcess);
+        m_ulHarqDci.resize(m_ulHarqDci.size() + m_numHarqProcess);
+        m_ueSchedInfo.push_back(UeSchedInfo());
+    }
+
+    if (rnti >= m_ueSlot.size())
+    {
+        m_ueSlot.resize(rnti + 1, NO_SLOT);
+    }
+    m_ueSlot[rnti] = slot;
+    m_ueRnti[slot] = rnti;
+    m_ueFlags[slot] = 0;
+    m_ueSchedInfo[slot].Reset();
+    m_activeRntis.insert(std::lower_bound(m_activeRntis.begin(), m_activeRntis.end(), rnti),
+                         rnti);
+    return slot;
+}
+
+void
+MmWaveFlexTtiMacScheduler::ClearUeState(uint16_t slot, uint8_t flags)
+{
+    m_ueFlags[slot] &= ~flags;
+    if (m_ueFlags[slot] == 0)
+    {
+        uint16_t rnti = m_ueRnti[slot];
+        m_ueSlot[rnti] = NO_SLOT;
+        m_freeSlots.push_back(slot);
+        m_activeRntis.erase(
+            std::lower_bound(m_activeRntis.begin(), m_activeRntis.end(), rnti));
+    }
+}
+
+void
+MmWaveFlexTtiMacScheduler::ReleaseIdleUeSlots()
+{
+    std::vector<uint16_t>::iterator it = m_activeRntis.begin();
+    for (uint16_t rnti : m_activeRntis)
+    {
+        uint16_t slot = m_ueSlot[rnti];
+        if (m_ueFlags[slot] == 0)
+        {
+            m_ueSlot[rnti] = NO_SLOT;
+            m_freeSlots.push_back(slot);
+        }
+        else
+        {
+            *it++ = rnti;
+        }
+    }
+    m_activeRntis.erase(it, m_activeRntis.end());
 }
 
 void
@@ -329,25 +434,26 @@ MmWaveFlexTtiMacScheduler::DoSchedDlRlcBufferReq(
 {
     NS_LOG_FUNCTION(this << params.m_rnti << (uint32_t)params.m_logicalChannelIdentity);
     // API generated by RLC for updating RLC parameters on a LC (tx and retx queues)
-    std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it =
-        m_rlcBufferReq.begin();
     bool newLc = true;
-    while (it != m_rlcBufferReq.end())
+    for (std::size_t i = 0; i < m_rlcBufferReq.size(); i++)
     {
-        // remove old entries of this UE-LC
-        if (((*it).m_rnti == params.m_rnti) &&
-            ((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity))
+        // remove the old entry of this UE-LC
+        if (m_rlcBufferReq[i].m_rnti == params.m_rnti &&
+            m_rlcBufferReq[i].m_lcid == params.m_logicalChannelIdentity)
         {
-            it = m_rlcBufferReq.erase(it);
+            m_rlcBufferReq.erase(m_rlcBufferReq.begin() + i);
             newLc = false;
-        }
-        else
-        {
-            ++it;
+            break;
         }
     }
     // add the new parameters
-    m_rlcBufferReq.insert(it, params);
+    RlcBufferElem elem;
+    elem.m_rnti = params.m_rnti;
+    elem.m_lcid = params.m_logicalChannelIdentity;
+    elem.m_statusPduSize = params.m_rlcStatusPduSize;
+    elem.m_txQueueSize = params.m_rlcTransmissionQueueSize;
+    elem.m_retxQueueSize = params.m_rlcRetransmissionQueueSize;
+    m_rlcBufferReq.push_back(elem);
     NS_LOG_INFO("BSR for RNTI " << params.m_rnti << " LC "
                                 << (uint16_t)params.m_logicalChannelIdentity << " RLC tx size "
                                 << params.m_rlcTransmissionQueueSize << " RLC retx size "
@@ -356,10 +462,17 @@ MmWaveFlexTtiMacScheduler::DoSchedDlRlcBufferReq(
     // initialize statistics of the flow in case of new flows
     if (newLc == true)
     {
-        m_wbCqiRxed.insert(
-            std::pair<uint16_t, uint8_t>(params.m_rnti, 1)); // only codeword 0 at this stage (SISO)
-        // initialized to 1 (i.e., the lowest value for transmitting a signal)
-        m_wbCqiTimers.insert(std::pair<uint16_t, uint32_t>(params.m_rnti, m_cqiTimersThreshold));
+        uint16_t slot = AddUeSlot(params.m_rnti);
+        m_rlcLcCount[slot]++;
+        m_ueFlags[slot] |= UE_RLC;
+        if (!(m_ueFlags[slot] & UE_DL_CQI))
+        {
+            // only codeword 0 at this stage (SISO)
+            // initialized to 1 (i.e., the lowest value for transmitting a signal)
+            m_wbCqi[slot] = 1;
+            m_wbCqiTimer[slot] = m_cqiTimersThreshold;
+            m_ueFlags[slot] |= UE_DL_CQI;
+        }
     }
 }
 
@@ -369,33 +482,15 @@ MmWaveFlexTtiMacScheduler::DoSchedDlCqiInfoReq(
 {
     NS_LOG_FUNCTION(this);
 
-    std::map<uint16_t, uint8_t>::iterator it;
     for (unsigned int i = 0; i < params.m_cqiList.size(); i++)
     {
         if (params.m_cqiList.at(i).m_cqiType == DlCqiInfo::WB)
         {
-            // wideband CQI reporting
-            std::map<uint16_t, uint8_t>::iterator it;
-            uint16_t rnti = params.m_cqiList.at(i).m_rnti;
-            it = m_wbCqiRxed.find(rnti);
-            if (it == m_wbCqiRxed.end())
-            {
-                // create the new entry
-                m_wbCqiRxed.insert(std::pair<uint16_t, uint8_t>(
-                    rnti,
-                    params.m_cqiList.at(i).m_wbCqi)); // only codeword 0 at this stage (SISO)
-                // generate correspondent timer
-                m_wbCqiTimers.insert(std::pair<uint16_t, uint32_t>(rnti, m_cqiTimersThreshold));
-            }
-            else
-            {
-                // update the CQI value
-                (*it).second = params.m_cqiList.at(i).m_wbCqi;
-                // update correspondent timer
-                std::map<uint16_t, uint32_t>::iterator itTimers;
-                itTimers = m_wbCqiTimers.find(rnti);
-                (*itTimers).second = m_cqiTimersThreshold;
-            }
+            // wideband CQI reporting: create or update the entry and its timer
+            uint16_t slot = AddUeSlot(params.m_cqiList.at(i).m_rnti);
+            m_wbCqi[slot] = params.m_cqiList.at(i).m_wbCqi; // only codeword 0 at this stage (SISO)
+            m_wbCqiTimer[slot] = m_cqiTimersThreshold;
+            m_ueFlags[slot] |= UE_DL_CQI;
         }
         else if (params.m_cqiList.at(i).m_cqiType == DlCqiInfo::SB)
         {
@@ -423,71 +518,61 @@ MmWaveFlexTtiMacScheduler::DoSchedUlCqiInfoReq(
     switch (params.m_ulCqi.m_type)
     {
     case UlCqiInfo::PUSCH: {
-        std::map<uint32_t, struct AllocMapElem>::iterator itMap;
-        std::map<uint16_t, struct UlCqiMapElem>::iterator itCqi;
-        itMap = m_ulAllocationMap.find(params.m_sfnSf.Encode());
-        if (itMap == m_ulAllocationMap.end())
+        uint64_t sfn = params.m_sfnSf.Encode();
+        std::vector<UlAllocElem>::iterator itAlloc = m_ulAllocations.begin();
+        while (itAlloc != m_ulAllocations.end() && itAlloc->m_sfn != sfn)
+        {
+            ++itAlloc;
+        }
+        if (itAlloc == m_ulAllocations.end())
         {
             NS_LOG_INFO(this << " Does not find info on allocation, size : "
-                             << m_ulAllocationMap.size());
+                             << m_ulAllocations.size());
             return;
         }
-        NS_ASSERT_MSG(itMap->second.m_rntiPerChunk.size() == m_phyMacConfig->GetNumRb(),
+        NS_ASSERT_MSG(params.m_ulCqi.m_sinr.size() >= m_numRb,
                       "SINR chunk map must cover full BW in TDMA mode");
-        for (unsigned i = 0; i < itMap->second.m_rntiPerChunk.size(); i++)
+        // in TDMA mode all the chunks are allocated to the same UE
+        uint16_t rnti = itAlloc->m_rnti;
+        uint16_t slot = AddUeSlot(rnti);
+        double* ulCqi = &m_ulCqi[slot * m_numRb];
+        if (!(m_ueFlags[slot] & UE_UL_CQI))
+        {
+            // create a new entry, initialized with NO_SINR value.
+            std::fill(ulCqi, ulCqi + m_numRb, 30.0);
+            m_ueFlags[slot] |= UE_UL_CQI;
+        }
+        for (unsigned i = 0; i < m_numRb; i++)
         {
             // convert from fixed point notation Sxxxxxxxxxxx.xxx to double
             // double sinr = LteFfConverter::fpS11dot3toDouble (params.m_ulCqi.m_sinr.at (i));
-            itCqi = m_ueUlCqi.find(itMap->second.m_rntiPerChunk.at(i));
-            if (itCqi == m_ueUlCqi.end())
+            ulCqi[i] = params.m_ulCqi.m_sinr[i];
+            NS_LOG_INFO("UL CQI report for RNTI "
+                        << rnti << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr[i]
+                        << " frame " << frameNum << " subframe " << +subframeNum << " slot "
+                        << +slotNum << " startSym " << +symNum);
+        }
+        // generate or update correspondent timer
+        m_ulCqiTimer[slot] = m_cqiTimersThreshold;
+
+        // remove obsolete info on allocation, including the allocations older than a frame
+        // whose UL-CQI has never been received
+        uint64_t oldest = sfn > (uint64_t(1) << 24) ? sfn - (uint64_t(1) << 24) : 0;
+        *itAlloc = m_ulAllocations.back();
+        m_ulAllocations.pop_back();
+        itAlloc = m_ulAllocations.begin();
+        while (itAlloc != m_ulAllocations.end())
+        {
+            if (itAlloc->m_sfn < oldest)
             {
-                // create a new entry
-                std::vector<double> newCqi;
-                for (uint32_t j = 0; j < m_phyMacConfig->GetNumRb(); j++)
-                {
-                    unsigned chunkInd = i;
-                    if (chunkInd == j)
-                    {
-                        newCqi.push_back(params.m_ulCqi.m_sinr.at(i));
-                        NS_LOG_INFO("UL CQI report for RNTI "
-                                    << itMap->second.m_rntiPerChunk.at(i) << " chunk " << i
-                                    << " SINR " << params.m_ulCqi.m_sinr.at(i) << " frame "
-                                    << frameNum << " subframe " << +subframeNum << " slot "
-                                    << +slotNum << " startSym " << +symNum);
-                    }
-                    else
-                    {
-                        // initialize with NO_SINR value.
-                        newCqi.push_back(30.0);
-                    }
-                }
-                m_ueUlCqi.insert(std::pair<uint16_t, struct UlCqiMapElem>(
-                    itMap->second.m_rntiPerChunk.at(i),
-                    UlCqiMapElem(newCqi, itMap->second.m_numSym, itMap->second.m_tbSize)));
-                // generate correspondent timer
-                m_ueCqiTimers.insert(
-                    std::pair<uint16_t, uint32_t>(itMap->second.m_rntiPerChunk.at(i),
-                                                  m_cqiTimersThreshold));
+                *itAlloc = m_ulAllocations.back();
+                m_ulAllocations.pop_back();
             }
             else
             {
-                // update the value
-                (*itCqi).second.m_ueUlCqi.at(i) = params.m_ulCqi.m_sinr.at(i);
-                (*itCqi).second.m_numSym = itMap->second.m_numSym;
-                (*itCqi).second.m_tbSize = itMap->second.m_tbSize;
-                // update correspondent timer
-                std::map<uint16_t, uint32_t>::iterator itTimers;
-                itTimers = m_ueCqiTimers.find(itMap->second.m_rntiPerChunk.at(i));
-                (*itTimers).second = m_cqiTimersThreshold;
-
-                NS_LOG_INFO("UL CQI report for RNTI "
-                            << itMap->second.m_rntiPerChunk.at(i) << " chunk " << i << " SINR "
-                            << params.m_ulCqi.m_sinr.at(i) << " frame " << frameNum << " subframe "
-                            << +subframeNum << " slot " << +slotNum << " startSym " << +symNum);
+                ++itAlloc;
             }
         }
-        // remove obsolete info on allocation
-        m_ulAllocationMap.erase(itMap);
     }
     break;
     default:
@@ -501,54 +586,38 @@ MmWaveFlexTtiMacScheduler::RefreshHarqProcesses()
 {
     NS_LOG_FUNCTION(this);
 
-    std::map<uint16_t, DlHarqProcessesTimer_t>::iterator itTimers;
-    for (itTimers = m_dlHarqProcessesTimer.begin(); itTimers != m_dlHarqProcessesTimer.end();
-         itTimers++)
+    for (uint16_t rnti : m_activeRntis)
     {
-        for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess(); i++)
+        uint16_t slot = m_ueSlot[rnti];
+        if (!(m_ueFlags[slot] & UE_HARQ))
         {
-            if ((*itTimers).second.at(i) == m_phyMacConfig->GetHarqTimeout())
+            continue;
+        }
+        uint8_t* dlStatus = &m_dlHarqStatus[slot * m_numHarqProcess];
+        uint8_t* dlTimer = &m_dlHarqTimer[slot * m_numHarqProcess];
+        uint8_t* ulStatus = &m_ulHarqStatus[slot * m_numHarqProcess];
+        uint8_t* ulTimer = &m_ulHarqTimer[slot * m_numHarqProcess];
+        for (uint16_t i = 0; i < m_numHarqProcess; i++)
+        {
+            if (dlTimer[i] == m_harqTimeout)
             { // reset HARQ process
-                NS_LOG_INFO(this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers).first);
-                std::map<uint16_t, DlHarqProcessesStatus_t>::iterator itStat =
-                    m_dlHarqProcessesStatus.find((*itTimers).first);
-                if (itStat == m_dlHarqProcessesStatus.end())
-                {
-                    NS_FATAL_ERROR("No Process Id Status found for this RNTI "
-                                   << (*itTimers).first);
-                }
-                (*itStat).second.at(i) = 0;
-                (*itTimers).second.at(i) = 0;
+                NS_LOG_INFO(this << " Reset HARQ proc " << i << " for RNTI " << rnti);
+                dlStatus[i] = 0;
+                dlTimer[i] = 0;
             }
             else
             {
-                (*itTimers).second.at(i)++;
+                dlTimer[i]++;
             }
-        }
-    }
-
-    std::map<uint16_t, UlHarqProcessesTimer_t>::iterator itTimers2;
-    for (itTimers2 = m_ulHarqProcessesTimer.begin(); itTimers2 != m_ulHarqProcessesTimer.end();
-         itTimers2++)
-    {
-        for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess(); i++)
-        {
-            if ((*itTimers2).second.at(i) == m_phyMacConfig->GetHarqTimeout())
+            if (ulTimer[i] == m_harqTimeout)
             { // reset HARQ process
-                NS_LOG_INFO(this << " Reset HARQ proc " << i << " for RNTI " << (*itTimers2).first);
-                std::map<uint16_t, UlHarqProcessesStatus_t>::iterator itStat =
-                    m_ulHarqProcessesStatus.find((*itTimers2).first);
-                if (itStat == m_ulHarqProcessesStatus.end())
-                {
-                    NS_FATAL_ERROR("No Process Id Status found for this RNTI "
-                                   << (*itTimers2).first);
-                }
-                (*itStat).second.at(i) = 0;
-                (*itTimers2).second.at(i) = 0;
+                NS_LOG_INFO(this << " Reset HARQ proc " << i << " for RNTI " << rnti);
+                ulStatus[i] = 0;
+                ulTimer[i] = 0;
             }
             else
             {
-                (*itTimers2).second.at(i)++;
+                ulTimer[i]++;
             }
         }
     }
@@ -562,52 +631,29 @@ MmWaveFlexTtiMacScheduler::UpdateDlHarqProcessId(uint16_t rnti)
     if (m_harqOn == false)
     {
         uint8_t tbUid = m_tbUid;
-        m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess();
+        m_tbUid = (m_tbUid + 1) % m_numHarqProcess;
         return tbUid;
     }
 
-    //  std::map <uint16_t, uint8_t>::iterator it = m_dlHarqCurrentProcessId.find (rnti);
-    //  if (it == m_dlHarqCurrentProcessId.end ())
-    //  {
-    //      NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
-    //  }
-    std::map<uint16_t, DlHarqProcessesStatus_t>::iterator itStat =
-        m_dlHarqProcessesStatus.find(rnti);
-    if (itStat == m_dlHarqProcessesStatus.end())
+    uint16_t slot = GetUeSlot(rnti);
+    if (slot == NO_SLOT || !(m_ueFlags[slot] & UE_HARQ))
     {
         NS_FATAL_ERROR("No Process Id Statusfound for this RNTI " << rnti);
     }
 
     // search for available process ID, if none available return numHarqProcess
-    uint8_t harqId = m_phyMacConfig->GetNumHarqProcess();
-    for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess(); i++)
+    uint8_t* status = &m_dlHarqStatus[slot * m_numHarqProcess];
+    uint8_t harqId = m_numHarqProcess;
+    for (unsigned i = 0; i < m_numHarqProcess; i++)
     {
-        if (itStat->second[i] == 0)
+        if (status[i] == 0)
         {
-            itStat->second[i] = 1;
+            status[i] = 1;
             harqId = i;
             break;
         }
     }
     return harqId;
-
-    //  uint8_t i = (*it).second;
-    //  do
-    //  {
-    //      i = (i + 1) % m_phyMacConfig->GetNumHarqProcess ();
-    //  }
-    //  while ( ((*itStat).second.at (i) != 0)&&(i != (*it).second));
-    //  if ((*itStat).second.at (i) == 0)
-    //  {
-    //      (*it).second = i;
-    //      (*itStat).second.at (i) = 1;
-    //  }
-    //  else
-    //  {
-    //      return (m_phyMacConfig->GetNumHarqProcess () + 1); // return a not valid harq proc id
-    //  }
-    //
-    //  return ((*it).second);
 }
 
 uint8_t
@@ -618,29 +664,24 @@ MmWaveFlexTtiMacScheduler::UpdateUlHarqProcessId(uint16_t rnti)
     if (m_harqOn == false)
     {
         uint8_t tbUid = m_tbUid;
-        m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess();
+        m_tbUid = (m_tbUid + 1) % m_numHarqProcess;
         return tbUid;
     }
 
-    //  std::map <uint16_t, uint8_t>::iterator it = m_ulHarqCurrentProcessId.find (rnti);
-    //  if (it == m_ulHarqCurrentProcessId.end ())
-    //  {
-    //      NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
-    //  }
-    std::map<uint16_t, UlHarqProcessesStatus_t>::iterator itStat =
-        m_ulHarqProcessesStatus.find(rnti);
-    if (itStat == m_ulHarqProcessesStatus.end())
+    uint16_t slot = GetUeSlot(rnti);
+    if (slot == NO_SLOT || !(m_ueFlags[slot] & UE_HARQ))
     {
         NS_FATAL_ERROR("No Process Id Statusfound for this RNTI " << rnti);
     }
 
-    // search for available process ID, if none available return numHarqProcess+1
-    uint8_t harqId = m_phyMacConfig->GetNumHarqProcess();
-    for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess(); i++)
+    // search for available process ID, if none available return numHarqProcess
+    uint8_t* status = &m_ulHarqStatus[slot * m_numHarqProcess];
+    uint8_t harqId = m_numHarqProcess;
+    for (unsigned i = 0; i < m_numHarqProcess; i++)
     {
-        if (itStat->second[i] == 0)
+        if (status[i] == 0)
         {
-            itStat->second[i] = 1;
+            status[i] = 1;
             harqId = i;
             break;
         }
@@ -735,46 +776,39 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
     // Process DL HARQ feedback
     RefreshHarqProcesses();
 
-    // m_rlcBufferReq.sort (SortRlcBufferReq);     // sort list by RNTI
     //  number of DL/UL flows for new transmissions (not HARQ RETX)
     int nFlowsDl = 0;
     int nFlowsUl = 0;
-    std::map<uint16_t, struct UeSchedInfo> ueInfo;
-    std::map<uint16_t, struct UeSchedInfo>::iterator itUeInfo;
-    std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator itRlcBuf;
 
-    // retrieve past HARQ retx buffered
-    if (m_dlHarqInfoList.size() > 0 && params.m_dlHarqInfoList.size() > 0)
-    {
-        m_dlHarqInfoList.insert(m_dlHarqInfoList.end(),
-                                params.m_dlHarqInfoList.begin(),
-                                params.m_dlHarqInfoList.end());
-    }
-    else if (params.m_dlHarqInfoList.size() > 0)
+    // reset the UE info of the previous TTI
+    for (uint16_t rnti : m_schedRntis)
     {
-        m_dlHarqInfoList = params.m_dlHarqInfoList;
-    }
-    if (m_ulHarqInfoList.size() > 0 && params.m_ulHarqInfoList.size() > 0)
-    {
-        m_ulHarqInfoList.insert(m_ulHarqInfoList.end(),
-                                params.m_ulHarqInfoList.begin(),
-                                params.m_ulHarqInfoList.end());
-    }
-    else if (params.m_ulHarqInfoList.size() > 0)
-    {
-        m_ulHarqInfoList = params.m_ulHarqInfoList;
+        uint16_t slot = GetUeSlot(rnti);
+        if (slot != NO_SLOT)
+        {
+            m_ueSchedInfo[slot].Reset();
+        }
     }
+    m_schedRntis.clear();
+
+    // retrieve past HARQ retx buffered
+    m_dlHarqInfoList.insert(m_dlHarqInfoList.end(),
+                            params.m_dlHarqInfoList.begin(),
+                            params.m_dlHarqInfoList.end());
+    m_ulHarqInfoList.insert(m_ulHarqInfoList.end(),
+                            params.m_ulHarqInfoList.begin(),
+                            params.m_ulHarqInfoList.end());
 
     if (m_harqOn == false) // Ignore HARQ feedback
     {
         m_dlHarqInfoList.clear();
+        m_ulHarqInfoList.clear();
     }
     else
     {
         // Process DL HARQ feedback and assign slots for RETX if resources available
-        std::vector<struct DlHarqInfo>
-            dlInfoListUntxed; // TBs not able to be retransmitted in this sf
-        std::vector<struct UlHarqInfo> ulInfoListUntxed;
+        m_dlHarqInfoUntxed.clear(); // TBs not able to be retransmitted in this sf
+        m_ulHarqInfoUntxed.clear();
 
         for (unsigned i = 0; i < m_dlHarqInfoList.size(); i++)
         {
@@ -782,120 +816,37 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
             {
                 break; // no symbols left to allocate
             }
-            uint8_t harqId = m_dlHarqInfoList.at(i).m_harqProcessId;
-            uint16_t rnti = m_dlHarqInfoList.at(i).m_rnti;
-            itUeInfo = ueInfo.find(rnti);
-            std::map<uint16_t, UlHarqProcessesStatus_t>::iterator itStat =
-                m_dlHarqProcessesStatus.find(rnti);
-            if (itStat == m_dlHarqProcessesStatus.end())
+            uint8_t harqId = m_dlHarqInfoList[i].m_harqProcessId;
+            uint16_t rnti = m_dlHarqInfoList[i].m_rnti;
+            uint16_t slot = GetUeSlot(rnti);
+            if (slot == NO_SLOT || !(m_ueFlags[slot] & UE_HARQ))
             {
                 NS_FATAL_ERROR("No HARQ status info found for UE " << rnti);
             }
-            std::map<uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =
-                m_dlHarqProcessesRlcPduMap.find(rnti);
-            if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end())
-            {
-                NS_FATAL_ERROR("Unable to find RlcPdcList in HARQ buffer for RNTI "
-                               << m_dlHarqInfoList.at(i).m_rnti);
-            }
-            if (m_dlHarqInfoList.at(i).m_harqStatus == DlHarqInfo::ACK ||
-                itStat->second.at(harqId) == 0)
+            NS_ASSERT(harqId < m_numHarqProcess);
+            uint8_t& harqStatus = m_dlHarqStatus[slot * m_numHarqProcess + harqId];
+            std::vector<struct RlcPduInfo>& harqRlcPdu =
+                m_dlHarqRlcPdu[slot * m_numHarqProcess + harqId];
+            if (m_dlHarqInfoList[i].m_harqStatus == DlHarqInfo::ACK || harqStatus == 0)
             { // acknowledgment or process timeout, reset process
-                // NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << +harqId << " HARQ-ACK received");
-                itStat->second.at(harqId) = 0;                         // release process ID
-                for (uint16_t k = 0; k < itRlcPdu->second.size(); k++) // clear RLC buffers
-                {
-                    itRlcPdu->second.at(harqId).clear();
-                }
+                harqStatus = 0;     // release process ID
+                harqRlcPdu.clear(); // clear RLC buffers
                 continue;
             }
-            else if (m_dlHarqInfoList.at(i).m_harqStatus == DlHarqInfo::NACK)
+            else if (m_dlHarqInfoList[i].m_harqStatus == DlHarqInfo::NACK)
             {
-                std::map<uint16_t, DlHarqProcessesDciInfoList_t>::iterator itHarq =
-                    m_dlHarqProcessesDciInfoMap.find(rnti);
-                if (itHarq == m_dlHarqProcessesDciInfoMap.end())
-                {
-                    NS_FATAL_ERROR("No DCI/HARQ buffer entry found for UE " << rnti);
-                }
-                DciInfoElementTdma dciInfoReTx = itHarq->second.at(harqId);
-                // NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << +harqId << " HARQ-NACK received,
-                // rv " << +dciInfoReTx.m_rv);
+                DciInfoElementTdma& harqDci = m_dlHarqDci[slot * m_numHarqProcess + harqId];
+                DciInfoElementTdma dciInfoReTx = harqDci;
                 NS_ASSERT(harqId == dciInfoReTx.m_harqProcess);
-                // NS_ASSERT(itStat->second.at (harqId) > 0);
-                NS_ASSERT(itStat->second.at(harqId) - 1 == dciInfoReTx.m_rv);
+                NS_ASSERT(harqStatus - 1 == dciInfoReTx.m_rv);
                 if (dciInfoReTx.m_rv == 3) // maximum number of retx reached -> drop process
                 {
                     NS_LOG_INFO("Max number of retransmissions reached -> drop process");
-                    itStat->second.at(harqId) = 0;
-                    for (uint16_t k = 0; k < (*itRlcPdu).second.size(); k++)
-                    {
-                        itRlcPdu->second.at(harqId).clear();
-                    }
+                    harqStatus = 0;
+                    harqRlcPdu.clear();
                     continue;
                 }
 
-                // (1) Check if the CQI has decreased. If no updated value available, use the same
-                // MCS minus 1.
-                //                        If CQI is below min threshold, drop process.
-                // (2) Calculate new number of symbols it will take to encode at lower MCS.
-                //          If this exceeds the total number of symbols, reTX with original
-                //parameters.
-                //                        If exceeds remaining symbols available in this subframe
-                //                        (but not total symbols in SF),
-                //          update DCI info and try scheduling in next SF.
-
-                /*std::map <uint16_t,uint8_t>::iterator itCqi = m_wbCqiRxed.find (itRlcBuf->m_rnti);
-                int cqi;
-                int mcsNew;
-                if (itCqi != m_wbCqiRxed.end ())
-                {
-                        cqi = itCqi->second;
-                        if (cqi == 0)
-                        {
-                                NS_LOG_INFO ("CQI for reTX is below threshhold. Drop process");
-                                itStat->second.at (harqId) = 0;
-                                for (uint16_t k = 0; k < (*itRlcPdu).second.size (); k++)
-                                {
-                                        itRlcPdu->second.at (harqId).clear ();
-                                }
-                                continue;
-                        }
-                        else
-                        {
-                                mcsNew = m_amc->GetMcsFromCqi (cqi);  // get MCS
-                        }
-                }
-                else
-                {
-                        if(dciInfoReTx.m_mcs > 0)
-                        {
-                                mcsNew = dciInfoReTx.m_mcs - 1;
-                        }
-                        else
-                        {
-                                mcsNew = dciInfoReTx.m_mcs;
-                        }
-                }
-                // compute number of symbols required
-                unsigned numSymReq;
-                if (mcsNew < dciInfoReTx.m_mcs)
-                {
-                        numSymReq = m_amc->GetNumSymbolsFromTbsMcs (dciInfoReTx.m_tbSize, mcsNew);
-                        while (numSymReq < symAvail && mcsNew < dciInfoReTx.m_mcs);
-                        {
-                                mcsNew++;
-                                numSymReq = m_amc->GetNumSymbolsFromTbsMcs (dciInfoReTx.m_tbSize,
-                mcsNew);
-                        }
-                        mcsNew--;
-                        numSymReq = m_amc->GetNumSymbolsFromTbsMcs (dciInfoReTx.m_tbSize, mcsNew);
-                }
-                if (numSymReq <= (m_phyMacConfig->GetSymbolsPerSubframe () - resvCtrl))
-                {   // not enough symbols to encode TB at required MCS, attempt in later SF
-                        dlInfoListUntxed.push_back (m_dlHarqInfoList.at (i));
-                        continue;
-                }*/
-
                 // allocate retx if enough symbols are available
                 if (symAvail >= dciInfoReTx.m_numSym)
                 {
@@ -906,59 +857,41 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                                             m_phyMacConfig->GetUlCtrlSymbols());
                     dciInfoReTx.m_rv++;
                     dciInfoReTx.m_ndi = 0;
-                    itHarq->second.at(harqId) = dciInfoReTx;
-                    itStat->second.at(harqId) = itStat->second.at(harqId) + 1;
+                    harqDci = dciInfoReTx;
+                    harqStatus = harqStatus + 1;
                     TtiAllocInfo ttiInfo(ttiIdx++,
                                          TtiAllocInfo::DL_slotAllocInfo,
                                          TtiAllocInfo::CTRL_DATA,
-                                         itUeInfo->first);
+                                         rnti);
                     ttiInfo.m_dci = dciInfoReTx;
                     NS_LOG_DEBUG("UE" << dciInfoReTx.m_rnti << " gets DL OFDM symbols "
                                       << +dciInfoReTx.m_symStart << "-"
                                       << +(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1)
                                       << " tbs " << dciInfoReTx.m_tbSize << " harqId "
-                                      << +dciInfoReTx.m_harqProcess << " harqId "
                                       << +dciInfoReTx.m_harqProcess << " rv " << +dciInfoReTx.m_rv
                                       << " in frame " << ret.m_sfnSf.m_frameNum << " subframe "
                                       << +ret.m_sfnSf.m_sfNum << " slot " << +ret.m_sfnSf.m_slotNum
                                       << " RETX");
-
-                    std::map<uint16_t, DlHarqRlcPduList_t>::iterator itRlcList =
-                        m_dlHarqProcessesRlcPduMap.find(rnti);
-                    if (itRlcList == m_dlHarqProcessesRlcPduMap.end())
-                    {
-                        NS_FATAL_ERROR("Unable to find RlcPdcList in HARQ buffer for RNTI "
-                                       << rnti);
-                    }
-                    for (uint16_t k = 0;
-                         k < (*itRlcList).second.at(dciInfoReTx.m_harqProcess).size();
-                         k++)
-                    {
-                        ttiInfo.m_rlcPduInfo.push_back(
-                            (*itRlcList).second.at(dciInfoReTx.m_harqProcess).at(k));
-                    }
+                    ttiInfo.m_rlcPduInfo = harqRlcPdu;
                     ret.m_slotAllocInfo.m_ttiAllocInfo.push_back(ttiInfo);
                     ret.m_slotAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
-                    if (itUeInfo == ueInfo.end())
+                    UeSchedInfo& ueInfo = m_ueSchedInfo[slot];
+                    if (!ueInfo.m_active)
                     {
-                        itUeInfo =
-                            ueInfo
-                                .insert(
-                                    std::pair<uint16_t, struct UeSchedInfo>(rnti, UeSchedInfo()))
-                                .first;
+                        ueInfo.m_active = true;
+                        m_schedRntis.push_back(rnti);
                     }
-                    itUeInfo->second.m_dlSymbolsRetx = dciInfoReTx.m_numSym;
+                    ueInfo.m_dlSymbolsRetx = dciInfoReTx.m_numSym;
                 }
                 else
                 {
                     NS_LOG_INFO("No resource for this retx -> buffer it");
-                    dlInfoListUntxed.push_back(m_dlHarqInfoList.at(i));
+                    m_dlHarqInfoUntxed.push_back(m_dlHarqInfoList[i]);
                 }
             }
         }
 
-        m_dlHarqInfoList.clear();
-        m_dlHarqInfoList = dlInfoListUntxed;
+        m_dlHarqInfoList.swap(m_dlHarqInfoUntxed);
 
         // Process UL HARQ feedback
         for (uint16_t i = 0; i < m_ulHarqInfoList.size(); i++)
@@ -967,46 +900,34 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
             {
                 break; // no symbols left to allocate
             }
-            UlHarqInfo harqInfo = m_ulHarqInfoList.at(i);
+            const UlHarqInfo& harqInfo = m_ulHarqInfoList[i];
             uint8_t harqId = harqInfo.m_harqProcessId;
             uint16_t rnti = harqInfo.m_rnti;
-            itUeInfo = ueInfo.find(rnti);
-            std::map<uint16_t, UlHarqProcessesStatus_t>::iterator itStat =
-                m_ulHarqProcessesStatus.find(rnti);
-            if (itStat == m_ulHarqProcessesStatus.end())
+            uint16_t slot = GetUeSlot(rnti);
+            if (slot == NO_SLOT || !(m_ueFlags[slot] & UE_HARQ))
             {
                 NS_LOG_ERROR("No info found in HARQ buffer for UE (might have changed eNB) "
                              << rnti);
+                continue;
             }
-            if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || itStat->second.at(harqId) == 0)
+            NS_ASSERT(harqId < m_numHarqProcess);
+            uint8_t& harqStatus = m_ulHarqStatus[slot * m_numHarqProcess + harqId];
+            if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || harqStatus == 0)
             {
-                // NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << +harqInfo.m_harqProcessId << "
-                // HARQ-ACK received");
-                if (itStat != m_ulHarqProcessesStatus.end())
-                {
-                    itStat->second.at(harqId) = 0; // release process ID
-                }
+                harqStatus = 0; // release process ID
             }
             else if (harqInfo.m_receptionStatus == UlHarqInfo::NotOk)
             {
-                std::map<uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarq =
-                    m_ulHarqProcessesDciInfoMap.find(rnti);
-                if (itHarq == m_ulHarqProcessesDciInfoMap.end())
-                {
-                    NS_LOG_ERROR("No info found in UL-HARQ buffer for UE (might have changed eNB) "
-                                 << rnti);
-                }
                 // retx correspondent block: retrieve the UL-DCI
-                DciInfoElementTdma dciInfoReTx = itHarq->second.at(harqId);
-                // NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << +harqInfo.m_harqProcessId << "
-                // HARQ-NACK received, rv " << +dciInfoReTx.m_rv);
+                DciInfoElementTdma& harqDci = m_ulHarqDci[slot * m_numHarqProcess + harqId];
+                DciInfoElementTdma dciInfoReTx = harqDci;
                 NS_ASSERT(harqId == dciInfoReTx.m_harqProcess);
-                NS_ASSERT(itStat->second.at(harqId) > 0);
-                NS_ASSERT(itStat->second.at(harqId) - 1 == dciInfoReTx.m_rv);
+                NS_ASSERT(harqStatus > 0);
+                NS_ASSERT(harqStatus - 1 == dciInfoReTx.m_rv);
                 if (dciInfoReTx.m_rv == 3)
                 {
                     NS_LOG_INFO("Max number of retransmissions reached (UL)-> drop process");
-                    itStat->second.at(harqId) = 0;
+                    harqStatus = 0;
                     continue;
                 }
 
@@ -1019,8 +940,8 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                                             m_phyMacConfig->GetUlCtrlSymbols());
                     dciInfoReTx.m_rv++;
                     dciInfoReTx.m_ndi = 0;
-                    itStat->second.at(harqId) = itStat->second.at(harqId) + 1;
-                    itHarq->second.at(harqId) = dciInfoReTx;
+                    harqStatus = harqStatus + 1;
+                    harqDci = dciInfoReTx;
                     TtiAllocInfo ttiInfo(ttiIdx++,
                                          TtiAllocInfo::UL_slotAllocInfo,
                                          TtiAllocInfo::CTRL_DATA,
@@ -1036,25 +957,22 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                                       << " RETX");
                     ret.m_slotAllocInfo.m_ttiAllocInfo.push_back(ttiInfo);
                     ret.m_slotAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
-                    if (itUeInfo == ueInfo.end())
+                    UeSchedInfo& ueInfo = m_ueSchedInfo[slot];
+                    if (!ueInfo.m_active)
                     {
-                        itUeInfo =
-                            ueInfo
-                                .insert(
-                                    std::pair<uint16_t, struct UeSchedInfo>(rnti, UeSchedInfo()))
-                                .first;
+                        ueInfo.m_active = true;
+                        m_schedRntis.push_back(rnti);
                     }
-                    itUeInfo->second.m_ulSymbolsRetx = dciInfoReTx.m_numSym;
+                    ueInfo.m_ulSymbolsRetx = dciInfoReTx.m_numSym;
                 }
                 else
                 {
-                    ulInfoListUntxed.push_back(m_ulHarqInfoList.at(i));
+                    m_ulHarqInfoUntxed.push_back(m_ulHarqInfoList[i]);
                 }
             }
         }
 
-        m_ulHarqInfoList.clear();
-        m_ulHarqInfoList = ulInfoListUntxed;
+        m_ulHarqInfoList.swap(m_ulHarqInfoUntxed);
     }
 
     // ********************* END OF HARQ SECTION, START OF NEW DATA SCHEDULING *********************
@@ -1063,80 +981,70 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
     // get info on active DL flows
     if (symAvail > 0 && !m_ulOnly) // remaining symbols in current subframe after HARQ retx sched
     {
-        for (itRlcBuf = m_rlcBufferReq.begin(); itRlcBuf != m_rlcBufferReq.end(); itRlcBuf++)
+        for (const RlcBufferElem& rlcBuf : m_rlcBufferReq)
         {
-            itUeInfo = ueInfo.find(itRlcBuf->m_rnti);
-            //      if (itUeInfo != ueInfo.end () && itUeInfo->second.m_dlSymbols > 0)
-            //      {
-            //          continue;
-            //      }
-
-            if ((((*itRlcBuf).m_rlcTransmissionQueueSize > 0) ||
-                 ((*itRlcBuf).m_rlcRetransmissionQueueSize > 0) ||
-                 ((*itRlcBuf).m_rlcStatusPduSize > 0)))
+            if (rlcBuf.m_txQueueSize > 0 || rlcBuf.m_retxQueueSize > 0 ||
+                rlcBuf.m_statusPduSize > 0)
             {
-                NS_LOG_INFO(this << " User " << itRlcBuf->m_rnti << " LC "
-                                 << (uint16_t)itRlcBuf->m_logicalChannelIdentity
-                                 << " is active, status  " << (*itRlcBuf).m_rlcStatusPduSize
-                                 << " retx " << (*itRlcBuf).m_rlcRetransmissionQueueSize << " tx "
-                                 << (*itRlcBuf).m_rlcTransmissionQueueSize);
-                std::map<uint16_t, uint8_t>::iterator itCqi = m_wbCqiRxed.find(itRlcBuf->m_rnti);
+                NS_LOG_INFO(this << " User " << rlcBuf.m_rnti << " LC " << (uint16_t)rlcBuf.m_lcid
+                                 << " is active, status  " << rlcBuf.m_statusPduSize << " retx "
+                                 << rlcBuf.m_retxQueueSize << " tx " << rlcBuf.m_txQueueSize);
+                // every UE with an RLC buffer owns a slot
+                uint16_t slot = m_ueSlot[rlcBuf.m_rnti];
                 uint8_t cqi = 0;
-                if (itCqi != m_wbCqiRxed.end())
+                if (m_ueFlags[slot] & UE_DL_CQI)
                 {
-                    cqi = itCqi->second;
+                    cqi = m_wbCqi[slot];
                 }
                 else // no CQI available
                 {
-                    NS_LOG_INFO(this << " UE " << itRlcBuf->m_rnti << " does not have DL-CQI");
+                    NS_LOG_INFO(this << " UE " << rlcBuf.m_rnti << " does not have DL-CQI");
                     cqi = 1; // lowest value for trying a transmission
                 }
                 if (cqi != 0 ||
                     m_fixedMcsDl) // CQI == 0 means "out of range" (see table 7.2.3-1 of 36.213)
                 {
-                    if (itUeInfo == ueInfo.end())
+                    UeSchedInfo& ueInfo = m_ueSchedInfo[slot];
+                    if (!ueInfo.m_active)
                     {
                         nFlowsDl++; // for simplicity, all RLC LCs are considered as a single flow
-                        itUeInfo =
-                            ueInfo
-                                .insert(std::pair<uint16_t, struct UeSchedInfo>(itRlcBuf->m_rnti,
-                                                                                UeSchedInfo()))
-                                .first;
+                        ueInfo.m_active = true;
+                        m_schedRntis.push_back(rlcBuf.m_rnti);
                     }
-                    else if (itUeInfo->second.m_maxDlBufSize == 0)
+                    else if (ueInfo.m_maxDlBufSize == 0)
                     {
                         nFlowsDl++;
                     }
 
                     if (m_fixedMcsDl)
                     {
-                        itUeInfo->second.m_dlMcs = m_mcsDefaultDl;
+                        ueInfo.m_dlMcs = m_mcsDefaultDl;
                     }
                     else
                     {
-                        itUeInfo->second.m_dlMcs = m_amc->GetMcsFromCqi(cqi); // get MCS
+                        ueInfo.m_dlMcs = m_amc->GetMcsFromCqi(cqi); // get MCS
                     }
 
                     // temporarily store the TX queue size
-                    if (itRlcBuf->m_rlcStatusPduSize > 0)
+                    if (rlcBuf.m_statusPduSize > 0)
                     {
                         RlcPduInfo newRlcStatusPdu;
-                        newRlcStatusPdu.m_lcid = itRlcBuf->m_logicalChannelIdentity;
-                        newRlcStatusPdu.m_size += itRlcBuf->m_rlcStatusPduSize + m_subHdrSize;
-                        itUeInfo->second.m_rlcPduInfo.push_back(newRlcStatusPdu);
-                        itUeInfo->second.m_maxDlBufSize +=
+                        newRlcStatusPdu.m_lcid = rlcBuf.m_lcid;
+                        newRlcStatusPdu.m_size += rlcBuf.m_statusPduSize + m_subHdrSize;
+                        ueInfo.m_rlcPduInfo.push_back(newRlcStatusPdu);
+                        ueInfo.m_maxDlBufSize +=
                             newRlcStatusPdu.m_size; // add to total DL buffer size
                     }
 
                     RlcPduInfo newRlcEl;
-                    newRlcEl.m_lcid = itRlcBuf->m_logicalChannelIdentity;
-                    if (itRlcBuf->m_rlcRetransmissionQueueSize > 0)
+                    newRlcEl.m_lcid = rlcBuf.m_lcid;
+                    if (rlcBuf.m_retxQueueSize > 0)
                     {
-                        newRlcEl.m_size = itRlcBuf->m_rlcRetransmissionQueueSize;
+                        newRlcEl.m_size = rlcBuf.m_retxQueueSize;
                     }
-                    else if (itRlcBuf->m_rlcTransmissionQueueSize > 0)
+                    else if (rlcBuf.m_txQueueSize > 0)
                     {
-                        newRlcEl.m_size = itRlcBuf->m_rlcTransmissionQueueSize;
+                        newRlcEl.m_size = rlcBuf.m_txQueueSize;
                     }
 
                     if (newRlcEl.m_size > 0)
@@ -1146,14 +1054,13 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                             newRlcEl.m_size = 8;
                         }
                         newRlcEl.m_size += m_rlcHdrSize + m_subHdrSize + 10;
-                        itUeInfo->second.m_rlcPduInfo.push_back(newRlcEl);
-                        itUeInfo->second.m_maxDlBufSize +=
-                            newRlcEl.m_size; // add to total DL buffer size
+                        ueInfo.m_rlcPduInfo.push_back(newRlcEl);
+                        ueInfo.m_maxDlBufSize += newRlcEl.m_size; // add to total DL buffer size
                     }
                 }
                 else
                 { // SINR out of range, don't schedule for DL
-                    NS_LOG_INFO("*** RNTI " << itRlcBuf->m_rnti
+                    NS_LOG_INFO("*** RNTI " << rlcBuf.m_rnti
                                             << " DL-CQI out of range, skipping allocation");
                 }
             }
@@ -1163,73 +1070,62 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
     // get info on active UL flows
     if (symAvail > 0 && !m_dlOnly) // remaining symbols in future UL subframe after HARQ retx sched
     {
-        std::map<uint16_t, uint32_t>::iterator ceBsrIt;
-        for (ceBsrIt = m_ceBsrRxed.begin(); ceBsrIt != m_ceBsrRxed.end(); ceBsrIt++)
+        for (uint16_t rnti : m_activeRntis)
         {
-            if (ceBsrIt->second > 0) // UL buffer size > 0
+            uint16_t slot = m_ueSlot[rnti];
+            if ((m_ueFlags[slot] & UE_BSR) && m_bsr[slot] > 0) // UL buffer size > 0
             {
-                std::map<uint16_t, struct UlCqiMapElem>::iterator itCqi =
-                    m_ueUlCqi.find(ceBsrIt->first);
                 int cqi = 0;
                 uint8_t mcs{0};
-                if (itCqi == m_ueUlCqi.end()) // no cqi info for this UE
+                if (!(m_ueFlags[slot] & UE_UL_CQI)) // no cqi info for this UE
                 {
-                    NS_LOG_INFO(this << " UE " << ceBsrIt->first << " does not have UL-CQI");
+                    NS_LOG_INFO(this << " UE " << rnti << " does not have UL-CQI");
                     cqi = 1;
                     mcs = 0;
                 }
                 else
                 {
                     cqi = 0;
-                    SpectrumValue specVals(
-                        MmWaveSpectrumValueHelper::GetSpectrumModel(m_phyMacConfig));
-                    Values::iterator specIt = specVals.ValuesBegin();
-                    for (uint32_t ichunk = 0; ichunk < m_phyMacConfig->GetNumRb(); ichunk++)
-                    {
-                        NS_ASSERT(specIt != specVals.ValuesEnd());
-                        *specIt = itCqi->second.m_ueUlCqi.at(ichunk); // sinrLin;
-                        specIt++;
-                    }
+                    std::copy(m_ulCqi.begin() + slot * m_numRb,
+                              m_ulCqi.begin() + (slot + 1) * m_numRb,
+                              m_ulSinr->ValuesBegin()); // sinrLin
 
-                    cqi = m_amc->CreateCqiFeedbackWbTdma(specVals, mcs);
+                    cqi = m_amc->CreateCqiFeedbackWbTdma(*m_ulSinr, mcs);
 
                     if (cqi == 0 && !m_fixedMcsUl) // out of range (SINR too low)
                     {
-                        NS_LOG_INFO("*** RNTI "
-                                    << ceBsrIt->first
-                                    << " UL-CQI out of range, skipping allocation in UL");
+                        NS_LOG_INFO("*** RNTI " << rnti
+                                                << " UL-CQI out of range, skipping allocation in UL");
                         continue; // do not allocate UE in uplink
                     }
                 }
-                itUeInfo = ueInfo.find(ceBsrIt->first);
-                if (itUeInfo == ueInfo.end())
+                UeSchedInfo& ueInfo = m_ueSchedInfo[slot];
+                if (!ueInfo.m_active)
                 {
-                    itUeInfo = ueInfo
-                                   .insert(std::pair<uint16_t, struct UeSchedInfo>(ceBsrIt->first,
-                                                                                   UeSchedInfo()))
-                                   .first;
+                    ueInfo.m_active = true;
+                    m_schedRntis.push_back(rnti);
                     nFlowsUl++;
                 }
-                else if (itUeInfo->second.m_maxUlBufSize == 0)
+                else if (ueInfo.m_maxUlBufSize == 0)
                 {
                     nFlowsUl++;
                 }
                 if (m_fixedMcsUl)
                 {
-                    itUeInfo->second.m_ulMcs = m_mcsDefaultUl;
+                    ueInfo.m_ulMcs = m_mcsDefaultUl;
                 }
                 else
                 {
-                    itUeInfo->second.m_ulMcs = mcs; // m_amc->GetMcsFromCqi (cqi);  // get MCS
+                    ueInfo.m_ulMcs = mcs; // m_amc->GetMcsFromCqi (cqi);  // get MCS
                 }
-                itUeInfo->second.m_maxUlBufSize = ceBsrIt->second + m_rlcHdrSize + m_macHdrSize + 8;
+                ueInfo.m_maxUlBufSize = m_bsr[slot] + m_rlcHdrSize + m_macHdrSize + 8;
             }
         }
     }
 
     int nFlowsTot = nFlowsDl + nFlowsUl;
-    if (ueInfo.size() == 0) // No new data to schedule: only UL CTRL left to schedule, then
-                            // scheduling operations are over
+    if (m_schedRntis.empty()) // No new data to schedule: only UL CTRL left to schedule, then
+                              // scheduling operations are over
     {
         // Add TTI for UL control at the end of the slot
         TtiAllocInfo ulCtrlTti(ttiIdx, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
@@ -1240,59 +1136,56 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
         return;
     }
 
+    // the UEs are served in increasing RNTI order, starting from m_nextRnti
+    std::sort(m_schedRntis.begin(), m_schedRntis.end());
+    const std::size_t numSchedUes = m_schedRntis.size();
+
     // compute requested num slots and TB size based on MCS and DL buffer size
     // final allocated slots may be less
     int totDlSymReq = 0;
     int totUlSymReq = 0;
-    for (itUeInfo = ueInfo.begin(); itUeInfo != ueInfo.end(); itUeInfo++)
+    for (uint16_t rnti : m_schedRntis)
     {
+        UeSchedInfo& ueInfo = m_ueSchedInfo[m_ueSlot[rnti]];
         unsigned dlTbSize = 0;
         unsigned ulTbSize = 0;
-        if (itUeInfo->second.m_maxDlBufSize > 0)
+        if (ueInfo.m_maxDlBufSize > 0)
         {
-            itUeInfo->second.m_maxDlSymbols = CalcMinTbSizeNumSym(itUeInfo->second.m_dlMcs,
-                                                                  itUeInfo->second.m_maxDlBufSize,
-                                                                  dlTbSize);
-            itUeInfo->second.m_maxDlBufSize = dlTbSize;
+            ueInfo.m_maxDlSymbols =
+                CalcMinTbSizeNumSym(ueInfo.m_dlMcs, ueInfo.m_maxDlBufSize, dlTbSize);
+            ueInfo.m_maxDlBufSize = dlTbSize;
             if (m_fixedTti)
             {
-                itUeInfo->second.m_maxDlSymbols =
-                    ceil((double)itUeInfo->second.m_maxDlSymbols / (double)m_symPerSlot) *
-                    m_symPerSlot; // round up to nearest sym per TTI
+                ueInfo.m_maxDlSymbols = ceil((double)ueInfo.m_maxDlSymbols / (double)m_symPerSlot) *
+                                        m_symPerSlot; // round up to nearest sym per TTI
             }
-            totDlSymReq += itUeInfo->second.m_maxDlSymbols;
+            totDlSymReq += ueInfo.m_maxDlSymbols;
         }
-        if (itUeInfo->second.m_maxUlBufSize > 0)
+        if (ueInfo.m_maxUlBufSize > 0)
         {
-            itUeInfo->second.m_maxUlSymbols =
-                CalcMinTbSizeNumSym(itUeInfo->second.m_ulMcs,
-                                    itUeInfo->second.m_maxUlBufSize + 10,
-                                    ulTbSize);
-            itUeInfo->second.m_maxUlBufSize = ulTbSize;
+            ueInfo.m_maxUlSymbols =
+                CalcMinTbSizeNumSym(ueInfo.m_ulMcs, ueInfo.m_maxUlBufSize + 10, ulTbSize);
+            ueInfo.m_maxUlBufSize = ulTbSize;
             if (m_fixedTti)
             {
-                itUeInfo->second.m_maxUlSymbols =
-                    ceil((double)itUeInfo->second.m_maxUlSymbols / (double)m_symPerSlot) *
-                    m_symPerSlot; // round up to nearest sym per TTI
+                ueInfo.m_maxUlSymbols = ceil((double)ueInfo.m_maxUlSymbols / (double)m_symPerSlot) *
+                                        m_symPerSlot; // round up to nearest sym per TTI
             }
-            totUlSymReq += itUeInfo->second.m_maxUlSymbols;
+            totUlSymReq += ueInfo.m_maxUlSymbols;
         }
     }
 
-    std::map<uint16_t, struct UeSchedInfo>::iterator itUeInfoStart;
+    std::size_t ueStart = 0;
     if (m_nextRnti != 0) // start with RNTI at which the scheduler left off
     {
-        itUeInfoStart = ueInfo.find(m_nextRnti);
-        if (itUeInfoStart == ueInfo.end())
+        std::vector<uint16_t>::iterator itStart =
+            std::lower_bound(m_schedRntis.begin(), m_schedRntis.end(), m_nextRnti);
+        if (itStart != m_schedRntis.end() && *itStart == m_nextRnti)
         {
-            itUeInfoStart = ueInfo.begin();
+            ueStart = itStart - m_schedRntis.begin();
         }
     }
-    else // start with first active RNTI
-    {
-        itUeInfoStart = ueInfo.begin();
-    }
-    itUeInfo = itUeInfoStart;
+    std::size_t ueIdx = ueStart;
 
     // divide OFDM symbols evenly between active UEs, which are then evenly divided between DL and
     // UL flows
@@ -1330,17 +1223,18 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
             }
             while (remSym > 0)
             {
+                UeSchedInfo& ueInfo = m_ueSchedInfo[m_ueSlot[m_schedRntis[ueIdx]]];
                 int addSym = 0;
                 // deficit = difference between requested and allocated symbols
-                int deficit = itUeInfo->second.m_maxDlSymbols - itUeInfo->second.m_dlSymbols;
+                int deficit = ueInfo.m_maxDlSymbols - ueInfo.m_dlSymbols;
                 NS_ASSERT(deficit >= 0);
                 if (m_fixedTti)
                 {
                     deficit = ceil((double)deficit / (double)m_symPerSlot) *
                               m_symPerSlot; // round up to nearest sym per TTI
                 }
-                if (deficit > 0 && ((itUeInfo->second.m_dlSymbols +
-                                     itUeInfo->second.m_dlSymbolsRetx) <= nSymPerFlow0))
+                if (deficit > 0 &&
+                    ((ueInfo.m_dlSymbols + ueInfo.m_dlSymbolsRetx) <= nSymPerFlow0))
                 {
                     if (deficit < nRemSymPerFlow)
                     {
@@ -1371,13 +1265,13 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                     }
                     allocated = true;
                 }
-                itUeInfo->second.m_dlSymbols += addSym;
+                ueInfo.m_dlSymbols += addSym;
                 remSym -= addSym;
                 NS_ASSERT(remSym >= 0);
 
                 addSym = 0;
                 // deficit = difference between requested and allocated symbols
-                deficit = itUeInfo->second.m_maxUlSymbols - itUeInfo->second.m_ulSymbols;
+                deficit = ueInfo.m_maxUlSymbols - ueInfo.m_ulSymbols;
                 NS_ASSERT(deficit >= 0);
                 if (m_fixedTti)
                 {
@@ -1390,8 +1284,7 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                                      m_symPerSlot; // round up to nearest sym per TTI
                 }
                 if (remSym > 0 && deficit > 0 &&
-                    ((itUeInfo->second.m_ulSymbols + itUeInfo->second.m_ulSymbolsRetx) <=
-                     nSymPerFlow0))
+                    ((ueInfo.m_ulSymbols + ueInfo.m_ulSymbolsRetx) <= nSymPerFlow0))
                 {
                     if (deficit < nRemSymPerFlow)
                     {
@@ -1423,16 +1316,13 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                         allocated = true;
                     }
                 }
-                itUeInfo->second.m_ulSymbols += addSym;
+                ueInfo.m_ulSymbols += addSym;
                 remSym -= addSym;
                 NS_ASSERT(remSym >= 0);
 
-                itUeInfo++;
-                if (itUeInfo == ueInfo.end())
-                { // loop around to first RNTI in map
-                    itUeInfo = ueInfo.begin();
-                }
-                if (itUeInfo == itUeInfoStart)
+                // loop around to first RNTI
+                ueIdx = (ueIdx + 1) % numSchedUes;
+                if (ueIdx == ueStart)
                 { // break when looped back to initial RNTI or no symbols remain
                     break;
                 }
@@ -1440,23 +1330,24 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
         }
     }
 
-    m_nextRnti = itUeInfo->first;
+    m_nextRnti = m_schedRntis[ueIdx];
 
     // create DCI elements and assign symbol indices
     // such that all DL slots are contiguous (at beginning of subframe)
     // and all UL slots are contiguous (at end of subframe)
-    itUeInfo = itUeInfoStart;
+    ueIdx = ueStart;
 
-    // ulSymIdx -= totUlSymActual; // symbols reserved for control at end of subframe before UL ctrl
     NS_ASSERT(symIdx > 0); // Should be at least 1, as the DL CTRL TTI at the beginning of the slot
                            // should have been scheduled already
     do
     {
-        UeSchedInfo& ueSchedInfo = itUeInfo->second;
+        uint16_t rnti = m_schedRntis[ueIdx];
+        uint16_t slot = m_ueSlot[rnti];
+        UeSchedInfo& ueSchedInfo = m_ueSchedInfo[slot];
         if (ueSchedInfo.m_dlSymbols > 0)
         {
             DciInfoElementTdma dci;
-            dci.m_rnti = itUeInfo->first;
+            dci.m_rnti = rnti;
             dci.m_format = 0;
             dci.m_symStart = symIdx;
             dci.m_numSym = ueSchedInfo.m_dlSymbols;
@@ -1464,22 +1355,17 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
             dci.m_ndi = 1;
             dci.m_mcs = ueSchedInfo.m_dlMcs;
             dci.m_tbSize = m_amc->CalculateTbSize(dci.m_mcs, dci.m_numSym);
-            /*while (dci.m_tbSize > m_phyMacConfig->GetMaxTbSize () && dci.m_mcs > 0)
-            {
-                    dci.m_mcs--;
-                    dci.m_tbSize = m_amc->CalculateTbSize (dci.m_mcs, dci.m_numSym) / 8;
-            }*/
             NS_ASSERT(symIdx <=
                       m_phyMacConfig->GetSymbPerSlot() - m_phyMacConfig->GetUlCtrlSymbols());
             dci.m_rv = 0;
-            dci.m_harqProcess = UpdateDlHarqProcessId(itUeInfo->first);
-            NS_ASSERT(dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess());
-            NS_LOG_DEBUG("UE" << itUeInfo->first << " DL harqId " << +dci.m_harqProcess
+            dci.m_harqProcess = UpdateDlHarqProcessId(rnti);
+            NS_ASSERT(dci.m_harqProcess < m_numHarqProcess);
+            NS_LOG_DEBUG("UE" << rnti << " DL harqId " << +dci.m_harqProcess
                               << " HARQ process assigned");
             TtiAllocInfo ttiInfo(ttiIdx++,
                                  TtiAllocInfo::DL_slotAllocInfo,
                                  TtiAllocInfo::CTRL_DATA,
-                                 itUeInfo->first);
+                                 rnti);
             ttiInfo.m_dci = dci;
             NS_LOG_DEBUG("UE" << dci.m_rnti << " gets DL OFDM symbols " << +dci.m_symStart << "-"
                               << +(dci.m_symStart + dci.m_numSym - 1) << " tbs " << dci.m_tbSize
@@ -1487,24 +1373,17 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                               << +dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe "
                               << +ret.m_sfnSf.m_sfNum << " slot " << +ret.m_sfnSf.m_slotNum);
 
+            std::vector<struct RlcPduInfo>* harqRlcPdu = nullptr;
             if (m_harqOn == true)
-            { // store DCI for HARQ buffer
-                std::map<uint16_t, DlHarqProcessesDciInfoList_t>::iterator itDciInfo =
-                    m_dlHarqProcessesDciInfoMap.find(dci.m_rnti);
-                if (itDciInfo == m_dlHarqProcessesDciInfoMap.end())
+            { // store DCI for HARQ buffer and refresh timer
+                if (!(m_ueFlags[slot] & UE_HARQ))
                 {
                     NS_FATAL_ERROR("Unable to find RNTI entry in DCI HARQ buffer for RNTI "
                                    << dci.m_rnti);
                 }
-                (*itDciInfo).second.at(dci.m_harqProcess) = dci;
-                // refresh timer
-                std::map<uint16_t, DlHarqProcessesTimer_t>::iterator itHarqTimer =
-                    m_dlHarqProcessesTimer.find(dci.m_rnti);
-                if (itHarqTimer == m_dlHarqProcessesTimer.end())
-                {
-                    NS_FATAL_ERROR("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-                }
-                (*itHarqTimer).second.at(dci.m_harqProcess) = 0;
+                m_dlHarqDci[slot * m_numHarqProcess + dci.m_harqProcess] = dci;
+                m_dlHarqTimer[slot * m_numHarqProcess + dci.m_harqProcess] = 0;
+                harqRlcPdu = &m_dlHarqRlcPdu[slot * m_numHarqProcess + dci.m_harqProcess];
             }
 
             // distribute bytes between active RLC queues
@@ -1535,33 +1414,15 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                 }
                 // else tbSize equals RLC queue size
                 NS_ASSERT(ueSchedInfo.m_rlcPduInfo[i].m_size > 0);
-                /*for (itRlcBuf = m_rlcBufferReq.begin (); itRlcBuf != m_rlcBufferReq.end ();
-                itRlcBuf++)
-                {
-                        if(itRlcBuf->m_rnti == itUeInfo->first)
-                        {
-                                if(itRlcBuf->m_rlcTransmissionQueueSize == 0)
-                                {
-                                        NS_FATAL_ERROR ("LC is scheduled but RLC buffer == 0");
-                                }
-                        }
-                }*/
                 // update RLC buffer info with expected queue size after scheduling
-                UpdateDlRlcBufferInfo(itUeInfo->first,
+                UpdateDlRlcBufferInfo(rnti,
                                       ueSchedInfo.m_rlcPduInfo[i].m_lcid,
                                       ueSchedInfo.m_rlcPduInfo[i].m_size - m_subHdrSize);
                 ttiInfo.m_rlcPduInfo.push_back(ueSchedInfo.m_rlcPduInfo[i]);
-                if (m_harqOn == true)
+                if (harqRlcPdu)
                 {
                     // store RLC PDU list for HARQ
-                    std::map<uint16_t, DlHarqRlcPduList_t>::iterator itRlcPdu =
-                        m_dlHarqProcessesRlcPduMap.find(dci.m_rnti);
-                    if (itRlcPdu == m_dlHarqProcessesRlcPduMap.end())
-                    {
-                        NS_FATAL_ERROR("Unable to find RlcPdcList in HARQ buffer for RNTI "
-                                       << dci.m_rnti);
-                    }
-                    (*itRlcPdu).second.at(dci.m_harqProcess).push_back(ueSchedInfo.m_rlcPduInfo[i]);
+                    harqRlcPdu->push_back(ueSchedInfo.m_rlcPduInfo[i]);
                 }
             }
             // reorder/reindex slots to maintain DL before UL slot order
@@ -1601,7 +1462,7 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
         if (ueSchedInfo.m_ulSymbols > 0)
         {
             DciInfoElementTdma dci;
-            dci.m_rnti = itUeInfo->first;
+            dci.m_rnti = rnti;
             dci.m_format = 1;
             NS_ASSERT(symIdx <=
                       m_phyMacConfig->GetSymbPerSlot() - m_phyMacConfig->GetUlCtrlSymbols());
@@ -1611,15 +1472,15 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
             dci.m_mcs = ueSchedInfo.m_ulMcs;
             dci.m_ndi = 1;
             dci.m_tbSize = m_amc->CalculateTbSize(dci.m_mcs, dci.m_numSym);
-            dci.m_harqProcess = UpdateUlHarqProcessId(itUeInfo->first);
-            NS_LOG_DEBUG("UE" << itUeInfo->first << " UL harqId " << +dci.m_harqProcess
+            dci.m_harqProcess = UpdateUlHarqProcessId(rnti);
+            NS_LOG_DEBUG("UE" << rnti << " UL harqId " << +dci.m_harqProcess
                               << " HARQ process assigned");
-            NS_ASSERT(dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess());
+            NS_ASSERT(dci.m_harqProcess < m_numHarqProcess);
 
             TtiAllocInfo ttiInfo(ttiIdx++,
                                  TtiAllocInfo::UL_slotAllocInfo,
                                  TtiAllocInfo::CTRL_DATA,
-                                 itUeInfo->first);
+                                 rnti);
             ttiInfo.m_dci = dci;
 
             NS_LOG_DEBUG("UE" << dci.m_rnti << " gets UL OFDM symbols " << +dci.m_symStart << "-"
@@ -1628,54 +1489,36 @@ MmWaveFlexTtiMacScheduler::DoSchedTriggerReq(
                               << +dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe "
                               << +ret.m_sfnSf.m_sfNum << " slot " << +ret.m_sfnSf.m_slotNum);
 
-            UpdateUlRlcBufferInfo(itUeInfo->first, dci.m_tbSize - m_subHdrSize);
+            UpdateUlRlcBufferInfo(rnti, dci.m_tbSize - m_subHdrSize);
             ret.m_slotAllocInfo.m_ttiAllocInfo.push_back(ttiInfo); // add to front
             ret.m_slotAllocInfo.m_numSymAlloc += dci.m_numSym;
-            std::vector<uint16_t> ueChunkMap;
-            for (uint32_t i = 0; i < m_phyMacConfig->GetNumRb(); i++)
-            {
-                ueChunkMap.push_back(dci.m_rnti);
-            }
             SfnSf slotSfn = ret.m_slotAllocInfo.m_sfnSf;
             slotSfn.m_symStart =
                 dci.m_symStart; // use the start symbol index of the slot because the absolute UL
                                 // slot index depends on the future DL allocation
-            // insert into allocation map to recall previous allocations upon receiving UL-CQI
-            m_ulAllocationMap.insert(std::pair<uint32_t, struct AllocMapElem>(
-                slotSfn.Encode(),
-                AllocMapElem(ueChunkMap, dci.m_numSym, dci.m_tbSize)));
+            // recall the allocation upon receiving UL-CQI
+            UlAllocElem alloc;
+            alloc.m_sfn = slotSfn.Encode();
+            alloc.m_rnti = dci.m_rnti;
+            m_ulAllocations.push_back(alloc);
 
             if (m_harqOn == true)
             {
-                uint8_t harqId = dci.m_harqProcess;
-                std::map<uint16_t, UlHarqProcessesDciInfoList_t>::iterator itHarqTbInfo =
-                    m_ulHarqProcessesDciInfoMap.find(dci.m_rnti);
-                if (itHarqTbInfo == m_ulHarqProcessesDciInfoMap.end())
+                if (!(m_ueFlags[slot] & UE_HARQ))
                 {
                     NS_FATAL_ERROR("Unable to find RNTI entry in UL DCI HARQ buffer for RNTI "
                                    << dci.m_rnti);
                 }
-                (*itHarqTbInfo).second.at(harqId) = dci;
+                m_ulHarqDci[slot * m_numHarqProcess + dci.m_harqProcess] = dci;
                 // Update HARQ process status (RV 0)
-                std::map<uint16_t, UlHarqProcessesStatus_t>::iterator itStat =
-                    m_ulHarqProcessesStatus.find(dci.m_rnti);
-                NS_ASSERT(itStat->second[dci.m_harqProcess] > 0);
+                NS_ASSERT(m_ulHarqStatus[slot * m_numHarqProcess + dci.m_harqProcess] > 0);
                 // refresh timer
-                std::map<uint16_t, UlHarqProcessesTimer_t>::iterator itHarqTimer =
-                    m_ulHarqProcessesTimer.find(dci.m_rnti);
-                if (itHarqTimer == m_ulHarqProcessesTimer.end())
-                {
-                    NS_FATAL_ERROR("Unable to find HARQ timer for RNTI " << (uint16_t)dci.m_rnti);
-                }
-                (*itHarqTimer).second.at(dci.m_harqProcess) = 0;
+                m_ulHarqTimer[slot * m_numHarqProcess + dci.m_harqProcess] = 0;
             }
         }
-        itUeInfo++;
-        if (itUeInfo == ueInfo.end())
-        { // loop around to first RNTI in map
-            itUeInfo = ueInfo.begin();
-        }
-    } while (itUeInfo != itUeInfoStart); // break when looped back to initial RNTI
+        // loop around to first RNTI
+        ueIdx = (ueIdx + 1) % numSchedUes;
+    } while (ueIdx != ueStart); // break when looped back to initial RNTI
 
     // Add TTI for UL control at the end of the slot
     TtiAllocInfo ulCtrlTti(ttiIdx, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
@@ -1693,8 +1536,6 @@ MmWaveFlexTtiMacScheduler::DoSchedUlMacCtrlInfoReq(
 {
     NS_LOG_FUNCTION(this);
 
-    std::map<uint16_t, uint32_t>::iterator it;
-
     for (unsigned int i = 0; i < params.m_macCeList.size(); i++)
     {
         if (params.m_macCeList.at(i).m_macCeType == MacCeElement::BSR)
@@ -1714,19 +1555,11 @@ MmWaveFlexTtiMacScheduler::DoSchedUlMacCtrlInfoReq(
             }
 
             uint16_t rnti = params.m_macCeList.at(i).m_rnti;
-            it = m_ceBsrRxed.find(rnti);
-            if (it == m_ceBsrRxed.end())
-            {
-                // create the new entry
-                m_ceBsrRxed.insert(std::pair<uint16_t, uint32_t>(rnti, buffer));
-                NS_LOG_INFO(this << " Insert RNTI " << rnti << " queue " << buffer);
-            }
-            else
-            {
-                // update the buffer size value
-                (*it).second = buffer;
-                NS_LOG_INFO(this << " Update RNTI " << rnti << " queue " << buffer);
-            }
+            uint16_t slot = AddUeSlot(rnti);
+            NS_LOG_INFO(this << ((m_ueFlags[slot] & UE_BSR) ? " Update RNTI " : " Insert RNTI ")
+                             << rnti << " queue " << buffer);
+            m_bsr[slot] = buffer;
+            m_ueFlags[slot] |= UE_BSR;
         }
     }
 
@@ -1754,31 +1587,34 @@ MmWaveFlexTtiMacScheduler::SortRlcBufferReq(
 void
 MmWaveFlexTtiMacScheduler::RefreshDlCqiMaps(void)
 {
-    NS_LOG_FUNCTION(this << m_wbCqiTimers.size());
+    NS_LOG_FUNCTION(this << m_activeRntis.size());
     // refresh DL CQI P01 Map
-    std::map<uint16_t, uint32_t>::iterator itP10 = m_wbCqiTimers.begin();
-    while (itP10 != m_wbCqiTimers.end())
+    bool expired = false;
+    for (uint16_t rnti : m_activeRntis)
     {
-        NS_LOG_INFO(this << " P10-CQI for user " << (*itP10).first << " is "
-                         << (uint32_t)(*itP10).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-        if ((*itP10).second == 0)
+        uint16_t slot = m_ueSlot[rnti];
+        if (!(m_ueFlags[slot] & UE_DL_CQI))
+        {
+            continue;
+        }
+        NS_LOG_INFO(this << " P10-CQI for user " << rnti << " is " << m_wbCqiTimer[slot]
+                         << " thr " << (uint32_t)m_cqiTimersThreshold);
+        if (m_wbCqiTimer[slot] == 0)
         {
             // delete correspondent entries
-            std::map<uint16_t, uint8_t>::iterator itMap = m_wbCqiRxed.find((*itP10).first);
-            NS_ASSERT_MSG(itMap != m_wbCqiRxed.end(),
-                          " Does not find CQI report for user " << (*itP10).first);
-            NS_LOG_INFO(this << " P10-CQI exired for user " << (*itP10).first);
-            m_wbCqiRxed.erase(itMap);
-            std::map<uint16_t, uint32_t>::iterator temp = itP10;
-            itP10++;
-            m_wbCqiTimers.erase(temp);
+            NS_LOG_INFO(this << " P10-CQI exired for user " << rnti);
+            m_ueFlags[slot] &= ~UE_DL_CQI;
+            expired = true;
         }
         else
         {
-            (*itP10).second--;
-            itP10++;
+            m_wbCqiTimer[slot]--;
         }
     }
+    if (expired)
+    {
+        ReleaseIdleUeSlots();
+    }
 
     return;
 }
@@ -1787,30 +1623,32 @@ void
 MmWaveFlexTtiMacScheduler::RefreshUlCqiMaps(void)
 {
     // refresh UL CQI  Map
-    std::map<uint16_t, uint32_t>::iterator itUl = m_ueCqiTimers.begin();
-    while (itUl != m_ueCqiTimers.end())
+    bool expired = false;
+    for (uint16_t rnti : m_activeRntis)
     {
-        NS_LOG_INFO(this << " UL-CQI for user " << (*itUl).first << " is "
-                         << (uint32_t)(*itUl).second << " thr " << (uint32_t)m_cqiTimersThreshold);
-        if ((*itUl).second == 0)
+        uint16_t slot = m_ueSlot[rnti];
+        if (!(m_ueFlags[slot] & UE_UL_CQI))
+        {
+            continue;
+        }
+        NS_LOG_INFO(this << " UL-CQI for user " << rnti << " is " << m_ulCqiTimer[slot]
+                         << " thr " << (uint32_t)m_cqiTimersThreshold);
+        if (m_ulCqiTimer[slot] == 0)
         {
             // delete correspondent entries
-            std::map<uint16_t, struct UlCqiMapElem>::iterator itMap = m_ueUlCqi.find((*itUl).first);
-            NS_ASSERT_MSG(itMap != m_ueUlCqi.end(),
-                          " Does not find CQI report for user " << (*itUl).first);
-            NS_LOG_INFO(this << " UL-CQI expired for user " << (*itUl).first);
-            itMap->second.m_ueUlCqi.clear();
-            m_ueUlCqi.erase(itMap);
-            std::map<uint16_t, uint32_t>::iterator temp = itUl;
-            itUl++;
-            m_ueCqiTimers.erase(temp);
+            NS_LOG_INFO(this << " UL-CQI expired for user " << rnti);
+            m_ueFlags[slot] &= ~UE_UL_CQI;
+            expired = true;
         }
         else
         {
-            (*itUl).second--;
-            itUl++;
+            m_ulCqiTimer[slot]--;
         }
     }
+    if (expired)
+    {
+        ReleaseIdleUeSlots();
+    }
 
     return;
 }
@@ -1819,35 +1657,32 @@ void
 MmWaveFlexTtiMacScheduler::UpdateDlRlcBufferInfo(uint16_t rnti, uint8_t lcid, uint16_t size)
 {
     NS_LOG_FUNCTION(this);
-    std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
-    for (it = m_rlcBufferReq.begin(); it != m_rlcBufferReq.end(); it++)
+    for (RlcBufferElem& elem : m_rlcBufferReq)
     {
-        if (((*it).m_rnti == rnti) && ((*it).m_logicalChannelIdentity == lcid))
+        if (elem.m_rnti == rnti && elem.m_lcid == lcid)
         {
             NS_LOG_INFO(this << " UE " << rnti << " LC " << (uint16_t)lcid << " txqueue "
-                             << (*it).m_rlcTransmissionQueueSize << " retxqueue "
-                             << (*it).m_rlcRetransmissionQueueSize << " status "
-                             << (*it).m_rlcStatusPduSize << " decrease " << size);
+                             << elem.m_txQueueSize << " retxqueue " << elem.m_retxQueueSize
+                             << " status " << elem.m_statusPduSize << " decrease " << size);
             // Update queues: RLC tx order Status, ReTx, Tx
             // Update status queue
-            if (((*it).m_rlcStatusPduSize > 0) && (size >= (*it).m_rlcStatusPduSize))
+            if ((elem.m_statusPduSize > 0) && (size >= elem.m_statusPduSize))
             {
-                (*it).m_rlcStatusPduSize = 0;
+                elem.m_statusPduSize = 0;
             }
 
-            if ((*it).m_rlcRetransmissionQueueSize > 0)
+            if (elem.m_retxQueueSize > 0)
             {
-                if ((*it).m_rlcRetransmissionQueueSize <=
-                    (unsigned)(size - (*it).m_rlcStatusPduSize))
+                if (elem.m_retxQueueSize <= (unsigned)(size - elem.m_statusPduSize))
                 {
-                    (*it).m_rlcRetransmissionQueueSize = 0;
+                    elem.m_retxQueueSize = 0;
                 }
                 else
                 {
-                    (*it).m_rlcRetransmissionQueueSize -= (size - (*it).m_rlcStatusPduSize);
+                    elem.m_retxQueueSize -= (size - elem.m_statusPduSize);
                 }
             }
-            else if ((*it).m_rlcTransmissionQueueSize > 0)
+            else if (elem.m_txQueueSize > 0)
             {
                 uint32_t rlcOverhead;
                 if (lcid == 1)
@@ -1864,15 +1699,13 @@ MmWaveFlexTtiMacScheduler::UpdateDlRlcBufferInfo(uint16_t rnti, uint8_t lcid, ui
                     rlcOverhead = 2;
                 }
                 // update transmission queue
-                if ((*it).m_rlcTransmissionQueueSize <=
-                    (size - rlcOverhead - (*it).m_rlcStatusPduSize))
+                if (elem.m_txQueueSize <= (size - rlcOverhead - elem.m_statusPduSize))
                 {
-                    (*it).m_rlcTransmissionQueueSize = 0;
+                    elem.m_txQueueSize = 0;
                 }
                 else
                 {
-                    (*it).m_rlcTransmissionQueueSize -=
-                        (size - rlcOverhead - (*it).m_rlcStatusPduSize);
+                    elem.m_txQueueSize -= (size - rlcOverhead - elem.m_statusPduSize);
                 }
             }
             return;
@@ -1884,18 +1717,18 @@ void
 MmWaveFlexTtiMacScheduler::UpdateUlRlcBufferInfo(uint16_t rnti, uint16_t size)
 {
     size = size - 2; // remove the minimum RLC overhead
-    std::map<uint16_t, uint32_t>::iterator it = m_ceBsrRxed.find(rnti);
-    if (it != m_ceBsrRxed.end())
+    uint16_t slot = GetUeSlot(rnti);
+    if (slot != NO_SLOT && (m_ueFlags[slot] & UE_BSR))
     {
         NS_LOG_INFO(this << " Update RLC BSR UE " << rnti << " size " << size << " BSR "
-                         << (*it).second);
-        if ((*it).second >= size)
+                         << m_bsr[slot]);
+        if (m_bsr[slot] >= size)
         {
-            (*it).second -= size;
+            m_bsr[slot] -= size;
         }
         else
         {
-            (*it).second = 0;
+            m_bsr[slot] = 0;
         }
     }
     else
@@ -1925,42 +1758,20 @@ MmWaveFlexTtiMacScheduler::DoCschedUeConfigReq(
     NS_LOG_FUNCTION(this << " RNTI " << params.m_rnti << " txMode "
                          << (uint16_t)params.m_transmissionMode);
 
-    if (m_dlHarqProcessesStatus.find(params.m_rnti) == m_dlHarqProcessesStatus.end())
+    uint16_t slot = AddUeSlot(params.m_rnti);
+    if (!(m_ueFlags[slot] & UE_HARQ))
     {
-        // m_dlHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (params.m_rnti, 0));
-        DlHarqProcessesStatus_t dlHarqPrcStatus;
-        dlHarqPrcStatus.resize(m_phyMacConfig->GetNumHarqProcess(), 0);
-        m_dlHarqProcessesStatus.insert(
-            std::pair<uint16_t, DlHarqProcessesStatus_t>(params.m_rnti, dlHarqPrcStatus));
-        DlHarqProcessesTimer_t dlHarqProcessesTimer;
-        dlHarqProcessesTimer.resize(m_phyMacConfig->GetNumHarqProcess(), 0);
-        m_dlHarqProcessesTimer.insert(
-            std::pair<uint16_t, DlHarqProcessesTimer_t>(params.m_rnti, dlHarqProcessesTimer));
-        DlHarqProcessesDciInfoList_t dlHarqTbInfoList;
-        dlHarqTbInfoList.resize(m_phyMacConfig->GetNumHarqProcess());
-        m_dlHarqProcessesDciInfoMap.insert(
-            std::pair<uint16_t, DlHarqProcessesDciInfoList_t>(params.m_rnti, dlHarqTbInfoList));
-        DlHarqRlcPduList_t dlHarqRlcPduList;
-        dlHarqRlcPduList.resize(m_phyMacConfig->GetNumHarqProcess());
-        m_dlHarqProcessesRlcPduMap.insert(
-            std::pair<uint16_t, DlHarqRlcPduList_t>(params.m_rnti, dlHarqRlcPduList));
-    }
-
-    if (m_ulHarqProcessesStatus.find(params.m_rnti) == m_ulHarqProcessesStatus.end())
-    {
-        //              m_ulHarqCurrentProcessId.insert (std::pair <uint16_t,uint8_t > (rnti, 0));
-        UlHarqProcessesStatus_t ulHarqPrcStatus;
-        ulHarqPrcStatus.resize(m_phyMacConfig->GetNumHarqProcess(), 0);
-        m_ulHarqProcessesStatus.insert(
-            std::pair<uint16_t, UlHarqProcessesStatus_t>(params.m_rnti, ulHarqPrcStatus));
-        UlHarqProcessesTimer_t ulHarqProcessesTimer;
-        ulHarqProcessesTimer.resize(m_phyMacConfig->GetNumHarqProcess(), 0);
-        m_ulHarqProcessesTimer.insert(
-            std::pair<uint16_t, UlHarqProcessesTimer_t>(params.m_rnti, ulHarqProcessesTimer));
-        UlHarqProcessesDciInfoList_t ulHarqTbInfoList;
-        ulHarqTbInfoList.resize(m_phyMacConfig->GetNumHarqProcess());
-        m_ulHarqProcessesDciInfoMap.insert(
-            std::pair<uint16_t, UlHarqProcessesDciInfoList_t>(params.m_rnti, ulHarqTbInfoList));
+        for (uint32_t i = slot * m_numHarqProcess; i < (slot + 1u) * m_numHarqProcess; i++)
+        {
+            m_dlHarqStatus[i] = 0;
+            m_dlHarqTimer[i] = 0;
+            m_dlHarqDci[i] = DciInfoElementTdma();
+            m_dlHarqRlcPdu[i].clear();
+            m_ulHarqStatus[i] = 0;
+            m_ulHarqTimer[i] = 0;
+            m_ulHarqDci[i] = DciInfoElementTdma();
+        }
+        m_ueFlags[slot] |= UE_HARQ;
     }
 }
 
@@ -1980,14 +1791,19 @@ MmWaveFlexTtiMacScheduler::DoCschedLcReleaseReq(
     NS_LOG_FUNCTION(this);
     for (uint16_t i = 0; i < params.m_logicalChannelIdentity.size(); i++)
     {
-        std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it =
-            m_rlcBufferReq.begin();
+        std::vector<RlcBufferElem>::iterator it = m_rlcBufferReq.begin();
         while (it != m_rlcBufferReq.end())
         {
-            if (((*it).m_rnti == params.m_rnti) &&
-                ((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity.at(i)))
+            if (it->m_rnti == params.m_rnti &&
+                it->m_lcid == params.m_logicalChannelIdentity.at(i))
             {
                 it = m_rlcBufferReq.erase(it);
+                uint16_t slot = GetUeSlot(params.m_rnti);
+                NS_ASSERT(slot != NO_SLOT && m_rlcLcCount[slot] > 0);
+                if (--m_rlcLcCount[slot] == 0)
+                {
+                    ClearUeState(slot, UE_RLC);
+                }
             }
             else
             {
@@ -2004,24 +1820,12 @@ MmWaveFlexTtiMacScheduler::DoCschedUeReleaseReq(
 {
     NS_LOG_FUNCTION(this << " Release RNTI " << params.m_rnti);
 
-    // m_dlHarqCurrentProcessId.erase (params.m_rnti);
-    m_dlHarqProcessesStatus.erase(params.m_rnti);
-    m_dlHarqProcessesTimer.erase(params.m_rnti);
-    m_dlHarqProcessesDciInfoMap.erase(params.m_rnti);
-    m_dlHarqProcessesRlcPduMap.erase(params.m_rnti);
-    // m_ulHarqCurrentProcessId.erase  (params.m_rnti);
-    m_ulHarqProcessesTimer.erase(params.m_rnti);
-    m_ulHarqProcessesStatus.erase(params.m_rnti);
-    m_ulHarqProcessesDciInfoMap.erase(params.m_rnti);
-    m_ceBsrRxed.erase(params.m_rnti);
-    std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it =
-        m_rlcBufferReq.begin();
+    std::vector<RlcBufferElem>::iterator it = m_rlcBufferReq.begin();
     while (it != m_rlcBufferReq.end())
     {
-        if ((*it).m_rnti == params.m_rnti)
+        if (it->m_rnti == params.m_rnti)
         {
-            NS_LOG_INFO(this << " Erase RNTI " << (*it).m_rnti << " LC "
-                             << (uint16_t)(*it).m_logicalChannelIdentity);
+            NS_LOG_INFO(this << " Erase RNTI " << it->m_rnti << " LC " << (uint16_t)it->m_lcid);
             it = m_rlcBufferReq.erase(it);
         }
         else
@@ -2029,6 +1833,13 @@ MmWaveFlexTtiMacScheduler::DoCschedUeReleaseReq(
             it++;
         }
     }
+    // the DL and UL CQIs expire with their timers
+    uint16_t slot = GetUeSlot(params.m_rnti);
+    if (slot != NO_SLOT)
+    {
+        m_rlcLcCount[slot] = 0;
+        ClearUeState(slot, UE_HARQ | UE_BSR | UE_RLC);
+    }
     if (m_nextRntiUl == params.m_rnti)
     {
         m_nextRntiUl = 0;
@@ -34,6 +34,8 @@
 #include "mmwave-mac-scheduler.h"
 #include "string"
 
+#include <ns3/spectrum-value.h>
+
 #include <set>
 #include <vector>
 
@@ -101,8 +103,32 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
               m_dlTbSize(0),
               m_ulTbSize(0),
               m_dlAllocDone(false),
-              m_ulAllocDone(false)
+              m_ulAllocDone(false),
+              m_active(false)
+        {
+        }
+
+        /**
+         * Resets the info for a new TTI, keeping the capacity of m_rlcPduInfo
+         */
+        void Reset()
         {
+            m_dlMcs = 0;
+            m_ulMcs = 0;
+            m_maxDlBufSize = 0;
+            m_maxUlBufSize = 0;
+            m_maxDlSymbols = 0;
+            m_maxUlSymbols = 0;
+            m_dlSymbols = 0;
+            m_ulSymbols = 0;
+            m_dlSymbolsRetx = 0;
+            m_ulSymbolsRetx = 0;
+            m_dlTbSize = 0;
+            m_ulTbSize = 0;
+            m_rlcPduInfo.clear();
+            m_dlAllocDone = false;
+            m_ulAllocDone = false;
+            m_active = false;
         }
 
         uint8_t m_dlMcs;         // DL MCS
@@ -122,8 +148,73 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
         std::vector<struct RlcPduInfo> m_rlcPduInfo;
         bool m_dlAllocDone;
         bool m_ulAllocDone;
+        bool m_active; // the UE is part of the current TTI
+    };
+
+    /*
+     * Flags of the per-UE state held by a slot of the UE table
+     */
+    enum UeStateFlags : uint8_t
+    {
+        UE_HARQ = 0x01,   // HARQ processes configured by CSCHED_UE_CONFIG
+        UE_DL_CQI = 0x02, // wideband DL CQI available
+        UE_UL_CQI = 0x04, // UL CQI available
+        UE_BSR = 0x08,    // BSR received
+        UE_RLC = 0x10,    // at least one LC in m_rlcBufferReq
+    };
+
+    static const uint16_t NO_SLOT = 0xFFFF;
+
+    /*
+     * Compact copy of the fields of SchedDlRlcBufferReqParameters used by the scheduler
+     */
+    struct RlcBufferElem
+    {
+        uint16_t m_rnti;
+        uint8_t m_lcid;
+        uint16_t m_statusPduSize;
+        uint32_t m_txQueueSize;
+        uint32_t m_retxQueueSize;
+    };
+
+    /*
+     * UL allocation, used to retrieve the RNTI of a UL-CQI
+     */
+    struct UlAllocElem
+    {
+        uint64_t m_sfn; // SfnSf of the allocation, with the start symbol
+        uint16_t m_rnti;
     };
 
+    /**
+     * \brief Returns the slot of a UE in the UE table
+     * \param rnti the RNTI
+     * \return the slot, or NO_SLOT if the UE has no state
+     */
+    uint16_t GetUeSlot(uint16_t rnti) const
+    {
+        return rnti < m_ueSlot.size() ? m_ueSlot[rnti] : NO_SLOT;
+    }
+
+    /**
+     * \brief Returns the slot of a UE in the UE table, assigning one if needed
+     * \param rnti the RNTI
+     * \return the slot
+     */
+    uint16_t AddUeSlot(uint16_t rnti);
+
+    /**
+     * \brief Clears some state of a UE and frees its slot if no state is left
+     * \param slot the slot of the UE
+     * \param flags the UeStateFlags to clear
+     */
+    void ClearUeState(uint16_t slot, uint8_t flags);
+
+    /**
+     * \brief Frees the slots of the UEs without state
+     */
+    void ReleaseIdleUeSlots();
+
     unsigned CalcMinTbSizeNumSym(unsigned mcs, unsigned bufSize, unsigned& tbSize);
 
     uint32_t BsrId2BufferSize(uint8_t val)
@@ -219,48 +310,54 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
     Ptr<MmWaveAmc> m_amc;
 
     /*
-     * Vectors of UE's RLC info
-     */
-    std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBufferReq;
-
-    /*
-     * Map of UE's DL CQI WB received
-     */
-    std::map<uint16_t, uint8_t> m_wbCqiRxed;
-    /*
-     * Map of UE's timers on DL CQI WB received
+     * UE table: per-UE state stored as a struct of arrays, indexed by a dense slot
+     * assigned to the RNTI when it is first seen and recycled when its state is released.
+     * HARQ arrays hold m_numHarqProcess entries per slot, m_ulCqi holds m_numRb entries.
      */
-    std::map<uint16_t, uint32_t> m_wbCqiTimers;
+    std::vector<uint16_t> m_ueSlot;      // slot of each RNTI, NO_SLOT if none
+    std::vector<uint16_t> m_ueRnti;      // RNTI of each slot
+    std::vector<uint8_t> m_ueFlags;      // UeStateFlags of each slot
+    std::vector<uint16_t> m_freeSlots;   // slots available for new UEs
+    std::vector<uint16_t> m_activeRntis; // RNTIs owning a slot, in increasing order
+
+    std::vector<uint8_t> m_wbCqi;       // DL CQI WB received
+    std::vector<uint32_t> m_wbCqiTimer; // timers on DL CQI WB received
+    std::vector<double> m_ulCqi;        // UL-CQI per RBG
+    std::vector<uint32_t> m_ulCqiTimer; // timers on UL-CQI
+    std::vector<uint32_t> m_bsr;        // buffer status reports received
+    std::vector<uint8_t> m_rlcLcCount;  // number of LCs in m_rlcBufferReq
 
-    uint32_t m_cqiTimersThreshold; // # of TTIs for which a CQI can be considered valid
+    // HARQ status
+    //  0: process Id available
+    //  x>0: process Id equal to `x` trasmission count
+    std::vector<uint8_t> m_dlHarqStatus;
+    std::vector<uint8_t> m_dlHarqTimer;
+    std::vector<DciInfoElementTdma> m_dlHarqDci;
+    std::vector<std::vector<struct RlcPduInfo>> m_dlHarqRlcPdu;
+    std::vector<uint8_t> m_ulHarqStatus;
+    std::vector<uint8_t> m_ulHarqTimer;
+    std::vector<DciInfoElementTdma> m_ulHarqDci;
 
     /*
-     * Map of UEs' UL-CQI per RBG
+     * RLC buffers of the UEs' LCs, in the order of their last update
      */
-    struct UlCqiMapElem
-    {
-        UlCqiMapElem(std::vector<double> ulCqi, uint8_t nSym, uint32_t tbs)
-            : m_ueUlCqi(ulCqi),
-              m_numSym(nSym),
-              m_tbSize(tbs)
-        {
-        }
+    std::vector<RlcBufferElem> m_rlcBufferReq;
 
-        std::vector<double> m_ueUlCqi;
-        uint8_t m_numSym;
-        uint32_t m_tbSize;
-    };
+    uint32_t m_cqiTimersThreshold; // # of TTIs for which a CQI can be considered valid
 
-    std::map<uint16_t, struct UlCqiMapElem> m_ueUlCqi;
     /*
-     * Map of UEs' timers on UL-CQI per RBG
+     * Previous UL allocations (used to retrieve info from UL-CQI)
      */
-    std::map<uint16_t, uint32_t> m_ueCqiTimers;
+    std::vector<UlAllocElem> m_ulAllocations;
 
     /*
-     * Map of UE's buffer status reports received
+     * Per-TTI scratch buffers, reused across TTIs
      */
-    std::map<uint16_t, uint32_t> m_ceBsrRxed;
+    std::vector<struct UeSchedInfo> m_ueSchedInfo; // indexed by UE slot
+    std::vector<uint16_t> m_schedRntis;            // UEs of the current TTI
+    std::vector<DlHarqInfo> m_dlHarqInfoUntxed;    // TBs not able to be retransmitted in this TTI
+    std::vector<UlHarqInfo> m_ulHarqInfoUntxed;
+    Ptr<SpectrumValue> m_ulSinr;
 
     uint16_t m_nextRnti;
     uint64_t m_nextRntiDl;
@@ -269,6 +366,7 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
     uint8_t m_tbUid;
     uint32_t m_numChunks;
     uint32_t m_numDataSymbols;
+    uint32_t m_numRb;
 
     MmWaveMacSchedSapProvider* m_macSchedSapProvider;
     MmWaveMacSchedSapUser* m_macSchedSapUser;
@@ -277,25 +375,6 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
 
     MmWaveMacCschedSapProvider::CschedCellConfigReqParameters m_cschedCellConfig;
 
-    struct AllocMapElem
-    {
-        AllocMapElem(std::vector<uint16_t> rntiMap, uint8_t nSym, uint32_t tbs)
-            : m_rntiPerChunk(rntiMap),
-              m_numSym(nSym),
-              m_tbSize(tbs)
-        {
-        }
-
-        std::vector<uint16_t> m_rntiPerChunk;
-        uint8_t m_numSym;
-        uint32_t m_tbSize;
-    };
-    /*
-     * Map of previous allocated UE per RBG
-     * (used to retrieve info from UL-CQI)
-     */
-    std::map<uint32_t, struct AllocMapElem> m_ulAllocationMap;
-
     // HARQ attributes
     /**
      * m_harqOn when false inhibit te HARQ mechanisms (by default active)
@@ -304,25 +383,9 @@ class MmWaveFlexTtiMacScheduler : public MmWaveMacScheduler
     uint8_t m_numHarqProcess;
     uint8_t m_harqTimeout;
 
-    std::map<uint16_t, uint8_t> m_dlHarqCurrentProcessId;
-    // HARQ status
-    //  0: process Id available
-    //  x>0: process Id equal to `x` trasmission count
-    std::map<uint16_t, DlHarqProcessesStatus_t> m_dlHarqProcessesStatus;
-    std::map<uint16_t, DlHarqProcessesTimer_t> m_dlHarqProcessesTimer;
-    std::map<uint16_t, DlHarqProcessesDciInfoList_t> m_dlHarqProcessesDciInfoMap;
-    std::map<uint16_t, DlHarqRlcPduList_t> m_dlHarqProcessesRlcPduMap;
     std::vector<DlHarqInfo> m_dlHarqInfoList; // HARQ retx buffered
     std::vector<UlHarqInfo> m_ulHarqInfoList; // HARQ retx buffered
 
-    std::map<uint16_t, uint8_t> m_ulHarqCurrentProcessId;
-    // HARQ status
-    //  0: process Id available
-    //  x>0: process Id equal to `x` trasmission count
-    std::map<uint16_t, UlHarqProcessesStatus_t> m_ulHarqProcessesStatus;
-    std::map<uint16_t, UlHarqProcessesTimer_t> m_ulHarqProcessesTimer;
-    std::map<uint16_t, UlHarqProcessesDciInfoList_t> m_ulHarqProcessesDciInfoMap;
-
     static const unsigned m_macHdrSize;
     static const unsigned m_subHdrSize;
     static const unsigned m_rlcHdrSize;
@@ -0,0 +1,353 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/eps-bearer.h"
+#include "ns3/mmwave-mac-csched-sap.h"
+#include "ns3/mmwave-mac-sched-sap.h"
+#include "ns3/mmwave-mac-scheduler.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * \file mmwave-mac-scheduler-test.cc
+ * \ingroup test
+ *
+ * \brief Drives the flex-TTI MAC schedulers through their SAP interfaces with a fixed
+ * sequence of RLC buffer updates, DL CQIs, BSRs, UL CQIs and HARQ feedback (including
+ * NACKs, so that DL and UL retransmissions are scheduled), and compares a checksum of
+ * all the DCIs they allocate with the value obtained with the reference implementation.
+ * The scenario is the one of the mmwave-scheduler-benchmark example, with two bearers
+ * configured for each UE. MmWaveFlexTtiMaxWeightMacScheduler is not covered: it only
+ * schedules the PDCP packets listed in the RLC buffer reports, and aborts in
+ * MmWaveAmc::GetMinNumSymForTbSize when such a backlog exceeds a slot.
+ */
+
+/**
+ * \brief Collects the scheduling decisions and turns them into the feedback of the next slot
+ */
+class MmWaveChecksumSchedSapUser : public MmWaveMacSchedSapUser
+{
+  public:
+    MmWaveChecksumSchedSapUser()
+        : m_checksum(14695981039346656037ULL),
+          m_dataTtis(0)
+    {
+    }
+
+    void SchedConfigInd(const struct SchedConfigIndParameters& params) override
+    {
+        for (const TtiAllocInfo& tti : params.m_slotAllocInfo.m_ttiAllocInfo)
+        {
+            if (tti.m_ttiType == TtiAllocInfo::CTRL)
+            {
+                continue;
+            }
+            const DciInfoElementTdma& dci = tti.m_dci;
+            Hash(tti.m_tddMode);
+            Hash(dci.m_rnti);
+            Hash(dci.m_symStart);
+            Hash(dci.m_numSym);
+            Hash(dci.m_mcs);
+            Hash(dci.m_tbSize);
+            Hash(dci.m_harqProcess);
+            Hash(dci.m_rv);
+            m_dataTtis++;
+            if (tti.m_tddMode == TtiAllocInfo::DL_slotAllocInfo)
+            {
+                m_dlDci.push_back(dci);
+            }
+            else
+            {
+                m_ulDci.push_back(dci);
+            }
+        }
+    }
+
+    /**
+     * Mixes a value into the checksum (FNV-1a)
+     *
+     * \param value the value
+     */
+    void Hash(uint64_t value)
+    {
+        m_checksum = (m_checksum ^ value) * 1099511628211ULL;
+    }
+
+    uint64_t m_checksum;                     //!< checksum of the allocations
+    uint64_t m_dataTtis;                     //!< number of data TTIs allocated
+    std::vector<DciInfoElementTdma> m_dlDci; //!< DL DCIs waiting for HARQ feedback
+    std::vector<DciInfoElementTdma> m_ulDci; //!< UL DCIs waiting for HARQ feedback and UL CQI
+};
+
+/**
+ * \brief Ignores the CSCHED confirmations
+ */
+class MmWaveChecksumCschedSapUser : public MmWaveMacCschedSapUser
+{
+  public:
+    void CschedCellConfigCnf(const struct CschedCellConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedUeConfigCnf(const struct CschedUeConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedLcConfigCnf(const struct CschedLcConfigCnfParameters& params) override
+    {
+    }
+
+    void CschedLcReleaseCnf(const struct CschedLcReleaseCnfParameters& params) override
+    {
+    }
+
+    void CschedUeReleaseCnf(const struct CschedUeReleaseCnfParameters& params) override
+    {
+    }
+
+    void CschedUeConfigUpdateInd(const struct CschedUeConfigUpdateIndParameters& params) override
+    {
+    }
+
+    void CschedCellConfigUpdateInd(
+        const struct CschedCellConfigUpdateIndParameters& params) override
+    {
+    }
+};
+
+/**
+ * \brief Checks the allocations of a scheduler against a reference checksum
+ */
+class MmWaveMacSchedulerChecksumTestCase : public TestCase
+{
+  public:
+    /**
+     * \param schedulerType the TypeId name of the scheduler
+     * \param expectedTtis the number of data TTIs allocated by the reference implementation
+     * \param expectedChecksum the checksum of the reference implementation
+     */
+    MmWaveMacSchedulerChecksumTestCase(std::string schedulerType,
+                                       uint64_t expectedTtis,
+                                       uint64_t expectedChecksum)
+        : TestCase("Allocations of " + schedulerType),
+          m_schedulerType(schedulerType),
+          m_expectedTtis(expectedTtis),
+          m_expectedChecksum(expectedChecksum)
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    std::string m_schedulerType; //!< the TypeId name of the scheduler
+    uint64_t m_expectedTtis;     //!< the expected number of data TTIs
+    uint64_t m_expectedChecksum; //!< the expected checksum
+};
+
+void
+MmWaveMacSchedulerChecksumTestCase::DoRun()
+{
+    const uint16_t numUes = 20;
+    const uint32_t numSlots = 500;
+    const double nackProbability = 0.1;
+
+    Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon>();
+    ObjectFactory factory;
+    factory.SetTypeId(m_schedulerType);
+    Ptr<MmWaveMacScheduler> scheduler = factory.Create<MmWaveMacScheduler>();
+
+    MmWaveChecksumSchedSapUser schedSapUser;
+    MmWaveChecksumCschedSapUser cschedSapUser;
+    scheduler->ConfigureCommonParameters(config);
+    scheduler->SetMacSchedSapUser(&schedSapUser);
+    scheduler->SetMacCschedSapUser(&cschedSapUser);
+    MmWaveMacSchedSapProvider* sched = scheduler->GetMacSchedSapProvider();
+    MmWaveMacCschedSapProvider* csched = scheduler->GetMacCschedSapProvider();
+
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    MmWaveMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    csched->CschedCellConfigReq(cellConfig);
+    for (uint16_t rnti = 1; rnti <= numUes; rnti++)
+    {
+        MmWaveMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        // two bearers per UE, as configured by the eNB MAC
+        MmWaveMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        for (uint8_t lcid = 3; lcid <= 4; lcid++)
+        {
+            LogicalChannelConfigListElement_s lc;
+            lc.m_logicalChannelIdentity = lcid;
+            lc.m_logicalChannelGroup = 1;
+            lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+            lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+            lc.m_qci = EpsBearer::NGBR_VIDEO_TCP_DEFAULT;
+            lcConfig.m_logicalChannelConfigList.push_back(lc);
+        }
+        csched->CschedLcConfigReq(lcConfig);
+    }
+
+    const uint32_t slotsPerSubframe = config->GetSlotsPerSubframe();
+    const uint32_t subframesPerFrame = config->GetSubframesPerFrame();
+    const uint32_t cqiPeriod = 40; // slots between two DL CQIs of the same UE
+    const uint32_t numRb = config->GetNumRb();
+
+    std::vector<DciInfoElementTdma> dlFeedback;
+    std::vector<DciInfoElementTdma> ulFeedback;
+    SfnSf prevSfn;
+
+    for (uint32_t slot = 0; slot < numSlots; slot++)
+    {
+        SfnSf sfn(slot / (slotsPerSubframe * subframesPerFrame),
+                  (slot / slotsPerSubframe) % subframesPerFrame,
+                  slot % slotsPerSubframe);
+
+        // new DL data for a few UEs
+        for (uint16_t i = 0; i < 1 + numUes / 20; i++)
+        {
+            MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rng->GetInteger(1, numUes);
+            rlc.m_logicalChannelIdentity = 3 + rng->GetInteger(0, 1);
+            rlc.m_rlcTransmissionQueueSize = rng->GetInteger(100, 20000);
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = rng->GetValue() < 0.1 ? 4 : 0;
+            rlc.m_arrivalRate = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+
+        // periodic wideband DL CQIs, staggered between the UEs
+        MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = sfn;
+        for (uint16_t rnti = 1 + slot % cqiPeriod; rnti <= numUes; rnti += cqiPeriod)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = rng->GetInteger(1, 15);
+            cqi.m_wbPmi = 0;
+            dlCqi.m_cqiList.push_back(cqi);
+        }
+        if (!dlCqi.m_cqiList.empty())
+        {
+            sched->SchedDlCqiInfoReq(dlCqi);
+        }
+
+        // BSRs of a few UEs
+        MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = sfn;
+        for (uint16_t i = 0; i < 1 + numUes / 20; i++)
+        {
+            MacCeElement ce;
+            ce.m_rnti = rng->GetInteger(1, numUes);
+            ce.m_macCeType = MacCeElement::BSR;
+            for (uint8_t lcg = 0; lcg < 4; lcg++)
+            {
+                ce.m_macCeValue.m_bufferStatus.push_back(lcg == 0 ? rng->GetInteger(0, 40) : 0);
+            }
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedUlMacCtrlInfoReq(bsr);
+
+        // UL CQIs and HARQ feedback of the UL transmissions scheduled in the previous slot
+        MmWaveMacSchedSapProvider::SchedTriggerReqParameters trigger;
+        trigger.m_snfSf = sfn;
+        for (const DciInfoElementTdma& dci : ulFeedback)
+        {
+            MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+            ulCqi.m_sfnSf = prevSfn;
+            ulCqi.m_sfnSf.m_symStart = dci.m_symStart;
+            ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+            ulCqi.m_ulCqi.m_sinr.assign(numRb, rng->GetValue(1.0, 1000.0));
+            sched->SchedUlCqiInfoReq(ulCqi);
+
+            UlHarqInfo harq;
+            harq.m_rnti = dci.m_rnti;
+            harq.m_harqProcessId = dci.m_harqProcess;
+            harq.m_numRetx = dci.m_rv;
+            harq.m_receptionStatus =
+                rng->GetValue() < nackProbability ? UlHarqInfo::NotOk : UlHarqInfo::Ok;
+            trigger.m_ulHarqInfoList.push_back(harq);
+        }
+
+        // HARQ feedback of the DL transmissions scheduled in the previous slot
+        for (const DciInfoElementTdma& dci : dlFeedback)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci.m_rnti;
+            harq.m_harqProcessId = dci.m_harqProcess;
+            harq.m_numRetx = dci.m_rv;
+            harq.m_harqStatus =
+                rng->GetValue() < nackProbability ? DlHarqInfo::NACK : DlHarqInfo::ACK;
+            trigger.m_dlHarqInfoList.push_back(harq);
+        }
+
+        schedSapUser.m_dlDci.clear();
+        schedSapUser.m_ulDci.clear();
+        sched->SchedTriggerReq(trigger);
+        dlFeedback.swap(schedSapUser.m_dlDci);
+        ulFeedback.swap(schedSapUser.m_ulDci);
+        prevSfn = sfn;
+    }
+    scheduler->Dispose();
+
+    NS_TEST_EXPECT_MSG_EQ(schedSapUser.m_dataTtis, m_expectedTtis, "Wrong number of data TTIs");
+    NS_TEST_EXPECT_MSG_EQ(schedSapUser.m_checksum,
+                          m_expectedChecksum,
+                          "Allocations differ from the reference, checksum 0x"
+                              << std::hex << schedSapUser.m_checksum << std::dec);
+}
+
+/**
+ * \brief MAC scheduler test suite
+ */
+class MmWaveMacSchedulerTestSuite : public TestSuite
+{
+  public:
+    MmWaveMacSchedulerTestSuite()
+        : TestSuite("mmwave-mac-scheduler", UNIT)
+    {
+        // reference values obtained with the std::map based implementation of the schedulers
+        AddTestCase(new MmWaveMacSchedulerChecksumTestCase("ns3::MmWaveFlexTtiMacScheduler",
+                                                           5986,
+                                                           0xcd50bb08108254f1ULL),
+                    QUICK);
+        AddTestCase(new MmWaveMacSchedulerChecksumTestCase("ns3::MmWaveFlexTtiPfMacScheduler",
+                                                           3048,
+                                                           0xf0af80a319fa0dd4ULL),
+                    EXTENSIVE);
+        AddTestCase(new MmWaveMacSchedulerChecksumTestCase("ns3::MmWaveFlexTtiMaxRateMacScheduler",
+                                                           891,
+                                                           0xb9ae5e22c903fbf9ULL),
+                    QUICK);
+    }
+};
+
+static MmWaveMacSchedulerTestSuite g_mmwaveMacSchedulerTestSuite; //!< MAC scheduler test suite
@@ -0,0 +1,228 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "ns3/mmwave-trace-writer.h"
+#include "ns3/test.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+ * \file mmwave-trace-writer-test.cc
+ * \ingroup test
+ *
+ * \brief Writes binary traces with MmWaveTraceWriter and reads them back with
+ * MmWaveTraceReader, with and without compression. The number of records is chosen
+ * so that the last block is only partially filled. Files with a bad magic, version or
+ * record size must be rejected by the reader.
+ */
+
+/**
+ * \brief Binary trace round trip testcase
+ */
+class MmWaveTraceWriterTestCase : public TestCase
+{
+  public:
+    /**
+     * \param compress whether the blocks are compressed
+     */
+    MmWaveTraceWriterTestCase(bool compress)
+        : TestCase(compress ? "Binary trace round trip, compressed"
+                            : "Binary trace round trip, uncompressed"),
+          m_compress(compress)
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param i the index of the record
+     * \return the i-th record written by the test
+     */
+    static RxPacketTraceRecord CreateRecord(uint32_t i);
+
+    bool m_compress; //!< whether the blocks are compressed
+};
+
+RxPacketTraceRecord
+MmWaveTraceWriterTestCase::CreateRecord(uint32_t i)
+{
+    RxPacketTraceRecord record = {};
+    record.m_time = i * 1e-4;
+    record.m_sinrDb = 10.0 + (i % 17);
+    record.m_tbler = 1.0 / (i + 1);
+    record.m_cellId = i % 3;
+    record.m_frameNum = i / 80;
+    record.m_tbSize = 100 * i;
+    record.m_rnti = i % 50;
+    record.m_uplink = i % 2;
+    record.m_slotNum = i % 8;
+    record.m_mcs = i % 28;
+    return record;
+}
+
+void
+MmWaveTraceWriterTestCase::DoRun()
+{
+    // 10 records fit in a block, 1234 records end with a partial block of 4 records
+    const uint32_t blockSize = 10 * sizeof(RxPacketTraceRecord);
+    const uint32_t count = 1234;
+    std::string fileName = CreateTempDirFilename("mmwave-trace-writer-test.bin");
+
+    {
+        MmWaveTraceWriter writer;
+        writer.Open(fileName, RX_PACKET_TRACE, sizeof(RxPacketTraceRecord), blockSize, m_compress);
+        NS_TEST_ASSERT_MSG_EQ(writer.IsOpen(), true, "writer not open");
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            writer.Write(CreateRecord(i));
+        }
+        writer.Close();
+        NS_TEST_ASSERT_MSG_EQ(writer.IsOpen(), false, "writer not closed");
+    }
+
+    MmWaveTraceReader reader;
+    NS_TEST_ASSERT_MSG_EQ(reader.Open(fileName), true, "trace not readable");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetRecordType(), RX_PACKET_TRACE, "wrong record type");
+    NS_TEST_ASSERT_MSG_EQ(reader.GetRecordSize(), sizeof(RxPacketTraceRecord), "wrong size");
+    RxPacketTraceRecord record;
+    uint32_t read = 0;
+    while (reader.Read(&record))
+    {
+        RxPacketTraceRecord expected = CreateRecord(read);
+        NS_TEST_ASSERT_MSG_EQ(std::memcmp(&record, &expected, sizeof(record)),
+                              0,
+                              "record " << read << " differs");
+        read++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(read, count, "wrong number of records");
+
+    if (m_compress && MmWaveTraceWriter::IsCompressionSupported())
+    {
+        // the records are very regular, the compressed file must be smaller than the raw one
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        NS_TEST_EXPECT_MSG_LT(static_cast<uint64_t>(file.tellg()),
+                              static_cast<uint64_t>(count) * sizeof(RxPacketTraceRecord),
+                              "blocks not compressed");
+    }
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \brief Checks that the reader rejects invalid files
+ */
+class MmWaveTraceReaderHeaderTestCase : public TestCase
+{
+  public:
+    MmWaveTraceReaderHeaderTestCase()
+        : TestCase("Binary trace header validation")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Writes a file made of a header and of a block of zeroes
+     *
+     * \param fileName the file
+     * \param magic the magic of the header
+     * \param recordType the record type of the header
+     * \param recordSize the record size of the header
+     */
+    void WriteFile(std::string fileName,
+                   const char* magic,
+                   uint32_t recordType,
+                   uint32_t recordSize) const;
+};
+
+void
+MmWaveTraceReaderHeaderTestCase::WriteFile(std::string fileName,
+                                           const char* magic,
+                                           uint32_t recordType,
+                                           uint32_t recordSize) const
+{
+    MmWaveTraceWriter::FileHeader header;
+    std::memcpy(header.m_magic, magic, sizeof(header.m_magic));
+    header.m_recordType = recordType;
+    header.m_recordSize = recordSize;
+    MmWaveTraceWriter::BlockHeader block;
+    block.m_rawSize = 64;
+    block.m_storedSize = 64;
+    char payload[64] = {};
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&block), sizeof(block));
+    file.write(payload, sizeof(payload));
+}
+
+void
+MmWaveTraceReaderHeaderTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("mmwave-trace-reader-test.bin");
+
+    WriteFile(fileName, MmWaveTraceWriter::MAGIC, SCHED_ALLOC_TRACE, sizeof(PhyTxTraceRecord));
+    {
+        MmWaveTraceReader reader;
+        NS_TEST_ASSERT_MSG_EQ(reader.Open(fileName), true, "valid file rejected");
+        PhyTxTraceRecord record;
+        uint32_t read = 0;
+        while (reader.Read(&record))
+        {
+            read++;
+        }
+        NS_TEST_ASSERT_MSG_EQ(read, 64 / sizeof(PhyTxTraceRecord), "wrong number of records");
+    }
+
+    WriteFile(fileName, "NOTATRC1", RX_PACKET_TRACE, sizeof(RxPacketTraceRecord));
+    NS_TEST_EXPECT_MSG_EQ(MmWaveTraceReader().Open(fileName), false, "bad magic accepted");
+
+    WriteFile(fileName, "MMWTRC99", RX_PACKET_TRACE, sizeof(RxPacketTraceRecord));
+    NS_TEST_EXPECT_MSG_EQ(MmWaveTraceReader().Open(fileName), false, "bad version accepted");
+
+    WriteFile(fileName, MmWaveTraceWriter::MAGIC, RX_PACKET_TRACE, 0);
+    NS_TEST_EXPECT_MSG_EQ(MmWaveTraceReader().Open(fileName), false, "empty records accepted");
+
+    WriteFile(fileName, MmWaveTraceWriter::MAGIC, RX_PACKET_TRACE, sizeof(PhyTxTraceRecord));
+    NS_TEST_EXPECT_MSG_EQ(MmWaveTraceReader().Open(fileName), false, "wrong size accepted");
+
+    WriteFile(fileName, MmWaveTraceWriter::MAGIC, 42, sizeof(PhyTxTraceRecord));
+    NS_TEST_EXPECT_MSG_EQ(MmWaveTraceReader().Open(fileName), false, "unknown type accepted");
+
+    std::remove(fileName.c_str());
+}
+
+/**
+ * \brief Binary trace test suite
+ */
+class MmWaveTraceWriterTestSuite : public TestSuite
+{
+  public:
+    MmWaveTraceWriterTestSuite()
+        : TestSuite("mmwave-trace-writer", UNIT)
+    {
+        AddTestCase(new MmWaveTraceWriterTestCase(false), QUICK);
+        AddTestCase(new MmWaveTraceWriterTestCase(true), QUICK);
+        AddTestCase(new MmWaveTraceReaderHeaderTestCase(), QUICK);
+    }
+};
+
+static MmWaveTraceWriterTestSuite g_mmwaveTraceWriterTestSuite; //!< binary trace test suite
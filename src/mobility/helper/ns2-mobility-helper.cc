@@ -38,12 +38,15 @@
 
 #include "ns2-mobility-helper.h"
 
+#include "ns3/abort.h"
 #include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
 #include "ns3/node.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/simulator.h"
 
+#include <filesystem>
 #include <fstream>
 #include <map>
 #include <sstream>
@@ -189,6 +192,14 @@ static bool IsSchedSetPos(ParseResult pr);
  */
 static bool IsSchedMobilityPos(ParseResult pr);
 
+/**
+ * Stop the last movement of a node if its destination is not reached at
+ * the time of a new movement
+ * \param point last movement (updated with the actually reached position)
+ * \param at new movement time
+ */
+static void StopMovement(DestinationPoint& point, double at);
+
 /**
  * Set waypoints and speed for movement.
  * \param model mobility model
@@ -197,6 +208,7 @@ static bool IsSchedMobilityPos(ParseResult pr);
  * \param xFinalPosition final position (X axis)
  * \param yFinalPosition final position (Y axis)
  * \param speed movement speed
+ * \param start simulation time of the time 0 of the trace
  * \returns A descriptor of the movement
  */
 static DestinationPoint SetMovement(Ptr<ConstantVelocityMobilityModel> model,
@@ -204,7 +216,8 @@ static DestinationPoint SetMovement(Ptr<ConstantVelocityMobilityModel> model,
                                     double at,
                                     double xFinalPosition,
                                     double yFinalPosition,
-                                    double speed);
+                                    double speed,
+                                    Time start);
 
 /**
  * Set initial position for a node
@@ -231,7 +244,8 @@ static Vector SetSchedPosition(Ptr<ConstantVelocityMobilityModel> model,
                                double coordVal);
 
 Ns2MobilityHelper::Ns2MobilityHelper(std::string filename)
-    : m_filename(filename)
+    : m_filename(filename),
+      m_window(0)
 {
     std::ifstream file(m_filename, std::ios::in);
     if (!(file.is_open()))
@@ -430,21 +444,7 @@ Ns2MobilityHelper::ConfigNodesMovements(const ObjectStore& store) const
                  */
                 if (IsSchedMobilityPos(pr))
                 {
-                    if (last_pos[iNodeId].m_targetArrivalTime > at)
-                    {
-                        NS_LOG_LOGIC("Did not reach a destination! stoptime = "
-                                     << last_pos[iNodeId].m_targetArrivalTime << ", at = " << at);
-                        double actuallytraveled = at - last_pos[iNodeId].m_travelStartTime;
-                        Vector reached = Vector(last_pos[iNodeId].m_startPosition.x +
-                                                    last_pos[iNodeId].m_speed.x * actuallytraveled,
-                                                last_pos[iNodeId].m_startPosition.y +
-                                                    last_pos[iNodeId].m_speed.y * actuallytraveled,
-                                                0);
-                        NS_LOG_LOGIC("Final point = " << last_pos[iNodeId].m_finalPosition
-                                                      << ", actually reached = " << reached);
-                        last_pos[iNodeId].m_stopEvent.Cancel();
-                        last_pos[iNodeId].m_finalPosition = reached;
-                    }
+                    StopMovement(last_pos[iNodeId], at);
                     //                                     last position     time  X coord     Y
                     //                                     coord      velocity
                     last_pos[iNodeId] = SetMovement(model,
@@ -452,7 +452,8 @@ Ns2MobilityHelper::ConfigNodesMovements(const ObjectStore& store) const
                                                     at,
                                                     pr.dvals[5],
                                                     pr.dvals[6],
-                                                    pr.dvals[7]);
+                                                    pr.dvals[7],
+                                                    Simulator::Now());
 
                     // Log new position
                     NS_LOG_DEBUG("Positions after parse for node "
@@ -777,14 +778,36 @@ IsSchedMobilityPos(ParseResult pr)
            pr.tokens[4] == NS2_SETDEST; // and has setdest
 }
 
+void
+StopMovement(DestinationPoint& point, double at)
+{
+    if (point.m_targetArrivalTime > at)
+    {
+        NS_LOG_LOGIC("Did not reach a destination! stoptime = " << point.m_targetArrivalTime
+                                                                 << ", at = " << at);
+        double actuallytraveled = at - point.m_travelStartTime;
+        Vector reached = Vector(point.m_startPosition.x + point.m_speed.x * actuallytraveled,
+                                point.m_startPosition.y + point.m_speed.y * actuallytraveled,
+                                0);
+        NS_LOG_LOGIC("Final point = " << point.m_finalPosition
+                                      << ", actually reached = " << reached);
+        point.m_stopEvent.Cancel();
+        point.m_finalPosition = reached;
+    }
+}
+
 DestinationPoint
 SetMovement(Ptr<ConstantVelocityMobilityModel> model,
             Vector last_pos,
             double at,
             double xFinalPosition,
             double yFinalPosition,
-            double speed)
+            double speed,
+            Time start)
 {
+    // the times of the trace are relative to start
+    Time now = Simulator::Now();
+
     DestinationPoint retval;
     retval.m_startPosition = last_pos;
     retval.m_finalPosition = last_pos;
@@ -794,7 +817,7 @@ SetMovement(Ptr<ConstantVelocityMobilityModel> model,
     if (speed == 0)
     {
         // We have to maintain last position, and stop the movement
-        retval.m_stopEvent = Simulator::Schedule(Seconds(at),
+        retval.m_stopEvent = Simulator::Schedule(start + Seconds(at) - now,
                                                  &ConstantVelocityMobilityModel::SetVelocity,
                                                  model,
                                                  Vector(0, 0, 0));
@@ -822,11 +845,11 @@ SetMovement(Ptr<ConstantVelocityMobilityModel> model,
         NS_LOG_DEBUG("Calculated Speed: X=" << xSpeed << " Y=" << ySpeed << " Z=" << zSpeed);
 
         // Set the Values
-        Simulator::Schedule(Seconds(at),
+        Simulator::Schedule(start + Seconds(at) - now,
                             &ConstantVelocityMobilityModel::SetVelocity,
                             model,
                             Vector(xSpeed, ySpeed, zSpeed));
-        retval.m_stopEvent = Simulator::Schedule(Seconds(at + time),
+        retval.m_stopEvent = Simulator::Schedule(start + Seconds(at + time) - now,
                                                  &ConstantVelocityMobilityModel::SetVelocity,
                                                  model,
                                                  Vector(0, 0, 0));
@@ -871,6 +894,433 @@ SetSchedPosition(Ptr<ConstantVelocityMobilityModel> model,
     return position;
 }
 
+/**
+ * The trace of the streaming mode of Ns2MobilityHelper, read during the
+ * simulation with its binary index.
+ *
+ * The index starts with a header (the magic string "ns2index", the size
+ * and the modification time of the trace, and the number of nodes), then
+ * has one entry per node in the order of their first line in the trace
+ * (the node id, the number of initial positions, the number of scheduled
+ * lines and the position of their offsets in the index), then the offsets
+ * in the trace of the initial positions and of the scheduled lines of each
+ * node, in the order of the trace.
+ */
+class Ns2MobilityStream : public SimpleRefCount<Ns2MobilityStream>
+{
+  public:
+    /**
+     * Open the trace and its index, building the index if it is missing
+     * or outdated
+     * \param filename the trace file
+     * \param indexFilename the index file
+     * \param window the lookahead of the movements scheduled for each node
+     */
+    Ns2MobilityStream(std::string filename, std::string indexFilename, Time window);
+
+    /**
+     * Set the initial positions of a node, and register it to be read
+     * \param entry the index of the node in the index file
+     * \param model the mobility model of the node
+     */
+    void AddNode(uint32_t entry, Ptr<ConstantVelocityMobilityModel> model);
+
+    /**
+     * \param entry the index of a node in the index file
+     * \returns the id of the node
+     */
+    uint32_t GetNodeId(uint32_t entry) const;
+
+    /**
+     * \returns the number of nodes of the index file
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * Schedule the movements of the registered nodes within the window
+     */
+    void Start();
+
+  private:
+    /**
+     * Schedule the next movements of a node within the window, and the
+     * next call when its following line gets within the window
+     * \param node the node
+     */
+    void Refill(uint32_t node);
+
+    /**
+     * Write the index of the trace
+     * \param size the size of the trace
+     * \param time the modification time of the trace
+     */
+    void BuildIndex(uint64_t size, int64_t time);
+
+    /**
+     * Read a line of the trace
+     * \param offset the offset of the line
+     * \returns the line
+     */
+    std::string ReadLine(uint64_t offset);
+
+    /**
+     * Read offsets from the index
+     * \param position the position of the offsets in the index
+     * \param count the number of offsets
+     * \returns the offsets
+     */
+    std::vector<uint64_t> ReadOffsets(uint64_t position, uint64_t count);
+
+    /// An entry of the index
+    struct IndexEntry
+    {
+        uint32_t m_id;          //!< the node id
+        uint32_t m_nInitial;    //!< the number of initial positions
+        uint64_t m_nScheduled;  //!< the number of scheduled lines
+        uint64_t m_position;    //!< the position of the offsets in the index
+    };
+
+    /// The state of a node being read
+    struct NodeStream
+    {
+        Ptr<ConstantVelocityMobilityModel> m_model; //!< the mobility model
+        DestinationPoint m_last;                    //!< the last movement scheduled
+        Vector m_position;                //!< the position set by the scheduled set positions
+        uint64_t m_next;                  //!< the position of the next offsets in the index
+        uint64_t m_remaining;             //!< the number of lines still to read
+        std::vector<uint64_t> m_offsets;  //!< the offsets read ahead from the index
+        size_t m_current;                 //!< the next line in m_offsets
+    };
+
+    static constexpr size_t READ_AHEAD = 64; //!< the number of offsets read at once per node
+
+    std::string m_filename;          //!< the trace file
+    std::string m_indexFilename;     //!< the index file
+    Time m_window;                   //!< the lookahead of the movements
+    Time m_start;                    //!< the simulation time of the time 0 of the trace
+    std::ifstream m_trace;           //!< the trace
+    std::ifstream m_index;           //!< the index
+    char m_traceBuffer[512];         //!< the small buffer of the trace, read at random
+    std::vector<IndexEntry> m_entries; //!< the entries of the index
+    std::vector<NodeStream> m_nodes;   //!< the registered nodes
+};
+
+Ns2MobilityStream::Ns2MobilityStream(std::string filename, std::string indexFilename, Time window)
+    : m_filename(filename),
+      m_indexFilename(indexFilename),
+      m_window(window),
+      m_start(Simulator::Now())
+{
+    NS_LOG_FUNCTION(this << filename << indexFilename << window);
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(m_filename, ec);
+    NS_ABORT_MSG_IF(ec, "Could not read the size of the trace file " << m_filename);
+    int64_t time = std::filesystem::last_write_time(m_filename, ec).time_since_epoch().count();
+    NS_ABORT_MSG_IF(ec, "Could not read the modification time of the trace file " << m_filename);
+
+    for (uint32_t attempt = 0; attempt < 2; ++attempt)
+    {
+        m_index.open(m_indexFilename, std::ios::in | std::ios::binary);
+        char magic[8] = {};
+        uint64_t indexSize = 0;
+        int64_t indexTime = 0;
+        uint32_t nNodes = 0;
+        m_index.read(magic, sizeof(magic));
+        m_index.read(reinterpret_cast<char*>(&indexSize), sizeof(indexSize));
+        m_index.read(reinterpret_cast<char*>(&indexTime), sizeof(indexTime));
+        m_index.read(reinterpret_cast<char*>(&nNodes), sizeof(nNodes));
+        if (m_index && std::string(magic, sizeof(magic)) == "ns2index" && indexSize == size &&
+            indexTime == time)
+        {
+            m_entries.resize(nNodes);
+            for (auto& entry : m_entries)
+            {
+                m_index.read(reinterpret_cast<char*>(&entry.m_id), sizeof(entry.m_id));
+                m_index.read(reinterpret_cast<char*>(&entry.m_nInitial), sizeof(entry.m_nInitial));
+                m_index.read(reinterpret_cast<char*>(&entry.m_nScheduled),
+                             sizeof(entry.m_nScheduled));
+                m_index.read(reinterpret_cast<char*>(&entry.m_position), sizeof(entry.m_position));
+            }
+            NS_ABORT_MSG_IF(!m_index, "Corrupted index file " << m_indexFilename);
+            break;
+        }
+        NS_ABORT_MSG_IF(attempt > 0, "Could not read the index file " << m_indexFilename);
+        m_index.close();
+        m_index.clear();
+        BuildIndex(size, time);
+    }
+
+    m_trace.rdbuf()->pubsetbuf(m_traceBuffer, sizeof(m_traceBuffer));
+    m_trace.open(m_filename, std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_IF(!m_trace.is_open(), "Could not open trace file " << m_filename);
+}
+
+void
+Ns2MobilityStream::BuildIndex(uint64_t size, int64_t time)
+{
+    NS_LOG_FUNCTION(this << size << time);
+    std::ifstream file(m_filename, std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_IF(!file.is_open(), "Could not open trace file " << m_filename);
+
+    // the offsets of the lines of each node, in the order of their first line
+    std::map<int, uint32_t> entries;
+    std::vector<std::pair<std::vector<uint64_t>, std::vector<uint64_t>>> offsets;
+    m_entries.clear();
+    uint64_t offset = 0;
+    std::string line;
+    while (getline(file, line))
+    {
+        uint64_t lineOffset = offset;
+        offset += line.size() + 1;
+
+        // ignore empty lines
+        if (line.empty())
+        {
+            continue;
+        }
+
+        ParseResult pr = ParseNs2Line(line); // Parse line and obtain tokens
+        if (pr.tokens.size() != 4 && pr.tokens.size() != 7 && pr.tokens.size() != 8)
+        {
+            NS_LOG_ERROR("Line has not correct number of parameters (corrupted file?): "
+                         << line << "\n");
+            continue;
+        }
+        int iNodeId = GetNodeIdInt(pr);
+        if (iNodeId == -1)
+        {
+            NS_LOG_ERROR("Node number couldn't be obtained (corrupted file?): " << line << "\n");
+            continue;
+        }
+        auto it = entries.find(iNodeId);
+        if (it == entries.end())
+        {
+            it = entries.emplace(iNodeId, m_entries.size()).first;
+            m_entries.push_back({static_cast<uint32_t>(iNodeId), 0, 0, 0});
+            offsets.emplace_back();
+        }
+        if (IsSetInitialPos(pr))
+        {
+            offsets[it->second].first.push_back(lineOffset);
+        }
+        else if (pr.tokens.size() != 4)
+        {
+            offsets[it->second].second.push_back(lineOffset);
+        }
+    }
+
+    std::ofstream index(m_indexFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!index.is_open(), "Could not write the index file " << m_indexFilename);
+    uint32_t nNodes = m_entries.size();
+    uint64_t position = 8 + sizeof(size) + sizeof(time) + sizeof(nNodes) +
+                        m_entries.size() * (2 * sizeof(uint32_t) + 2 * sizeof(uint64_t));
+    index.write("ns2index", 8);
+    index.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    index.write(reinterpret_cast<const char*>(&time), sizeof(time));
+    index.write(reinterpret_cast<const char*>(&nNodes), sizeof(nNodes));
+    for (uint32_t i = 0; i < m_entries.size(); ++i)
+    {
+        IndexEntry& entry = m_entries[i];
+        entry.m_nInitial = offsets[i].first.size();
+        entry.m_nScheduled = offsets[i].second.size();
+        entry.m_position = position;
+        position += (entry.m_nInitial + entry.m_nScheduled) * sizeof(uint64_t);
+        index.write(reinterpret_cast<const char*>(&entry.m_id), sizeof(entry.m_id));
+        index.write(reinterpret_cast<const char*>(&entry.m_nInitial), sizeof(entry.m_nInitial));
+        index.write(reinterpret_cast<const char*>(&entry.m_nScheduled),
+                    sizeof(entry.m_nScheduled));
+        index.write(reinterpret_cast<const char*>(&entry.m_position), sizeof(entry.m_position));
+    }
+    for (const auto& [initial, scheduled] : offsets)
+    {
+        index.write(reinterpret_cast<const char*>(initial.data()),
+                    initial.size() * sizeof(uint64_t));
+        index.write(reinterpret_cast<const char*>(scheduled.data()),
+                    scheduled.size() * sizeof(uint64_t));
+    }
+    NS_ABORT_MSG_IF(!index, "Could not write the index file " << m_indexFilename);
+    NS_LOG_DEBUG("Indexed " << m_entries.size() << " nodes of " << m_filename);
+}
+
+std::string
+Ns2MobilityStream::ReadLine(uint64_t offset)
+{
+    std::string line;
+    m_trace.clear();
+    m_trace.seekg(offset);
+    getline(m_trace, line);
+    return line;
+}
+
+std::vector<uint64_t>
+Ns2MobilityStream::ReadOffsets(uint64_t position, uint64_t count)
+{
+    std::vector<uint64_t> offsets(count);
+    m_index.clear();
+    m_index.seekg(position);
+    m_index.read(reinterpret_cast<char*>(offsets.data()), count * sizeof(uint64_t));
+    NS_ABORT_MSG_IF(!m_index, "Corrupted index file " << m_indexFilename);
+    return offsets;
+}
+
+uint32_t
+Ns2MobilityStream::GetNodeId(uint32_t entry) const
+{
+    return m_entries[entry].m_id;
+}
+
+uint32_t
+Ns2MobilityStream::GetNNodes() const
+{
+    return m_entries.size();
+}
+
+void
+Ns2MobilityStream::AddNode(uint32_t entry, Ptr<ConstantVelocityMobilityModel> model)
+{
+    const IndexEntry& indexEntry = m_entries[entry];
+    NodeStream node;
+    node.m_model = model;
+    for (auto offset : ReadOffsets(indexEntry.m_position, indexEntry.m_nInitial))
+    {
+        ParseResult pr = ParseNs2Line(ReadLine(offset));
+        DestinationPoint point;
+        //                                                    coord         coord value
+        point.m_finalPosition = SetInitialPosition(model, pr.tokens[2], pr.dvals[3]);
+        node.m_last = point;
+        NS_LOG_DEBUG("Positions after parse for node " << indexEntry.m_id
+                                                       << " position = " << point.m_finalPosition);
+    }
+    node.m_position = model->GetPosition();
+    node.m_next = indexEntry.m_position + indexEntry.m_nInitial * sizeof(uint64_t);
+    node.m_remaining = indexEntry.m_nScheduled;
+    node.m_current = 0;
+    m_nodes.push_back(node);
+}
+
+void
+Ns2MobilityStream::Start()
+{
+    for (uint32_t i = 0; i < m_nodes.size(); ++i)
+    {
+        Refill(i);
+    }
+}
+
+void
+Ns2MobilityStream::Refill(uint32_t i)
+{
+    NodeStream& node = m_nodes[i];
+    Time now = Simulator::Now();
+    while (node.m_remaining > 0 || node.m_current < node.m_offsets.size())
+    {
+        if (node.m_current == node.m_offsets.size())
+        {
+            uint64_t count = std::min<uint64_t>(node.m_remaining, READ_AHEAD);
+            node.m_offsets = ReadOffsets(node.m_next, count);
+            node.m_current = 0;
+            node.m_next += count * sizeof(uint64_t);
+            node.m_remaining -= count;
+        }
+        std::string line = ReadLine(node.m_offsets[node.m_current]);
+        ParseResult pr = ParseNs2Line(line);
+
+        // This is a scheduled event, so time at should be present
+        if (!IsNumber(pr.tokens[2]))
+        {
+            NS_LOG_WARN("Time is not a number: " << pr.tokens[2]);
+            node.m_current++;
+            continue;
+        }
+        double at = pr.dvals[2]; // set time at
+        if (at < 0)
+        {
+            NS_LOG_WARN("Time is less than cero: " << at);
+            node.m_current++;
+            continue;
+        }
+        if (m_start + Seconds(at) > now + m_window)
+        {
+            // read the line again when it gets within the window
+            Simulator::Schedule(m_start + Seconds(at) - m_window - now,
+                                &Ns2MobilityStream::Refill,
+                                Ptr<Ns2MobilityStream>(this),
+                                i);
+            return;
+        }
+        node.m_current++;
+        Time start = m_start;
+        if (start + Seconds(at) < now)
+        {
+            NS_LOG_WARN("Line read after its time (trace not sorted by time?): " << line);
+            start = now - Seconds(at);
+        }
+
+        if (IsSchedMobilityPos(pr))
+        {
+            StopMovement(node.m_last, at);
+            node.m_last = SetMovement(node.m_model,
+                                      node.m_last.m_finalPosition,
+                                      at,
+                                      pr.dvals[5],
+                                      pr.dvals[6],
+                                      pr.dvals[7],
+                                      start);
+        }
+        else if (IsSchedSetPos(pr))
+        {
+            node.m_position = SetOneInitialCoord(node.m_position, pr.tokens[5], pr.dvals[6]);
+            Simulator::Schedule(start + Seconds(at) - now,
+                                &ConstantVelocityMobilityModel::SetPosition,
+                                node.m_model,
+                                node.m_position);
+            node.m_last.m_finalPosition = node.m_position;
+            if (node.m_last.m_targetArrivalTime > at)
+            {
+                node.m_last.m_stopEvent.Cancel();
+            }
+            node.m_last.m_targetArrivalTime = at;
+            node.m_last.m_travelStartTime = at;
+        }
+        else
+        {
+            NS_LOG_WARN("Format Line is not correct: " << line << "\n");
+        }
+        NS_LOG_DEBUG("Positions after parse for node " << m_entries[i].m_id << " position ="
+                                                       << node.m_last.m_finalPosition);
+    }
+    // the node has no more lines, release its memory
+    node.m_offsets = std::vector<uint64_t>();
+    node.m_model = nullptr;
+}
+
+void
+Ns2MobilityHelper::EnableStreaming(Time window, std::string indexFilename)
+{
+    NS_ABORT_MSG_UNLESS(window.IsStrictlyPositive(), "The window must be positive");
+    m_window = window;
+    m_indexFilename = indexFilename.empty() ? m_filename + ".idx" : indexFilename;
+}
+
+void
+Ns2MobilityHelper::ConfigNodesStreaming(const ObjectStore& store) const
+{
+    Ptr<Ns2MobilityStream> stream =
+        Create<Ns2MobilityStream>(m_filename, m_indexFilename, m_window);
+    for (uint32_t i = 0; i < stream->GetNNodes(); ++i)
+    {
+        std::string nodeId = std::to_string(stream->GetNodeId(i));
+        Ptr<ConstantVelocityMobilityModel> model = GetMobilityModel(nodeId, store);
+        if (!model)
+        {
+            NS_LOG_ERROR("Unknown node ID (corrupted file?): " << nodeId << "\n");
+            continue;
+        }
+        stream->AddNode(i, model);
+    }
+    stream->Start();
+}
+
 void
 Ns2MobilityHelper::Install() const
 {
@@ -22,6 +22,7 @@
 #ifndef NS2_MOBILITY_HELPER_H
 #define NS2_MOBILITY_HELPER_H
 
+#include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 
@@ -70,6 +71,12 @@ class ConstantVelocityMobilityModel;
  *
  *  See usage example in examples/mobility/ns2-mobility-trace.cc
  *
+ * By default, Install() parses the whole trace and schedules all its
+ * movements at once, so that the number of pending events grows with the
+ * length of the trace. For long traces, such as SUMO exports with many
+ * vehicles, EnableStreaming() reads the trace during the simulation
+ * instead, keeping only the movements of the next seconds scheduled.
+ *
  * \bug Rounding errors may cause movement to diverge from the mobility
  * pattern in ns-2 (using the same trace).
  * See https://www.nsnam.org/bugzilla/show_bug.cgi?id=1316
@@ -83,6 +90,28 @@ class Ns2MobilityHelper
      */
     Ns2MobilityHelper(std::string filename);
 
+    /**
+     * Read the trace during the simulation instead of at installation.
+     *
+     * A binary index of the lines of each node in the trace is written to
+     * indexFilename at the first installation, and reused as long as the
+     * trace file keeps its size and modification time. Install() then only
+     * sets the initial positions, and each node reads its next lines from
+     * the trace when their time gets within the window, so that the number
+     * of pending events is proportional to the number of nodes rather than
+     * to the number of lines of the trace.
+     *
+     * The lines of each node must be sorted by time, as in the traces of
+     * BonnMotion and SUMO; a line read after its time is applied at once.
+     * The movements of different nodes at the same time may be applied in
+     * another order than with the default mode.
+     *
+     * \param window the lookahead of the movements scheduled for each node
+     * \param indexFilename the file of the binary index, by default the name
+     *        of the trace file followed by ".idx"
+     */
+    void EnableStreaming(Time window, std::string indexFilename = "");
+
     /**
      * Read the ns2 trace file and configure the movement
      * patterns of all nodes contained in the global ns3::NodeList
@@ -137,7 +166,15 @@ class Ns2MobilityHelper
      */
     Ptr<ConstantVelocityMobilityModel> GetMobilityModel(std::string idString,
                                                         const ObjectStore& store) const;
-    std::string m_filename; //!< filename of file containing ns-2 mobility trace
+    /**
+     * Sets the initial positions and starts reading the ns-2 mobility file
+     * during the simulation
+     * \param store Object store containing ns-3 mobility models
+     */
+    void ConfigNodesStreaming(const ObjectStore& store) const;
+    std::string m_filename;      //!< filename of file containing ns-2 mobility trace
+    Time m_window;               //!< lookahead of the streaming mode, or 0 to read the whole trace
+    std::string m_indexFilename; //!< filename of the index of the streaming mode
 };
 
 } // namespace ns3
@@ -174,7 +211,14 @@ Ns2MobilityHelper::Install(T begin, T end) const
         T m_end;
     };
 
-    ConfigNodesMovements(MyObjectStore(begin, end));
+    if (m_window.IsStrictlyPositive())
+    {
+        ConfigNodesStreaming(MyObjectStore(begin, end));
+    }
+    else
+    {
+        ConfigNodesMovements(MyObjectStore(begin, end));
+    }
 }
 
 } // namespace ns3
@@ -48,6 +48,7 @@
 #include "ns3/test.h"
 
 #include <algorithm>
+#include <cstdio>
 
 using namespace ns3;
 
@@ -133,7 +134,8 @@ class Ns2MobilityHelperTest : public TestCase
         : TestCase(name),
           m_timeLimit(timeLimit),
           m_nodeCount(nodes),
-          m_nextRefPoint(0)
+          m_nextRefPoint(0),
+          m_window(0)
     {
     }
 
@@ -151,6 +153,15 @@ class Ns2MobilityHelperTest : public TestCase
         m_trace = trace;
     }
 
+    /**
+     * Read the trace during the simulation
+     * \param window the lookahead of Ns2MobilityHelper::EnableStreaming
+     */
+    void SetStreaming(Time window)
+    {
+        m_window = window;
+    }
+
     /**
      * Add next reference point
      * \param r reference point to add
@@ -185,6 +196,8 @@ class Ns2MobilityHelperTest : public TestCase
     size_t m_nextRefPoint;
     /// TMP trace file name
     std::string m_traceFile;
+    /// Lookahead of the streaming mode, 0 to read the whole trace at installation
+    Time m_window;
 
   private:
     /**
@@ -292,6 +305,7 @@ class Ns2MobilityHelperTest : public TestCase
 
     void DoTeardown() override
     {
+        std::remove((m_traceFile + ".idx").c_str());
         Names::Clear();
         Simulator::Destroy();
     }
@@ -307,6 +321,10 @@ class Ns2MobilityHelperTest : public TestCase
             return;
         }
         Ns2MobilityHelper mobility(m_traceFile);
+        if (m_window.IsStrictlyPositive())
+        {
+            mobility.EnableStreaming(m_window);
+        }
         mobility.Install();
         if (CheckInitialPositions())
         {
@@ -331,21 +349,34 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         : TestSuite("mobility-ns2-trace-helper", UNIT)
     {
         SetDataDir(NS_TEST_SOURCEDIR);
+        AddTestCases(Seconds(0), "");
+        // the streaming mode, with a window shorter than the traces
+        AddTestCases(MilliSeconds(1500), " (streaming)");
+    }
 
+  private:
+    /**
+     * Add the test cases
+     * \param window the lookahead of the streaming mode, or 0
+     * \param suffix the suffix of the names of the test cases
+     */
+    void AddTestCases(Time window, std::string suffix)
+    {
         // to be used as temporary variable for test cases.
         // Note that test suite takes care of deleting all test cases.
         Ns2MobilityHelperTest* t(nullptr);
 
         // Initial position
-        t = new Ns2MobilityHelperTest("initial position", Seconds(1));
+        t = new Ns2MobilityHelperTest("initial position" + suffix, Seconds(1));
         t->SetTrace("$node_(0) set X_ 1.0\n"
                     "$node_(0) set Y_ 2.0\n"
                     "$node_(0) set Z_ 3.0\n");
         t->AddReferencePoint("0", 0, Vector(1, 2, 3), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Check parsing comments, empty lines and no EOF at the end of file
-        t = new Ns2MobilityHelperTest("comments", Seconds(1));
+        t = new Ns2MobilityHelperTest("comments" + suffix, Seconds(1));
         t->SetTrace("# comment\n"
                     "\n\n" // empty lines
                     "$node_(0) set X_ 1.0 # comment \n"
@@ -353,19 +384,21 @@ class Ns2MobilityHelperTestSuite : public TestSuite
                     "$node_(0) set Z_ 3.0 # $node_(0) set Z_ 3.0\n"
                     "#$node_(0) set Z_ 100 #");
         t->AddReferencePoint("0", 0, Vector(1, 2, 3), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Simple setdest. Arguments are interpreted as x, y, speed by default
-        t = new Ns2MobilityHelperTest("simple setdest", Seconds(10));
+        t = new Ns2MobilityHelperTest("simple setdest" + suffix, Seconds(10));
         t->SetTrace("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"");
         //                     id  t  position         velocity
         t->AddReferencePoint("0", 0, Vector(0, 0, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 1, Vector(0, 0, 0), Vector(5, 0, 0));
         t->AddReferencePoint("0", 6, Vector(25, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Several set and setdest. Arguments are interpreted as x, y, speed by default
-        t = new Ns2MobilityHelperTest("square setdest", Seconds(6));
+        t = new Ns2MobilityHelperTest("square setdest" + suffix, Seconds(6));
         t->SetTrace("$node_(0) set X_ 0.0\n"
                     "$node_(0) set Y_ 0.0\n"
                     "$ns_ at 1.0 \"$node_(0) setdest 5  0  5\"\n"
@@ -382,13 +415,15 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 4, Vector(0, 5, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 4, Vector(0, 5, 0), Vector(0, -5, 0));
         t->AddReferencePoint("0", 5, Vector(0, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Copy of previous test case but with the initial positions at
         // the end of the trace rather than at the beginning.
         //
         // Several set and setdest. Arguments are interpreted as x, y, speed by default
-        t = new Ns2MobilityHelperTest("square setdest (initial positions at end)", Seconds(6));
+        t = new Ns2MobilityHelperTest("square setdest (initial positions at end)" + suffix,
+                                      Seconds(6));
         t->SetTrace("$ns_ at 1.0 \"$node_(0) setdest 15  10  5\"\n"
                     "$ns_ at 2.0 \"$node_(0) setdest 15  15  5\"\n"
                     "$ns_ at 3.0 \"$node_(0) setdest 10  15  5\"\n"
@@ -405,10 +440,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 4, Vector(10, 15, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 4, Vector(10, 15, 0), Vector(0, -5, 0));
         t->AddReferencePoint("0", 5, Vector(10, 10, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Scheduled set position
-        t = new Ns2MobilityHelperTest("scheduled set position", Seconds(2));
+        t = new Ns2MobilityHelperTest("scheduled set position" + suffix, Seconds(2));
         t->SetTrace("$ns_ at 1.0 \"$node_(0) set X_ 10\"\n"
                     "$ns_ at 1.0 \"$node_(0) set Z_ 10\"\n"
                     "$ns_ at 1.0 \"$node_(0) set Y_ 10\"");
@@ -416,10 +452,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 1, Vector(10, 0, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 1, Vector(10, 0, 10), Vector(0, 0, 0));
         t->AddReferencePoint("0", 1, Vector(10, 10, 10), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Malformed lines
-        t = new Ns2MobilityHelperTest("malformed lines", Seconds(2));
+        t = new Ns2MobilityHelperTest("malformed lines" + suffix, Seconds(2));
         t->SetTrace("$node() set X_ 1 # node id is not present\n"
                     "$node # incoplete line\"\n"
                     "$node this line is not correct\n"
@@ -432,10 +469,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 0, Vector(1, 2, 3), Vector(0, 0, 0));
         t->AddReferencePoint("0", 1, Vector(1, 2, 3), Vector(1, 0, 0));
         t->AddReferencePoint("0", 2, Vector(2, 2, 3), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Non possible values
-        t = new Ns2MobilityHelperTest("non possible values", Seconds(2));
+        t = new Ns2MobilityHelperTest("non possible values" + suffix, Seconds(2));
         t->SetTrace(
             "$node_(0) set X_ 1 # line OK \n"
             "$node_(0) set Y_ 2 # line OK \n"
@@ -453,10 +491,13 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 0, Vector(1, 2, 3), Vector(0, 0, 0));
         t->AddReferencePoint("0", 1, Vector(1, 2, 3), Vector(1, 0, 0));
         t->AddReferencePoint("0", 2, Vector(2, 2, 3), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // More than one node
-        t = new Ns2MobilityHelperTest("few nodes, combinations of set and setdest", Seconds(10), 3);
+        t = new Ns2MobilityHelperTest("few nodes, combinations of set and setdest" + suffix,
+                                      Seconds(10),
+                                      3);
         t->SetTrace("$node_(0) set X_ 1.0\n"
                     "$node_(0) set Y_ 2.0\n"
                     "$node_(0) set Z_ 3.0\n"
@@ -481,10 +522,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("2", 4, Vector(0, 5, 0), Vector(0, 0, 0));
         t->AddReferencePoint("2", 4, Vector(0, 5, 0), Vector(0, -5, 0));
         t->AddReferencePoint("2", 5, Vector(0, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Test for Speed == 0, that acts as stop the node.
-        t = new Ns2MobilityHelperTest("setdest with speed cero", Seconds(10));
+        t = new Ns2MobilityHelperTest("setdest with speed cero" + suffix, Seconds(10));
         t->SetTrace("$ns_ at 1.0 \"$node_(0) setdest 25 0 5\"\n"
                     "$ns_ at 7.0 \"$node_(0) setdest 11  22  0\"\n");
         //                     id  t  position         velocity
@@ -492,10 +534,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 1, Vector(0, 0, 0), Vector(5, 0, 0));
         t->AddReferencePoint("0", 6, Vector(25, 0, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 7, Vector(25, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Test negative positions
-        t = new Ns2MobilityHelperTest("test negative positions", Seconds(10));
+        t = new Ns2MobilityHelperTest("test negative positions" + suffix, Seconds(10));
         t->SetTrace("$node_(0) set X_ -1.0\n"
                     "$node_(0) set Y_ 0\n"
                     "$ns_ at 1.0 \"$node_(0) setdest 0 0 1\"\n"
@@ -506,10 +549,11 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 2, Vector(0, 0, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 2, Vector(0, 0, 0), Vector(0, -1, 0));
         t->AddReferencePoint("0", 3, Vector(0, -1, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
         // Square setdest with values in the form 1.0e+2
-        t = new Ns2MobilityHelperTest("Foalt numbers in 1.0e+2 format", Seconds(6));
+        t = new Ns2MobilityHelperTest("Foalt numbers in 1.0e+2 format" + suffix, Seconds(6));
         t->SetTrace("$node_(0) set X_ 0.0\n"
                     "$node_(0) set Y_ 0.0\n"
                     "$ns_ at 1.0 \"$node_(0) setdest 1.0e+2  0       1.0e+2\"\n"
@@ -526,8 +570,9 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 4, Vector(0, 100, 0), Vector(0, 0, 0));
         t->AddReferencePoint("0", 4, Vector(0, 100, 0), Vector(0, -100, 0));
         t->AddReferencePoint("0", 5, Vector(0, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
-        t = new Ns2MobilityHelperTest("Bug 1219 testcase", Seconds(16));
+        t = new Ns2MobilityHelperTest("Bug 1219 testcase" + suffix, Seconds(16));
         t->SetTrace("$node_(0) set X_ 0.0\n"
                     "$node_(0) set Y_ 0.0\n"
                     "$ns_ at 1.0 \"$node_(0) setdest 0  10       1\"\n"
@@ -537,14 +582,16 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         t->AddReferencePoint("0", 1, Vector(0, 0, 0), Vector(0, 1, 0));
         t->AddReferencePoint("0", 6, Vector(0, 5, 0), Vector(0, -1, 0));
         t->AddReferencePoint("0", 16, Vector(0, -10, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
-        t = new Ns2MobilityHelperTest("Bug 1059 testcase", Seconds(16));
+        t = new Ns2MobilityHelperTest("Bug 1059 testcase" + suffix, Seconds(16));
         t->SetTrace("$node_(0) set X_ 10.0\r\n"
                     "$node_(0) set Y_ 0.0\r\n");
         //                     id  t  position         velocity
         t->AddReferencePoint("0", 0, Vector(10, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
-        t = new Ns2MobilityHelperTest("Bug 1301 testcase", Seconds(16));
+        t = new Ns2MobilityHelperTest("Bug 1301 testcase" + suffix, Seconds(16));
         t->SetTrace("$node_(0) set X_ 10.0\n"
                     "$node_(0) set Y_ 0.0\n"
                     "$ns_ at 1.0 \"$node_(0) setdest 10  0       1\"\n");
@@ -552,9 +599,10 @@ class Ns2MobilityHelperTestSuite : public TestSuite
         // Moving to the current position must change nothing. No NaN
         // speed must be.
         t->AddReferencePoint("0", 0, Vector(10, 0, 0), Vector(0, 0, 0));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
 
-        t = new Ns2MobilityHelperTest("Bug 1316 testcase", Seconds(1000));
+        t = new Ns2MobilityHelperTest("Bug 1316 testcase" + suffix, Seconds(1000));
         t->SetTrace("$node_(0) set X_ 350.00000000000000\n"
                     "$node_(0) set Y_ 50.00000000000000\n"
                     "$ns_ at 50.00000000000000  \"$node_(0) setdest 400.00000000000000 "
@@ -617,6 +665,7 @@ class Ns2MobilityHelperTestSuite : public TestSuite
                              920.000,
                              Vector(300.000, 650.000, 0.000),
                              Vector(0.000, 0.000, 0.000));
+        t->SetStreaming(window);
         AddTestCase(t, TestCase::QUICK);
     }
 } g_ns2TransmobilityHelperTestSuite; ///< the test suite
@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ *
+ * SimpleDistributedSpectrum places four nodes on a line, 300 m apart, and
+ * attaches them to a MultiModelSpectrumRemoteChannel. The two left nodes
+ * are on logical processor 0 and the two right nodes on logical processor 1.
+ *
+ *                 -------   -------
+ *                  RANK 0    RANK 1
+ *                 ------- | -------
+ *                         |
+ *          n0 ------ n1 --|-- n2 ------ n3
+ *
+ * Each node broadcasts one packet with an AlohaNoackNetDevice, in turn.
+ * When the transmitter and the receiver are on different logical
+ * processors, a descriptor of the signal is sent with MPI one lookahead,
+ * the propagation delay between n1 and n2, after the start of the
+ * transmission, and the receiving processor computes the propagation loss.
+ * Every packet is received by the three other nodes.
+ */
+
+#include "mpi-test-fixtures.h"
+
+#include "ns3/adhoc-aloha-noack-ideal-phy-helper.h"
+#include "ns3/core-module.h"
+#include "ns3/half-duplex-ideal-phy-signal-parameters.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/multi-model-spectrum-remote-channel.h"
+#include "ns3/network-module.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/wifi-spectrum-value-helper.h"
+
+#include <mpi.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SimpleDistributedSpectrum");
+
+/**
+ * Serialize the packet of the HalfDuplexIdealPhy signals.
+ *
+ * \param params The signal parameters.
+ * \return The packet.
+ */
+static Ptr<Packet>
+SerializeSignal(Ptr<const SpectrumSignalParameters> params)
+{
+    Ptr<const HalfDuplexIdealPhySignalParameters> halfDuplex =
+        DynamicCast<const HalfDuplexIdealPhySignalParameters>(params);
+    NS_ASSERT(halfDuplex);
+    return halfDuplex->data->Copy();
+}
+
+/**
+ * Rebuild the HalfDuplexIdealPhy signals.
+ *
+ * \param packet The packet.
+ * \return The signal parameters.
+ */
+static Ptr<SpectrumSignalParameters>
+DeserializeSignal(Ptr<Packet> packet)
+{
+    Ptr<HalfDuplexIdealPhySignalParameters> params = Create<HalfDuplexIdealPhySignalParameters>();
+    params->data = packet;
+    return params;
+}
+
+/**
+ * Count a received packet.
+ *
+ * \param packet The packet.
+ */
+static void
+RxEndOk(Ptr<const Packet> packet)
+{
+    SinkTracer::SinkTrace(packet, Address(), Address());
+}
+
+/**
+ * Broadcast a packet.
+ *
+ * \param device The device.
+ */
+static void
+Broadcast(Ptr<NetDevice> device)
+{
+    device->Send(Create<Packet>(125), device->GetBroadcast(), 1);
+}
+
+int
+main(int argc, char* argv[])
+{
+    bool nullmsg = false;
+    bool testing = false;
+
+    // Parse command line
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+    cmd.AddValue("test", "Enable regression test output", testing);
+    cmd.Parse(argc, argv);
+
+    // Distributed simulation setup; by default use granted time window algorithm.
+    if (nullmsg)
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::NullMessageSimulatorImpl"));
+    }
+    else
+    {
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DistributedSimulatorImpl"));
+    }
+
+    // Enable parallel simulator with the command line arguments
+    MpiInterface::Enable(&argc, &argv);
+
+    SinkTracer::Init();
+
+    uint32_t systemId = MpiInterface::GetSystemId();
+    uint32_t systemCount = MpiInterface::GetSize();
+
+    // Check for valid distributed parameters.
+    // Must have 2 and only 2 Logical Processors (LPs)
+    if (systemCount != 2)
+    {
+        std::cout << "This simulation requires 2 and only 2 logical processors." << std::endl;
+        return 1;
+    }
+
+    NodeContainer nodes;
+    nodes.Create(2, 0);
+    nodes.Create(2, 1);
+
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        positionAlloc->Add(Vector(300.0 * i, 0.0, 0.0));
+    }
+    mobility.SetPositionAllocator(positionAlloc);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    Ptr<MultiModelSpectrumRemoteChannel> channel = CreateObject<MultiModelSpectrumRemoteChannel>();
+    channel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+    channel->AddPropagationLossModel(CreateObject<FriisPropagationLossModel>());
+    channel->SetSignalSerializer(MakeCallback(&SerializeSignal), MakeCallback(&DeserializeSignal));
+
+    WifiSpectrumValue5MhzFactory sf;
+    double txPower = 0.1; // Watts
+    uint32_t channelNumber = 1;
+    Ptr<SpectrumValue> txPsd = sf.CreateTxPowerSpectralDensity(txPower, channelNumber);
+    // thermal noise at room temperature
+    Ptr<SpectrumValue> noisePsd = sf.CreateConstant(1.381e-23 * 290);
+
+    AdhocAlohaNoackIdealPhyHelper deviceHelper;
+    deviceHelper.SetChannel(channel);
+    deviceHelper.SetTxPowerSpectralDensity(txPsd);
+    deviceHelper.SetNoisePowerSpectralDensity(noisePsd);
+    deviceHelper.SetPhyAttribute("Rate", DataRateValue(DataRate("1Mbps")));
+    NetDeviceContainer devices = deviceHelper.Install(nodes);
+
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        if (nodes.Get(i)->GetSystemId() != systemId)
+        {
+            continue;
+        }
+        std::ostringstream path;
+        path << "/NodeList/" << nodes.Get(i)->GetId() << "/DeviceList/*/Phy/RxEndOk";
+        Config::ConnectWithoutContext(path.str(), MakeCallback(&RxEndOk));
+        Simulator::ScheduleWithContext(nodes.Get(i)->GetId(),
+                                       MilliSeconds(10 * (i + 1)),
+                                       &Broadcast,
+                                       devices.Get(i));
+    }
+
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    if (testing)
+    {
+        SinkTracer::Verify(12);
+    }
+
+    // Exit the MPI execution environment
+    MpiInterface::Disable();
+    return 0;
+}
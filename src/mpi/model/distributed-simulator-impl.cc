@@ -28,6 +28,7 @@
 #include "mpi-interface.h"
 
 #include "ns3/assert.h"
+#include "ns3/channel-list.h"
 #include "ns3/channel.h"
 #include "ns3/event-impl.h"
 #include "ns3/log.h"
@@ -222,6 +223,23 @@ DistributedSimulatorImpl::CalculateLookAhead()
                 }
             }
         }
+
+        // the shared channels split across tasks, such as the
+        // MultiModelSpectrumRemoteChannel, compute their own lookahead
+        for (ChannelList::Iterator iter = ChannelList::Begin(); iter != ChannelList::End(); ++iter)
+        {
+            TypeId::AttributeInformation info;
+            if (!(*iter)->GetInstanceTypeId().LookupAttributeByName("Lookahead", &info))
+            {
+                continue;
+            }
+            TimeValue lookahead;
+            (*iter)->GetAttribute("Lookahead", lookahead);
+            if (lookahead.Get() < m_lookAhead)
+            {
+                m_lookAhead = lookahead.Get();
+            }
+        }
     }
 
     // m_lookAhead is now set
@@ -31,6 +31,7 @@
 #include "remote-channel-bundle.h"
 
 #include <ns3/assert.h>
+#include <ns3/channel-list.h>
 #include <ns3/channel.h>
 #include <ns3/double.h>
 #include <ns3/event-impl.h>
@@ -45,6 +46,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <set>
 
 namespace ns3
 {
@@ -195,6 +197,40 @@ NullMessageSimulatorImpl::CalculateLookAhead()
                 remoteChannelBundle->AddChannel(channel, delay.Get());
             }
         }
+
+        // the shared channels split across tasks, such as the
+        // MultiModelSpectrumRemoteChannel, compute their own lookahead
+        for (ChannelList::Iterator iter = ChannelList::Begin(); iter != ChannelList::End(); ++iter)
+        {
+            Ptr<Channel> channel = *iter;
+            TypeId::AttributeInformation info;
+            if (!channel->GetInstanceTypeId().LookupAttributeByName("Lookahead", &info))
+            {
+                continue;
+            }
+            TimeValue lookahead;
+            channel->GetAttribute("Lookahead", lookahead);
+
+            std::set<uint32_t> systemIds;
+            for (std::size_t i = 0; i < channel->GetNDevices(); ++i)
+            {
+                Ptr<NetDevice> device = channel->GetDevice(i);
+                if (device && device->GetNode()->GetSystemId() != MpiInterface::GetSystemId())
+                {
+                    systemIds.insert(device->GetNode()->GetSystemId());
+                }
+            }
+            for (uint32_t systemId : systemIds)
+            {
+                Ptr<RemoteChannelBundle> remoteChannelBundle =
+                    RemoteChannelBundleManager::Find(systemId);
+                if (!remoteChannelBundle)
+                {
+                    remoteChannelBundle = RemoteChannelBundleManager::Add(systemId);
+                }
+                remoteChannelBundle->AddChannel(channel, lookahead.Get());
+            }
+        }
     }
 
     // Completed setup of remote channel bundles.  Setup send and receive buffers.
@@ -154,6 +154,10 @@ static MpiTestSuite g_mpiSimple2("mpi-example-simple-2",
                                  NS_TEST_SOURCEDIR,
                                  2);
 static MpiTestSuite g_mpiThird2("mpi-example-third-2", "third-distributed", NS_TEST_SOURCEDIR, 2);
+static MpiTestSuite g_mpiSpectrum2("mpi-example-spectrum-2",
+                                   "simple-distributed-spectrum",
+                                   NS_TEST_SOURCEDIR,
+                                   2);
 
 /* Tests using NullMessageSimulatorImpl */
 static MpiTestSuite g_mpiSimple2NullMsg("mpi-example-simple-2-nullmsg",
@@ -171,3 +175,8 @@ static MpiTestSuite g_mpiEmpty3NullMsg("mpi-example-empty-3-nullmsg",
                                        NS_TEST_SOURCEDIR,
                                        3,
                                        "-nullmsg");
+static MpiTestSuite g_mpiSpectrum2NullMsg("mpi-example-spectrum-2-nullmsg",
+                                          "simple-distributed-spectrum",
+                                          NS_TEST_SOURCEDIR,
+                                          2,
+                                          "--nullmsg");
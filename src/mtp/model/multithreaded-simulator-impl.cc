@@ -0,0 +1,794 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition* MultithreadedSimulatorImpl::t_current =
+    nullptr;
+
+namespace
+{
+
+/**
+ * \ingroup mtp
+ * Check whether the ends of a channel can be in different partitions.
+ *
+ * \param [in] channel The channel.
+ * \returns The delay of the channel in time steps, or 0 if its ends
+ *          must be in the same partition.
+ */
+uint64_t
+GetCutDelay(Ptr<Channel> channel)
+{
+    if (channel->GetNDevices() != 2)
+    {
+        return 0;
+    }
+    TypeId tid = channel->GetInstanceTypeId();
+    bool stateless = false;
+    for (const char* name : {"ns3::PointToPointChannel", "ns3::SimpleChannel"})
+    {
+        TypeId base;
+        if (TypeId::LookupByNameFailSafe(name, &base) && (tid == base || tid.IsChildOf(base)))
+        {
+            stateless = true;
+        }
+    }
+    if (!stateless)
+    {
+        return 0;
+    }
+    TimeValue delay;
+    channel->GetAttribute("Delay", delay);
+    return delay.Get().IsStrictlyPositive() ? delay.Get().GetTimeStep() : 0;
+}
+
+/**
+ * \ingroup mtp
+ * Find the root of a node in a union-find forest, compressing the path.
+ *
+ * \param [in,out] parent The parent of each node.
+ * \param [in] node The node.
+ * \returns The root.
+ */
+uint32_t
+FindRoot(std::vector<uint32_t>& parent, uint32_t node)
+{
+    while (parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("MaxThreads",
+                          "The maximum number of threads running the partitions, "
+                          "or 0 for the number of hardware threads",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxThreads),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_lookahead(std::numeric_limits<uint64_t>::max()),
+      m_maxThreads(0),
+      m_stop(false),
+      m_windowEnd(0),
+      m_inWindow(false),
+      m_nextActive(0),
+      m_running(0),
+      m_generation(0),
+      m_exit(false)
+{
+    NS_LOG_FUNCTION(this);
+    // the global partition holds the events until the nodes are partitioned
+    m_partitions.push_back(std::make_unique<Partition>());
+    m_partitions[0]->m_currentContext = Simulator::NO_CONTEXT;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorkers();
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorkers();
+    MergeInboxes();
+    for (auto& partition : m_partitions)
+    {
+        while (!partition->m_events->IsEmpty())
+        {
+            Scheduler::Event next = partition->m_events->RemoveNext();
+            next.impl->Unref();
+        }
+        partition->m_events = nullptr;
+    }
+    m_partitions.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    m_schedulerFactory = schedulerFactory;
+    for (auto& partition : m_partitions)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (partition->m_events)
+        {
+            while (!partition->m_events->IsEmpty())
+            {
+                scheduler->Insert(partition->m_events->RemoveNext());
+            }
+        }
+        partition->m_events = scheduler;
+    }
+}
+
+// The partitions share the address space of a single system
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+MultithreadedSimulatorImpl::Partition*
+MultithreadedSimulatorImpl::GetCurrent() const
+{
+    return t_current ? t_current : m_partitions[0].get();
+}
+
+MultithreadedSimulatorImpl::Partition*
+MultithreadedSimulatorImpl::GetPartitionOf(uint32_t context) const
+{
+    if (context < m_nodePartition.size())
+    {
+        return m_partitions[m_nodePartition[context]].get();
+    }
+    // events without context and nodes created after the partitioning
+    return m_partitions[0].get();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount() const
+{
+    return m_partitions.size();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition(uint32_t context) const
+{
+    return GetPartitionOf(context)->m_index;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    if (m_lookahead == std::numeric_limits<uint64_t>::max())
+    {
+        return GetMaximumSimulationTime();
+    }
+    return TimeStep(m_lookahead);
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert(Partition* partition,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = partition->m_uid;
+    partition->m_uid++;
+    partition->m_unscheduledEvents++;
+    partition->m_events->Insert(ev);
+    return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nNodes = NodeList::GetNNodes();
+    std::vector<uint32_t> parent(nNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    // the nodes of the channels with a shared state are merged, the others are cut
+    struct Cut
+    {
+        uint32_t a;     //!< First node.
+        uint32_t b;     //!< Second node.
+        uint64_t delay; //!< Delay of the channel, in time steps.
+    };
+
+    std::vector<Cut> cuts;
+    for (auto it = ChannelList::Begin(); it != ChannelList::End(); ++it)
+    {
+        Ptr<Channel> channel = *it;
+        std::vector<uint32_t> nodes;
+        for (std::size_t i = 0; i < channel->GetNDevices(); ++i)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(i);
+            if (device && device->GetNode())
+            {
+                nodes.push_back(device->GetNode()->GetId());
+            }
+        }
+        uint64_t delay = GetCutDelay(channel);
+        if (delay > 0 && nodes.size() == 2)
+        {
+            cuts.push_back({nodes[0], nodes[1], delay});
+            continue;
+        }
+        for (std::size_t i = 1; i < nodes.size(); ++i)
+        {
+            parent[FindRoot(parent, nodes[i])] = FindRoot(parent, nodes[0]);
+        }
+    }
+
+    // number the partitions in the order of their first node
+    Partition* global = m_partitions[0].get();
+    std::vector<uint32_t> rootPartition(nNodes, 0);
+    m_nodePartition.resize(nNodes);
+    for (uint32_t node = 0; node < nNodes; ++node)
+    {
+        uint32_t root = FindRoot(parent, node);
+        if (rootPartition[root] == 0)
+        {
+            auto partition = std::make_unique<Partition>();
+            partition->m_index = m_partitions.size();
+            partition->m_events = m_schedulerFactory.Create<Scheduler>();
+            // the uids of the events moved from the global partition stay unique
+            partition->m_uid = global->m_uid;
+            rootPartition[root] = partition->m_index;
+            m_partitions.push_back(std::move(partition));
+        }
+        m_nodePartition[node] = rootPartition[root];
+    }
+
+    m_lookahead = std::numeric_limits<uint64_t>::max();
+    for (const auto& cut : cuts)
+    {
+        if (m_nodePartition[cut.a] != m_nodePartition[cut.b])
+        {
+            m_lookahead = std::min(m_lookahead, cut.delay);
+        }
+    }
+
+    // move the events of the nodes to their partitions
+    std::vector<Scheduler::Event> events;
+    while (!global->m_events->IsEmpty())
+    {
+        events.push_back(global->m_events->RemoveNext());
+    }
+    for (const auto& ev : events)
+    {
+        Partition* partition = GetPartitionOf(ev.key.m_context);
+        partition->m_events->Insert(ev);
+        if (partition != global)
+        {
+            global->m_unscheduledEvents--;
+            partition->m_unscheduledEvents++;
+        }
+    }
+    NS_LOG_INFO(nNodes << " nodes in " << m_partitions.size() - 1
+                       << " partitions, lookahead=" << GetLookahead());
+}
+
+void
+MultithreadedSimulatorImpl::MergeInboxes()
+{
+    std::vector<Message*> messages;
+    for (auto& partition : m_partitions)
+    {
+        Message* message = partition->m_inbox.exchange(nullptr, std::memory_order_acquire);
+        if (!message)
+        {
+            continue;
+        }
+        messages.clear();
+        for (; message; message = message->m_next)
+        {
+            messages.push_back(message);
+        }
+        // the order of the pushes depends on the threads, not the order of the sources
+        std::sort(messages.begin(), messages.end(), [](const Message* a, const Message* b) {
+            if (a->m_ts != b->m_ts)
+            {
+                return a->m_ts < b->m_ts;
+            }
+            if (a->m_source != b->m_source)
+            {
+                return a->m_source < b->m_source;
+            }
+            return a->m_seq < b->m_seq;
+        });
+        for (Message* m : messages)
+        {
+            Insert(partition.get(), m->m_ts, m->m_context, m->m_event);
+            delete m;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(Partition* partition)
+{
+    Scheduler::Event next = partition->m_events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= partition->m_currentTs);
+    partition->m_unscheduledEvents--;
+    partition->m_eventCount++;
+
+    NS_LOG_LOGIC("handle " << next.key.m_ts);
+    partition->m_currentTs = next.key.m_ts;
+    partition->m_currentContext = next.key.m_context;
+    partition->m_currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessPartition(Partition* partition)
+{
+    t_current = partition;
+    while (!partition->m_events->IsEmpty() &&
+           partition->m_events->PeekNext().key.m_ts < m_windowEnd)
+    {
+        ProcessOneEvent(partition);
+    }
+    t_current = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessGlobal(uint64_t ts)
+{
+    Partition* global = m_partitions[0].get();
+    while (!global->m_events->IsEmpty() && global->m_events->PeekNext().key.m_ts == ts &&
+           !m_stop)
+    {
+        ProcessOneEvent(global);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow()
+{
+    uint32_t index;
+    while ((index = m_nextActive++) < m_active.size())
+    {
+        ProcessPartition(m_active[index]);
+    }
+    if (--m_running == 0)
+    {
+        std::unique_lock lock{m_mutex};
+        m_done.notify_one();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock{m_mutex};
+            m_start.wait(lock, [this, generation]() { return m_exit || m_generation != generation; });
+            if (m_exit)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+        ProcessWindow();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StartWorkers()
+{
+    uint32_t threads = m_maxThreads ? m_maxThreads : std::thread::hardware_concurrency();
+    threads = std::min<uint32_t>(std::max<uint32_t>(threads, 1), m_partitions.size() - 1);
+    NS_LOG_FUNCTION(this << threads);
+    // the main thread is one of them
+    while (m_workers.size() + 1 < threads)
+    {
+        m_workers.emplace_back(&MultithreadedSimulatorImpl::WorkerLoop, this);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopWorkers()
+{
+    NS_LOG_FUNCTION(this);
+    {
+        std::unique_lock lock{m_mutex};
+        m_exit = true;
+    }
+    m_start.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    m_exit = false;
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow()
+{
+    m_inWindow = true;
+    if (m_active.size() == 1 || m_workers.empty())
+    {
+        for (Partition* partition : m_active)
+        {
+            ProcessPartition(partition);
+        }
+        m_inWindow = false;
+        return;
+    }
+    m_nextActive = 0;
+    m_running = m_workers.size() + 1;
+    {
+        std::unique_lock lock{m_mutex};
+        m_generation++;
+    }
+    m_start.notify_all();
+    ProcessWindow();
+    {
+        std::unique_lock lock{m_mutex};
+        m_done.wait(lock, [this]() { return m_running == 0; });
+    }
+    m_inWindow = false;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_nodePartition.empty())
+    {
+        CreatePartitions();
+    }
+    StartWorkers();
+    m_stop = false;
+
+    Partition* global = m_partitions[0].get();
+    const uint64_t never = std::numeric_limits<uint64_t>::max();
+    while (!m_stop)
+    {
+        MergeInboxes();
+        uint64_t next = never;
+        for (std::size_t i = 1; i < m_partitions.size(); ++i)
+        {
+            if (!m_partitions[i]->m_events->IsEmpty())
+            {
+                next = std::min(next, m_partitions[i]->m_events->PeekNext().key.m_ts);
+            }
+        }
+        uint64_t globalNext = global->m_events->IsEmpty() ? never
+                                                          : global->m_events->PeekNext().key.m_ts;
+        if (next == never && globalNext == never)
+        {
+            break;
+        }
+        // the global events run alone, after the events of the nodes earlier than them
+        if (globalNext <= next)
+        {
+            ProcessGlobal(globalNext);
+            continue;
+        }
+        m_windowEnd = (next > never - m_lookahead) ? never : next + m_lookahead;
+        m_windowEnd = std::min(m_windowEnd, globalNext);
+        m_active.clear();
+        for (std::size_t i = 1; i < m_partitions.size(); ++i)
+        {
+            Partition* partition = m_partitions[i].get();
+            if (!partition->m_events->IsEmpty() &&
+                partition->m_events->PeekNext().key.m_ts < m_windowEnd)
+            {
+                m_active.push_back(partition);
+            }
+        }
+        NS_LOG_LOGIC("window [" << next << ", " << m_windowEnd << ") with " << m_active.size()
+                                << " partitions");
+        RunWindow();
+    }
+
+    // the main thread sees the time of the last event
+    for (const auto& partition : m_partitions)
+    {
+        global->m_currentTs = std::max(global->m_currentTs, partition->m_currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& partition : m_partitions)
+    {
+        if (!partition->m_events->IsEmpty() || partition->m_inbox.load() != nullptr)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+    Partition* current = GetCurrent();
+    Time tAbsolute = delay + TimeStep(current->m_currentTs);
+    Scheduler::EventKey key = Insert(current,
+                                     static_cast<uint64_t>(tAbsolute.GetTimeStep()),
+                                     current->m_currentContext,
+                                     event);
+    return EventId(event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    Partition* current = GetCurrent();
+    Partition* target = GetPartitionOf(context);
+    Time tAbsolute = delay + TimeStep(current->m_currentTs);
+    uint64_t ts = static_cast<uint64_t>(tAbsolute.GetTimeStep());
+    if (target == current || !m_inWindow)
+    {
+        Insert(target, ts, context, event);
+        return;
+    }
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event scheduled at " << TimeStep(ts) << " in node " << context
+                                          << " from partition " << current->m_index
+                                          << ", earlier than the end of the window at "
+                                          << TimeStep(m_windowEnd)
+                                          << ": the lookahead is not respected");
+    auto message = new Message;
+    message->m_ts = ts;
+    message->m_context = context;
+    message->m_source = current->m_index;
+    message->m_seq = current->m_sent++;
+    message->m_event = event;
+    message->m_next = target->m_inbox.load(std::memory_order_relaxed);
+    while (!target->m_inbox.compare_exchange_weak(message->m_next,
+                                                  message,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed))
+    {
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    EventId id(Ptr<EventImpl>(event, false), GetCurrent()->m_currentTs, 0xffffffff, 2);
+    std::unique_lock lock{m_destroyMutex};
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(GetCurrent()->m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - GetCurrent()->m_currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Partition* partition = GetPartitionOf(id.GetContext());
+    NS_ABORT_MSG_IF(m_inWindow && partition != GetCurrent(),
+                    "Removing an event of partition " << partition->m_index << " from partition "
+                                                      << GetCurrent()->m_index);
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    partition->m_events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    partition->m_unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (const auto& destroy : m_destroyEvents)
+        {
+            if (destroy == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    const Partition* partition = GetPartitionOf(id.GetContext());
+    return id.PeekEventImpl() == nullptr || id.GetTs() < partition->m_currentTs ||
+           (id.GetTs() == partition->m_currentTs && id.GetUid() <= partition->m_currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return GetCurrent()->m_currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = 0;
+    for (const auto& partition : m_partitions)
+    {
+        count += partition->m_eventCount;
+    }
+    return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,275 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-id.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+/**
+ * \defgroup mtp Multithreaded simulation
+ *
+ * Parallel simulation on the cores of a single machine, without MPI.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Conservative parallel simulator running the nodes on threads.
+ *
+ * At the first Run(), the nodes are split in partitions, also known as
+ * logical processes, which have their own scheduler and clock. Two nodes
+ * attached to a channel go to the same partition, unless the channel is a
+ * point-to-point or a simple channel with a positive \c Delay attribute:
+ * these channels hold no state shared by their ends, and their delay is
+ * a lower bound of the time between an event on one end and its effect on
+ * the other one. The lookahead is the smallest of these delays among the
+ * channels linking two partitions. The nodes of CSMA, spectrum, WiFi and
+ * other channels with a shared medium stay in a single partition.
+ *
+ * The partitions are run in windows: all the events earlier than the end
+ * of the window, the earliest event plus the lookahead, can be run in
+ * parallel since they cannot be affected by another partition. The
+ * partitions with events in the window are handed to the worker threads,
+ * and the events they schedule in other partitions are pushed to lock-free
+ * inboxes which are merged in a fixed order at the end of the window. The
+ * events are thus ordered the same way whatever the number of threads and
+ * the interleaving of the partitions, and a simulation is deterministic.
+ *
+ * The events without context, which are typically scheduled when setting
+ * up the simulation, belong to a global partition run by the main thread
+ * when the other partitions are stopped, at the end of a window.
+ *
+ * The model code must be safe to run on several threads for the nodes of
+ * different partitions. This is the case of the core and network modules
+ * when ns-3 is configured with \c --enable-mtp, but not of the global
+ * trace sinks, such as the ASCII or NetAnim tracing, which are written
+ * concurrently by the nodes. An event scheduled in another partition
+ * earlier than the end of the current window, which means that a model
+ * does not respect the lookahead, is a fatal error.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the number of partitions, including the global one.
+     *
+     * \returns The number of partitions, which is 1 before the first Run().
+     */
+    uint32_t GetPartitionCount() const;
+
+    /**
+     * Get the partition of a node.
+     *
+     * \param [in] context The id of the node.
+     * \returns The index of the partition of the node.
+     */
+    uint32_t GetPartition(uint32_t context) const;
+
+    /**
+     * Get the lookahead of the partitions.
+     *
+     * \returns The lookahead, or the maximum simulation time if the
+     *          partitions are not linked.
+     */
+    Time GetLookahead() const;
+
+  private:
+    void DoDispose() override;
+
+    /** An event scheduled in another partition, pushed to its inbox. */
+    struct Message
+    {
+        Message* m_next;    //!< Next message of the inbox.
+        uint64_t m_ts;      //!< Absolute time stamp.
+        uint32_t m_context; //!< Context of the event.
+        uint32_t m_source;  //!< Partition which scheduled the event.
+        uint64_t m_seq;     //!< Sequence number of the message in the source partition.
+        EventImpl* m_event; //!< The event.
+    };
+
+    /** A logical process: a set of nodes with its own scheduler and clock. */
+    struct Partition
+    {
+        Ptr<Scheduler> m_events;                      //!< The events of the partition.
+        std::atomic<Message*> m_inbox{nullptr};       //!< Events scheduled by other partitions.
+        uint32_t m_index{0};                          //!< Index of the partition.
+        uint32_t m_uid{EventId::UID::VALID};          //!< Next event uid.
+        uint32_t m_currentUid{EventId::UID::INVALID}; //!< Uid of the current event.
+        uint64_t m_currentTs{0};                      //!< Time stamp of the current event.
+        uint32_t m_currentContext{0xffffffff};        //!< Context of the current event.
+        uint64_t m_eventCount{0};                     //!< Number of events run.
+        uint64_t m_sent{0};                           //!< Number of messages sent.
+        int m_unscheduledEvents{0};                   //!< Number of events in the scheduler.
+    };
+
+    /**
+     * Get the partition running on this thread.
+     *
+     * \returns The current partition, or the global one outside of the windows.
+     */
+    Partition* GetCurrent() const;
+
+    /**
+     * Get the partition of a context.
+     *
+     * \param [in] context The context.
+     * \returns The partition.
+     */
+    Partition* GetPartitionOf(uint32_t context) const;
+
+    /**
+     * Insert an event in a partition.
+     *
+     * \param [in] partition The partition.
+     * \param [in] ts The absolute time stamp.
+     * \param [in] context The context.
+     * \param [in] event The event.
+     * \returns The key of the event.
+     */
+    Scheduler::EventKey Insert(Partition* partition,
+                               uint64_t ts,
+                               uint32_t context,
+                               EventImpl* event);
+
+    /** Split the nodes in partitions and compute the lookahead. */
+    void CreatePartitions();
+
+    /** Merge the inboxes of the partitions in a deterministic order. */
+    void MergeInboxes();
+
+    /**
+     * Run the events of a partition earlier than the end of the window.
+     *
+     * \param [in] partition The partition.
+     */
+    void ProcessPartition(Partition* partition);
+
+    /**
+     * Run the next event of a partition.
+     *
+     * \param [in] partition The partition.
+     */
+    void ProcessOneEvent(Partition* partition);
+
+    /**
+     * Run the events of the global partition with a time stamp.
+     *
+     * \param [in] ts The time stamp.
+     */
+    void ProcessGlobal(uint64_t ts);
+
+    /** Run the current window on the worker threads. */
+    void RunWindow();
+
+    /** Process the partitions of the current window, on the main or a worker thread. */
+    void ProcessWindow();
+
+    /** Main loop of the worker threads. */
+    void WorkerLoop();
+
+    /** Start the worker threads. */
+    void StartWorkers();
+
+    /** Stop the worker threads. */
+    void StopWorkers();
+
+    /** The partition run by this thread, if any. */
+    static thread_local Partition* t_current;
+
+    std::vector<std::unique_ptr<Partition>> m_partitions; //!< The partitions, the global one first.
+    std::vector<uint32_t> m_nodePartition;                //!< Partition of each node.
+    ObjectFactory m_schedulerFactory;                     //!< Factory of the schedulers.
+    uint64_t m_lookahead;                                 //!< The lookahead, in time steps.
+    uint32_t m_maxThreads;                                //!< Maximum number of threads.
+    std::atomic<bool> m_stop;                             //!< Stop at the end of the window.
+
+    /** Container type for the events to run at Destroy(). */
+    typedef std::list<EventId> DestroyEvents;
+    DestroyEvents m_destroyEvents;     //!< The events to run at Destroy().
+    mutable std::mutex m_destroyMutex; //!< Protects m_destroyEvents.
+
+    // window state, written by the main thread when the workers are idle
+    uint64_t m_windowEnd;               //!< End of the current window, excluded.
+    bool m_inWindow;                    //!< Whether a window is running.
+    std::vector<Partition*> m_active;   //!< Partitions with events in the window.
+    std::atomic<uint32_t> m_nextActive; //!< Next partition to hand to a thread.
+    std::atomic<uint32_t> m_running;    //!< Threads still processing the window.
+
+    std::vector<std::thread> m_workers; //!< The worker threads.
+    std::mutex m_mutex;                 //!< Protects m_generation and m_exit.
+    std::condition_variable m_start;    //!< Signals a new window to the workers.
+    std::condition_variable m_done;     //!< Signals the end of a window to the main thread.
+    uint64_t m_generation;              //!< Number of windows handed to the workers.
+    bool m_exit;                        //!< Whether the workers must exit.
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
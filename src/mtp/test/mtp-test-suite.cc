@@ -0,0 +1,257 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/mac48-address.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests MultithreadedSimulatorImpl test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup mtp-tests
+ * Check the partitions and the events of a small network against the
+ * DefaultSimulatorImpl.
+ *
+ * Nodes 0 to 4 are a chain of point-to-point simple channels, and node 4
+ * shares a simple channel with nodes 5 and 6. Every node broadcasts a
+ * packet on each of its devices periodically.
+ */
+class MtpTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    MtpTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** A received packet: time, receiving node, size. */
+    typedef std::tuple<int64_t, uint32_t, uint32_t> Reception;
+
+    /** The result of a simulation. */
+    struct Result
+    {
+        std::vector<std::vector<Reception>> m_received; //!< Packets received by each node.
+        uint64_t m_events;                               //!< Number of events.
+    };
+
+    /**
+     * Run the simulation.
+     *
+     * \param [in] impl The simulator implementation.
+     * \param [in] threads The maximum number of threads of the multithreaded simulator.
+     * \returns The result.
+     */
+    Result Simulate(std::string impl, uint32_t threads);
+
+    /**
+     * Broadcast a packet on all the devices of a node and reschedule.
+     *
+     * \param [in] node The node.
+     */
+    void Send(Ptr<Node> node);
+
+    /**
+     * Record a received packet.
+     *
+     * \param [in] device The receiving device.
+     * \param [in] packet The packet.
+     * \param [in] protocol The protocol number.
+     * \param [in] from The sender address.
+     * \returns \c true.
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+
+    Result m_result; //!< The result of the current simulation.
+};
+
+MtpTestCase::MtpTestCase()
+    : TestCase("Check the partitions and the events against the default simulator")
+{
+}
+
+void
+MtpTestCase::Send(Ptr<Node> node)
+{
+    for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+    {
+        node->GetDevice(i)->Send(Create<Packet>(100 + node->GetId()),
+                                 Mac48Address::GetBroadcast(),
+                                 0x800);
+    }
+    Simulator::Schedule(MicroSeconds(100 + 13 * node->GetId()), &MtpTestCase::Send, this, node);
+}
+
+bool
+MtpTestCase::Receive(Ptr<NetDevice> device,
+                     Ptr<const Packet> packet,
+                     uint16_t protocol,
+                     const Address& from)
+{
+    uint32_t node = device->GetNode()->GetId();
+    // each node is run by a single thread
+    m_result.m_received[node].emplace_back(Simulator::Now().GetTimeStep(),
+                                           node,
+                                           packet->GetSize());
+    return true;
+}
+
+MtpTestCase::Result
+MtpTestCase::Simulate(std::string impl, uint32_t threads)
+{
+    GlobalValue::Bind("SimulatorImplementationType", StringValue(impl));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(threads));
+
+    NodeContainer nodes;
+    nodes.Create(7);
+    m_result.m_received.assign(nodes.GetN(), {});
+
+    auto link = [this](std::vector<Ptr<Node>> ends, Time delay) {
+        Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+        channel->SetAttribute("Delay", TimeValue(delay));
+        for (auto node : ends)
+        {
+            Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+            device->SetAddress(Mac48Address::Allocate());
+            device->SetChannel(channel);
+            // after AddDevice, which sets the callback of the node
+            node->AddDevice(device);
+            device->SetReceiveCallback(MakeCallback(&MtpTestCase::Receive, this));
+        }
+    };
+    link({nodes.Get(0), nodes.Get(1)}, MilliSeconds(1));
+    link({nodes.Get(1), nodes.Get(2)}, MilliSeconds(2));
+    link({nodes.Get(2), nodes.Get(3)}, MilliSeconds(3));
+    link({nodes.Get(3), nodes.Get(4)}, MicroSeconds(500));
+    link({nodes.Get(4), nodes.Get(5), nodes.Get(6)}, MilliSeconds(1));
+
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        Simulator::ScheduleWithContext(i,
+                                       MicroSeconds(10 * i),
+                                       &MtpTestCase::Send,
+                                       this,
+                                       nodes.Get(i));
+    }
+    Simulator::Stop(MilliSeconds(50));
+    Simulator::Run();
+
+    Ptr<MultithreadedSimulatorImpl> mtp =
+        DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    if (mtp)
+    {
+        // the chain is cut, the shared channel is not
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartitionCount(), 6, "wrong number of partitions");
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            NS_TEST_EXPECT_MSG_NE(mtp->GetPartition(i),
+                                  mtp->GetPartition(i + 1),
+                                  "nodes " << i << " and " << i + 1 << " not cut");
+        }
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartition(5), mtp->GetPartition(4), "node 5 cut");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetPartition(6), mtp->GetPartition(4), "node 6 cut");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLookahead(), MicroSeconds(500), "wrong lookahead");
+    }
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), MilliSeconds(50), "wrong stop time");
+    m_result.m_events = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(0));
+    return m_result;
+}
+
+void
+MtpTestCase::DoRun()
+{
+    Result reference = Simulate("ns3::DefaultSimulatorImpl", 0);
+    Result single = Simulate("ns3::MultithreadedSimulatorImpl", 1);
+    Result multi = Simulate("ns3::MultithreadedSimulatorImpl", 4);
+    NS_TEST_EXPECT_MSG_EQ(single.m_events, reference.m_events, "wrong number of events");
+    NS_TEST_EXPECT_MSG_EQ(multi.m_events, reference.m_events, "wrong number of events");
+    for (uint32_t node = 0; node < reference.m_received.size(); ++node)
+    {
+        NS_TEST_EXPECT_MSG_GT(reference.m_received[node].size(), 0, "no packet received");
+        // the order of the packets received at the same time depends on the event uids
+        std::vector<Reception> sorted = single.m_received[node];
+        std::sort(sorted.begin(), sorted.end());
+        std::sort(reference.m_received[node].begin(), reference.m_received[node].end());
+        NS_TEST_EXPECT_MSG_EQ((sorted == reference.m_received[node]),
+                              true,
+                              "wrong packets in node " << node);
+        // which must not depend on the threads
+        NS_TEST_EXPECT_MSG_EQ((multi.m_received[node] == single.m_received[node]),
+                              true,
+                              "packets of node " << node << " depend on the threads");
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    MtpTestSuite();
+};
+
+MtpTestSuite::MtpTestSuite()
+    : TestSuite("mtp", UNIT)
+{
+    AddTestCase(new MtpTestCase(), TestCase::QUICK);
+}
+
+/**
+ * \ingroup mtp-tests
+ * MtpTestSuite instance variable.
+ */
+static MtpTestSuite g_mtpTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
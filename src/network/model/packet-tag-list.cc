@@ -150,7 +150,6 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     {
         NS_ASSERT(cur != nullptr);
         NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(cur->size);
         copy->tid = cur->tid;
         copy->count = 1;
@@ -158,6 +157,8 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
         memcpy(copy->data, cur->data, copy->size);
         copy->next = cur->next; // merge into tail
         copy->next->count++;    // mark new merge
+        // unmerge cur last, the other lists may release it as soon as we do
+        cur->count--;
         *prevNext = copy;       // point prior list at copy
         prevNext = &copy->next; // advance
         cur = copy->next;
@@ -201,13 +202,13 @@ PacketTagList::RemoveWriter(Tag& tag,
     else
     {
         // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
         if (cur->next != nullptr)
         {
             // there's a next, so make it a merge
             cur->next->count++;
         }
+        // unmerge cur, since we linked around it already
+        cur->count--;
     }
     return found;
 }
@@ -243,7 +244,6 @@ PacketTagList::ReplaceWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(tag.GetSerializedSize());
         copy->tid = tag.GetInstanceTypeId();
         copy->count = 1;
@@ -253,6 +253,7 @@ PacketTagList::ReplaceWriter(Tag& tag,
         {
             copy->next->count++; // mark new merge
         }
+        cur->count--;     // unmerge cur
         *prevNext = copy; // point prior list at copy
     }
     return found;
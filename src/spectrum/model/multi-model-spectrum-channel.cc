@@ -19,6 +19,7 @@
 
 #include "multi-model-spectrum-channel.h"
 
+#include <ns3/abort.h>
 #include <ns3/angles.h>
 #include <ns3/antenna-model.h>
 #include <ns3/double.h>
@@ -241,6 +242,20 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                           // underlying DynamicCasts)
     m_txSigParamsTrace(txParamsTrace);
 
+    Propagate(txParams, Time(0));
+}
+
+bool
+MultiModelSpectrumChannel::IsLocalReceiver(Ptr<SpectrumPhy> phy) const
+{
+    return true;
+}
+
+void
+MultiModelSpectrumChannel::Propagate(Ptr<SpectrumSignalParameters> txParams, Time elapsed)
+{
+    NS_LOG_FUNCTION(this << txParams << elapsed);
+
     Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility();
     SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid();
     NS_LOG_LOGIC("txSpectrumModelUid " << txSpectrumModelUid);
@@ -291,7 +306,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                           "SpectrumModel change was not notified to MultiModelSpectrumChannel "
                           "(i.e., AddRx should be called again after model is changed)");
 
-            if ((*rxPhyIterator) != txParams->txPhy)
+            if ((*rxPhyIterator) != txParams->txPhy && IsLocalReceiver(*rxPhyIterator))
             {
                 Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
                 Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
@@ -367,6 +382,10 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                         delay = m_propagationDelay->GetDelay(txMobility, receiverMobility);
                     }
                 }
+                delay -= elapsed;
+                NS_ABORT_MSG_IF(delay.IsStrictlyNegative(),
+                                "the propagation delay is shorter than the time elapsed since the "
+                                "start of the transmission");
 
                 if (rxNetDevice)
                 {
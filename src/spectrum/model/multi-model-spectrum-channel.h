@@ -122,6 +122,25 @@ class MultiModelSpectrumChannel : public SpectrumChannel
   protected:
     void DoDispose() override;
 
+    /**
+     * Compute the signal received by each receiver of the channel and
+     * schedule its reception after the propagation delay.
+     *
+     * \param txParams The signal parameters of the transmitter.
+     * \param elapsed The time elapsed since the start of the transmission,
+     *                which is deducted from the propagation delays.
+     */
+    void Propagate(Ptr<SpectrumSignalParameters> txParams, Time elapsed);
+
+    /**
+     * Check whether the reception of a signal by a SpectrumPhy is simulated
+     * here; the receivers simulated elsewhere are skipped by Propagate().
+     *
+     * \param phy The receiver.
+     * \return true, unless overridden.
+     */
+    virtual bool IsLocalReceiver(Ptr<SpectrumPhy> phy) const;
+
   private:
     /**
      * This method checks if m_rxSpectrumModelInfoMap contains an entry
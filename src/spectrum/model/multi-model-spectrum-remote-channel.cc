@@ -0,0 +1,466 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multi-model-spectrum-remote-channel.h"
+
+#include <ns3/abort.h>
+#include <ns3/antenna-model.h>
+#include <ns3/channel-list.h>
+#include <ns3/header.h>
+#include <ns3/log.h>
+#include <ns3/mobility-model.h>
+#include <ns3/mpi-interface.h>
+#include <ns3/mpi-receiver.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
+#include <ns3/phased-array-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/simulator.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-signal-parameters.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultiModelSpectrumRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(MultiModelSpectrumRemoteChannel);
+
+/**
+ * \ingroup spectrum
+ *
+ * Descriptor of a signal sent by a MultiModelSpectrumRemoteChannel to the
+ * other ranks.
+ */
+class RemoteSpectrumSignalHeader : public Header
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+    TypeId GetInstanceTypeId() const override;
+    uint32_t GetSerializedSize() const override;
+    void Serialize(Buffer::Iterator start) const override;
+    uint32_t Deserialize(Buffer::Iterator start) override;
+    void Print(std::ostream& os) const override;
+
+    uint32_t m_channel{0};                           //!< Id of the channel.
+    uint32_t m_txPhy{0};                             //!< Index of the transmitter.
+    int64_t m_start{0};                              //!< Start of the transmission.
+    int64_t m_duration{0};                           //!< Duration of the signal.
+    bool m_txAntenna{false};                         //!< Whether the signal has a txAntenna.
+    Vector m_position;                               //!< Position of the transmitter.
+    uint32_t m_model{0};                             //!< Uid of the SpectrumModel of the PSD.
+    std::vector<double> m_psd;                       //!< Values of the PSD.
+    PhasedArrayModel::ComplexVector m_beamforming{}; //!< Beamforming vector of the transmitter.
+
+  private:
+    /**
+     * Write a double.
+     *
+     * \param i The buffer iterator.
+     * \param value The value.
+     */
+    static void WriteDouble(Buffer::Iterator& i, double value);
+
+    /**
+     * Read a double.
+     *
+     * \param i The buffer iterator.
+     * \return The value.
+     */
+    static double ReadDouble(Buffer::Iterator& i);
+};
+
+NS_OBJECT_ENSURE_REGISTERED(RemoteSpectrumSignalHeader);
+
+TypeId
+RemoteSpectrumSignalHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::RemoteSpectrumSignalHeader")
+                            .SetParent<Header>()
+                            .SetGroupName("Spectrum")
+                            .AddConstructor<RemoteSpectrumSignalHeader>();
+    return tid;
+}
+
+TypeId
+RemoteSpectrumSignalHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+uint32_t
+RemoteSpectrumSignalHeader::GetSerializedSize() const
+{
+    return 4 + 4 + 8 + 8 + 1 + 3 * 8 + 4 + 4 + 8 * m_psd.size() + 2 +
+           16 * m_beamforming.GetSize();
+}
+
+void
+RemoteSpectrumSignalHeader::WriteDouble(Buffer::Iterator& i, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    i.WriteHtonU64(bits);
+}
+
+double
+RemoteSpectrumSignalHeader::ReadDouble(Buffer::Iterator& i)
+{
+    uint64_t bits = i.ReadNtohU64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void
+RemoteSpectrumSignalHeader::Serialize(Buffer::Iterator start) const
+{
+    Buffer::Iterator i = start;
+    i.WriteHtonU32(m_channel);
+    i.WriteHtonU32(m_txPhy);
+    i.WriteHtonU64(m_start);
+    i.WriteHtonU64(m_duration);
+    i.WriteU8(m_txAntenna);
+    WriteDouble(i, m_position.x);
+    WriteDouble(i, m_position.y);
+    WriteDouble(i, m_position.z);
+    i.WriteHtonU32(m_model);
+    i.WriteHtonU32(m_psd.size());
+    for (double value : m_psd)
+    {
+        WriteDouble(i, value);
+    }
+    i.WriteHtonU16(m_beamforming.GetSize());
+    for (size_t j = 0; j < m_beamforming.GetSize(); ++j)
+    {
+        WriteDouble(i, m_beamforming[j].real());
+        WriteDouble(i, m_beamforming[j].imag());
+    }
+}
+
+uint32_t
+RemoteSpectrumSignalHeader::Deserialize(Buffer::Iterator start)
+{
+    Buffer::Iterator i = start;
+    m_channel = i.ReadNtohU32();
+    m_txPhy = i.ReadNtohU32();
+    m_start = i.ReadNtohU64();
+    m_duration = i.ReadNtohU64();
+    m_txAntenna = i.ReadU8();
+    m_position.x = ReadDouble(i);
+    m_position.y = ReadDouble(i);
+    m_position.z = ReadDouble(i);
+    m_model = i.ReadNtohU32();
+    m_psd.resize(i.ReadNtohU32());
+    for (double& value : m_psd)
+    {
+        value = ReadDouble(i);
+    }
+    m_beamforming = PhasedArrayModel::ComplexVector(i.ReadNtohU16());
+    for (size_t j = 0; j < m_beamforming.GetSize(); ++j)
+    {
+        double real = ReadDouble(i);
+        m_beamforming[j] = std::complex<double>(real, ReadDouble(i));
+    }
+    return GetSerializedSize();
+}
+
+void
+RemoteSpectrumSignalHeader::Print(std::ostream& os) const
+{
+    os << "channel=" << m_channel << " txPhy=" << m_txPhy << " start=" << m_start
+       << " duration=" << m_duration << " position=" << m_position << " model=" << m_model
+       << " values=" << m_psd.size() << " beamforming=" << m_beamforming.GetSize();
+}
+
+TypeId
+MultiModelSpectrumRemoteChannel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultiModelSpectrumRemoteChannel")
+            .SetParent<MultiModelSpectrumChannel>()
+            .SetGroupName("Spectrum")
+            .AddConstructor<MultiModelSpectrumRemoteChannel>()
+            .AddAttribute("Lookahead",
+                          "The smallest propagation delay between two SpectrumPhy of different "
+                          "ranks, or zero to compute it from the positions at the start of "
+                          "the simulation.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultiModelSpectrumRemoteChannel::SetLookahead,
+                                           &MultiModelSpectrumRemoteChannel::GetLookahead),
+                          MakeTimeChecker());
+    return tid;
+}
+
+MultiModelSpectrumRemoteChannel::MultiModelSpectrumRemoteChannel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MultiModelSpectrumRemoteChannel::~MultiModelSpectrumRemoteChannel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultiModelSpectrumRemoteChannel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_updateRanks.Cancel();
+    m_phys.clear();
+    m_phyIndex.clear();
+    m_models.clear();
+    m_ranks.clear();
+    m_serializer = MakeNullCallback<Ptr<Packet>, Ptr<const SpectrumSignalParameters>>();
+    m_deserializer = MakeNullCallback<Ptr<SpectrumSignalParameters>, Ptr<Packet>>();
+    MultiModelSpectrumChannel::DoDispose();
+}
+
+void
+MultiModelSpectrumRemoteChannel::SetSignalSerializer(SignalSerializer serializer,
+                                                     SignalDeserializer deserializer)
+{
+    m_serializer = serializer;
+    m_deserializer = deserializer;
+}
+
+void
+MultiModelSpectrumRemoteChannel::SetLookahead(Time lookahead)
+{
+    m_lookahead = lookahead;
+}
+
+Time
+MultiModelSpectrumRemoteChannel::GetLookahead() const
+{
+    if (!m_lookahead.IsZero())
+    {
+        return m_lookahead;
+    }
+    if (!m_computedLookahead.IsZero())
+    {
+        return m_computedLookahead;
+    }
+
+    // every rank must find the same value, hence all the pairs of ranks
+    m_computedLookahead = Simulator::GetMaximumSimulationTime();
+    for (std::size_t i = 0; i < m_phys.size(); ++i)
+    {
+        uint32_t rank = GetRank(m_phys[i]);
+        Ptr<MobilityModel> mobility = m_phys[i]->GetMobility();
+        for (std::size_t j = i + 1; j < m_phys.size(); ++j)
+        {
+            if (GetRank(m_phys[j]) == rank)
+            {
+                continue;
+            }
+            NS_ABORT_MSG_UNLESS(m_propagationDelay && mobility && m_phys[j]->GetMobility(),
+                                "a propagation delay model and the mobility of the SpectrumPhy "
+                                "are needed to compute the lookahead");
+            m_computedLookahead =
+                std::min(m_computedLookahead,
+                         m_propagationDelay->GetDelay(mobility, m_phys[j]->GetMobility()));
+        }
+    }
+    NS_ABORT_MSG_IF(m_computedLookahead.IsZero(),
+                    "two SpectrumPhy of different ranks are co-located");
+    NS_LOG_LOGIC("lookahead " << m_computedLookahead);
+    return m_computedLookahead;
+}
+
+uint32_t
+MultiModelSpectrumRemoteChannel::GetRank(Ptr<SpectrumPhy> phy)
+{
+    Ptr<NetDevice> device = phy->GetDevice();
+    if (!device || !device->GetNode())
+    {
+        return 0;
+    }
+    return device->GetNode()->GetSystemId();
+}
+
+bool
+MultiModelSpectrumRemoteChannel::IsLocalReceiver(Ptr<SpectrumPhy> phy) const
+{
+    return GetRank(phy) == MpiInterface::GetSystemId();
+}
+
+void
+MultiModelSpectrumRemoteChannel::AddRx(Ptr<SpectrumPhy> phy)
+{
+    NS_LOG_FUNCTION(this << phy);
+    MultiModelSpectrumChannel::AddRx(phy);
+
+    if (m_phyIndex.emplace(PeekPointer(phy), m_phys.size()).second)
+    {
+        m_phys.push_back(phy);
+        m_computedLookahead = Time(0);
+    }
+    Ptr<const SpectrumModel> model = phy->GetRxSpectrumModel();
+    m_models.emplace(model->GetUid(), model);
+
+    // the device may not be attached to its node yet
+    if (!m_updateRanks.IsRunning())
+    {
+        m_updateRanks =
+            Simulator::ScheduleNow(&MultiModelSpectrumRemoteChannel::UpdateRanks, this);
+    }
+}
+
+void
+MultiModelSpectrumRemoteChannel::UpdateRanks()
+{
+    NS_LOG_FUNCTION(this);
+    m_ranks.clear();
+    for (const auto& phy : m_phys)
+    {
+        Ptr<NetDevice> device = phy->GetDevice();
+        if (!device || !device->GetNode())
+        {
+            continue;
+        }
+        uint32_t rank = device->GetNode()->GetSystemId();
+        if (!m_ranks.emplace(rank, std::make_pair(device->GetNode()->GetId(), device->GetIfIndex()))
+                 .second ||
+            rank != MpiInterface::GetSystemId())
+        {
+            continue;
+        }
+        Ptr<MpiReceiver> receiver = device->GetObject<MpiReceiver>();
+        if (!receiver)
+        {
+            receiver = CreateObject<MpiReceiver>();
+            device->AggregateObject(receiver);
+        }
+        receiver->SetReceiveCallback(MakeCallback(&MultiModelSpectrumRemoteChannel::Receive));
+    }
+}
+
+void
+MultiModelSpectrumRemoteChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
+{
+    NS_LOG_FUNCTION(this << txParams);
+
+    if (m_updateRanks.IsRunning())
+    {
+        m_updateRanks.Cancel();
+        UpdateRanks();
+    }
+
+    uint32_t rank = MpiInterface::GetSystemId();
+    if (m_ranks.size() > 1 || (m_ranks.size() == 1 && m_ranks.begin()->first != rank))
+    {
+        auto index = m_phyIndex.find(PeekPointer(txParams->txPhy));
+        NS_ABORT_MSG_IF(index == m_phyIndex.end(),
+                        "the transmitter must be added to the channel with AddRx");
+
+        RemoteSpectrumSignalHeader header;
+        header.m_channel = GetId();
+        header.m_txPhy = index->second;
+        header.m_start = Simulator::Now().GetTimeStep();
+        header.m_duration = txParams->duration.GetTimeStep();
+        header.m_txAntenna = txParams->txAntenna != nullptr;
+        Ptr<MobilityModel> mobility = txParams->txPhy->GetMobility();
+        if (mobility)
+        {
+            header.m_position = mobility->GetPosition();
+        }
+        header.m_model = txParams->psd->GetSpectrumModelUid();
+        header.m_psd.assign(txParams->psd->ConstValuesBegin(), txParams->psd->ConstValuesEnd());
+        Ptr<const PhasedArrayModel> array =
+            DynamicCast<const PhasedArrayModel>(txParams->txPhy->GetAntenna());
+        if (array)
+        {
+            header.m_beamforming = array->GetBeamformingVector();
+        }
+
+        Ptr<Packet> packet = m_serializer.IsNull() ? Create<Packet>() : m_serializer(txParams);
+        packet->AddHeader(header);
+
+        Time rxTime = Simulator::Now() + GetLookahead();
+        for (const auto& [remote, device] : m_ranks)
+        {
+            if (remote != rank)
+            {
+                MpiInterface::SendPacket(packet->Copy(), rxTime, device.first, device.second);
+            }
+        }
+    }
+
+    MultiModelSpectrumChannel::StartTx(txParams);
+}
+
+void
+MultiModelSpectrumRemoteChannel::Receive(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(packet);
+    RemoteSpectrumSignalHeader header;
+    packet->RemoveHeader(header);
+    Ptr<MultiModelSpectrumRemoteChannel> channel =
+        DynamicCast<MultiModelSpectrumRemoteChannel>(ChannelList::GetChannel(header.m_channel));
+    NS_ASSERT_MSG(channel, "channel " << header.m_channel << " is not a remote spectrum channel");
+    channel->StartRemoteTx(header, packet);
+}
+
+void
+MultiModelSpectrumRemoteChannel::StartRemoteTx(const RemoteSpectrumSignalHeader& header,
+                                               Ptr<Packet> payload)
+{
+    NS_LOG_FUNCTION(this << payload);
+    NS_ASSERT(header.m_txPhy < m_phys.size());
+    Ptr<SpectrumPhy> txPhy = m_phys[header.m_txPhy];
+
+    // the copy of the transmitter on this rank follows the original
+    Ptr<MobilityModel> mobility = txPhy->GetMobility();
+    if (mobility && mobility->GetPosition() != header.m_position)
+    {
+        mobility->SetPosition(header.m_position);
+    }
+    Ptr<PhasedArrayModel> array = DynamicCast<PhasedArrayModel>(txPhy->GetAntenna());
+    if (array && header.m_beamforming.GetSize() > 0)
+    {
+        array->SetBeamformingVector(header.m_beamforming);
+    }
+
+    auto model = m_models.find(header.m_model);
+    NS_ABORT_MSG_IF(model == m_models.end(),
+                    "SpectrumModel " << header.m_model
+                                     << " is not the receive model of a SpectrumPhy");
+    Ptr<SpectrumValue> psd = Create<SpectrumValue>(model->second);
+    NS_ASSERT(psd->GetValuesN() == header.m_psd.size());
+    std::copy(header.m_psd.begin(), header.m_psd.end(), psd->ValuesBegin());
+
+    Ptr<SpectrumSignalParameters> params = m_deserializer.IsNull()
+                                               ? Create<SpectrumSignalParameters>()
+                                               : m_deserializer(payload);
+    params->psd = psd;
+    params->duration = TimeStep(header.m_duration);
+    params->txPhy = txPhy;
+    if (header.m_txAntenna)
+    {
+        params->txAntenna = DynamicCast<AntennaModel>(txPhy->GetAntenna());
+    }
+
+    Propagate(params, Simulator::Now() - TimeStep(header.m_start));
+}
+
+} // namespace ns3
@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H
+#define MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H
+
+#include <ns3/callback.h>
+#include <ns3/event-id.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/nstime.h>
+#include <ns3/packet.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class RemoteSpectrumSignalHeader;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief MultiModelSpectrumChannel whose SpectrumPhy instances are split
+ * across the ranks of a distributed simulation.
+ *
+ * As with the other channels of a distributed simulation, every rank
+ * builds the whole topology, and the SpectrumPhy instances attached to a
+ * node belong to the rank of that node. A rank computes the reception of
+ * the signals by its own receivers only. When one of its SpectrumPhy
+ * transmits, the channel sends a compact descriptor of the signal to each
+ * other rank with receivers on the channel: the index of the transmitter,
+ * its position and beamforming vector, the SpectrumModel uid and values of
+ * the PSD, and the duration. The descriptor arrives one lookahead after
+ * the start of the transmission, and the receiving rank applies the
+ * position and the beamforming vector to its copy of the transmitter,
+ * then computes the propagation loss and schedules the receptions of its
+ * own receivers at the end of their propagation delay.
+ *
+ * The lookahead is the smallest propagation delay between two SpectrumPhy
+ * of different ranks at the time it is first needed, usually the start of
+ * the simulation, unless set with the \c Lookahead attribute. The channel
+ * thus needs a PropagationDelayModel, and aborts when a receiver gets
+ * closer to a remote transmitter than the lookahead allows: the attribute
+ * must then be set to a lower bound of the delays for the whole simulation.
+ *
+ * The technology-specific fields of the signal parameters, such as the
+ * packet of the HalfDuplexIdealPhySignalParameters, are not known to the
+ * channel. They are shipped in a packet produced by the serializer set
+ * with SetSignalSerializer(), and the deserializer creates the signal
+ * parameters of the right type from it on the receiving rank. Without a
+ * serializer, the remote receivers get plain SpectrumSignalParameters,
+ * which are enough to model the interference.
+ *
+ * The spectrum models are looked up by uid on the receiving rank, among
+ * the receive models of the SpectrumPhy of the channel, which requires
+ * every rank to create them in the same order.
+ */
+class MultiModelSpectrumRemoteChannel : public MultiModelSpectrumChannel
+{
+  public:
+    MultiModelSpectrumRemoteChannel();
+    ~MultiModelSpectrumRemoteChannel() override;
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    // inherited from MultiModelSpectrumChannel
+    void AddRx(Ptr<SpectrumPhy> phy) override;
+    void StartTx(Ptr<SpectrumSignalParameters> params) override;
+
+    /**
+     * Callback serializing the technology-specific fields of the signal
+     * parameters to a packet.
+     */
+    typedef Callback<Ptr<Packet>, Ptr<const SpectrumSignalParameters>> SignalSerializer;
+
+    /**
+     * Callback creating signal parameters from the packet built by the
+     * SignalSerializer; the channel then fills the base fields.
+     */
+    typedef Callback<Ptr<SpectrumSignalParameters>, Ptr<Packet>> SignalDeserializer;
+
+    /**
+     * Set the callbacks shipping the technology-specific fields of the
+     * signal parameters to the other ranks.
+     *
+     * \param serializer The serializer.
+     * \param deserializer The deserializer.
+     */
+    void SetSignalSerializer(SignalSerializer serializer, SignalDeserializer deserializer);
+
+    /**
+     * Set the lookahead.
+     *
+     * \param lookahead The smallest propagation delay between two SpectrumPhy
+     *                  of different ranks, or zero to compute it.
+     */
+    void SetLookahead(Time lookahead);
+
+    /**
+     * Get the lookahead, computing it if needed.
+     *
+     * \return The lookahead, or the maximum simulation time if the
+     *         SpectrumPhy instances all belong to this rank.
+     */
+    Time GetLookahead() const;
+
+  protected:
+    void DoDispose() override;
+    bool IsLocalReceiver(Ptr<SpectrumPhy> phy) const override;
+
+  private:
+    /**
+     * Get the rank of a SpectrumPhy.
+     *
+     * \param phy The SpectrumPhy.
+     * \return The system id of its node, or 0 if it has no node.
+     */
+    static uint32_t GetRank(Ptr<SpectrumPhy> phy);
+
+    /**
+     * Find the device receiving the descriptors on each rank, and attach
+     * the MpiReceiver to the one of this rank. This is done at the start of
+     * the simulation and after the SpectrumPhy instances change.
+     */
+    void UpdateRanks();
+
+    /**
+     * Receive a descriptor, on the device of this rank.
+     *
+     * \param packet The descriptor.
+     */
+    static void Receive(Ptr<Packet> packet);
+
+    /**
+     * Rebuild a remote signal and propagate it to the receivers of this rank.
+     *
+     * \param header The descriptor.
+     * \param payload The technology-specific fields.
+     */
+    void StartRemoteTx(const RemoteSpectrumSignalHeader& header, Ptr<Packet> payload);
+
+    std::vector<Ptr<SpectrumPhy>> m_phys;                  //!< The SpectrumPhy, by index.
+    std::unordered_map<SpectrumPhy*, uint32_t> m_phyIndex; //!< Index of each SpectrumPhy.
+    /// The receive spectrum models of the SpectrumPhy, by uid.
+    std::map<SpectrumModelUid_t, Ptr<const SpectrumModel>> m_models;
+    /// The node and device receiving the descriptors on each other rank.
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> m_ranks;
+    EventId m_updateRanks;             //!< Pending update of m_ranks.
+    Time m_lookahead;                  //!< The lookahead set by the user, or zero.
+    mutable Time m_computedLookahead;  //!< The computed lookahead, zero when not known.
+    SignalSerializer m_serializer;     //!< Serializer of the technology fields.
+    SignalDeserializer m_deserializer; //!< Deserializer of the technology fields.
+};
+
+} // namespace ns3
+
+#endif /* MULTI_MODEL_SPECTRUM_REMOTE_CHANNEL_H */
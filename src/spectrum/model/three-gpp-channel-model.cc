@@ -29,10 +29,16 @@
 #include "ns3/phased-array-model.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include <ns3/simulator.h>
+#include <ns3/trace-source-accessor.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <random>
+#include <thread>
 
 namespace ns3
 {
@@ -245,6 +251,10 @@ static const double sqrtC_office_NLOS[6][6] = {
 };
 
 ThreeGppChannelModel::ThreeGppChannelModel()
+    : m_fullUpdates(0),
+      m_incrementalUpdates(0),
+      m_pairStreams(-1),
+      m_lastPrefetch(Time::Min())
 {
     NS_LOG_FUNCTION(this);
     m_uniformRv = CreateObject<UniformRandomVariable>();
@@ -272,6 +282,9 @@ ThreeGppChannelModel::DoDispose()
     m_channelMatrixMap.clear();
     m_channelParamsMap.clear();
     m_channelConditionModel = nullptr;
+    m_prefetchEvent.Cancel();
+    m_prefetchPairs.clear();
+    m_pairRv.clear();
 }
 
 TypeId
@@ -306,6 +319,29 @@ ThreeGppChannelModel::GetTypeId()
                           TimeValue(MilliSeconds(0)),
                           MakeTimeAccessor(&ThreeGppChannelModel::m_updatePeriod),
                           MakeTimeChecker())
+            .AddAttribute("SinglePrecision",
+                          "Synthesize the clusters of the channel matrix in single precision, "
+                          "which halves the memory traffic of large arrays at the cost of "
+                          "accuracy",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&ThreeGppChannelModel::m_singlePrecision),
+                          MakeBooleanChecker())
+            .AddAttribute("SpatialConsistencyUpdate",
+                          "Update the channel params incrementally when the update period "
+                          "expires, following the spatial consistency procedure of "
+                          "3GPP TR 38.901 Sec. 7.6.3.2, instead of generating new ones",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&ThreeGppChannelModel::m_spatialConsistency),
+                          MakeBooleanChecker())
+            .AddAttribute("PrefetchThreads",
+                          "The number of threads regenerating the channels of the known pairs "
+                          "of devices at each multiple of the update period, ahead of need, or "
+                          "0 to generate each channel on request. The params of each pair of "
+                          "nodes are then drawn from their own random variables, so that the "
+                          "channels do not depend on the number of threads",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&ThreeGppChannelModel::m_prefetchThreads),
+                          MakeUintegerChecker<uint32_t>())
             // attributes for the blockage model
             .AddAttribute("Blockage",
                           "Enable blockage model A (sec 7.6.4.1)",
@@ -335,6 +371,19 @@ ThreeGppChannelModel::GetTypeId()
                           DoubleValue(0.0),
                           MakeDoubleAccessor(&ThreeGppChannelModel::m_vScatt),
                           MakeDoubleChecker<double>(0.0))
+            .AddTraceSource("FullUpdates",
+                            "Number of regenerations of the channel params of a pair of nodes",
+                            MakeTraceSourceAccessor(&ThreeGppChannelModel::m_fullUpdates),
+                            "ns3::TracedValueCallback::Uint64")
+            .AddTraceSource("IncrementalUpdates",
+                            "Number of incremental updates of the channel params of a pair of "
+                            "nodes",
+                            MakeTraceSourceAccessor(&ThreeGppChannelModel::m_incrementalUpdates),
+                            "ns3::TracedValueCallback::Uint64")
+            .AddTraceSource("ChannelUpdate",
+                            "The channel params of a pair of nodes were updated",
+                            MakeTraceSourceAccessor(&ThreeGppChannelModel::m_channelUpdateTrace),
+                            "ns3::ThreeGppChannelModel::ChannelUpdateTracedCallback")
 
         ;
     return tid;
@@ -1107,6 +1156,15 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     // Compute the channel matrix key. The key is reciprocal, i.e., key (a, b) = key (b, a)
     uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
 
+    if (m_prefetchThreads > 0)
+    {
+        if (m_prefetchPairs.find(channelMatrixKey) == m_prefetchPairs.end())
+        {
+            AddPrefetchPair(aMob, bMob, aAntenna, bAntenna);
+        }
+        SchedulePrefetch();
+    }
+
     // retrieve the channel condition
     Ptr<const ChannelCondition> condition =
         m_channelConditionModel->GetChannelCondition(aMob, bMob);
@@ -1144,7 +1202,18 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     // get the 3GPP parameters
     Ptr<const ParamsTable> table3gpp = GetThreeGppTable(condition, hBs, hUt, distance2D);
 
-    if (notFoundParams || updateParams)
+    auto updateStart = std::chrono::steady_clock::now();
+    bool incremental = false;
+    if (updateParams && m_spatialConsistency &&
+        condition->IsEqual(channelParams->m_losCondition, channelParams->m_o2iCondition))
+    {
+        // the coherence time is over, but the clusters still exist: move them
+        channelParams = UpdateChannelParameters(channelParams, GetPairState(aMob, bMob));
+        m_channelParamsMap[channelParamsKey] = channelParams;
+        incremental = true;
+        m_incrementalUpdates++;
+    }
+    else if (notFoundParams || updateParams)
     {
         // Step 4: Generate large scale parameters. All LSPS are uncorrelated.
         // Step 5: Generate Delays.
@@ -1154,9 +1223,16 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         // shuffle all the arrays to perform random coupling
         // Step 9: Generate the cross polarization power ratios
         // Step 10: Draw initial phases
-        channelParams = GenerateChannelParameters(condition, table3gpp, aMob, bMob);
+        channelParams = GenerateChannelParameters(condition,
+                                                  table3gpp,
+                                                  GetPairState(aMob, bMob),
+                                                  GetRandomVariables(channelParamsKey));
         // store or replace the channel parameters
         m_channelParamsMap[channelParamsKey] = channelParams;
+        if (updateParams)
+        {
+            m_fullUpdates++;
+        }
     }
 
     if (m_channelMatrixMap.find(channelMatrixKey) != m_channelMatrixMap.end())
@@ -1177,7 +1253,8 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     if (notFoundMatrix || updateMatrix)
     {
         // channel matrix not found or has to be updated, generate a new one
-        channelMatrix = GetNewChannel(channelParams, table3gpp, aMob, bMob, aAntenna, bAntenna);
+        channelMatrix =
+            GetNewChannel(channelParams, table3gpp, GetPairState(aMob, bMob), aAntenna, bAntenna);
         channelMatrix->m_antennaPair =
             std::make_pair(aAntenna->GetId(),
                            bAntenna->GetId()); // save antenna pair, with the exact order of s and u
@@ -1187,6 +1264,16 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         m_channelMatrixMap[channelMatrixKey] = channelMatrix;
     }
 
+    if (updateParams)
+    {
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - updateStart);
+        m_channelUpdateTrace(channelParams->m_nodeIds.first,
+                             channelParams->m_nodeIds.second,
+                             incremental,
+                             NanoSeconds(duration.count()));
+    }
+
     return channelMatrix;
 }
 
@@ -1210,18 +1297,287 @@ ThreeGppChannelModel::GetParams(Ptr<const MobilityModel> aMob, Ptr<const Mobilit
     }
 }
 
+ThreeGppChannelModel::PairState
+ThreeGppChannelModel::GetPairState(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob)
+{
+    PairState pair;
+    pair.m_time = Simulator::Now();
+    pair.m_aId = aMob->GetObject<Node>()->GetId();
+    pair.m_bId = bMob->GetObject<Node>()->GetId();
+    pair.m_aPosition = aMob->GetPosition();
+    pair.m_bPosition = bMob->GetPosition();
+    pair.m_aVelocity = aMob->GetVelocity();
+    pair.m_bVelocity = bMob->GetVelocity();
+    return pair;
+}
+
+ThreeGppChannelModel::ChannelRandomVariables
+ThreeGppChannelModel::GetRandomVariables(uint64_t channelParamsKey)
+{
+    if (m_prefetchThreads == 0)
+    {
+        return {m_normalRv, m_uniformRv, m_uniformRvShuffle, m_uniformRvDoppler};
+    }
+
+    // the draws of a pair do not depend on the order in which the pairs are generated
+    auto it = m_pairRv.find(channelParamsKey);
+    if (it == m_pairRv.end())
+    {
+        ChannelRandomVariables rv;
+        rv.m_normalRv = CreateObject<NormalRandomVariable>();
+        rv.m_normalRv->SetAttribute("Mean", DoubleValue(0.0));
+        rv.m_normalRv->SetAttribute("Variance", DoubleValue(1.0));
+        rv.m_uniformRv = CreateObject<UniformRandomVariable>();
+        rv.m_uniformRvShuffle = CreateObject<UniformRandomVariable>();
+        rv.m_uniformRvDoppler = CreateObject<UniformRandomVariable>();
+        if (m_pairStreams >= 0)
+        {
+            int64_t stream = m_pairStreams + 4 * m_pairRv.size();
+            rv.m_normalRv->SetStream(stream);
+            rv.m_uniformRv->SetStream(stream + 1);
+            rv.m_uniformRvShuffle->SetStream(stream + 2);
+            rv.m_uniformRvDoppler->SetStream(stream + 3);
+        }
+        it = m_pairRv.emplace(channelParamsKey, rv).first;
+    }
+    return it->second;
+}
+
+void
+ThreeGppChannelModel::AddPrefetchPair(Ptr<const MobilityModel> aMob,
+                                      Ptr<const MobilityModel> bMob,
+                                      Ptr<const PhasedArrayModel> aAntenna,
+                                      Ptr<const PhasedArrayModel> bAntenna)
+{
+    NS_LOG_FUNCTION(this << aMob << bMob << aAntenna << bAntenna);
+
+    uint64_t channelParamsKey =
+        GetKey(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId());
+    uint64_t channelMatrixKey = GetKey(aAntenna->GetId(), bAntenna->GetId());
+    m_prefetchPairs.emplace(channelMatrixKey,
+                            PrefetchPair{aMob, bMob, aAntenna, bAntenna, channelParamsKey});
+    SchedulePrefetch();
+}
+
+void
+ThreeGppChannelModel::SchedulePrefetch()
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_prefetchThreads == 0 || m_updatePeriod.IsZero() || m_prefetchEvent.IsRunning())
+    {
+        return;
+    }
+    // the channels are regenerated at the multiples of the update period
+    // following a request, so that the simulation ends once they are idle
+    int64_t period = m_updatePeriod.GetTimeStep();
+    int64_t now = Simulator::Now().GetTimeStep();
+    Time next = TimeStep((now + period - 1) / period * period);
+    if (next == m_lastPrefetch)
+    {
+        next += m_updatePeriod;
+    }
+    m_prefetchEvent =
+        Simulator::Schedule(next - Simulator::Now(), &ThreeGppChannelModel::Prefetch, this);
+}
+
+/**
+ * Call a function for each index in [0, n), on up to nThreads threads,
+ * including the calling one
+ *
+ * \param nThreads the number of threads
+ * \param n the number of indices
+ * \param f the function
+ */
+template <typename F>
+static void
+ParallelFor(uint32_t nThreads, size_t n, F f)
+{
+    std::atomic<size_t> next{0};
+    auto work = [&next, &f, n]() {
+        for (size_t i = next++; i < n; i = next++)
+        {
+            f(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min<size_t>(nThreads, n); t++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void
+ThreeGppChannelModel::Prefetch()
+{
+    NS_LOG_FUNCTION(this);
+
+    // The mobility and channel condition models are queried on this thread
+    // only, and the worker threads copy no Ptr to a shared object, since the
+    // reference counts are not atomic: the jobs hold the state of the pairs.
+    struct ParamsJob
+    {
+        uint64_t m_channelParamsKey;                 //!< the key of the pair of nodes
+        PairState m_pair;                            //!< the state of the pair
+        Ptr<const ChannelCondition> m_condition;     //!< the channel condition
+        Ptr<const ParamsTable> m_table3gpp;          //!< the 3gpp parameters
+        ChannelRandomVariables m_rv;                 //!< the random variables of the pair
+        Ptr<const ThreeGppChannelParams> m_previous; //!< the current params, if any
+        bool m_update;                               //!< the params have to be updated
+        bool m_incremental;                          //!< update with spatial consistency
+        Ptr<ThreeGppChannelParams> m_params;         //!< the new params
+        std::chrono::nanoseconds m_duration;         //!< time spent on the pair
+    };
+
+    struct MatrixJob
+    {
+        uint64_t m_channelMatrixKey;               //!< the key of the pair of devices
+        const PrefetchPair* m_prefetchPair;        //!< the pair of devices
+        ParamsJob* m_paramsJob;                    //!< the job of the pair of nodes
+        PairState m_pair;                          //!< the state of the pair, from a to b
+        Ptr<const ThreeGppChannelParams> m_params; //!< the channel params
+        Ptr<ChannelMatrix> m_matrix;               //!< the new matrix
+        std::chrono::nanoseconds m_duration;       //!< time spent on the matrix
+    };
+
+    std::vector<ParamsJob> paramsJobs;
+    std::unordered_map<uint64_t, size_t> paramsJobIndex;
+    for (const auto& [channelMatrixKey, prefetchPair] : m_prefetchPairs)
+    {
+        if (paramsJobIndex.count(prefetchPair.m_channelParamsKey) > 0)
+        {
+            continue;
+        }
+        paramsJobIndex[prefetchPair.m_channelParamsKey] = paramsJobs.size();
+        ParamsJob job;
+        job.m_channelParamsKey = prefetchPair.m_channelParamsKey;
+        job.m_pair = GetPairState(prefetchPair.m_aMob, prefetchPair.m_bMob);
+        job.m_condition =
+            m_channelConditionModel->GetChannelCondition(prefetchPair.m_aMob, prefetchPair.m_bMob);
+        double x = job.m_pair.m_aPosition.x - job.m_pair.m_bPosition.x;
+        double y = job.m_pair.m_aPosition.y - job.m_pair.m_bPosition.y;
+        double hUt = std::min(job.m_pair.m_aPosition.z, job.m_pair.m_bPosition.z);
+        double hBs = std::max(job.m_pair.m_aPosition.z, job.m_pair.m_bPosition.z);
+        job.m_table3gpp = GetThreeGppTable(job.m_condition, hBs, hUt, sqrt(x * x + y * y));
+        job.m_rv = GetRandomVariables(job.m_channelParamsKey);
+        auto it = m_channelParamsMap.find(job.m_channelParamsKey);
+        if (it != m_channelParamsMap.end())
+        {
+            job.m_previous = it->second;
+        }
+        // the params generated on request at this time are already fresh
+        job.m_update = !job.m_previous || job.m_previous->m_generatedTime != Simulator::Now();
+        job.m_incremental = job.m_previous && m_spatialConsistency &&
+                            job.m_condition->IsEqual(job.m_previous->m_losCondition,
+                                                     job.m_previous->m_o2iCondition);
+        job.m_duration = std::chrono::nanoseconds(0);
+        paramsJobs.push_back(job);
+    }
+
+    ParallelFor(m_prefetchThreads, paramsJobs.size(), [this, &paramsJobs](size_t i) {
+        ParamsJob& job = paramsJobs[i];
+        if (!job.m_update)
+        {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (job.m_incremental)
+        {
+            job.m_params = UpdateChannelParameters(job.m_previous, job.m_pair);
+        }
+        else
+        {
+            job.m_params =
+                GenerateChannelParameters(job.m_condition, job.m_table3gpp, job.m_pair, job.m_rv);
+        }
+        job.m_duration = std::chrono::steady_clock::now() - start;
+    });
+
+    std::vector<MatrixJob> matrixJobs;
+    for (auto& job : paramsJobs)
+    {
+        if (job.m_update)
+        {
+            m_channelParamsMap[job.m_channelParamsKey] = job.m_params;
+        }
+    }
+    for (const auto& [channelMatrixKey, prefetchPair] : m_prefetchPairs)
+    {
+        ParamsJob& paramsJob = paramsJobs[paramsJobIndex[prefetchPair.m_channelParamsKey]];
+        Ptr<const ThreeGppChannelParams> channelParams =
+            m_channelParamsMap[prefetchPair.m_channelParamsKey];
+        auto it = m_channelMatrixMap.find(channelMatrixKey);
+        if (it != m_channelMatrixMap.end() && !ChannelMatrixNeedsUpdate(channelParams, it->second))
+        {
+            continue;
+        }
+        MatrixJob job;
+        job.m_channelMatrixKey = channelMatrixKey;
+        job.m_prefetchPair = &prefetchPair;
+        job.m_paramsJob = &paramsJob;
+        job.m_pair = GetPairState(prefetchPair.m_aMob, prefetchPair.m_bMob);
+        job.m_params = channelParams;
+        matrixJobs.push_back(job);
+    }
+
+    ParallelFor(m_prefetchThreads, matrixJobs.size(), [this, &matrixJobs](size_t i) {
+        MatrixJob& job = matrixJobs[i];
+        auto start = std::chrono::steady_clock::now();
+        job.m_matrix = GetNewChannel(job.m_params,
+                                     job.m_paramsJob->m_table3gpp,
+                                     job.m_pair,
+                                     job.m_prefetchPair->m_aAntenna,
+                                     job.m_prefetchPair->m_bAntenna);
+        job.m_duration = std::chrono::steady_clock::now() - start;
+    });
+
+    for (auto& job : matrixJobs)
+    {
+        job.m_matrix->m_antennaPair = std::make_pair(job.m_prefetchPair->m_aAntenna->GetId(),
+                                                     job.m_prefetchPair->m_bAntenna->GetId());
+        m_channelMatrixMap[job.m_channelMatrixKey] = job.m_matrix;
+        job.m_paramsJob->m_duration += job.m_duration;
+    }
+    for (const auto& job : paramsJobs)
+    {
+        if (!job.m_update || !job.m_previous)
+        {
+            continue;
+        }
+        if (job.m_incremental)
+        {
+            m_incrementalUpdates++;
+        }
+        else
+        {
+            m_fullUpdates++;
+        }
+        m_channelUpdateTrace(job.m_params->m_nodeIds.first,
+                             job.m_params->m_nodeIds.second,
+                             job.m_incremental,
+                             NanoSeconds(job.m_duration.count()));
+    }
+    NS_LOG_DEBUG("Prefetched " << paramsJobs.size() << " params and " << matrixJobs.size()
+                               << " matrices");
+    m_lastPrefetch = Simulator::Now();
+}
+
 Ptr<ThreeGppChannelModel::ThreeGppChannelParams>
-ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition> channelCondition,
-                                                const Ptr<const ParamsTable> table3gpp,
-                                                const Ptr<const MobilityModel> aMob,
-                                                const Ptr<const MobilityModel> bMob) const
+ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition>& channelCondition,
+                                                const Ptr<const ParamsTable>& table3gpp,
+                                                const PairState& pair,
+                                                const ChannelRandomVariables& rv) const
 {
     NS_LOG_FUNCTION(this);
     // create a channel matrix instance
     Ptr<ThreeGppChannelParams> channelParams = Create<ThreeGppChannelParams>();
-    channelParams->m_generatedTime = Simulator::Now();
-    channelParams->m_nodeIds =
-        std::make_pair(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId());
+    channelParams->m_generatedTime = pair.m_time;
+    channelParams->m_nodeIds = std::make_pair(pair.m_aId, pair.m_bId);
     channelParams->m_losCondition = channelCondition->GetLosCondition();
     channelParams->m_o2iCondition = channelCondition->GetO2iCondition();
 
@@ -1237,7 +1593,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     // Generate paramNum independent LSPs.
     for (uint8_t iter = 0; iter < paramNum; iter++)
     {
-        LSPsIndep.push_back(m_normalRv->GetValue());
+        LSPsIndep.push_back(rv.m_normalRv->GetValue());
     }
     for (uint8_t row = 0; row < paramNum; row++)
     {
@@ -1290,7 +1646,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     double minTau = 100.0;
     for (uint8_t cIndex = 0; cIndex < table3gpp->m_numOfCluster; cIndex++)
     {
-        double tau = -1 * table3gpp->m_rTau * DS * log(m_uniformRv->GetValue(0, 1)); //(7.5-1)
+        double tau = -1 * table3gpp->m_rTau * DS * log(rv.m_uniformRv->GetValue(0, 1)); //(7.5-1)
         if (minTau > tau)
         {
             minTau = tau;
@@ -1315,7 +1671,8 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         double power =
             exp(-1 * clusterDelay[cIndex] * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
             pow(10,
-                -1 * m_normalRv->GetValue() * table3gpp->m_perClusterShadowingStd / 10.0); //(7.5-5)
+                -1 * rv.m_normalRv->GetValue() * table3gpp->m_perClusterShadowingStd /
+                    10.0); //(7.5-5)
         powerSum += power;
         clusterPower.push_back(power);
     }
@@ -1493,31 +1850,31 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         clusterZod.push_back(ZSD * angle);
     }
 
-    Angles sAngle(bMob->GetPosition(), aMob->GetPosition());
-    Angles uAngle(aMob->GetPosition(), bMob->GetPosition());
+    Angles sAngle(pair.m_bPosition, pair.m_aPosition);
+    Angles uAngle(pair.m_aPosition, pair.m_bPosition);
 
     for (uint8_t cIndex = 0; cIndex < channelParams->m_reducedClusterNumber; cIndex++)
     {
         int Xn = 1;
-        if (m_uniformRv->GetValue(0, 1) < 0.5)
+        if (rv.m_uniformRv->GetValue(0, 1) < 0.5)
         {
             Xn = -1;
         }
-        clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (m_normalRv->GetValue() * ASA / 7.0) +
+        clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (rv.m_normalRv->GetValue() * ASA / 7.0) +
                              RadiansToDegrees(uAngle.GetAzimuth()); //(7.5-11)
-        clusterAod[cIndex] = clusterAod[cIndex] * Xn + (m_normalRv->GetValue() * ASD / 7.0) +
+        clusterAod[cIndex] = clusterAod[cIndex] * Xn + (rv.m_normalRv->GetValue() * ASD / 7.0) +
                              RadiansToDegrees(sAngle.GetAzimuth());
         if (channelCondition->IsO2i())
         {
             clusterZoa[cIndex] =
-                clusterZoa[cIndex] * Xn + (m_normalRv->GetValue() * ZSA / 7.0) + 90; //(7.5-16)
+                clusterZoa[cIndex] * Xn + (rv.m_normalRv->GetValue() * ZSA / 7.0) + 90; //(7.5-16)
         }
         else
         {
-            clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (m_normalRv->GetValue() * ZSA / 7.0) +
+            clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (rv.m_normalRv->GetValue() * ZSA / 7.0) +
                                  RadiansToDegrees(uAngle.GetInclination()); //(7.5-16)
         }
-        clusterZod[cIndex] = clusterZod[cIndex] * Xn + (m_normalRv->GetValue() * ZSD / 7.0) +
+        clusterZod[cIndex] = clusterZod[cIndex] * Xn + (rv.m_normalRv->GetValue() * ZSD / 7.0) +
                              RadiansToDegrees(sAngle.GetInclination()) +
                              table3gpp->m_offsetZOD; //(7.5-19)
     }
@@ -1603,7 +1960,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     DoubleVector attenuationDb;
     if (m_blockage)
     {
-        attenuationDb = CalcAttenuationOfBlockage(channelParams, clusterAoa, clusterZoa);
+        attenuationDb = CalcAttenuationOfBlockage(channelParams, clusterAoa, clusterZoa, rv);
         for (uint8_t cInd = 0; cInd < channelParams->m_reducedClusterNumber; cInd++)
         {
             channelParams->m_clusterPower[cInd] =
@@ -1656,10 +2013,18 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
 
     for (uint8_t cIndex = 0; cIndex < channelParams->m_reducedClusterNumber; cIndex++)
     {
-        Shuffle(&rayAodRadian[cIndex][0], &rayAodRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayAoaRadian[cIndex][0], &rayAoaRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayZodRadian[cIndex][0], &rayZodRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayZoaRadian[cIndex][0], &rayZoaRadian[cIndex][table3gpp->m_raysPerCluster]);
+        Shuffle(&rayAodRadian[cIndex][0],
+                &rayAodRadian[cIndex][table3gpp->m_raysPerCluster],
+                rv.m_uniformRvShuffle);
+        Shuffle(&rayAoaRadian[cIndex][0],
+                &rayAoaRadian[cIndex][table3gpp->m_raysPerCluster],
+                rv.m_uniformRvShuffle);
+        Shuffle(&rayZodRadian[cIndex][0],
+                &rayZodRadian[cIndex][table3gpp->m_raysPerCluster],
+                rv.m_uniformRvShuffle);
+        Shuffle(&rayZoaRadian[cIndex][0],
+                &rayZoaRadian[cIndex][table3gpp->m_raysPerCluster],
+                rv.m_uniformRvShuffle);
     }
 
     // store values
@@ -1684,11 +2049,11 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
             double sigXprLinear = pow(10, table3gpp->m_sigXpr / 10.0); // convert to linear
 
             temp.push_back(
-                std::pow(10, (m_normalRv->GetValue() * sigXprLinear + uXprLinear) / 10.0));
+                std::pow(10, (rv.m_normalRv->GetValue() * sigXprLinear + uXprLinear) / 10.0));
             DoubleVector temp3; // used to store the PHI values
             for (uint8_t pInd = 0; pInd < 4; pInd++)
             {
-                temp3.push_back(m_uniformRv->GetValue(-1 * M_PI, M_PI));
+                temp3.push_back(rv.m_uniformRv->GetValue(-1 * M_PI, M_PI));
             }
             temp2.push_back(temp3);
         }
@@ -1816,8 +2181,8 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         double D = 0;
         if (cIndex != 0)
         {
-            alpha = m_uniformRvDoppler->GetValue(-1, 1);
-            D = m_uniformRvDoppler->GetValue(-m_vScatt, m_vScatt);
+            alpha = rv.m_uniformRvDoppler->GetValue(-1, 1);
+            D = rv.m_uniformRvDoppler->GetValue(-m_vScatt, m_vScatt);
         }
         dopplerTermAlpha.push_back(alpha);
         dopplerTermD.push_back(D);
@@ -1828,13 +2193,342 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     return channelParams;
 }
 
+Ptr<ThreeGppChannelModel::ThreeGppChannelParams>
+ThreeGppChannelModel::UpdateChannelParameters(const Ptr<const ThreeGppChannelParams>& channelParams,
+                                              const PairState& pair) const
+{
+    NS_LOG_FUNCTION(this);
+    Ptr<ThreeGppChannelParams> updated = Create<ThreeGppChannelParams>(*channelParams);
+    updated->m_generatedTime = pair.m_time;
+    double deltaT = (pair.m_time - channelParams->m_generatedTime).GetSeconds();
+    const double c = 3e8;
+
+    // the angles of departure are those of the first node of the params
+    Vector sVelocity = pair.m_aVelocity;
+    Vector uVelocity = pair.m_bVelocity;
+    Vector sPosition = pair.m_aPosition;
+    Vector uPosition = pair.m_bPosition;
+    if (pair.m_aId != channelParams->m_nodeIds.first)
+    {
+        std::swap(sVelocity, uVelocity);
+        std::swap(sPosition, uPosition);
+    }
+    // the positions at the previous generation, with the current velocities
+    Vector sPrevious = sPosition - Vector(sVelocity.x * deltaT,
+                                          sVelocity.y * deltaT,
+                                          sVelocity.z * deltaT);
+    Vector uPrevious = uPosition - Vector(uVelocity.x * deltaT,
+                                          uVelocity.y * deltaT,
+                                          uVelocity.z * deltaT);
+    double losDelay = CalculateDistance(sPrevious, uPrevious) / c;
+    double newLosDelay = CalculateDistance(sPosition, uPosition) / c;
+    updated->m_dis2D = CalculateDistance(Vector2D(sPosition.x, sPosition.y),
+                                         Vector2D(uPosition.x, uPosition.y));
+    updated->m_dis3D = newLosDelay * c;
+    updated->m_preLocUT = channelParams->m_locUT;
+    updated->m_locUT = uPosition;
+    updated->m_speed = uVelocity;
+
+    auto dot = [](const Vector& a, const Vector& b) { return a.x * b.x + a.y * b.y + a.z * b.z; };
+    // unit vector of the direction (azimuth, inclination), in radians
+    auto direction = [](double phi, double theta) {
+        return Vector(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta));
+    };
+    // unit vectors of the spherical coordinates
+    auto phiHat = [](double phi) { return Vector(-sin(phi), cos(phi), 0); };
+    auto thetaHat = [](double phi, double theta) {
+        return Vector(cos(theta) * cos(phi), cos(theta) * sin(phi), -sin(theta));
+    };
+    // wrap the angles in degrees as in GenerateChannelParameters
+    auto wrapDegrees = [](double angle, bool zenith) {
+        angle = fmod(angle, 360);
+        if (angle < 0)
+        {
+            angle += 360;
+        }
+        if (zenith && angle > 180)
+        {
+            angle = 360 - angle;
+        }
+        return angle;
+    };
+
+    uint8_t numCluster = channelParams->m_reducedClusterNumber;
+    DoubleVector delay(numCluster);
+    // the changes of the angles of each cluster: AOA, ZOA, AOD, ZOD, in degrees
+    Double2DVector deltaAngle(4, DoubleVector(numCluster, 0));
+    Angles sAngle(uPosition, sPosition);
+    Angles uAngle(sPosition, uPosition);
+    for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+        double aoa = DegreesToRadians(channelParams->m_angle[0][cIndex]);
+        double zoa = DegreesToRadians(channelParams->m_angle[1][cIndex]);
+        double aod = DegreesToRadians(channelParams->m_angle[2][cIndex]);
+        double zod = DegreesToRadians(channelParams->m_angle[3][cIndex]);
+        if (cIndex == 0 && channelParams->m_losCondition == ChannelCondition::LOS)
+        {
+            // the LOS cluster follows the direct path
+            delay[cIndex] = newLosDelay;
+            deltaAngle[0][cIndex] = RadiansToDegrees(uAngle.GetAzimuth() - aoa);
+            deltaAngle[1][cIndex] = RadiansToDegrees(uAngle.GetInclination() - zoa);
+            deltaAngle[2][cIndex] = RadiansToDegrees(sAngle.GetAzimuth() - aod);
+            deltaAngle[3][cIndex] = RadiansToDegrees(sAngle.GetInclination() - zod);
+            continue;
+        }
+        double tau = losDelay + channelParams->m_delay[cIndex];
+        delay[cIndex] = tau - (dot(direction(aoa, zoa), uVelocity) +
+                               dot(direction(aod, zod), sVelocity)) /
+                                  c * deltaT; //(7.6-9)
+        // the scatterers are seen from the moving nodes at the distance c tau
+        double distance = c * tau;
+        deltaAngle[0][cIndex] = RadiansToDegrees(-dot(uVelocity, phiHat(aoa)) * deltaT /
+                                                 (distance * std::max(sin(zoa), 1e-6)));
+        deltaAngle[1][cIndex] =
+            RadiansToDegrees(-dot(uVelocity, thetaHat(aoa, zoa)) * deltaT / distance);
+        deltaAngle[2][cIndex] = RadiansToDegrees(-dot(sVelocity, phiHat(aod)) * deltaT /
+                                                 (distance * std::max(sin(zod), 1e-6)));
+        deltaAngle[3][cIndex] =
+            RadiansToDegrees(-dot(sVelocity, thetaHat(aod, zod)) * deltaT / distance);
+    }
+
+    // the delays are relative to the first path
+    double minDelay = *std::min_element(delay.begin(), delay.end());
+    for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+        double deltaTau = delay[cIndex] - losDelay - channelParams->m_delay[cIndex];
+        updated->m_delay[cIndex] = delay[cIndex] - minDelay;
+        for (uint8_t ind = 0; ind < 4; ind++)
+        {
+            updated->m_angle[ind][cIndex] =
+                wrapDegrees(channelParams->m_angle[ind][cIndex] + deltaAngle[ind][cIndex],
+                            ind == 1 || ind == 3);
+        }
+        for (size_t mInd = 0; mInd < channelParams->m_rayAoaRadian[cIndex].size(); mInd++)
+        {
+            std::tie(updated->m_rayAoaRadian[cIndex][mInd], updated->m_rayZoaRadian[cIndex][mInd]) =
+                WrapAngles(
+                    channelParams->m_rayAoaRadian[cIndex][mInd] +
+                        DegreesToRadians(deltaAngle[0][cIndex]),
+                    channelParams->m_rayZoaRadian[cIndex][mInd] +
+                        DegreesToRadians(deltaAngle[1][cIndex]));
+            std::tie(updated->m_rayAodRadian[cIndex][mInd], updated->m_rayZodRadian[cIndex][mInd]) =
+                WrapAngles(
+                    channelParams->m_rayAodRadian[cIndex][mInd] +
+                        DegreesToRadians(deltaAngle[2][cIndex]),
+                    channelParams->m_rayZodRadian[cIndex][mInd] +
+                        DegreesToRadians(deltaAngle[3][cIndex]));
+            // the phase of the rays rotates with the length of their path
+            for (auto& phase : updated->m_clusterPhase[cIndex][mInd])
+            {
+                phase = fmod(phase - 2 * M_PI * m_frequency * deltaTau, 2 * M_PI);
+                if (phase < -M_PI)
+                {
+                    phase += 2 * M_PI;
+                }
+                else if (phase >= M_PI)
+                {
+                    phase -= 2 * M_PI;
+                }
+            }
+        }
+    }
+
+    // the sub-clusters of the two strongest clusters follow them
+    uint8_t cluster1st = channelParams->m_cluster1st;
+    uint8_t cluster2nd = channelParams->m_cluster2nd;
+    uint8_t minCluster = std::min(cluster1st, cluster2nd);
+    uint8_t maxCluster = std::max(cluster1st, cluster2nd);
+    std::vector<uint8_t> parents{minCluster, minCluster};
+    if (cluster1st != cluster2nd)
+    {
+        parents.push_back(maxCluster);
+        parents.push_back(maxCluster);
+    }
+    for (size_t i = 0; i < parents.size(); i++)
+    {
+        uint8_t parent = parents[i];
+        updated->m_delay[numCluster + i] = channelParams->m_delay[numCluster + i] +
+                                           updated->m_delay[parent] -
+                                           channelParams->m_delay[parent];
+        for (uint8_t ind = 0; ind < 4; ind++)
+        {
+            updated->m_angle[ind][numCluster + i] = updated->m_angle[ind][parent];
+        }
+    }
+
+    NS_LOG_DEBUG("Updated the channel params after " << deltaT << " s, LOS delay " << newLosDelay);
+    return updated;
+}
+
+/**
+ * The sub-cluster of each ray of the two strongest clusters, in (7.5-28):
+ * 0 for the first one, whose coefficients are stored at the index of the
+ * cluster, 1 and 2 for the two appended ones.
+ */
+static constexpr uint8_t raySubCluster[20] =
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 0};
+
+/// The x, y and z coefficients of the phase of each ray at an antenna element
+using DirectionCoefficients = std::array<const MatrixBasedChannelModel::Double2DVector*, 3>;
+
+/**
+ * The inputs of SynthesizeClusters(), computed by GetNewChannel.
+ */
+struct ClusterSynthesis
+{
+    /// the part of the rays independent of the antenna elements
+    const MatrixBasedChannelModel::Complex2DVector& raysPreComp;
+    DirectionCoefficients rxDirection;                        //!< the rx phase of each ray
+    DirectionCoefficients txDirection;                        //!< the tx phase of each ray
+    const std::vector<Vector>& uLoc;                          //!< the rx element locations
+    const std::vector<Vector>& sLoc;                          //!< the tx element locations
+    uint8_t numCluster;                                       //!< the number of clusters
+    uint8_t raysPerCluster;                                   //!< the number of rays per cluster
+    uint8_t cluster1st;                                       //!< the strongest cluster
+    uint8_t cluster2nd;                                       //!< the second strongest cluster
+    const MatrixBasedChannelModel::DoubleVector& clusterPower; //!< the cluster powers
+};
+
+/**
+ * Compute the steering phasors of the rays of a cluster at the antenna
+ * elements, exp (j 2 pi r_m . d_e), as split real and imaginary parts
+ * indexed by [ray * number of elements + element].
+ *
+ * \tparam T the floating point type of the phasors
+ * \param direction the x, y and z coefficients of the phase of each ray
+ * \param nIndex the cluster
+ * \param raysPerCluster the number of rays
+ * \param loc the element locations
+ * \param re the real parts
+ * \param im the imaginary parts
+ */
+template <typename T>
+static void
+ComputeSteeringPhasors(const DirectionCoefficients& direction,
+                       uint8_t nIndex,
+                       uint8_t raysPerCluster,
+                       const std::vector<Vector>& loc,
+                       std::vector<T>& re,
+                       std::vector<T>& im)
+{
+    size_t size = loc.size();
+    re.resize(raysPerCluster * size);
+    im.resize(raysPerCluster * size);
+    for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
+    {
+        // lambda_0 is accounted in the antenna spacing
+        T x = 2 * M_PI * (*direction[0])[nIndex][mIndex];
+        T y = 2 * M_PI * (*direction[1])[nIndex][mIndex];
+        T z = 2 * M_PI * (*direction[2])[nIndex][mIndex];
+        T* phase = &re[mIndex * size];
+        for (size_t e = 0; e < size; e++)
+        {
+            phase[e] = x * static_cast<T>(loc[e].x) + y * static_cast<T>(loc[e].y) +
+                       z * static_cast<T>(loc[e].z);
+        }
+    }
+    // separate loops over contiguous arrays, which the compiler can vectorize
+    for (size_t i = 0; i < re.size(); i++)
+    {
+        im[i] = std::sin(re[i]);
+    }
+    for (size_t i = 0; i < re.size(); i++)
+    {
+        re[i] = std::cos(re[i]);
+    }
+}
+
+/**
+ * Compute the coefficients of the clusters of the channel matrix, (7.5-22)
+ * and (7.5-28), without the LOS component.
+ *
+ * The rx and tx steering phasors of each ray are computed once per element,
+ * rather than once per pair of elements, and the coefficients of each
+ * (sub-)cluster are the sum over its rays of the outer products of the
+ * weighted rx phasors and the tx phasors, accumulated over split real and
+ * imaginary parts so that the inner loop over the tx elements vectorizes.
+ *
+ * \tparam T the floating point type of the synthesis
+ * \param in the inputs
+ * \param hUsn the channel coefficients
+ */
+template <typename T>
+static void
+SynthesizeClusters(const ClusterSynthesis& in, MatrixBasedChannelModel::Complex3DVector& hUsn)
+{
+    NS_ASSERT(in.raysPerCluster <= sizeof(raySubCluster));
+    size_t uSize = in.uLoc.size();
+    size_t sSize = in.sLoc.size();
+    std::vector<T> rxRe;
+    std::vector<T> rxIm;
+    std::vector<T> txRe;
+    std::vector<T> txIm;
+    std::vector<T> accRe(3 * uSize * sSize);
+    std::vector<T> accIm(3 * uSize * sSize);
+
+    // Keeps track of how many sub-clusters have been added up to now
+    uint8_t numSubClustersAdded = 0;
+    for (uint8_t nIndex = 0; nIndex < in.numCluster; nIndex++)
+    {
+        bool strong = (nIndex == in.cluster1st || nIndex == in.cluster2nd);
+        ComputeSteeringPhasors(in.rxDirection, nIndex, in.raysPerCluster, in.uLoc, rxRe, rxIm);
+        ComputeSteeringPhasors(in.txDirection, nIndex, in.raysPerCluster, in.sLoc, txRe, txIm);
+        std::fill(accRe.begin(), accRe.end(), 0);
+        std::fill(accIm.begin(), accIm.end(), 0);
+
+        for (uint8_t mIndex = 0; mIndex < in.raysPerCluster; mIndex++)
+        {
+            // NOTE Doppler is computed in the CalcBeamformingGain function and is
+            // simplified to only account for the center angle of each cluster.
+            T preRe = in.raysPreComp(nIndex, mIndex).real();
+            T preIm = in.raysPreComp(nIndex, mIndex).imag();
+            size_t sub = strong ? raySubCluster[mIndex] : 0;
+            const T* sRe = &txRe[mIndex * sSize];
+            const T* sIm = &txIm[mIndex * sSize];
+            for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+            {
+                T uRe = rxRe[mIndex * uSize + uIndex];
+                T uIm = rxIm[mIndex * uSize + uIndex];
+                T wRe = preRe * uRe - preIm * uIm;
+                T wIm = preRe * uIm + preIm * uRe;
+                T* aRe = &accRe[(sub * uSize + uIndex) * sSize];
+                T* aIm = &accIm[(sub * uSize + uIndex) * sSize];
+                for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+                {
+                    aRe[sIndex] += wRe * sRe[sIndex] - wIm * sIm[sIndex];
+                    aIm[sIndex] += wRe * sIm[sIndex] + wIm * sRe[sIndex];
+                }
+            }
+        }
+
+        double scale = sqrt(in.clusterPower[nIndex] / in.raysPerCluster);
+        size_t subPage = in.numCluster + numSubClustersAdded;
+        size_t pages[3] = {nIndex, subPage, subPage + 1};
+        for (size_t sub = 0; sub < (strong ? 3 : 1); sub++)
+        {
+            for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+            {
+                for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+                {
+                    size_t i = (sub * uSize + uIndex) * sSize + sIndex;
+                    hUsn(uIndex, sIndex, pages[sub]) =
+                        std::complex<double>(accRe[i], accIm[i]) * scale;
+                }
+            }
+        }
+        if (strong)
+        {
+            numSubClustersAdded += 2;
+        }
+    }
+}
+
 Ptr<MatrixBasedChannelModel::ChannelMatrix>
-ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelParams,
-                                    Ptr<const ParamsTable> table3gpp,
-                                    const Ptr<const MobilityModel> sMob,
-                                    const Ptr<const MobilityModel> uMob,
-                                    Ptr<const PhasedArrayModel> sAntenna,
-                                    Ptr<const PhasedArrayModel> uAntenna) const
+ThreeGppChannelModel::GetNewChannel(const Ptr<const ThreeGppChannelParams>& channelParams,
+                                    const Ptr<const ParamsTable>& table3gpp,
+                                    const PairState& pair,
+                                    const Ptr<const PhasedArrayModel>& sAntenna,
+                                    const Ptr<const PhasedArrayModel>& uAntenna) const
 {
     NS_LOG_FUNCTION(this);
 
@@ -1842,10 +2536,9 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
 
     // create a channel matrix instance
     Ptr<ChannelMatrix> channelMatrix = Create<ChannelMatrix>();
-    channelMatrix->m_generatedTime = Simulator::Now();
+    channelMatrix->m_generatedTime = pair.m_time;
     // save in which order is generated this matrix
-    channelMatrix->m_nodeIds =
-        std::make_pair(sMob->GetObject<Node>()->GetId(), uMob->GetObject<Node>()->GetId());
+    channelMatrix->m_nodeIds = std::make_pair(pair.m_aId, pair.m_bId);
     // check if channelParams structure is generated in direction s-to-u or u-to-s
     bool isSameDirection = (channelParams->m_nodeIds == channelMatrix->m_nodeIds);
 
@@ -1903,18 +2596,18 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAoaRadian[0].size());
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAodRadian[0].size());
 
-    double x = sMob->GetPosition().x - uMob->GetPosition().x;
-    double y = sMob->GetPosition().y - uMob->GetPosition().y;
+    double x = pair.m_aPosition.x - pair.m_bPosition.x;
+    double y = pair.m_aPosition.y - pair.m_bPosition.y;
     double distance2D = sqrt(x * x + y * y);
     // NOTE we assume hUT = min (height(a), height(b)) and
     // hBS = max (height (a), height (b))
-    double hUt = std::min(sMob->GetPosition().z, uMob->GetPosition().z);
-    double hBs = std::max(sMob->GetPosition().z, uMob->GetPosition().z);
+    double hUt = std::min(pair.m_aPosition.z, pair.m_bPosition.z);
+    double hBs = std::max(pair.m_aPosition.z, pair.m_bPosition.z);
     // compute the 3D distance using eq. 7.4-1
     double distance3D = std::sqrt(distance2D * distance2D + (hBs - hUt) * (hBs - hUt));
 
-    Angles sAngle(uMob->GetPosition(), sMob->GetPosition());
-    Angles uAngle(sMob->GetPosition(), uMob->GetPosition());
+    Angles sAngle(pair.m_bPosition, pair.m_aPosition);
+    Angles uAngle(pair.m_aPosition, pair.m_bPosition);
 
     Complex2DVector raysPreComp(channelParams->m_reducedClusterNumber,
                                 table3gpp->m_raysPerCluster); // stores part of the ray expression,
@@ -1989,113 +2682,38 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
         }
     }
 
-    // The following for loops computes the channel coefficients
-    // Keeps track of how many sub-clusters have been added up to now
-    uint8_t numSubClustersAdded = 0;
-    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+    // The element locations do not depend on the cluster
+    std::vector<Vector> uLoc(uSize);
+    for (size_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-        for (size_t uIndex = 0; uIndex < uSize; uIndex++)
-        {
-            Vector uLoc = uAntenna->GetElementLocation(uIndex);
-
-            for (size_t sIndex = 0; sIndex < sSize; sIndex++)
-            {
-                Vector sLoc = sAntenna->GetElementLocation(sIndex);
-                // Compute the N-2 weakest cluster, assuming 0 slant angle and a
-                // polarization slant angle configured in the array (7.5-22)
-                if (nIndex != channelParams->m_cluster1st && nIndex != channelParams->m_cluster2nd)
-                {
-                    std::complex<double> rays(0, 0);
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
-                    {
-                        // lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                        double rxPhaseDiff =
-                            2 * M_PI *
-                            (sinCosA[nIndex][mIndex] * uLoc.x + sinSinA[nIndex][mIndex] * uLoc.y +
-                             cosZoA[nIndex][mIndex] * uLoc.z);
-
-                        double txPhaseDiff =
-                            2 * M_PI *
-                            (sinCosD[nIndex][mIndex] * sLoc.x + sinSinD[nIndex][mIndex] * sLoc.y +
-                             cosZoD[nIndex][mIndex] * sLoc.z);
-
-                        // NOTE Doppler is computed in the CalcBeamformingGain function and is
-                        // simplified to only account for the center angle of each cluster.
-                        rays += raysPreComp(nIndex, mIndex) *
-                                std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                                std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-                    }
-                    rays *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn(uIndex, sIndex, nIndex) = rays;
-                }
-                else //(7.5-28)
-                {
-                    std::complex<double> raysSub1(0, 0);
-                    std::complex<double> raysSub2(0, 0);
-                    std::complex<double> raysSub3(0, 0);
+        uLoc[uIndex] = uAntenna->GetElementLocation(uIndex);
+    }
+    std::vector<Vector> sLoc(sSize);
+    for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+    {
+        sLoc[sIndex] = sAntenna->GetElementLocation(sIndex);
+    }
 
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
-                    {
-                        // ZML:Just remind me that the angle offsets for the 3 subclusters were not
-                        // generated correctly.
-                        double rxPhaseDiff =
-                            2 * M_PI *
-                            (sinCosA[nIndex][mIndex] * uLoc.x + sinSinA[nIndex][mIndex] * uLoc.y +
-                             cosZoA[nIndex][mIndex] * uLoc.z);
-
-                        double txPhaseDiff =
-                            2 * M_PI *
-                            (sinCosD[nIndex][mIndex] * sLoc.x + sinSinD[nIndex][mIndex] * sLoc.y +
-                             cosZoD[nIndex][mIndex] * sLoc.z);
-
-                        std::complex<double> raySub =
-                            raysPreComp(nIndex, mIndex) *
-                            std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                            std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-
-                        switch (mIndex)
-                        {
-                        case 9:
-                        case 10:
-                        case 11:
-                        case 12:
-                        case 17:
-                        case 18:
-                            raysSub2 += raySub;
-                            break;
-                        case 13:
-                        case 14:
-                        case 15:
-                        case 16:
-                            raysSub3 += raySub;
-                            break;
-                        default: // case 1,2,3,4,5,6,7,8,19,20
-                            raysSub1 += raySub;
-                            break;
-                        }
-                    }
-                    raysSub1 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub2 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub3 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn(uIndex, sIndex, nIndex) = raysSub1;
-                    hUsn(uIndex,
-                         sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded) = raysSub2;
-                    hUsn(uIndex,
-                         sIndex,
-                         channelParams->m_reducedClusterNumber + numSubClustersAdded + 1) =
-                        raysSub3;
-                }
-            }
-        }
-        if (nIndex == channelParams->m_cluster1st || nIndex == channelParams->m_cluster2nd)
-        {
-            numSubClustersAdded += 2;
-        }
+    // Compute the channel coefficients of the N-2 weakest clusters, assuming 0 slant angle and
+    // a polarization slant angle configured in the array (7.5-22), and of the sub-clusters of
+    // the two strongest clusters (7.5-28)
+    ClusterSynthesis synthesis{raysPreComp,
+                               {&sinCosA, &sinSinA, &cosZoA},
+                               {&sinCosD, &sinSinD, &cosZoD},
+                               uLoc,
+                               sLoc,
+                               channelParams->m_reducedClusterNumber,
+                               table3gpp->m_raysPerCluster,
+                               channelParams->m_cluster1st,
+                               channelParams->m_cluster2nd,
+                               channelParams->m_clusterPower};
+    if (m_singlePrecision)
+    {
+        SynthesizeClusters<float>(synthesis, hUsn);
+    }
+    else
+    {
+        SynthesizeClusters<double>(synthesis, hUsn);
     }
 
     if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
@@ -2198,9 +2816,10 @@ ThreeGppChannelModel::WrapAngles(double azimuthRad, double inclinationRad)
 
 MatrixBasedChannelModel::DoubleVector
 ThreeGppChannelModel::CalcAttenuationOfBlockage(
-    const Ptr<ThreeGppChannelModel::ThreeGppChannelParams> channelParams,
+    const Ptr<ThreeGppChannelModel::ThreeGppChannelParams>& channelParams,
     const DoubleVector& clusterAOA,
-    const DoubleVector& clusterZOA) const
+    const DoubleVector& clusterZOA,
+    const ChannelRandomVariables& rv) const
 {
     NS_LOG_FUNCTION(this);
 
@@ -2235,18 +2854,18 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
         {
             // draw value from table 7.6.4.1-2 Blocking region parameters
             DoubleVector table;
-            table.push_back(m_normalRv->GetValue()); // phi_k: store the normal RV that will be
+            table.push_back(rv.m_normalRv->GetValue()); // phi_k: store the normal RV that will be
                                                      // mapped to uniform (0,360) later.
             if (m_scenario == "InH-OfficeMixed" || m_scenario == "InH-OfficeOpen")
             {
-                table.push_back(m_uniformRv->GetValue(15, 45)); // x_k
+                table.push_back(rv.m_uniformRv->GetValue(15, 45)); // x_k
                 table.push_back(90);                            // Theta_k
-                table.push_back(m_uniformRv->GetValue(5, 15));  // y_k
+                table.push_back(rv.m_uniformRv->GetValue(5, 15));  // y_k
                 table.push_back(2);                             // r
             }
             else
             {
-                table.push_back(m_uniformRv->GetValue(5, 15)); // x_k
+                table.push_back(rv.m_uniformRv->GetValue(5, 15)); // x_k
                 table.push_back(90);                           // Theta_k
                 table.push_back(5);                            // y_k
                 table.push_back(10);                           // r
@@ -2316,7 +2935,7 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
                 // Generate a new correlated normal RV with the following formula
                 channelParams->m_nonSelfBlocking[blockInd][PHI_INDEX] =
                     R * channelParams->m_nonSelfBlocking[blockInd][PHI_INDEX] +
-                    sqrt(1 - R * R) * m_normalRv->GetValue();
+                    sqrt(1 - R * R) * rv.m_normalRv->GetValue();
             }
         }
     }
@@ -2449,11 +3068,13 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
 }
 
 void
-ThreeGppChannelModel::Shuffle(double* first, double* last) const
+ThreeGppChannelModel::Shuffle(double* first,
+                              double* last,
+                              const Ptr<UniformRandomVariable>& uniformRv) const
 {
     for (auto i = (last - first) - 1; i > 0; --i)
     {
-        std::swap(first[i], first[m_uniformRvShuffle->GetInteger(0, i)]);
+        std::swap(first[i], first[uniformRv->GetInteger(0, i)]);
     }
 }
 
@@ -2465,6 +3086,7 @@ ThreeGppChannelModel::AssignStreams(int64_t stream)
     m_uniformRv->SetStream(stream + 1);
     m_uniformRvShuffle->SetStream(stream + 2);
     m_uniformRvDoppler->SetStream(stream + 3);
+    m_pairStreams = (int64_t(1) << 40) + (stream << 20);
     return 4;
 }
 
@@ -24,9 +24,13 @@
 #include "ns3/angles.h"
 #include <ns3/boolean.h>
 #include <ns3/channel-condition-model.h>
+#include <ns3/event-id.h>
 #include <ns3/matrix-based-channel-model.h>
+#include <ns3/traced-callback.h>
+#include <ns3/traced-value.h>
 
 #include <complex.h>
+#include <map>
 #include <unordered_map>
 
 namespace ns3
@@ -127,15 +131,59 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      */
     Ptr<const ChannelParams> GetParams(Ptr<const MobilityModel> aMob,
                                        Ptr<const MobilityModel> bMob) const override;
+
+    /**
+     * Register a pair of devices whose channel is generated ahead of need.
+     *
+     * When the PrefetchThreads attribute is positive, the channel params and
+     * matrices of the registered pairs are regenerated at the multiples of the
+     * update period, all at once on PrefetchThreads threads, and published
+     * before the first request of the new period. A regeneration takes place
+     * at the multiple following a request, or this call. The pairs passed to
+     * GetChannel are registered automatically, so that only their first
+     * channel is generated on request; registering the pairs beforehand also
+     * moves that one out of the critical path.
+     *
+     * \param aMob mobility model of the a device
+     * \param bMob mobility model of the b device
+     * \param aAntenna antenna of the a device
+     * \param bAntenna antenna of the b device
+     */
+    void AddPrefetchPair(Ptr<const MobilityModel> aMob,
+                         Ptr<const MobilityModel> bMob,
+                         Ptr<const PhasedArrayModel> aAntenna,
+                         Ptr<const PhasedArrayModel> bAntenna);
+
     /**
      * \brief Assign a fixed random variable stream number to the random variables
      * used by this model.
      *
+     * When the channels are prefetched, the random variables of each pair of
+     * nodes are assigned four streams from 2^40 + 2^20 * stream on, in the
+     * order in which the pairs are first seen, which keeps them clear of the
+     * streams assigned to the other models.
+     *
      * \param stream first stream index to use
      * \return the number of stream indices assigned by this model
      */
     int64_t AssignStreams(int64_t stream);
 
+    /**
+     * TracedCallback signature for the update of the channel parameters of
+     * a pair of nodes.
+     *
+     * \param [in] aNodeId the id of the a node
+     * \param [in] bNodeId the id of the b node
+     * \param [in] incremental true if the parameters were updated with the
+     *             spatial consistency procedure, false if they were regenerated
+     * \param [in] duration the wall clock time spent updating the parameters
+     *             and the channel matrix
+     */
+    typedef void (*ChannelUpdateTracedCallback)(uint32_t aNodeId,
+                                                uint32_t bNodeId,
+                                                bool incremental,
+                                                Time duration);
+
   protected:
     /**
      * Wrap an (azimuth, inclination) angle pair in a valid range.
@@ -156,8 +204,44 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * \brief Shuffle the elements of a simple sequence container of type double
      * \param first Pointer to the first element among the elements to be shuffled
      * \param last Pointer to the last element among the elements to be shuffled
+     * \param uniformRv the uniform random variable drawing the permutation
+     */
+    void Shuffle(double* first, double* last, const Ptr<UniformRandomVariable>& uniformRv) const;
+
+    /**
+     * The state of a pair of nodes used to generate their channel, read from
+     * the mobility models beforehand so that the generation does not touch
+     * them. The channel is generated from node a, or s, to node b, or u.
+     */
+    struct PairState
+    {
+        Time m_time;        //!< the time of the state
+        uint32_t m_aId;     //!< the id of the a node
+        uint32_t m_bId;     //!< the id of the b node
+        Vector m_aPosition; //!< the position of the a node
+        Vector m_bPosition; //!< the position of the b node
+        Vector m_aVelocity; //!< the velocity of the a node
+        Vector m_bVelocity; //!< the velocity of the b node
+    };
+
+    /**
+     * Read the state of a pair of nodes
+     * \param aMob the a node mobility model
+     * \param bMob the b node mobility model
+     * \return the state of the pair
+     */
+    static PairState GetPairState(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob);
+
+    /**
+     * The random variables drawn to generate the channel params
      */
-    void Shuffle(double* first, double* last) const;
+    struct ChannelRandomVariables
+    {
+        Ptr<NormalRandomVariable> m_normalRv;          //!< normal random variable
+        Ptr<UniformRandomVariable> m_uniformRv;        //!< uniform random variable
+        Ptr<UniformRandomVariable> m_uniformRvShuffle; //!< shuffles the rays
+        Ptr<UniformRandomVariable> m_uniformRvDoppler; //!< draws the Doppler terms
+    };
 
     /**
      * Extends the struct ChannelParams by including information that is used
@@ -272,16 +356,37 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * which is the return value of this function.
      * \param channelCondition the channel condition
      * \param table3gpp the 3gpp parameters from the table
-     * \param aMob the a node mobility model
-     * \param bMob the b node mobility model
+     * \param pair the state of the a and b nodes
+     * \param rv the random variables to draw from
      * \return ThreeGppChannelParams structure with all the channel parameters generated
      * according 38.901 steps from 4 to 10.
      */
     Ptr<ThreeGppChannelParams> GenerateChannelParameters(
-        const Ptr<const ChannelCondition> channelCondition,
-        const Ptr<const ParamsTable> table3gpp,
-        const Ptr<const MobilityModel> aMob,
-        const Ptr<const MobilityModel> bMob) const;
+        const Ptr<const ChannelCondition>& channelCondition,
+        const Ptr<const ParamsTable>& table3gpp,
+        const PairState& pair,
+        const ChannelRandomVariables& rv) const;
+
+    /**
+     * Update the channel parameters among the nodes a and b following the
+     * spatial consistency procedure A of 3GPP TR 38.901, Sec. 7.6.3.2.
+     *
+     * The large scale parameters, the clusters and the rays of the previous
+     * parameters are kept. The delay and the angles of each cluster evolve
+     * with the displacement of the nodes since the previous generation,
+     * (7.6-9) to (7.6-14), the scatterers being assumed at the distance
+     * c tau_n from the nodes, and the angles of the rays are shifted with
+     * those of their cluster. The initial phases of the rays are rotated
+     * by the change of the length of their path. The LOS cluster follows
+     * the direct path.
+     *
+     * \param channelParams the previous channel parameters
+     * \param pair the state of the a and b nodes
+     * \return the updated channel parameters
+     */
+    Ptr<ThreeGppChannelParams> UpdateChannelParameters(
+        const Ptr<const ThreeGppChannelParams>& channelParams,
+        const PairState& pair) const;
 
     /**
      * Compute the channel matrix between two nodes a and b, and their
@@ -290,30 +395,30 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * \param channelParams the channel parameters previously generated for the pair of
      * nodes a and b
      * \param table3gpp the 3gpp parameters table
-     * \param sMob the mobility model of node s
-     * \param uMob the mobility model of node u
+     * \param pair the state of the nodes s (a) and u (b)
      * \param sAntenna the antenna array of node s
      * \param uAntenna the antenna array of node u
      * \return the channel realization
      */
 
-    virtual Ptr<ChannelMatrix> GetNewChannel(Ptr<const ThreeGppChannelParams> channelParams,
-                                             Ptr<const ParamsTable> table3gpp,
-                                             const Ptr<const MobilityModel> sMob,
-                                             const Ptr<const MobilityModel> uMob,
-                                             Ptr<const PhasedArrayModel> sAntenna,
-                                             Ptr<const PhasedArrayModel> uAntenna) const;
+    virtual Ptr<ChannelMatrix> GetNewChannel(const Ptr<const ThreeGppChannelParams>& channelParams,
+                                             const Ptr<const ParamsTable>& table3gpp,
+                                             const PairState& pair,
+                                             const Ptr<const PhasedArrayModel>& sAntenna,
+                                             const Ptr<const PhasedArrayModel>& uAntenna) const;
     /**
      * Applies the blockage model A described in 3GPP TR 38.901
      * \param channelParams the channel parameters structure
      * \param clusterAOA vector containing the azimuth angle of arrival for each cluster
      * \param clusterZOA vector containing the zenith angle of arrival for each cluster
+     * \param rv the random variables to draw from
      * \return vector containing the power attenuation for each cluster
      */
     DoubleVector CalcAttenuationOfBlockage(
-        const Ptr<ThreeGppChannelModel::ThreeGppChannelParams> channelParams,
+        const Ptr<ThreeGppChannelModel::ThreeGppChannelParams>& channelParams,
         const DoubleVector& clusterAOA,
-        const DoubleVector& clusterZOA) const;
+        const DoubleVector& clusterZOA,
+        const ChannelRandomVariables& rv) const;
 
     /**
      * Check if the channel params has to be updated
@@ -334,6 +439,39 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     bool ChannelMatrixNeedsUpdate(Ptr<const ThreeGppChannelParams> channelParams,
                                   Ptr<const ChannelMatrix> channelMatrix);
 
+    /**
+     * Get the random variables drawn to generate the channel params of a pair
+     * of nodes: those of the pair when prefetching, which are created on the
+     * first call, or those of the model otherwise.
+     * \param channelParamsKey the key of the pair of nodes
+     * \return the random variables
+     */
+    ChannelRandomVariables GetRandomVariables(uint64_t channelParamsKey);
+
+    /**
+     * Schedule Prefetch at the next multiple of the update period, if it is
+     * not already scheduled.
+     */
+    void SchedulePrefetch();
+
+    /**
+     * Regenerate the channel params and matrices of the registered pairs of
+     * devices, on m_prefetchThreads threads, and store them in the maps.
+     */
+    void Prefetch();
+
+    /**
+     * A pair of devices whose channel is prefetched
+     */
+    struct PrefetchPair
+    {
+        Ptr<const MobilityModel> m_aMob;        //!< the mobility model of the a device
+        Ptr<const MobilityModel> m_bMob;        //!< the mobility model of the b device
+        Ptr<const PhasedArrayModel> m_aAntenna; //!< the antenna of the a device
+        Ptr<const PhasedArrayModel> m_bAntenna; //!< the antenna of the b device
+        uint64_t m_channelParamsKey;            //!< the key of the pair of nodes
+    };
+
     std::unordered_map<uint64_t, Ptr<ChannelMatrix>>
         m_channelMatrixMap; //!< map containing the channel realizations per pair of
                             //!< PhasedAntennaArray instances, the key of this map is reciprocal
@@ -364,6 +502,27 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     bool m_portraitMode;           //!< true if portrait mode, false if landscape
     double m_blockerSpeed;         //!< the blocker speed
 
+    bool m_singlePrecision; //!< synthesize the clusters of the channel matrix in single precision
+
+    // spatial consistency update
+    bool m_spatialConsistency;           //!< update the channel params incrementally
+    TracedValue<uint64_t> m_fullUpdates; //!< number of regenerations of the channel params
+    TracedValue<uint64_t>
+        m_incrementalUpdates; //!< number of incremental updates of the channel params
+    /// trace fired when the channel params of a pair of nodes are updated
+    TracedCallback<uint32_t, uint32_t, bool, Time> m_channelUpdateTrace;
+
+    // prefetch of the channels
+    uint32_t m_prefetchThreads; //!< number of threads generating the channels ahead of need
+    /// the pairs of devices whose channel is prefetched, by channel matrix key
+    std::map<uint64_t, PrefetchPair> m_prefetchPairs;
+    /// the random variables of each pair of nodes, by channel params key
+    std::unordered_map<uint64_t, ChannelRandomVariables> m_pairRv;
+    EventId m_prefetchEvent; //!< the next regeneration of the prefetched channels
+    int64_t m_pairStreams;   //!< first stream of the pairs of nodes, or -1 to assign them
+                             //!< automatically
+    Time m_lastPrefetch;     //!< the time of the last regeneration of the prefetched channels
+
     static const uint8_t PHI_INDEX = 0; //!< index of the PHI value in the m_nonSelfBlocking array
     static const uint8_t X_INDEX = 1;   //!< index of the X value in the m_nonSelfBlocking array
     static const uint8_t THETA_INDEX =
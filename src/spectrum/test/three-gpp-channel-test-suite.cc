@@ -17,9 +17,11 @@
 
 #include "ns3/abort.h"
 #include "ns3/angles.h"
+#include "ns3/boolean.h"
 #include "ns3/channel-condition-model.h"
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/double.h"
 #include "ns3/isotropic-antenna-model.h"
 #include "ns3/log.h"
@@ -434,6 +436,420 @@ ThreeGppChannelMatrixUpdateTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup spectrum-tests
+ *
+ * Test case for the spatial consistency update of the ThreeGppChannelModel
+ * class. It checks that the channel params are updated incrementally when
+ * the update period expires, that the LOS cluster follows the direct path,
+ * and that the updates are traced.
+ */
+class ThreeGppChannelSpatialConsistencyTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelSpatialConsistencyTest();
+
+  private:
+    /**
+     * Build the test scenario
+     */
+    void DoRun() override;
+
+    /**
+     * Generate the channel matrix and save it with its params
+     * \param channelModel the ThreeGppChannelModel object used to generate the channel matrix
+     * \param txMob the mobility model of the first node
+     * \param rxMob the mobility model of the second node
+     * \param txAntenna the antenna object associated to the first node
+     * \param rxAntenna the antenna object associated to the second node
+     */
+    void DoGetChannel(Ptr<ThreeGppChannelModel> channelModel,
+                      Ptr<MobilityModel> txMob,
+                      Ptr<MobilityModel> rxMob,
+                      Ptr<PhasedArrayModel> txAntenna,
+                      Ptr<PhasedArrayModel> rxAntenna);
+
+    /**
+     * Record an update of the channel params
+     * \param aNodeId the id of the a node
+     * \param bNodeId the id of the b node
+     * \param incremental whether the update is incremental
+     * \param duration the wall clock duration of the update
+     */
+    void ChannelUpdate(uint32_t aNodeId, uint32_t bNodeId, bool incremental, Time duration);
+
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>>
+        m_channels; //!< the channel matrices
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelParams>> m_params; //!< the channel params
+    std::vector<bool> m_updates; //!< the traced updates, true if incremental
+    /// the azimuths of arrival and departure of the direct path
+    std::vector<std::pair<double, double>> m_losAzimuths;
+};
+
+ThreeGppChannelSpatialConsistencyTest::ThreeGppChannelSpatialConsistencyTest()
+    : TestCase("Check the spatial consistency update of the channel params")
+{
+}
+
+void
+ThreeGppChannelSpatialConsistencyTest::DoGetChannel(Ptr<ThreeGppChannelModel> channelModel,
+                                                    Ptr<MobilityModel> txMob,
+                                                    Ptr<MobilityModel> rxMob,
+                                                    Ptr<PhasedArrayModel> txAntenna,
+                                                    Ptr<PhasedArrayModel> rxAntenna)
+{
+    m_channels.push_back(channelModel->GetChannel(txMob, rxMob, txAntenna, rxAntenna));
+    m_params.push_back(channelModel->GetParams(txMob, rxMob));
+    Angles arrival(txMob->GetPosition(), rxMob->GetPosition());
+    Angles departure(rxMob->GetPosition(), txMob->GetPosition());
+    m_losAzimuths.emplace_back(WrapTo2Pi(arrival.GetAzimuth()),
+                               WrapTo2Pi(departure.GetAzimuth()));
+}
+
+void
+ThreeGppChannelSpatialConsistencyTest::ChannelUpdate(uint32_t aNodeId,
+                                                     uint32_t bNodeId,
+                                                     bool incremental,
+                                                     Time duration)
+{
+    m_updates.push_back(incremental);
+}
+
+void
+ThreeGppChannelSpatialConsistencyTest::DoRun()
+{
+    uint32_t updatePeriodMs = 10; // update period in ms
+
+    // create the ThreeGppChannelModel object used to generate the channel matrix
+    Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+    channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+    channelModel->SetAttribute("Scenario", StringValue("UMi-StreetCanyon"));
+    channelModel->SetAttribute("ChannelConditionModel",
+                               PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+    channelModel->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(updatePeriodMs)));
+    channelModel->SetAttribute("SpatialConsistencyUpdate", BooleanValue(true));
+    channelModel->TraceConnectWithoutContext(
+        "ChannelUpdate",
+        MakeCallback(&ThreeGppChannelSpatialConsistencyTest::ChannelUpdate, this));
+
+    // create the tx and rx nodes, the rx node moves sideways
+    NodeContainer nodes;
+    nodes.Create(2);
+    Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel>();
+    txMob->SetPosition(Vector(0.0, 0.0, 10.0));
+    Ptr<ConstantVelocityMobilityModel> rxMob = CreateObject<ConstantVelocityMobilityModel>();
+    rxMob->SetPosition(Vector(100.0, 0.0, 1.6));
+    rxMob->SetVelocity(Vector(0.0, 20.0, 0.0));
+    nodes.Get(0)->AggregateObject(txMob);
+    nodes.Get(1)->AggregateObject(rxMob);
+
+    Ptr<PhasedArrayModel> txAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(2),
+        "NumRows",
+        UintegerValue(2),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()));
+    Ptr<PhasedArrayModel> rxAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(2),
+        "NumRows",
+        UintegerValue(2),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    // generate the channel, then update it twice
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Simulator::Schedule(MilliSeconds(1 + i * (updatePeriodMs + 1)),
+                            &ThreeGppChannelSpatialConsistencyTest::DoGetChannel,
+                            this,
+                            channelModel,
+                            txMob,
+                            rxMob,
+                            txAntenna,
+                            rxAntenna);
+    }
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_updates.size(), 2, "The updates are not traced");
+    NS_TEST_EXPECT_MSG_EQ(m_updates[0], true, "The update is not incremental");
+    NS_TEST_EXPECT_MSG_EQ(m_updates[1], true, "The update is not incremental");
+
+    for (uint32_t i = 1; i < m_params.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_NE(m_params[i], m_params[i - 1], "The params are not updated");
+        NS_TEST_EXPECT_MSG_NE(m_channels[i], m_channels[i - 1], "The channel is not updated");
+        NS_TEST_EXPECT_MSG_EQ(m_params[i]->m_generatedTime,
+                              MilliSeconds(1 + i * (updatePeriodMs + 1)),
+                              "Wrong generation time");
+        NS_TEST_ASSERT_MSG_EQ(m_params[i]->m_delay.size(),
+                              m_params[0]->m_delay.size(),
+                              "The clusters are not kept");
+
+        // the LOS cluster follows the direct path
+        NS_TEST_EXPECT_MSG_EQ_TOL(m_params[i]->m_delay[0], 0, 1e-12, "Wrong LOS delay");
+        NS_TEST_EXPECT_MSG_EQ_TOL(DegreesToRadians(m_params[i]->m_angle[0][0]),
+                                  m_losAzimuths[i].first,
+                                  1e-9,
+                                  "Wrong LOS azimuth of arrival");
+        NS_TEST_EXPECT_MSG_EQ_TOL(DegreesToRadians(m_params[i]->m_angle[2][0]),
+                                  m_losAzimuths[i].second,
+                                  1e-9,
+                                  "Wrong LOS azimuth of departure");
+
+        // the other clusters move slowly
+        for (size_t c = 1; c < m_params[i]->m_delay.size(); c++)
+        {
+            NS_TEST_EXPECT_MSG_EQ_TOL(m_params[i]->m_delay[c],
+                                      m_params[i - 1]->m_delay[c],
+                                      1e-9,
+                                      "Cluster " << c << " jumped");
+        }
+    }
+    NS_TEST_EXPECT_MSG_GT(std::abs(DegreesToRadians(m_params[2]->m_angle[0][0]) -
+                                   DegreesToRadians(m_params[0]->m_angle[0][0])),
+                          0,
+                          "The LOS cluster did not move");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Test case for the ThreeGppChannelModel class. It checks that the channel
+ * matrix synthesized in single precision matches the one synthesized in
+ * double precision from the same channel params.
+ */
+class ThreeGppChannelSinglePrecisionTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelSinglePrecisionTest();
+
+  private:
+    /**
+     * Build the test scenario
+     */
+    void DoRun() override;
+};
+
+ThreeGppChannelSinglePrecisionTest::ThreeGppChannelSinglePrecisionTest()
+    : TestCase("Check the synthesis of the channel matrix in single precision")
+{
+}
+
+void
+ThreeGppChannelSinglePrecisionTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel>();
+    txMob->SetPosition(Vector(0.0, 0.0, 25.0));
+    Ptr<MobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel>();
+    rxMob->SetPosition(Vector(80.0, 30.0, 1.5));
+    nodes.Get(0)->AggregateObject(txMob);
+    nodes.Get(1)->AggregateObject(rxMob);
+
+    Ptr<PhasedArrayModel> txAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(4),
+        "NumRows",
+        UintegerValue(4),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()));
+    Ptr<PhasedArrayModel> rxAntenna = CreateObjectWithAttributes<UniformPlanarArray>(
+        "NumColumns",
+        UintegerValue(2),
+        "NumRows",
+        UintegerValue(2),
+        "AntennaElement",
+        PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    // two models drawing the same channel params
+    Ptr<const ThreeGppChannelModel::ChannelMatrix> channels[2];
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+        channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+        channelModel->SetAttribute("Scenario", StringValue("UMa"));
+        channelModel->SetAttribute("ChannelConditionModel",
+                                   PointerValue(CreateObject<NeverLosChannelConditionModel>()));
+        channelModel->SetAttribute("SinglePrecision", BooleanValue(i == 1));
+        channelModel->AssignStreams(1);
+        channels[i] = channelModel->GetChannel(txMob, rxMob, txAntenna, rxAntenna);
+    }
+
+    const ThreeGppChannelModel::Complex3DVector& reference = channels[0]->m_channel;
+    const ThreeGppChannelModel::Complex3DVector& single = channels[1]->m_channel;
+    NS_TEST_ASSERT_MSG_EQ(single.GetNumPages(),
+                          reference.GetNumPages(),
+                          "Wrong number of clusters");
+    for (size_t page = 0; page < reference.GetNumPages(); page++)
+    {
+        for (size_t row = 0; row < reference.GetNumRows(); row++)
+        {
+            for (size_t col = 0; col < reference.GetNumCols(); col++)
+            {
+                double error = std::abs(single(row, col, page) - reference(row, col, page));
+                NS_TEST_EXPECT_MSG_EQ_TOL(error,
+                                          0,
+                                          1e-5,
+                                          "Wrong coefficient " << row << ", " << col << ", "
+                                                               << page);
+            }
+        }
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup spectrum-tests
+ *
+ * Test case for the prefetch of the channels of the ThreeGppChannelModel.
+ * It checks that the channels of the known pairs are regenerated at the
+ * multiples of the update period, and that they do not depend on the number
+ * of threads generating them.
+ */
+class ThreeGppChannelPrefetchTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelPrefetchTest();
+
+  private:
+    /**
+     * Build the test scenario
+     */
+    void DoRun() override;
+
+    /**
+     * Get the channel of a pair of devices and store it in m_channels
+     * \param channelModel the ThreeGppChannelModel object used to generate the channel matrix
+     * \param txMob the mobility model of the first node
+     * \param rxMob the mobility model of the second node
+     * \param txAntenna the antenna object associated to the first node
+     * \param rxAntenna the antenna object associated to the second node
+     */
+    void DoGetChannel(Ptr<ThreeGppChannelModel> channelModel,
+                      Ptr<MobilityModel> txMob,
+                      Ptr<MobilityModel> rxMob,
+                      Ptr<PhasedArrayModel> txAntenna,
+                      Ptr<PhasedArrayModel> rxAntenna);
+
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>>
+        m_channels; //!< the channels returned by GetChannel
+};
+
+ThreeGppChannelPrefetchTest::ThreeGppChannelPrefetchTest()
+    : TestCase("Check the prefetch of the channels on several threads")
+{
+}
+
+void
+ThreeGppChannelPrefetchTest::DoGetChannel(Ptr<ThreeGppChannelModel> channelModel,
+                                          Ptr<MobilityModel> txMob,
+                                          Ptr<MobilityModel> rxMob,
+                                          Ptr<PhasedArrayModel> txAntenna,
+                                          Ptr<PhasedArrayModel> rxAntenna)
+{
+    m_channels.push_back(channelModel->GetChannel(txMob, rxMob, txAntenna, rxAntenna));
+}
+
+void
+ThreeGppChannelPrefetchTest::DoRun()
+{
+    uint32_t updatePeriodMs = 10; // update period in ms
+    uint32_t numUes = 3;
+    std::vector<uint32_t> requestMs = {3, 15, 25, 37}; // times of the requests, in ms
+
+    // a base station and the UEs moving away from it
+    NodeContainer nodes;
+    nodes.Create(numUes + 1);
+    std::vector<Ptr<ConstantVelocityMobilityModel>> mobs;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i <= numUes; i++)
+    {
+        mobs.push_back(CreateObject<ConstantVelocityMobilityModel>());
+        nodes.Get(i)->AggregateObject(mobs[i]);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(2),
+            "NumRows",
+            UintegerValue(2),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+
+    // prefetch on one thread, then on four
+    std::vector<uint32_t> threads = {1, 4};
+    for (uint32_t run = 0; run < threads.size(); run++)
+    {
+        Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+        channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+        channelModel->SetAttribute("Scenario", StringValue("UMa"));
+        channelModel->SetAttribute("ChannelConditionModel",
+                                   PointerValue(CreateObject<NeverLosChannelConditionModel>()));
+        channelModel->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(updatePeriodMs)));
+        channelModel->SetAttribute("PrefetchThreads", UintegerValue(threads[run]));
+        channelModel->AssignStreams(1);
+
+        mobs[0]->SetPosition(Vector(0.0, 0.0, 25.0));
+        for (uint32_t i = 1; i <= numUes; i++)
+        {
+            mobs[i]->SetPosition(Vector(50.0 * i, 20.0, 1.5));
+            mobs[i]->SetVelocity(Vector(10.0, 5.0 * i, 0.0));
+        }
+
+        for (auto ms : requestMs)
+        {
+            for (uint32_t i = 1; i <= numUes; i++)
+            {
+                Simulator::Schedule(MilliSeconds(ms),
+                                    &ThreeGppChannelPrefetchTest::DoGetChannel,
+                                    this,
+                                    channelModel,
+                                    mobs[0],
+                                    mobs[i],
+                                    antennas[0],
+                                    antennas[i]);
+            }
+        }
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    size_t numChannels = requestMs.size() * numUes;
+    NS_TEST_ASSERT_MSG_EQ(m_channels.size(), numChannels * threads.size(), "Missing channels");
+    for (size_t i = 0; i < numChannels; i++)
+    {
+        // the channel is generated on request first, then at the last multiple of the period
+        uint32_t ms = requestMs[i / numUes];
+        Time generated = MilliSeconds(i < numUes ? ms : ms - ms % updatePeriodMs);
+        NS_TEST_EXPECT_MSG_EQ(m_channels[i]->m_generatedTime, generated, "Wrong generation time");
+
+        Ptr<const ThreeGppChannelModel::ChannelMatrix> other = m_channels[numChannels + i];
+        NS_TEST_EXPECT_MSG_EQ(other->m_generatedTime, generated, "Wrong generation time");
+        NS_TEST_ASSERT_MSG_EQ((other->m_channel == m_channels[i]->m_channel),
+                              true,
+                              "The channel depends on the number of threads");
+        if (i >= numUes)
+        {
+            NS_TEST_EXPECT_MSG_EQ((m_channels[i]->m_channel == m_channels[i - numUes]->m_channel),
+                                  false,
+                                  "The channel is not updated");
+        }
+    }
+}
+
 /**
  * \ingroup spectrum-tests
  * \brief A structure that holds the parameters for the function
@@ -701,6 +1117,9 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite()
 {
     AddTestCase(new ThreeGppChannelMatrixComputationTest, TestCase::QUICK);
     AddTestCase(new ThreeGppChannelMatrixUpdateTest, TestCase::QUICK);
+    AddTestCase(new ThreeGppChannelSpatialConsistencyTest, TestCase::QUICK);
+    AddTestCase(new ThreeGppChannelSinglePrecisionTest, TestCase::QUICK);
+    AddTestCase(new ThreeGppChannelPrefetchTest, TestCase::QUICK);
     AddTestCase(new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
 }
 
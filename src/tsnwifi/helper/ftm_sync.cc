@@ -15,6 +15,7 @@
 #include "ns3/ftm-header.h"
 #include "ns3/pointer.h"
 #include "ns3/ftm_sync.h"
+#include "ns3/clock-sync-service.h"
 #include "ns3/wifi-setup.h"
 
 
@@ -86,45 +87,21 @@ void PropagationDelayManager (FtmSession session)
 
 }
 
-void ReceivePacket (Ptr<Socket> socket)
+void InstallClockSync (Ptr<Node> ap, Ptr<Socket> socket, Ptr<Node> sta)
 {
-        Ptr<Packet> packet;
-        Address from;
-	Ptr<Node> node;
-	Ptr<LocalClock> clk_AP;
-        Time off;
-        TimestampTag timestamp;
-	
-	/* Search for the clock of AP from list of nodes */
-	for (uint32_t i = 0; i < NodeList::GetNNodes (); i++)
-	{
-		node = NodeList::GetNode (i);
-		if(socket == node->GetObject<Socket>())
-		{
-			clk_AP = node->GetObject<LocalClock>();
-		}
-	}
-
-	while ((packet = socket->RecvFrom (from))) 
-	{
-		if (InetSocketAddress::IsMatchingType (from)) 
-		{
-			//NS_LOG_UNCOND ("Received " << packet->GetSize () << " bytes from " <<
-			//               InetSocketAddress::ConvertFrom (from).GetIpv4 ());
-		}
-		if (packet->FindFirstMatchingByteTag (timestamp)) 
-		{
-			Time tx = timestamp.GetTimestamp ();
-			off = timestamp.GetTimestamp () - clk_AP->GetLocalTime();
-			//NS_LOG_UNCOND (" received ts " << timestamp.GetTimestamp ().GetPicoSeconds() << " clock0 " << clock0->GetLocalTime().GetPicoSeconds() << " offset " << timestamp.GetTimestamp () - clock0->GetLocalTime() << " clock1 " << clock1->GetLocalTime().GetPicoSeconds());
-
-		}
-	}
+	/* The service of the AP is bound to the socket, the switch time is then
+	 * received directly by the service */
+	Ptr<ClockSyncService> apService = CreateObject<ClockSyncService> ();
+	apService->Install (ap, socket);
+	Ptr<ClockSyncService> staService = CreateObject<ClockSyncService> ();
+	staService->Install (sta, 0);
+}
 
-	Ptr<PerfectClockModelImpl> clockImpl = CreateObject<PerfectClockModelImpl> ();
-	/* Set the clock of AP after receiving timestamp as bytetag from switch*/
-	clockImpl->SetAttribute ("Offset", TimeValue (off));
-	clk_AP->SetClock (clockImpl);
+void ReceivePacket (Ptr<Socket> socket)
+{
+	Ptr<ClockSyncService> service = socket->GetNode ()->GetObject<ClockSyncService> ();
+	NS_ABORT_MSG_UNLESS (service, "InstallClockSync has not been called for node " << socket->GetNode ()->GetId ());
+	service->ReceivePacket (socket);
 }
 
 void GenerateTraffic (Ptr<WifiNetDevice> ap, Ptr<WifiNetDevice> sta, Address recvAddr, FtmParams ftm_params, Ptr<LocalClock> clock_0, Ptr<LocalClock> clock_3)
@@ -143,9 +120,9 @@ void GenerateTraffic (Ptr<WifiNetDevice> ap, Ptr<WifiNetDevice> sta, Address rec
 	//create the wired error model
 	//Ptr<WiredFtmErrorModel> wired_error = CreateObject<WiredFtmErrorModel> ();
 	//wired_error->SetChannelBandwidth(WiredFtmErrorModel::Channel_20_MHz);
+	//the map is loaded once and shared by all the FTM sessions
 	Ptr<WirelessFtmErrorModel::FtmMap> map;
-	map = CreateObject<WirelessFtmErrorModel::FtmMap> ();
-	map->LoadMap ("src/wifi/ftm_map/10x10.map");
+	map = WirelessFtmErrorModel::FtmMap::GetSharedMap ("src/wifi/ftm_map/10x10.map");
 
 	//create wireless error model
 	//map has to be created prior
@@ -162,6 +139,10 @@ void GenerateTraffic (Ptr<WifiNetDevice> ap, Ptr<WifiNetDevice> sta, Address rec
 	session->SetOffsetCorrectionCallback(MakeCallback(&OffsetManager)); /* Offset Management callback */
 	session->SetPropgationDelayCallback(MakeCallback(&PropagationDelayManager)); /* Propagation delay manager callback */
 	session->SetSTATSClock(clock_3); /* Set the local clock of STA to the FTM Session */
+	Ptr<ClockSyncService> sync = sta->GetNode()->GetObject<ClockSyncService>();
+	NS_ABORT_MSG_UNLESS (sync, "InstallClockSync has not been called for the STA");
+	/* Report the measured RTTs to the synchronization service of the STA */
+	session->EnableLiveRTTFeedback(MakeCallback(&ClockSyncService::ReportFtmRtt, sync));
 	session->SessionBegin(); /* Begin FTM Session */
 }
 
@@ -64,9 +64,26 @@ void OffsetManager (Ptr<FtmSession::FtmDialog> dialog, FtmSession session);
  */
 void PropagationDelayManager (FtmSession session);
 
+/**
+ * InstallClockSync - Install the time synchronization services of the AP and of the STA.
+ *
+ * A ClockSyncService is aggregated to both nodes, which must have a LocalClock.
+ * The service of the AP receives the time sent by the switch on the socket,
+ * the service of the STA receives the RTTs measured by the FTM sessions started
+ * by GenerateTraffic. Must be called before the traffic starts.
+ *
+ * \param ap AP node.
+ * \param socket socket of the AP receiving the time sent from switch.
+ * \param sta STA node.
+ */
+void InstallClockSync (Ptr<Node> ap, Ptr<Socket> socket, Ptr<Node> sta);
+
 /**
  * ReceivePacket - Receive the time sent from switch to AP.
  *
+ * The clock of the AP is corrected by the ClockSyncService of the node, which
+ * must have been installed with InstallClockSync.
+ *
  * \param socket socket to receive.
  */
 void ReceivePacket (Ptr<Socket> socket);
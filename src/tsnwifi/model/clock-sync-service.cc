@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/clock-sync-service.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/timestamp-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ClockSyncService");
+
+NS_OBJECT_ENSURE_REGISTERED (ClockSyncService);
+
+TypeId
+ClockSyncService::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ClockSyncService")
+    .SetParent<Object> ()
+    .SetGroupName ("TsnWifi")
+    .AddConstructor<ClockSyncService> ()
+    .AddTraceSource ("Offset",
+                     "Offset correction applied to the local clock",
+                     MakeTraceSourceAccessor (&ClockSyncService::m_offsetTrace),
+                     "ns3::ClockSyncService::TimeTracedCallback")
+    .AddTraceSource ("Rtt",
+                     "Round trip time reported to the service",
+                     MakeTraceSourceAccessor (&ClockSyncService::m_rttTrace),
+                     "ns3::ClockSyncService::TimeTracedCallback")
+    .AddTraceSource ("CorrectionCount",
+                     "Number of corrections applied to the local clock",
+                     MakeTraceSourceAccessor (&ClockSyncService::m_correctionCount),
+                     "ns3::TracedValueCallback::Uint32")
+    ;
+  return tid;
+}
+
+ClockSyncService::ClockSyncService ()
+  : m_correctionCount (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ClockSyncService::~ClockSyncService ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ClockSyncService::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  m_node = 0;
+  m_socket = 0;
+  m_clock = 0;
+  m_clockModel = 0;
+  Object::DoDispose ();
+}
+
+void
+ClockSyncService::Install (Ptr<Node> node, Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << node << socket);
+  m_node = node;
+  m_clock = node->GetObject<LocalClock> ();
+  NS_ABORT_MSG_UNLESS (m_clock, "Node " << node->GetId () << " has no LocalClock");
+  m_socket = socket;
+  if (m_socket)
+    {
+      m_socket->SetRecvCallback (MakeCallback (&ClockSyncService::ReceivePacket, this));
+    }
+  if (!node->GetObject<ClockSyncService> ())
+    {
+      node->AggregateObject (this);
+    }
+}
+
+void
+ClockSyncService::ReceivePacket (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  TimestampTag timestamp;
+  bool received = false;
+  Time correction;
+
+  while ((packet = socket->RecvFrom (from)))
+    {
+      if (packet->FindFirstMatchingByteTag (timestamp))
+        {
+          correction = timestamp.GetTimestamp () - m_clock->GetLocalTime ();
+          received = true;
+        }
+    }
+
+  if (received)
+    {
+      ApplyOffsetCorrection (correction);
+    }
+}
+
+void
+ClockSyncService::ApplyOffsetCorrection (Time correction)
+{
+  NS_LOG_FUNCTION (this << correction);
+  NS_ASSERT_MSG (m_clock, "ClockSyncService not installed");
+  if (!m_clockModel)
+    {
+      // the clock is taken over by a model which keeps the current local time,
+      // it is then only adjusted in place
+      m_clockModel = CreateObject<PerfectClockModelImpl> ();
+      m_clockModel->SetAttribute ("Frequency", DoubleValue (1));
+      m_clockModel->SetOffset (m_clock->GetLocalTime () - Simulator::Now ());
+    }
+  // the correction is relative to the current local time, so it is added to the
+  // offset: setting the offset to the correction would leave the clock at
+  // reference - previous offset, and the error would change sign with every packet
+  m_clockModel->SetOffset (m_clockModel->GetOffset () + correction);
+  // the clock is told about the update so that it reschedules its pending events;
+  // the frequency of the model never changes, so that the delays of these events
+  // are the same whether they are converted with the old or with the new offset
+  m_clock->SetClock (m_clockModel);
+
+  m_lastOffset = correction;
+  m_correctionCount++;
+  m_offsetTrace (correction);
+}
+
+void
+ClockSyncService::ReportRtt (Time rtt)
+{
+  NS_LOG_FUNCTION (this << rtt);
+  m_rttTrace (rtt);
+}
+
+void
+ClockSyncService::ReportFtmRtt (int64_t rtt)
+{
+  ReportRtt (PicoSeconds (rtt));
+}
+
+Ptr<LocalClock>
+ClockSyncService::GetLocalClock (void) const
+{
+  return m_clock;
+}
+
+Time
+ClockSyncService::GetLastOffset (void) const
+{
+  return m_lastOffset;
+}
+
+uint32_t
+ClockSyncService::GetCorrectionCount (void) const
+{
+  return m_correctionCount;
+}
+
+} // namespace ns3
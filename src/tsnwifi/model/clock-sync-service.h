@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CLOCK_SYNC_SERVICE_H
+#define CLOCK_SYNC_SERVICE_H
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/local-clock.h"
+#include "ns3/perfect-clock-model-impl.h"
+
+namespace ns3 {
+
+/**
+ * \brief Synchronization service bound to a node, its local clock and the socket
+ * on which the time of the switch is received.
+ *
+ * The node, socket and clock are resolved once by Install. Every received
+ * timestamp is turned into an offset correction which is applied in place to a
+ * PerfectClockModelImpl owned by the service, so no clock model is allocated per
+ * packet. The service is aggregated to the node, so that it can be retrieved with
+ * node->GetObject<ClockSyncService> ().
+ */
+class ClockSyncService : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ClockSyncService ();
+  virtual ~ClockSyncService ();
+
+  /**
+   * Binds the service to a node and to the socket receiving the timestamps.
+   * The node must have a LocalClock aggregated.
+   *
+   * \param node the node whose clock is corrected
+   * \param socket the socket receiving the timestamps, can be 0
+   */
+  void Install (Ptr<Node> node, Ptr<Socket> socket);
+
+  /**
+   * Receives the timestamped packets available on the socket and corrects the clock
+   * with the last timestamp.
+   *
+   * \param socket the socket to read
+   */
+  void ReceivePacket (Ptr<Socket> socket);
+
+  /**
+   * Shifts the local clock of the node by the given amount, the clock then runs
+   * at the frequency of the simulator.
+   *
+   * \param correction the difference between the reference time and the local time
+   */
+  void ApplyOffsetCorrection (Time correction);
+
+  /**
+   * Reports a round trip time measured towards the reference, e.g. by FTM.
+   *
+   * \param rtt the round trip time
+   */
+  void ReportRtt (Time rtt);
+
+  /**
+   * Reports a round trip time in picoseconds, as provided by the live RTT
+   * feedback of an FtmSession.
+   *
+   * \param rtt the round trip time in picoseconds
+   */
+  void ReportFtmRtt (int64_t rtt);
+
+  /**
+   * \return the local clock corrected by this service
+   */
+  Ptr<LocalClock> GetLocalClock (void) const;
+
+  /**
+   * \return the last correction applied
+   */
+  Time GetLastOffset (void) const;
+
+  /**
+   * \return the number of corrections applied
+   */
+  uint32_t GetCorrectionCount (void) const;
+
+  /**
+   * TracedCallback signature for offset and RTT reports.
+   *
+   * \param value the offset or round trip time
+   */
+  typedef void (*TimeTracedCallback) (Time value);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  Ptr<Node> m_node; //!< the node whose clock is corrected
+  Ptr<Socket> m_socket; //!< the socket receiving the timestamps
+  Ptr<LocalClock> m_clock; //!< the local clock of the node
+  Ptr<PerfectClockModelImpl> m_clockModel; //!< the clock model adjusted in place
+  Time m_lastOffset; //!< the last correction applied
+
+  TracedValue<uint32_t> m_correctionCount; //!< number of corrections applied
+  TracedCallback<Time> m_offsetTrace; //!< fired for every correction
+  TracedCallback<Time> m_rttTrace; //!< fired for every RTT report
+};
+
+} // namespace ns3
+
+#endif /* CLOCK_SYNC_SERVICE_H */
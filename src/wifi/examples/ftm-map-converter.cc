@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Converts a text FTM map created by ftm_map_generator.py into the binary,
+// memory mappable format understood by WirelessFtmErrorModel::FtmMap.
+//
+// ./ns3 run "ftm-map-converter --input=src/wifi/ftm_map/10x10.map --output=10x10.bmap"
+
+#include "ns3/command-line.h"
+#include "ns3/ftm-error-model.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+    double x = 0;
+    double y = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Text map to convert", input);
+    cmd.AddValue("output", "Binary map to write", output);
+    cmd.AddValue("x", "x coordinate at which the converted map is checked", x);
+    cmd.AddValue("y", "y coordinate at which the converted map is checked", y);
+    cmd.Parse(argc, argv);
+
+    if (input.empty() || output.empty())
+    {
+        std::cerr << "Both --input and --output are required" << std::endl;
+        return 1;
+    }
+
+    WirelessFtmErrorModel::FtmMap::ConvertToBinary(input, output);
+
+    Ptr<WirelessFtmErrorModel::FtmMap> text = CreateObject<WirelessFtmErrorModel::FtmMap>();
+    text->LoadMap(input);
+    Ptr<WirelessFtmErrorModel::FtmMap> binary = CreateObject<WirelessFtmErrorModel::FtmMap>();
+    binary->LoadMap(output);
+    std::cout << "bias at (" << x << ", " << y << "): text " << text->GetBias(x, y) << " binary "
+              << binary->GetBias(x, y) << std::endl;
+
+    return 0;
+}
@@ -24,8 +24,22 @@
 #include <ns3/double.h>
 #include <ns3/enum.h>
 #include <ns3/integer.h>
+#include <ns3/boolean.h>
+#include <ns3/simulator.h>
+#include <ns3/abort.h>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 namespace ns3 {
@@ -206,6 +220,13 @@ WirelessFtmErrorModel::GetTypeId (void)
                   MakePointerAccessor (&WirelessFtmErrorModel::SetFtmMap,
                                        &WirelessFtmErrorModel::GetFtmMap),
                   MakePointerChecker<FtmMap> ())
+    .AddAttribute("Interpolation",
+                  "If true, the bias is bilinearly interpolated between the "
+                  "surrounding map points instead of taking the nearest lower one.",
+                  BooleanValue (false),
+                  MakeBooleanAccessor (&WirelessFtmErrorModel::SetInterpolation,
+                                       &WirelessFtmErrorModel::GetInterpolation),
+                  MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -216,6 +237,7 @@ WirelessFtmErrorModel::WirelessFtmErrorModel ()
 
   m_node = 0;
   m_map = 0;
+  m_interpolate = false;
 }
 
 WirelessFtmErrorModel::WirelessFtmErrorModel (std::uint_least32_t seed)
@@ -225,6 +247,7 @@ WirelessFtmErrorModel::WirelessFtmErrorModel (std::uint_least32_t seed)
 
   m_node = 0;
   m_map = 0;
+  m_interpolate = false;
 }
 
 WirelessFtmErrorModel::~WirelessFtmErrorModel()
@@ -242,7 +265,7 @@ WirelessFtmErrorModel::GetFtmError (void)
   Ptr<MobilityModel> mobility = m_node->GetObject<MobilityModel> ();
   Vector position = mobility->GetPosition();
 
-  double bias = m_map->GetBias(position.x, position.y);
+  double bias = m_map->GetBias(position.x, position.y, m_interpolate);
 
   int error = bias + WiredFtmErrorModel::GetFtmError ();
   return error;
@@ -272,8 +295,33 @@ WirelessFtmErrorModel::GetNode (void)
   return m_node;
 }
 
+void
+WirelessFtmErrorModel::SetInterpolation (bool interpolate)
+{
+  m_interpolate = interpolate;
+}
+
+bool
+WirelessFtmErrorModel::GetInterpolation (void) const
+{
+  return m_interpolate;
+}
+
 //NS_OBJECT_ENSURE_REGISTERED (WirelessFtmErrorModel::FtmMap); //does not work for some reason
 
+namespace {
+
+/// magic identifying binary FTM maps
+const char g_binaryMapMagic[8] = {'F', 'T', 'M', 'M', 'A', 'P', 'B', '1'};
+
+/// maps shared through WirelessFtmErrorModel::FtmMap::GetSharedMap, keyed by file name
+std::map<std::string, Ptr<WirelessFtmErrorModel::FtmMap> > g_sharedMaps;
+
+/// whether the cleanup of g_sharedMaps is scheduled for Simulator::Destroy
+bool g_sharedMapsCleanupScheduled = false;
+
+} // unnamed namespace
+
 TypeId
 WirelessFtmErrorModel::FtmMap::GetTypeId (void)
 {
@@ -290,6 +338,8 @@ WirelessFtmErrorModel::FtmMap::FtmMap ()
   NS_LOG_FUNCTION (this);
 
   map = 0;
+  mapping = 0;
+  mappingLength = 0;
 
   xmin = 0;
   xmax = 0;
@@ -304,30 +354,66 @@ WirelessFtmErrorModel::FtmMap::~FtmMap ()
 {
   NS_LOG_FUNCTION (this);
 
-  delete [] map;
+  ReleaseMap ();
+}
+
+void
+WirelessFtmErrorModel::FtmMap::ReleaseMap (void)
+{
+#ifndef __WIN32__
+  if (mapping != 0)
+    {
+      munmap (mapping, mappingLength);
+    }
+#endif
+  mapping = 0;
+  mappingLength = 0;
+  cells.clear ();
+  cells.shrink_to_fit ();
+  map = 0;
 }
 
 void
 WirelessFtmErrorModel::FtmMap::LoadMap (std::string filename)
 {
-  std::ifstream file (filename);
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename, std::ios::binary);
   if (!file.is_open ())
     {
       file.close();
       NS_FATAL_ERROR ("Specified map file can not be opened!");
       return;
     }
+  ReleaseMap ();
+
+  char magic[sizeof (g_binaryMapMagic)];
+  if (file.read (magic, sizeof (magic))
+      && std::equal (magic, magic + sizeof (magic), g_binaryMapMagic))
+    {
+      file.close ();
+      LoadBinaryMap (filename);
+      return;
+    }
+  file.clear ();
+  file.seekg (0);
+  LoadTextMap (file);
+  file.close();
+}
+
+void
+WirelessFtmErrorModel::FtmMap::LoadTextMap (std::ifstream &file)
+{
   std::string line;
   std::getline(file, line);
 
   line.erase(std::remove_if (line.begin(), line.end(), [](unsigned char x){return std::isspace(x);}), line.end());
   auto begin = line.begin();
   begin++; //first character is not important
-  double *header = new double [7];
+  double header[7] = {0};
   int i = 0;
   std::string tmp = "";
   bool save = false;
-  for (auto it = begin; it != line.end(); ++it)
+  for (auto it = begin; it != line.end() && i < 7; ++it)
     {
       if (*it == '=')
         {
@@ -346,7 +432,10 @@ WirelessFtmErrorModel::FtmMap::LoadMap (std::string filename)
           tmp += *it;
         }
     }
-  header[i] = std::stod(tmp);
+  if (i < 7)
+    {
+      header[i] = std::stod(tmp);
+    }
 
   xmin = header[0];
   xmax = header[1];
@@ -354,47 +443,211 @@ WirelessFtmErrorModel::FtmMap::LoadMap (std::string filename)
   ymax = header[3];
   resolution = header[6];
 
+  if (!(resolution > 0) || !(xmax >= xmin) || !(ymax >= ymin))
+    {
+      NS_FATAL_ERROR ("Invalid map header!");
+    }
   xsize = ((xmax - xmin) / resolution) + 1;
   ysize = ((ymax - ymin) / resolution) + 1;
-  map = new double [xsize * ysize];
+  cells.assign (static_cast<std::size_t> (xsize) * ysize, 0.0);
 
   std::getline(file, line);
   int y = 0;
-  while(std::getline(file, line))
+  while(y < ysize && std::getline(file, line))
     {
-      int x = 0;
-      std::string tmp = "";
-      for (auto it = line.begin(); it != line.end(); ++it)
+      // parse the row in place, without building temporary strings per value
+      const char *cursor = line.c_str ();
+      double *row = cells.data () + static_cast<std::size_t> (y) * xsize;
+      for (int x = 0; x < xsize; ++x)
         {
-          if (*it == ' ')
+          char *next;
+          double value = std::strtod (cursor, &next);
+          if (next == cursor)
             {
-              map [y * xsize + x] = std::stod (tmp);
-              tmp = "";
-              ++x;
+              break;
             }
-          else
+          row[x] = value;
+          cursor = next;
+        }
+      ++y;
+    }
+  map = cells.data ();
+}
+
+void
+WirelessFtmErrorModel::FtmMap::LoadBinaryMap (std::string filename)
+{
+  BinaryHeader header;
+  std::ifstream file (filename, std::ios::binary);
+  if (!file.read (reinterpret_cast<char *> (&header), sizeof (header)))
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " is truncated!");
+    }
+
+  // validate the header before trusting it to size and index the cells
+  if (header.xsize == 0 || header.ysize == 0
+      || header.xsize > static_cast<uint32_t> (std::numeric_limits<int>::max ())
+      || header.ysize > static_cast<uint32_t> (std::numeric_limits<int>::max ()))
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " has an invalid size "
+                      << header.xsize << "x" << header.ysize << "!");
+    }
+  if (!(header.resolution > 0) || !std::isfinite (header.resolution))
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " has an invalid resolution "
+                      << header.resolution << "!");
+    }
+  if (!(header.xmax >= header.xmin) || !(header.ymax >= header.ymin)
+      || !std::isfinite (header.xmax - header.xmin) || !std::isfinite (header.ymax - header.ymin)
+      || static_cast<uint64_t> ((header.xmax - header.xmin) / header.resolution) + 1 != header.xsize
+      || static_cast<uint64_t> ((header.ymax - header.ymin) / header.resolution) + 1 != header.ysize)
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " has bounds inconsistent with its size!");
+    }
+  std::size_t count = static_cast<std::size_t> (header.xsize) * header.ysize;
+  if (count > (std::numeric_limits<std::size_t>::max () - sizeof (header)) / sizeof (double))
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " is too large!");
+    }
+  std::size_t length = sizeof (header) + count * sizeof (double);
+  file.seekg (0, std::ios::end);
+  if (!file || static_cast<std::size_t> (file.tellg ()) < length)
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " is truncated!");
+    }
+  file.seekg (sizeof (header));
+
+  xmin = header.xmin;
+  xmax = header.xmax;
+  ymin = header.ymin;
+  ymax = header.ymax;
+  resolution = header.resolution;
+  xsize = header.xsize;
+  ysize = header.ysize;
+
+#ifndef __WIN32__
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd >= 0)
+    {
+      struct stat st;
+      if (fstat (fd, &st) == 0 && static_cast<std::size_t> (st.st_size) >= length)
+        {
+          void *addr = mmap (0, length, PROT_READ, MAP_SHARED, fd, 0);
+          if (addr != MAP_FAILED)
             {
-              tmp += *it;
+              mapping = addr;
+              mappingLength = length;
+              map = reinterpret_cast<const double *> (static_cast<const char *> (addr) + sizeof (header));
             }
         }
-      map [y * xsize + x] = std::stod (tmp);
-      ++y;
+      close (fd);
     }
-  file.close();
+  if (map != 0)
+    {
+      NS_LOG_DEBUG ("Memory mapped " << xsize << "x" << ysize << " map " << filename);
+      return;
+    }
+#endif
+
+  cells.resize (count);
+  if (!file.read (reinterpret_cast<char *> (cells.data ()), count * sizeof (double)))
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " is truncated!");
+    }
+  map = cells.data ();
+}
+
+void
+WirelessFtmErrorModel::FtmMap::SaveBinaryMap (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (map == 0, "No map loaded");
+
+  BinaryHeader header;
+  std::copy (g_binaryMapMagic, g_binaryMapMagic + sizeof (g_binaryMapMagic), header.magic);
+  header.xsize = xsize;
+  header.ysize = ysize;
+  header.xmin = xmin;
+  header.xmax = xmax;
+  header.ymin = ymin;
+  header.ymax = ymax;
+  header.resolution = resolution;
+
+  std::ofstream file (filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Binary map file " << filename << " can not be created!");
+    }
+  file.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  file.write (reinterpret_cast<const char *> (map),
+              static_cast<std::size_t> (xsize) * ysize * sizeof (double));
+}
+
+void
+WirelessFtmErrorModel::FtmMap::ConvertToBinary (std::string textFilename, std::string binaryFilename)
+{
+  Ptr<FtmMap> map = CreateObject<FtmMap> ();
+  map->LoadMap (textFilename);
+  map->SaveBinaryMap (binaryFilename);
+}
+
+Ptr<WirelessFtmErrorModel::FtmMap>
+WirelessFtmErrorModel::FtmMap::GetSharedMap (std::string filename)
+{
+  auto it = g_sharedMaps.find (filename);
+  if (it != g_sharedMaps.end ())
+    {
+      return it->second;
+    }
+  Ptr<FtmMap> map = CreateObject<FtmMap> ();
+  map->LoadMap (filename);
+  g_sharedMaps.insert (std::make_pair (filename, map));
+  if (!g_sharedMapsCleanupScheduled)
+    {
+      Simulator::ScheduleDestroy (&FtmMap::ClearSharedMaps);
+      g_sharedMapsCleanupScheduled = true;
+    }
+  return map;
+}
+
+void
+WirelessFtmErrorModel::FtmMap::ClearSharedMaps (void)
+{
+  g_sharedMaps.clear ();
+  g_sharedMapsCleanupScheduled = false;
 }
 
 double
-WirelessFtmErrorModel::FtmMap::GetBias (double x, double y)
+WirelessFtmErrorModel::FtmMap::GetCell (int x, int y) const
 {
-  if (x < xmin || y < ymin || x > xmax || y > ymax)
+  x = std::min (std::max (x, 0), xsize - 1);
+  y = std::min (std::max (y, 0), ysize - 1);
+  return map[static_cast<std::size_t> (y) * xsize + x];
+}
+
+double
+WirelessFtmErrorModel::FtmMap::GetBias (double x, double y, bool interpolate) const
+{
+  if (map == 0 || x < xmin || y < ymin || x > xmax || y > ymax)
     {
       return 0.0;
     }
 
-  int x_val = (std::abs(xmin - x)) / resolution;
-  int y_val = (std::abs(ymax - y)) / resolution;
+  double x_pos = (x - xmin) / resolution;
+  double y_pos = (ymax - y) / resolution;
+  int x_val = x_pos;
+  int y_val = y_pos;
+
+  if (!interpolate)
+    {
+      return GetCell (x_val, y_val);
+    }
 
-  return map[y_val * xsize + x_val];
+  double fx = x_pos - x_val;
+  double fy = y_pos - y_val;
+  double top = (1 - fx) * GetCell (x_val, y_val) + fx * GetCell (x_val + 1, y_val);
+  double bottom = (1 - fx) * GetCell (x_val, y_val + 1) + fx * GetCell (x_val + 1, y_val + 1);
+  return (1 - fy) * top + fy * bottom;
 }
 
 } /* namespace ns3 */
@@ -23,6 +23,8 @@
 
 #include <ns3/object.h>
 #include <random>
+#include <fstream>
+#include <vector>
 #include <ns3/node.h>
 
 namespace ns3 {
@@ -214,9 +216,23 @@ public:
    */
   Ptr<Node> GetNode (void);
 
+  /**
+   * Enables bilinear interpolation between the four map points surrounding
+   * the position of the node. Disabled by default.
+   *
+   * \param interpolate whether the bias is interpolated
+   */
+  void SetInterpolation (bool interpolate);
+
+  /**
+   * \return whether the bias is interpolated
+   */
+  bool GetInterpolation (void) const;
+
 private:
   Ptr<FtmMap> m_map; //!< Pointer to the map.
   Ptr<Node> m_node; //!< Pointer to the node.
+  bool m_interpolate; //!< whether the bias is interpolated
 };
 
 /**
@@ -227,6 +243,17 @@ private:
  * Also used to get the bias at a given point.
  * The map generator script can be found in the folder src/wifi/ftm_map/ and is called
  * ftm_map_generator.py. It can be used to create maps with custom size and bias.
+ *
+ * Besides the text format of the generator, a binary format is supported. It consists
+ * of a BinaryHeader followed by xsize * ysize double cells in row major order, the first
+ * row being the one at ymax. Binary maps are memory mapped where the platform allows it,
+ * so that large maps are loaded without parsing and their pages are shared between
+ * processes. ConvertToBinary can be used to convert an existing text map.
+ *
+ * Maps are usually shared between all the FTM sessions of a simulation, use
+ * GetSharedMap to obtain a cached instance instead of loading the same file once per
+ * session. A map is never modified once loaded, so per session settings such as the
+ * interpolation belong to the error model.
  */
 class WirelessFtmErrorModel::FtmMap : public Object
 {
@@ -241,23 +268,99 @@ public:
   virtual ~FtmMap ();
 
   /**
-   * Loads an existing map file created by the map generator.
+   * Header of the binary map format. All values are stored in host byte order.
+   */
+  struct BinaryHeader
+  {
+    char magic[8];     //!< always "FTMMAPB1"
+    uint32_t xsize;    //!< number of cells along the x axis
+    uint32_t ysize;    //!< number of cells along the y axis
+    double xmin;       //!< x axis minimum
+    double xmax;       //!< x axis maximum
+    double ymin;       //!< y axis minimum
+    double ymax;       //!< y axis maximum
+    double resolution; //!< map resolution
+  };
+
+  /**
+   * Loads an existing map file created by the map generator, or a binary map
+   * created by SaveBinaryMap. The format is detected from the file content.
    *
    * \param filename the path/name to an existing .map file to be loaded
    */
   void LoadMap (std::string filename);
 
+  /**
+   * Writes the currently loaded map in the binary format.
+   *
+   * \param filename the path/name of the binary map file to be written
+   */
+  void SaveBinaryMap (std::string filename) const;
+
+  /**
+   * Converts a text map created by the map generator to the binary format.
+   *
+   * \param textFilename the path/name of the text map to be read
+   * \param binaryFilename the path/name of the binary map to be written
+   */
+  static void ConvertToBinary (std::string textFilename, std::string binaryFilename);
+
+  /**
+   * Returns the map loaded from the given file, loading it only the first time
+   * it is requested. The cache is cleared when the simulator is destroyed.
+   *
+   * \param filename the path/name to an existing map file
+   * \return the shared map
+   */
+  static Ptr<FtmMap> GetSharedMap (std::string filename);
+
+  /**
+   * Drops all the maps held by the cache used by GetSharedMap.
+   */
+  static void ClearSharedMaps (void);
+
   /**
    * Returns the bias from the map at a given point.
    *
    * \param x the x coordinate
    * \param y the y coordinate
+   * \param interpolate if true, the bias is bilinearly interpolated between the four
+   *        map points surrounding the given point, otherwise the nearest lower one is used
    * \return the bias at the given point
    */
-  double GetBias (double x, double y);
+  double GetBias (double x, double y, bool interpolate = false) const;
 
 private:
-  double *map; //!< the map
+  /**
+   * Parses a text map created by the map generator.
+   *
+   * \param file the opened map file
+   */
+  void LoadTextMap (std::ifstream &file);
+
+  /**
+   * Loads a binary map, memory mapping it where possible.
+   *
+   * \param filename the path/name of the binary map file
+   */
+  void LoadBinaryMap (std::string filename);
+
+  /**
+   * Releases the cells of the map.
+   */
+  void ReleaseMap (void);
+
+  /**
+   * \param x the column
+   * \param y the row
+   * \return the value of the cell
+   */
+  double GetCell (int x, int y) const;
+
+  const double *map; //!< the map
+  std::vector<double> cells; //!< storage of the map if it is not memory mapped
+  void *mapping; //!< start of the memory mapped file, if any
+  std::size_t mappingLength; //!< length of the memory mapped file
 
   double xmin; //!< x axis minimum
   double xmax; //!< x axis maximum
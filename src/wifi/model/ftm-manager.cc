@@ -33,6 +33,21 @@ NS_LOG_COMPONENT_DEFINE ("FtmManager");
 
 NS_OBJECT_ENSURE_REGISTERED (FtmManager);
 
+/// Upper bound of the size of a MAC header, used to peek at the action fields of a frame
+static const uint32_t WIFI_MAC_HEADER_MAX_SIZE = 40;
+/// Size of the MAC header of an Ack frame
+static const uint32_t WIFI_ACK_HEADER_SIZE = 10;
+/// Size of the MAC header of a management frame without HT control
+static const uint32_t WIFI_MGT_HEADER_SIZE = 24;
+/// Type field of management frames
+static const uint8_t WIFI_FRAME_TYPE_MANAGEMENT = 0;
+/// Type field of control frames
+static const uint8_t WIFI_FRAME_TYPE_CONTROL = 1;
+/// Subtype field of action frames
+static const uint8_t WIFI_FRAME_SUBTYPE_ACTION = 13;
+/// Subtype field of Ack frames
+static const uint8_t WIFI_FRAME_SUBTYPE_ACK = 13;
+
 TypeId
 FtmManager::GetTypeId (void)
 {
@@ -74,43 +89,86 @@ FtmManager::~FtmManager ()
   m_txop = 0;
 }
 
+FtmManager::FrameClass
+FtmManager::ClassifyFrame (Ptr<const Packet> packet, WifiMacHeader &hdr)
+{
+  // Only the MAC header and the action category/value are needed to reject a frame.
+  // They are read from the packet buffer without copying the packet. The frame control
+  // is checked first, so that frames too short for their header are never deserialized.
+  uint8_t buffer[WIFI_MAC_HEADER_MAX_SIZE + 2];
+  uint32_t size = std::min (packet->GetSize (), WIFI_MAC_HEADER_MAX_SIZE + 2);
+  if (size < 2)
+    {
+      return OTHER_FRAME;
+    }
+  packet->CopyData (buffer, size);
+  uint8_t type = (buffer[0] >> 2) & 0x03;
+  uint8_t subtype = (buffer[0] >> 4) & 0x0f;
+  if (type == WIFI_FRAME_TYPE_CONTROL && subtype == WIFI_FRAME_SUBTYPE_ACK)
+    {
+      if (packet->GetSize () < WIFI_ACK_HEADER_SIZE)
+        {
+          return OTHER_FRAME;
+        }
+      packet->PeekHeader (hdr);
+      return ACK_FRAME;
+    }
+  if (type != WIFI_FRAME_TYPE_MANAGEMENT || subtype != WIFI_FRAME_SUBTYPE_ACTION
+      || packet->GetSize () < WIFI_MGT_HEADER_SIZE + 2)
+    {
+      return OTHER_FRAME;
+    }
+  packet->PeekHeader (hdr);
+  uint32_t hdrSize = hdr.GetSerializedSize ();
+  if (hdrSize > WIFI_MAC_HEADER_MAX_SIZE || packet->GetSize () < hdrSize + 2)
+    {
+      return OTHER_FRAME;
+    }
+  if (buffer[hdrSize] == WifiActionHeader::PUBLIC_ACTION
+      && buffer[hdrSize + 1] == WifiActionHeader::FTM_RESPONSE)
+    {
+      return FTM_RESPONSE_FRAME;
+    }
+  return OTHER_FRAME;
+}
+
+FtmResponseHeader
+FtmManager::GetFtmResponseHeader (Ptr<const Packet> packet, WifiActionHeader &action_hdr) const
+{
+  Ptr<Packet> copy = packet->Copy();
+  WifiMacHeader hdr;
+  copy->RemoveHeader(hdr);
+  copy->RemoveHeader(action_hdr);
+  FtmResponseHeader ftm_res_hdr;
+  copy->RemoveHeader(ftm_res_hdr);
+  return ftm_res_hdr;
+}
+
 void
 FtmManager::PhyTxBegin(Ptr<const Packet> packet, double num)
 {
-  Time now = Simulator::Now();
-  int64_t pico_sec = now.GetPicoSeconds();
-  pico_sec &= 0x0000FFFFFFFFFFFF;
   sent_packets++;
-  Ptr<Packet> copy = packet->Copy();
   WifiMacHeader hdr;
-  copy->RemoveHeader(hdr);
-  if(hdr.IsMgt() && hdr.IsAction()) {
-      WifiActionHeader action_hdr;
-      copy->RemoveHeader(action_hdr);
-      if(action_hdr.GetCategory() == WifiActionHeader::PUBLIC_ACTION) {
-          WifiActionHeader::ActionValue action = action_hdr.GetAction();
-          if (action.publicAction == WifiActionHeader::FTM_RESPONSE)
-            {
-              Ptr<FtmSession> session = FindSession (hdr.GetAddr1());
-              if (session != 0)
-                {
-                  FtmResponseHeader ftm_resp_hdr;
-                  copy->RemoveHeader(ftm_resp_hdr);
-		  /* Set T1 from the local clock of AP */
-		  session->SetT1(ftm_resp_hdr.GetDialogToken(), (session->GetAPTSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF));
-		  received_packets = 0;
-                  awaiting_ack = true;
-
-                  PacketInPieces pieces;
-                  pieces.mac_hdr = hdr;
-                  pieces.action_hdr = action_hdr;
-                  pieces.ftm_res_hdr = ftm_resp_hdr;
-                  m_current_tx_packet = pieces;
-                }
-            }
-      }
+  FrameClass frameClass = ClassifyFrame (packet, hdr);
+  if (frameClass == FTM_RESPONSE_FRAME) {
+      Ptr<FtmSession> session = FindSession (hdr.GetAddr1());
+      if (session != 0)
+        {
+          WifiActionHeader action_hdr;
+          FtmResponseHeader ftm_resp_hdr = GetFtmResponseHeader (packet, action_hdr);
+          /* Set T1 from the local clock of AP */
+          session->SetT1(ftm_resp_hdr.GetDialogToken(), (session->GetAPTSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF));
+          received_packets = 0;
+          awaiting_ack = true;
+
+          PacketInPieces pieces;
+          pieces.mac_hdr = hdr;
+          pieces.action_hdr = action_hdr;
+          pieces.ftm_res_hdr = ftm_resp_hdr;
+          m_current_tx_packet = pieces;
+        }
   }
-  else if(hdr.IsAck()) {
+  else if(frameClass == ACK_FRAME) {
       if(sending_ack && sent_packets == 1) {
           if(m_ack_to == hdr.GetAddr1()) {
               sending_ack = false;
@@ -129,54 +187,47 @@ void
 FtmManager::PhyRxBegin(Ptr<const Packet> packet, RxPowerWattPerChannelBand rxPowersW)
 {
   NS_LOG_FUNCTION (this);
-  Time now = Simulator::Now();
-  int64_t pico_sec = now.GetPicoSeconds();
-  pico_sec &= 0x0000FFFFFFFFFFFF;
-  Ptr<Packet> copy = packet->Copy();
   received_packets++;
   WifiMacHeader hdr;
-  copy->RemoveHeader(hdr);
-  if(hdr.GetAddr1() == m_mac_address){
-      if(hdr.IsMgt() && hdr.IsAction()) {
+  FrameClass frameClass = ClassifyFrame (packet, hdr);
+  if(frameClass == OTHER_FRAME || hdr.GetAddr1() != m_mac_address){
+      return;
+  }
+  if(frameClass == FTM_RESPONSE_FRAME) {
+      Mac48Address partner = hdr.GetAddr2();
+      sending_ack = true;
+      sent_packets = 0;
+      m_ack_to = partner;
+
+      Ptr<FtmSession> session = FindSession(partner);
+      if (session != 0)
+        {
           WifiActionHeader action_hdr;
-          copy->RemoveHeader(action_hdr);
-          if(action_hdr.GetCategory() == WifiActionHeader::PUBLIC_ACTION) {
-              Mac48Address partner = hdr.GetAddr2();
-              if(action_hdr.GetAction().publicAction == WifiActionHeader::FTM_RESPONSE) {
-                  sending_ack = true;
-                  sent_packets = 0;
-                  m_ack_to = partner;
-
-                  FtmResponseHeader ftm_res_hdr;
-                  copy->RemoveHeader(ftm_res_hdr);
-
-                  Ptr<FtmSession> session = FindSession(partner);
-                  if (session != 0 && ftm_res_hdr.GetDialogToken() != 0)
-                    {
-		      /* Set T2 from the local clock of STA */
-		      session->SetT2(ftm_res_hdr.GetDialogToken(), ( session->GetSTATSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF));
-		      PacketInPieces pieces;
-                      pieces.mac_hdr = hdr;
-                      pieces.action_hdr = action_hdr;
-                      pieces.ftm_res_hdr = ftm_res_hdr;
-                      m_current_rx_packet = pieces;
-                    }
-              }
-          }
+          FtmResponseHeader ftm_res_hdr = GetFtmResponseHeader (packet, action_hdr);
+          if (ftm_res_hdr.GetDialogToken() != 0)
+            {
+	      /* Set T2 from the local clock of STA */
+	      session->SetT2(ftm_res_hdr.GetDialogToken(), ( session->GetSTATSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF));
+	      PacketInPieces pieces;
+              pieces.mac_hdr = hdr;
+              pieces.action_hdr = action_hdr;
+              pieces.ftm_res_hdr = ftm_res_hdr;
+              m_current_rx_packet = pieces;
+            }
+        }
+  }
+  else if(frameClass == ACK_FRAME) {
+      if(awaiting_ack && received_packets == 1) {
+          awaiting_ack = false;
+          Ptr<FtmSession> session = FindSession (m_current_tx_packet.mac_hdr.GetAddr1());
+          if (session != 0)
+            {
+	    /* Set T4 from the local clock of AP */
+	    session->SetT4(m_current_tx_packet.ftm_res_hdr.GetDialogToken(), ( session->GetAPTSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF ));
+            }
       }
-      if(hdr.IsAck()) {
-          if(awaiting_ack && received_packets == 1) {
-              awaiting_ack = false;
-              Ptr<FtmSession> session = FindSession (m_current_tx_packet.mac_hdr.GetAddr1());
-              if (session != 0)
-                {
-		/* Set T4 from the local clock of AP */
-		session->SetT4(m_current_tx_packet.ftm_res_hdr.GetDialogToken(), ( session->GetAPTSClock()->GetLocalTime().GetPicoSeconds() & 0x0000FFFFFFFFFFFF ));
-                }
-          }
-          else if(awaiting_ack && received_packets > 1) { //this needs to be checked also for non ack, cause if ack never arrives but other packet, its still an error
-              awaiting_ack = false;
-          }
+      else if(awaiting_ack && received_packets > 1) { //this needs to be checked also for non ack, cause if ack never arrives but other packet, its still an error
+          awaiting_ack = false;
       }
   }
 }
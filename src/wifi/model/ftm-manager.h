@@ -29,6 +29,9 @@
 #include "ns3/qos-txop.h"
 #include "ns3/ftm-header.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/qos-utils.h"
+
+#include <unordered_map>
 
 
 namespace ns3 {
@@ -109,6 +112,27 @@ public:
    */
   void ReceivedFtmResponse (Mac48Address partner, FtmResponseHeader ftm_res);
 
+  /**
+   * Kinds of frames the PHY hooks have to handle.
+   */
+  enum FrameClass
+  {
+    OTHER_FRAME,        //!< frame unrelated to FTM
+    FTM_RESPONSE_FRAME, //!< FTM response action frame
+    ACK_FRAME           //!< Ack frame
+  };
+
+  /**
+   * Classifies a frame seen by the PHY without copying it. Only the MAC header
+   * and the category and action fields of action frames are read.
+   *
+   * \param packet the frame
+   * \param hdr the MAC header of the frame, filled in by this method unless the
+   *        frame is classified as OTHER_FRAME
+   * \return the kind of frame
+   */
+  static FrameClass ClassifyFrame (Ptr<const Packet> packet, WifiMacHeader &hdr);
+
 
 private:
 
@@ -123,6 +147,15 @@ private:
     FtmResponseHeader ftm_res_hdr;
   };
 
+  /**
+   * Deserializes the FTM response carried by a frame classified as FTM_RESPONSE_FRAME.
+   *
+   * \param packet the frame
+   * \param action_hdr the action header of the frame, filled in by this method
+   * \return the FTM response header
+   */
+  FtmResponseHeader GetFtmResponseHeader (Ptr<const Packet> packet, WifiActionHeader &action_hdr) const;
+
   /**
    * Finds the session with the specified partner, if it exists.
    *
@@ -196,7 +229,7 @@ private:
   void OverrideSession (Mac48Address partner, FtmRequestHeader ftm_req);
 
   Mac48Address m_mac_address; //!< The mac address.
-  std::map<Mac48Address, Ptr<FtmSession>> sessions; //!< The FTM sessions this manager has.
+  std::unordered_map<Mac48Address, Ptr<FtmSession>, WifiAddressHash> sessions; //!< The FTM sessions this manager has.
   unsigned int received_packets;  //!< How many packets have been received, after transmitting a FTM frame.
   bool awaiting_ack; //!< Next packet should be ack.
 
@@ -148,33 +148,126 @@ operator<<(std::ostream& os, const Event& event)
  *       short period of time.
  ****************************************************************/
 
-InterferenceHelper::NiChange::NiChange(double power, Ptr<Event> event)
-    : m_power(power),
-      m_event(event)
+InterferenceHelper::NiChanges::NiChanges()
+    : m_times{Time(0)},
+      m_powers{0.0},
+      m_events{nullptr},
+      m_first(0)
 {
 }
 
-InterferenceHelper::NiChange::~NiChange()
+std::size_t
+InterferenceHelper::NiChanges::Begin() const
 {
-    m_event = nullptr;
+    return m_first;
 }
 
-double
-InterferenceHelper::NiChange::GetPower() const
+std::size_t
+InterferenceHelper::NiChanges::End() const
+{
+    return m_times.size();
+}
+
+std::size_t
+InterferenceHelper::NiChanges::GetNextPosition(Time moment) const
+{
+    return std::upper_bound(m_times.begin() + m_first, m_times.end(), moment) - m_times.begin();
+}
+
+std::size_t
+InterferenceHelper::NiChanges::GetPreviousPosition(Time moment) const
 {
-    return m_power;
+    // This is safe since there is always an NiChange at time 0,
+    // before moment.
+    return GetNextPosition(moment) - 1;
+}
+
+std::size_t
+InterferenceHelper::NiChanges::GetFirstPosition(Time moment) const
+{
+    return std::lower_bound(m_times.begin() + m_first, m_times.end(), moment) - m_times.begin();
+}
+
+std::size_t
+InterferenceHelper::NiChanges::Add(Time moment, double power, Ptr<Event> event)
+{
+    std::size_t position = GetNextPosition(moment);
+    m_times.insert(m_times.begin() + position, moment);
+    m_powers.insert(m_powers.begin() + position, power);
+    m_events.insert(m_events.begin() + position, event);
+    return position;
 }
 
 void
-InterferenceHelper::NiChange::AddPower(double power)
+InterferenceHelper::NiChanges::AddPower(std::size_t first, std::size_t last, double power)
 {
-    m_power += power;
+    NS_ASSERT(first <= last && last <= m_powers.size());
+    for (std::size_t i = first; i < last; ++i)
+    {
+        m_powers[i] += power;
+    }
 }
 
-Ptr<Event>
-InterferenceHelper::NiChange::GetEvent() const
+void
+InterferenceHelper::NiChanges::RemoveUntil(std::size_t position)
+{
+    NS_ASSERT(position < m_times.size());
+    if (position <= m_first)
+    {
+        return;
+    }
+    std::fill(m_events.begin() + m_first, m_events.begin() + position, nullptr);
+    // The last removed change becomes the zero power change
+    m_times[position] = Time(0);
+    m_powers[position] = 0.0;
+    m_events[position] = nullptr;
+    m_first = position;
+    if (m_first > m_times.size() / 2)
+    {
+        m_times.erase(m_times.begin(), m_times.begin() + m_first);
+        m_powers.erase(m_powers.begin(), m_powers.begin() + m_first);
+        m_events.erase(m_events.begin(), m_events.begin() + m_first);
+        m_first = 0;
+    }
+}
+
+void
+InterferenceHelper::NiChanges::Clear()
+{
+    m_times.assign(1, Time(0));
+    m_powers.assign(1, 0.0);
+    m_events.assign(1, nullptr);
+    m_first = 0;
+}
+
+Time
+InterferenceHelper::NiChanges::GetTime(std::size_t position) const
+{
+    return m_times[position];
+}
+
+double
+InterferenceHelper::NiChanges::GetPower(std::size_t position) const
+{
+    return m_powers[position];
+}
+
+const Ptr<Event>&
+InterferenceHelper::NiChanges::GetEvent(std::size_t position) const
+{
+    return m_events[position];
+}
+
+const Time*
+InterferenceHelper::NiChanges::GetTimes(std::size_t position) const
+{
+    return m_times.data() + position;
+}
+
+const double*
+InterferenceHelper::NiChanges::GetPowers(std::size_t position) const
 {
-    return m_event;
+    return m_powers.data() + position;
 }
 
 /****************************************************************
@@ -241,10 +334,6 @@ void
 InterferenceHelper::RemoveBands()
 {
     NS_LOG_FUNCTION(this);
-    for (auto it : m_niChangesPerBand)
-    {
-        it.second.clear();
-    }
     m_niChangesPerBand.clear();
     m_firstPowerPerBand.clear();
 }
@@ -254,11 +343,9 @@ InterferenceHelper::AddBand(WifiSpectrumBand band)
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
     NS_ASSERT(m_niChangesPerBand.find(band) == m_niChangesPerBand.end());
-    NiChanges niChanges;
-    auto result = m_niChangesPerBand.insert({band, niChanges});
-    NS_ASSERT(result.second);
     // Always have a zero power noise event in the list
-    AddNiChangeEvent(Time(0), NiChange(0.0, nullptr), result.first);
+    auto result = m_niChangesPerBand.insert({band, NiChanges()});
+    NS_ASSERT(result.second);
     m_firstPowerPerBand.insert({band, 0.0});
 }
 
@@ -292,12 +379,13 @@ InterferenceHelper::GetEnergyDuration(double energyW, WifiSpectrumBand band)
     Time now = Simulator::Now();
     auto niIt = m_niChangesPerBand.find(band);
     NS_ASSERT(niIt != m_niChangesPerBand.end());
-    auto i = GetPreviousPosition(now, niIt);
-    Time end = i->first;
-    for (; i != niIt->second.end(); ++i)
+    const auto& niChanges = niIt->second;
+    auto i = niChanges.GetPreviousPosition(now);
+    Time end = niChanges.GetTime(i);
+    for (; i != niChanges.End(); ++i)
     {
-        double noiseInterferenceW = i->second.GetPower();
-        end = i->first;
+        double noiseInterferenceW = niChanges.GetPower(i);
+        end = niChanges.GetTime(i);
         if (noiseInterferenceW < energyW)
         {
             break;
@@ -315,16 +403,17 @@ InterferenceHelper::AppendEvent(Ptr<Event> event, bool isStartOfdmaRxing)
         WifiSpectrumBand band = it.first;
         auto niIt = m_niChangesPerBand.find(band);
         NS_ASSERT(niIt != m_niChangesPerBand.end());
+        auto& niChanges = niIt->second;
         double previousPowerStart = 0;
         double previousPowerEnd = 0;
-        auto previousPowerPosition = GetPreviousPosition(event->GetStartTime(), niIt);
-        previousPowerStart = previousPowerPosition->second.GetPower();
-        previousPowerEnd = GetPreviousPosition(event->GetEndTime(), niIt)->second.GetPower();
+        auto previousPowerPosition = niChanges.GetPreviousPosition(event->GetStartTime());
+        previousPowerStart = niChanges.GetPower(previousPowerPosition);
+        previousPowerEnd = niChanges.GetPower(niChanges.GetPreviousPosition(event->GetEndTime()));
         if (!m_rxing)
         {
             m_firstPowerPerBand.find(band)->second = previousPowerStart;
             // Always leave the first zero power noise event in the list
-            niIt->second.erase(++(niIt->second.begin()), ++previousPowerPosition);
+            niChanges.RemoveUntil(previousPowerPosition);
         }
         else if (isStartOfdmaRxing)
         {
@@ -333,13 +422,9 @@ InterferenceHelper::AppendEvent(Ptr<Event> event, bool isStartOfdmaRxing)
             // UL MU transmission and the start of UL-OFDMA payload.
             m_firstPowerPerBand.find(band)->second = previousPowerStart;
         }
-        auto first =
-            AddNiChangeEvent(event->GetStartTime(), NiChange(previousPowerStart, event), niIt);
-        auto last = AddNiChangeEvent(event->GetEndTime(), NiChange(previousPowerEnd, event), niIt);
-        for (auto i = first; i != last; ++i)
-        {
-            i->second.AddPower(it.second);
-        }
+        auto first = niChanges.Add(event->GetStartTime(), previousPowerStart, event);
+        auto last = niChanges.Add(event->GetEndTime(), previousPowerEnd, event);
+        niChanges.AddPower(first, last, it.second);
     }
 }
 
@@ -353,12 +438,10 @@ InterferenceHelper::UpdateEvent(Ptr<Event> event, const RxPowerWattPerChannelBan
         WifiSpectrumBand band = it.first;
         auto niIt = m_niChangesPerBand.find(band);
         NS_ASSERT(niIt != m_niChangesPerBand.end());
-        auto first = GetPreviousPosition(event->GetStartTime(), niIt);
-        auto last = GetPreviousPosition(event->GetEndTime(), niIt);
-        for (auto i = first; i != last; ++i)
-        {
-            i->second.AddPower(it.second);
-        }
+        auto& niChanges = niIt->second;
+        auto first = niChanges.GetPreviousPosition(event->GetStartTime());
+        auto last = niChanges.GetPreviousPosition(event->GetEndTime());
+        niChanges.AddPower(first, last, it.second);
     }
     event->UpdateRxPowerW(rxPower);
 }
@@ -397,7 +480,7 @@ InterferenceHelper::CalculateSnr(double signal,
 
 double
 InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
-                                                NiChangesPerBand* nis,
+                                                NiChangesRange* ni,
                                                 WifiSpectrumBand band) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
@@ -406,30 +489,63 @@ InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
     double noiseInterferenceW = firstPower_it->second;
     auto niIt = m_niChangesPerBand.find(band);
     NS_ASSERT(niIt != m_niChangesPerBand.end());
-    auto it = niIt->second.find(event->GetStartTime());
-    for (; it != niIt->second.end() && it->first < Simulator::Now(); ++it)
+    const auto& niChanges = niIt->second;
+    auto start = niChanges.GetFirstPosition(event->GetStartTime());
+    NS_ASSERT(start != niChanges.End() && niChanges.GetTime(start) == event->GetStartTime());
+    auto it = start;
+    for (; it != niChanges.End() && niChanges.GetTime(it) < Simulator::Now(); ++it)
     {
-        noiseInterferenceW = it->second.GetPower() - event->GetRxPowerW(band);
+        noiseInterferenceW = niChanges.GetPower(it) - event->GetRxPowerW(band);
     }
-    it = niIt->second.find(event->GetStartTime());
-    NS_ASSERT(it != niIt->second.end());
-    for (; it != niIt->second.end() && it->second.GetEvent() != event; ++it)
+    for (it = start; it != niChanges.End() && niChanges.GetEvent(it) != event; ++it)
     {
         ;
     }
-    NiChanges ni;
-    ni.emplace(event->GetStartTime(), NiChange(0, event));
-    while (++it != niIt->second.end() && it->second.GetEvent() != event)
+    auto first = it;
+    while (++it != niChanges.End() && niChanges.GetEvent(it) != event)
     {
-        ni.insert(*it);
+        ;
     }
-    ni.emplace(event->GetEndTime(), NiChange(0, event));
-    nis->insert({band, ni});
+    NS_ASSERT(it != niChanges.End());
+    ni->times = niChanges.GetTimes(first);
+    ni->powers = niChanges.GetPowers(first);
+    ni->size = it - first + 1;
     NS_ASSERT_MSG(noiseInterferenceW >= 0,
                   "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
     return noiseInterferenceW;
 }
 
+void
+InterferenceHelper::CalculateChunkSnrs(double powerW,
+                                       double noiseInterferenceW,
+                                       const NiChangesRange& ni,
+                                       uint16_t channelWidth,
+                                       uint8_t nss,
+                                       std::vector<double>& snrs) const
+{
+    NS_LOG_FUNCTION(this << powerW << noiseInterferenceW << ni.size << channelWidth << +nss);
+    NS_ASSERT(ni.size > 1);
+    // Same as CalculateSnr for each chunk, in a single loop over the powers
+    // of the NI changes: the power from the last change on is not needed.
+    static const double BOLTZMANN = 1.3803e-23;
+    double Nt = BOLTZMANN * 290 * channelWidth * 1e6;
+    double noiseFloor = m_noiseFigure * Nt;
+    double gain = 1;
+    if (m_errorRateModel->IsAwgn() && m_numRxAntennas > nss)
+    {
+        gain = static_cast<double>(m_numRxAntennas) / nss;
+    }
+    std::size_t nChunks = ni.size - 1;
+    snrs.resize(nChunks);
+    snrs[0] = powerW / (noiseFloor + noiseInterferenceW) * gain;
+    const double* powers = ni.powers;
+    double* snr = snrs.data();
+    for (std::size_t k = 1; k < nChunks; ++k)
+    {
+        snr[k] = powerW / (noiseFloor + (powers[k] - powerW)) * gain;
+    }
+}
+
 double
 InterferenceHelper::CalculateChunkSuccessRate(double snir,
                                               Time duration,
@@ -476,7 +592,7 @@ InterferenceHelper::CalculatePayloadChunkSuccessRate(double snir,
 double
 InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
                                         uint16_t channelWidth,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& ni,
                                         WifiSpectrumBand band,
                                         uint16_t staId,
                                         std::pair<Time, Time> window) const
@@ -484,31 +600,32 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId << window.first
                          << window.second);
     double psr = 1.0; /* Packet Success Rate */
-    const auto& niIt = nis->find(band)->second;
-    auto j = niIt.cbegin();
-    Time previous = j->first;
+    Time previous = ni.times[0];
     WifiMode payloadMode = event->GetTxVector().GetMode(staId);
-    Time phyPayloadStart = j->first;
+    Time phyPayloadStart = ni.times[0];
     if (event->GetPpdu()->GetType() != WIFI_PPDU_TYPE_UL_MU &&
         event->GetPpdu()->GetType() !=
-            WIFI_PPDU_TYPE_DL_MU) // j->first corresponds to the start of the OFDMA payload
+            WIFI_PPDU_TYPE_DL_MU) // times[0] corresponds to the start of the OFDMA payload
     {
         phyPayloadStart =
-            j->first + WifiPhy::CalculatePhyPreambleAndHeaderDuration(event->GetTxVector());
+            ni.times[0] + WifiPhy::CalculatePhyPreambleAndHeaderDuration(event->GetTxVector());
     }
     Time windowStart = phyPayloadStart + window.first;
     Time windowEnd = phyPayloadStart + window.second;
-    double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.cend())
+    std::vector<double> snrs;
+    CalculateChunkSnrs(powerW,
+                       m_firstPowerPerBand.find(band)->second,
+                       ni,
+                       channelWidth,
+                       event->GetTxVector().GetNss(staId),
+                       snrs);
+    for (std::size_t j = 1; j < ni.size; ++j)
     {
-        Time current = j->first;
+        Time current = ni.times[j];
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
-        double snr = CalculateSnr(powerW,
-                                  noiseInterferenceW,
-                                  channelWidth,
-                                  event->GetTxVector().GetNss(staId));
+        double snr = snrs[j - 1];
         // Case 1: Both previous and current point to the windowed payload
         if (previous >= windowStart)
         {
@@ -530,8 +647,7 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
                 "previous is before windowed payload and current is in the windowed payload: mode="
                 << payloadMode << ", psr=" << psr);
         }
-        noiseInterferenceW = j->second.GetPower() - powerW;
-        previous = j->first;
+        previous = current;
         if (previous > windowEnd)
         {
             NS_LOG_DEBUG("Stop: new previous=" << previous
@@ -546,15 +662,13 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
 double
 InterferenceHelper::CalculatePhyHeaderSectionPsr(
     Ptr<const Event> event,
-    NiChangesPerBand* nis,
+    const NiChangesRange& ni,
     uint16_t channelWidth,
     WifiSpectrumBand band,
     PhyEntity::PhyHeaderSections phyHeaderSections) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
     double psr = 1.0; /* Packet Success Rate */
-    auto niIt = nis->find(band)->second;
-    auto j = niIt.begin();
 
     NS_ASSERT(!phyHeaderSections.empty());
     Time stopLastSection = Seconds(0);
@@ -563,15 +677,16 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
         stopLastSection = Max(stopLastSection, section.second.first.second);
     }
 
-    Time previous = j->first;
-    double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
+    Time previous = ni.times[0];
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.end())
+    std::vector<double> snrs;
+    CalculateChunkSnrs(powerW, m_firstPowerPerBand.find(band)->second, ni, channelWidth, 1, snrs);
+    for (std::size_t j = 1; j < ni.size; ++j)
     {
-        Time current = j->first;
+        Time current = ni.times[j];
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
-        double snr = CalculateSnr(powerW, noiseInterferenceW, channelWidth, 1);
+        double snr = snrs[j - 1];
         for (const auto& section : phyHeaderSections)
         {
             Time start = section.second.first.first;
@@ -594,8 +709,7 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
                 }
             }
         }
-        noiseInterferenceW = j->second.GetPower() - powerW;
-        previous = j->first;
+        previous = current;
         if (previous > stopLastSection)
         {
             NS_LOG_DEBUG("Stop: new previous=" << previous << " after stop of last section="
@@ -608,18 +722,17 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
 
 double
 InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
-                                          NiChangesPerBand* nis,
+                                          const NiChangesRange& ni,
                                           uint16_t channelWidth,
                                           WifiSpectrumBand band,
                                           WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    auto niIt = nis->find(band)->second;
     auto phyEntity = WifiPhy::GetStaticPhyEntity(event->GetTxVector().GetModulationClass());
 
     PhyEntity::PhyHeaderSections sections;
     for (const auto& section :
-         phyEntity->GetPhyHeaderSections(event->GetTxVector(), niIt.begin()->first))
+         phyEntity->GetPhyHeaderSections(event->GetTxVector(), ni.times[0]))
     {
         if (section.first == header)
         {
@@ -630,7 +743,7 @@ InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
     double psr = 1.0;
     if (!sections.empty())
     {
-        psr = CalculatePhyHeaderSectionPsr(event, nis, channelWidth, band, sections);
+        psr = CalculatePhyHeaderSectionPsr(event, ni, channelWidth, band, sections);
     }
     return 1 - psr;
 }
@@ -644,7 +757,7 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
 {
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId
                          << relativeMpduStartStop.first << relativeMpduStartStop.second);
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band),
                               noiseInterferenceW,
@@ -654,7 +767,7 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
     /* calculate the SNIR at the start of the MPDU (located through windowing) and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePayloadPer(event, channelWidth, &ni, band, staId, relativeMpduStartStop);
+    double per = CalculatePayloadPer(event, channelWidth, ni, band, staId, relativeMpduStartStop);
 
     return PhyEntity::SnrPer(snr, per);
 }
@@ -665,7 +778,7 @@ InterferenceHelper::CalculateSnr(Ptr<Event> event,
                                  uint8_t nss,
                                  WifiSpectrumBand band) const
 {
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, nss);
     return snr;
@@ -678,14 +791,14 @@ InterferenceHelper::CalculatePhyHeaderSnrPer(Ptr<Event> event,
                                              WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    NiChangesPerBand ni;
+    NiChangesRange ni;
     double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, 1);
 
     /* calculate the SNIR at the start of the PHY header and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePhyHeaderPer(event, &ni, channelWidth, band, header);
+    double per = CalculatePhyHeaderPer(event, ni, channelWidth, band, header);
 
     return PhyEntity::SnrPer(snr, per);
 }
@@ -695,36 +808,13 @@ InterferenceHelper::EraseEvents()
 {
     for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-        niIt->second.clear();
         // Always have a zero power noise event in the list
-        AddNiChangeEvent(Time(0), NiChange(0.0, nullptr), niIt);
+        niIt->second.Clear();
         m_firstPowerPerBand.at(niIt->first) = 0.0;
     }
     m_rxing = false;
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetNextPosition(Time moment, NiChangesPerBand::iterator niIt)
-{
-    return niIt->second.upper_bound(moment);
-}
-
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPreviousPosition(Time moment, NiChangesPerBand::iterator niIt)
-{
-    auto it = GetNextPosition(moment, niIt);
-    // This is safe since there is always an NiChange at time 0,
-    // before moment.
-    --it;
-    return it;
-}
-
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::AddNiChangeEvent(Time moment, NiChange change, NiChangesPerBand::iterator niIt)
-{
-    return niIt->second.insert(GetNextPosition(moment, niIt), std::make_pair(moment, change));
-}
-
 void
 InterferenceHelper::NotifyRxStart()
 {
@@ -740,10 +830,11 @@ InterferenceHelper::NotifyRxEnd(Time endTime)
     // Update m_firstPowerPerBand for frame capture
     for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-        NS_ASSERT(niIt->second.size() > 1);
-        auto it = GetPreviousPosition(endTime, niIt);
+        const auto& niChanges = niIt->second;
+        NS_ASSERT(niChanges.End() - niChanges.Begin() > 1);
+        auto it = niChanges.GetPreviousPosition(endTime);
         it--;
-        m_firstPowerPerBand.find(niIt->first)->second = it->second.GetPower();
+        m_firstPowerPerBand.find(niIt->first)->second = niChanges.GetPower(it);
     }
 }
 
@@ -346,47 +346,116 @@ class InterferenceHelper : public Object
 
   private:
     /**
-     * Noise and Interference (thus Ni) event.
+     * Noise and Interference (thus Ni) changes of a band, sorted by time.
+     *
+     * Each change holds the total power from its time on, so that the power
+     * at any time is read from a single change. The changes are stored in
+     * contiguous vectors, from which the changes older than the receptions in
+     * progress are dropped by moving the first position; the vectors are
+     * compacted once most of them is unused. The first change is always a
+     * zero power change at time 0.
      */
-    class NiChange
+    class NiChanges
     {
       public:
         /**
-         * Create a NiChange at the given time and the amount of NI change.
-         *
-         * \param power the power in watts
-         * \param event causes this NI change
+         * Create the list with the zero power change at time 0.
+         */
+        NiChanges();
+        /**
+         * \return the position of the first change
+         */
+        std::size_t Begin() const;
+        /**
+         * \return the position past the last change
          */
-        NiChange(double power, Ptr<Event> event);
-        ~NiChange();
+        std::size_t End() const;
         /**
-         * Return the power
+         * \param moment time to check from
+         * \return the position of the first change later than moment
+         */
+        std::size_t GetNextPosition(Time moment) const;
+        /**
+         * \param moment time to check from
+         * \return the position of the last change not later than moment
+         */
+        std::size_t GetPreviousPosition(Time moment) const;
+        /**
+         * \param moment time to check from
+         * \return the position of the first change not earlier than moment
+         */
+        std::size_t GetFirstPosition(Time moment) const;
+        /**
+         * Add a change after the changes at the same time.
          *
-         * \return the power in watts
+         * \param moment the time of the change
+         * \param power the total power from the change on, in watts
+         * \param event the event causing the change
+         * \return the position of the new change
          */
-        double GetPower() const;
+        std::size_t Add(Time moment, double power, Ptr<Event> event);
         /**
-         * Add a given amount of power.
+         * Add power to a range of changes.
          *
-         * \param power the power to be added to the existing value in watts
+         * \param first the position of the first change
+         * \param last the position past the last change
+         * \param power the power to be added in watts
          */
-        void AddPower(double power);
+        void AddPower(std::size_t first, std::size_t last, double power);
         /**
-         * Return the event causes the corresponding NI change
+         * Remove the changes after the first one, up to the given position.
          *
-         * \return the event
+         * \param position the position of the last change to remove
+         */
+        void RemoveUntil(std::size_t position);
+        /**
+         * Remove all the changes but the zero power change at time 0.
+         */
+        void Clear();
+        /**
+         * \param position the position of a change
+         * \return the time of the change
+         */
+        Time GetTime(std::size_t position) const;
+        /**
+         * \param position the position of a change
+         * \return the total power from the change on, in watts
+         */
+        double GetPower(std::size_t position) const;
+        /**
+         * \param position the position of a change
+         * \return the event causing the change
+         */
+        const Ptr<Event>& GetEvent(std::size_t position) const;
+        /**
+         * \param position the position of a change
+         * \return the times of the changes from the position on
+         */
+        const Time* GetTimes(std::size_t position) const;
+        /**
+         * \param position the position of a change
+         * \return the powers of the changes from the position on
          */
-        Ptr<Event> GetEvent() const;
+        const double* GetPowers(std::size_t position) const;
 
       private:
-        double m_power;     ///< power in watts
-        Ptr<Event> m_event; ///< event
+        std::vector<Time> m_times;        ///< time of each change
+        std::vector<double> m_powers;     ///< total power from each change on, in watts
+        std::vector<Ptr<Event>> m_events; ///< event causing each change
+        std::size_t m_first;              ///< position of the first change
     };
 
     /**
-     * typedef for a multimap of NiChange
+     * The NI changes of a band from the start to the end of an event, both
+     * included. The arrays belong to the NiChanges of the band, and remain
+     * valid until the next change of the band.
      */
-    typedef std::multimap<Time, NiChange> NiChanges;
+    struct NiChangesRange
+    {
+        const Time* times;    ///< time of each change
+        const double* powers; ///< total power from each change on, in watts
+        std::size_t size;     ///< number of changes
+    };
 
     /**
      * Map of NiChanges per band
@@ -406,14 +475,31 @@ class InterferenceHelper : public Object
      * Calculate noise and interference power in W.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NI changes of the band during the event
      * \param band the band
      *
      * \return noise and interference power
      */
     double CalculateNoiseInterferenceW(Ptr<Event> event,
-                                       NiChangesPerBand* nis,
+                                       NiChangesRange* ni,
                                        WifiSpectrumBand band) const;
+    /**
+     * Calculate the SNR of each chunk of an event, between two consecutive
+     * NI changes, in a single pass over the changes.
+     *
+     * \param powerW the power of the event in watts
+     * \param noiseInterferenceW the noise and interference power of the first chunk in watts
+     * \param ni the NI changes of the band during the event
+     * \param channelWidth signal width (MHz)
+     * \param nss the number of spatial streams
+     * \param snrs the SNR of each chunk in linear scale, filled by this method
+     */
+    void CalculateChunkSnrs(double powerW,
+                            double noiseInterferenceW,
+                            const NiChangesRange& ni,
+                            uint16_t channelWidth,
+                            uint8_t nss,
+                            std::vector<double>& snrs) const;
     /**
      * Calculate the error rate of the given PHY payload only in the provided time
      * window (thus enabling per MPDU PER information). The PHY payload can be divided into
@@ -421,7 +507,7 @@ class InterferenceHelper : public Object
      *
      * \param event the event
      * \param channelWidth the channel width used to transmit the PSDU (in MHz)
-     * \param nis the NiChanges
+     * \param ni the NI changes of the band during the event
      * \param band identify the band used by the PSDU
      * \param staId the station ID of the PSDU (only used for MU)
      * \param window time window (pair of start and end times) of PHY payload to focus on
@@ -430,7 +516,7 @@ class InterferenceHelper : public Object
      */
     double CalculatePayloadPer(Ptr<const Event> event,
                                uint16_t channelWidth,
-                               NiChangesPerBand* nis,
+                               const NiChangesRange& ni,
                                WifiSpectrumBand band,
                                uint16_t staId,
                                std::pair<Time, Time> window) const;
@@ -439,7 +525,7 @@ class InterferenceHelper : public Object
      * can be divided into multiple chunks (e.g. due to interference from other transmissions).
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NI changes of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param header the PHY header to consider
@@ -447,7 +533,7 @@ class InterferenceHelper : public Object
      * \return the error rate of the HT PHY header
      */
     double CalculatePhyHeaderPer(Ptr<const Event> event,
-                                 NiChangesPerBand* nis,
+                                 const NiChangesRange& ni,
                                  uint16_t channelWidth,
                                  WifiSpectrumBand band,
                                  WifiPpduField header) const;
@@ -455,7 +541,7 @@ class InterferenceHelper : public Object
      * Calculate the success rate of the PHY header sections for the provided event.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param ni the NI changes of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param phyHeaderSections the map of PHY header sections (\see PhyEntity::PhyHeaderSections)
@@ -463,7 +549,7 @@ class InterferenceHelper : public Object
      * \return the success rate of the PHY header sections
      */
     double CalculatePhyHeaderSectionPsr(Ptr<const Event> event,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& ni,
                                         uint16_t channelWidth,
                                         WifiSpectrumBand band,
                                         PhyEntity::PhyHeaderSections phyHeaderSections) const;
@@ -474,36 +560,6 @@ class InterferenceHelper : public Object
     NiChangesPerBand m_niChangesPerBand;                    //!< NI Changes for each band
     std::map<WifiSpectrumBand, double> m_firstPowerPerBand; //!< first power of each band in watts
     bool m_rxing; //!< flag whether it is in receiving state
-
-    /**
-     * Returns an iterator to the first NiChange that is later than moment
-     *
-     * \param moment time to check from
-     * \param niIt iterator of the band to check
-     * \returns an iterator to the list of NiChanges
-     */
-    NiChanges::iterator GetNextPosition(Time moment, NiChangesPerBand::iterator niIt);
-    /**
-     * Returns an iterator to the last NiChange that is before than moment
-     *
-     * \param moment time to check from
-     * \param niIt iterator of the band to check
-     * \returns an iterator to the list of NiChanges
-     */
-    NiChanges::iterator GetPreviousPosition(Time moment, NiChangesPerBand::iterator niIt);
-
-    /**
-     * Add NiChange to the list at the appropriate position and
-     * return the iterator of the new event.
-     *
-     * \param moment time to check from
-     * \param change the NiChange to add
-     * \param niIt iterator of the band to check
-     * \returns the iterator of the new event
-     */
-    NiChanges::iterator AddNiChangeEvent(Time moment,
-                                         NiChange change,
-                                         NiChangesPerBand::iterator niIt);
 };
 
 } // namespace ns3
@@ -0,0 +1,303 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/ftm-error-model.h"
+#include "ns3/ftm-header.h"
+#include "ns3/ftm-manager.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/packet.h"
+#include "ns3/test.h"
+#include "ns3/wifi-mac-header.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief FTM map loading and lookup test
+ *
+ * Loads a 3x3 text map, converts it to the binary format and checks that both
+ * return the same biases, with and without interpolation.
+ */
+class FtmMapTest : public TestCase
+{
+  public:
+    FtmMapTest();
+
+  private:
+    void DoRun() override;
+};
+
+FtmMapTest::FtmMapTest()
+    : TestCase("FTM map text to binary round trip and lookup")
+{
+}
+
+void
+FtmMapTest::DoRun()
+{
+    // rows from ymax down to ymin, values chosen to need more than float precision
+    const double cells[3][3] = {{0.123456789012345, 10.0, 20.0},
+                                {30.0, 40.0, 50.0},
+                                {60.0, 70.0, 80.987654321098765}};
+    std::string textFile = CreateTempDirFilename("ftm-test.map");
+    std::string binaryFile = CreateTempDirFilename("ftm-test.bmap");
+    {
+        std::ofstream out(textFile);
+        out.precision(17);
+        out << "#xmin=0, xmax=2, ymin=0, ymax=2, mean=0, std=0, resolution=1" << std::endl;
+        out << "#" << std::endl;
+        for (const auto& row : cells)
+        {
+            out << row[0] << " " << row[1] << " " << row[2] << std::endl;
+        }
+    }
+
+    Ptr<WirelessFtmErrorModel::FtmMap> text = CreateObject<WirelessFtmErrorModel::FtmMap>();
+    text->LoadMap(textFile);
+    WirelessFtmErrorModel::FtmMap::ConvertToBinary(textFile, binaryFile);
+    Ptr<WirelessFtmErrorModel::FtmMap> binary = CreateObject<WirelessFtmErrorModel::FtmMap>();
+    binary->LoadMap(binaryFile);
+
+    for (int y = 0; y < 3; ++y)
+    {
+        for (int x = 0; x < 3; ++x)
+        {
+            double expected = cells[2 - y][x];
+            NS_TEST_EXPECT_MSG_EQ(text->GetBias(x, y), expected, "wrong text map cell");
+            NS_TEST_EXPECT_MSG_EQ(binary->GetBias(x, y), expected, "wrong binary map cell");
+            NS_TEST_EXPECT_MSG_EQ(binary->GetBias(x, y, true),
+                                  expected,
+                                  "interpolation must be exact on the map points");
+        }
+    }
+
+    // inside a cell: nearest takes the lower point, interpolation mixes the four neighbours
+    NS_TEST_EXPECT_MSG_EQ(binary->GetBias(0.5, 1.5), 0.123456789012345, "wrong nearest lookup");
+    NS_TEST_EXPECT_MSG_EQ_TOL(binary->GetBias(0.5, 1.5, true),
+                              (30.0 + 40.0 + 0.123456789012345 + 10.0) / 4,
+                              1e-12,
+                              "wrong bilinear lookup");
+    NS_TEST_EXPECT_MSG_EQ_TOL(text->GetBias(1.25, 1, true),
+                              40.0 * 0.75 + 50.0 * 0.25,
+                              1e-12,
+                              "wrong bilinear lookup along a row");
+
+    // on the x edge there is no next point, the interpolation only mixes along y
+    NS_TEST_EXPECT_MSG_EQ(binary->GetBias(2, 0.5), 50.0, "wrong nearest edge");
+    NS_TEST_EXPECT_MSG_EQ_TOL(binary->GetBias(2, 0.5, true),
+                              (50.0 + 80.987654321098765) / 2,
+                              1e-12,
+                              "wrong bilinear edge");
+    NS_TEST_EXPECT_MSG_EQ(binary->GetBias(2, 0, true), 80.987654321098765, "wrong corner");
+
+    // outside the map there is no bias
+    NS_TEST_EXPECT_MSG_EQ(binary->GetBias(2.01, 1), 0.0, "bias outside the map");
+    NS_TEST_EXPECT_MSG_EQ(binary->GetBias(-0.01, 1, true), 0.0, "bias outside the map");
+
+    // the interpolation is a setting of each error model, not of the shared map
+    Ptr<WirelessFtmErrorModel> first = CreateObject<WirelessFtmErrorModel>();
+    Ptr<WirelessFtmErrorModel> second = CreateObject<WirelessFtmErrorModel>();
+    first->SetFtmMap(binary);
+    second->SetFtmMap(binary);
+    first->SetAttribute("Interpolation", BooleanValue(true));
+    NS_TEST_EXPECT_MSG_EQ(first->GetInterpolation(), true, "interpolation not set");
+    NS_TEST_EXPECT_MSG_EQ(second->GetInterpolation(), false, "interpolation leaked");
+
+    std::remove(textFile.c_str());
+    std::remove(binaryFile.c_str());
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief FTM frame classification test
+ *
+ * Checks that FtmManager::ClassifyFrame recognizes FTM responses and Acks, and
+ * rejects every other frame, including frames too short for their headers.
+ */
+class FtmClassifyFrameTest : public TestCase
+{
+  public:
+    FtmClassifyFrameTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param action the public action of the frame
+     * \return an FTM request or response frame
+     */
+    Ptr<Packet> CreateFtmFrame(WifiActionHeader::PublicActionValue action) const;
+
+    /**
+     * \param packet the frame
+     * \param size the number of leading bytes to keep
+     * \return a frame made of the first bytes of the given one
+     */
+    Ptr<Packet> Truncate(Ptr<const Packet> packet, uint32_t size) const;
+
+    /**
+     * \param packet the frame
+     * \return the class assigned by the FtmManager
+     */
+    FtmManager::FrameClass Classify(Ptr<const Packet> packet) const;
+};
+
+FtmClassifyFrameTest::FtmClassifyFrameTest()
+    : TestCase("FTM frame classification")
+{
+}
+
+Ptr<Packet>
+FtmClassifyFrameTest::CreateFtmFrame(WifiActionHeader::PublicActionValue action) const
+{
+    Ptr<Packet> packet = Create<Packet>();
+    if (action == WifiActionHeader::FTM_REQUEST)
+    {
+        FtmRequestHeader request;
+        request.SetTrigger(1);
+        packet->AddHeader(request);
+    }
+    else
+    {
+        FtmResponseHeader response;
+        response.SetDialogToken(3);
+        packet->AddHeader(response);
+    }
+    WifiActionHeader actionHdr;
+    WifiActionHeader::ActionValue value;
+    value.publicAction = action;
+    actionHdr.SetAction(WifiActionHeader::PUBLIC_ACTION, value);
+    packet->AddHeader(actionHdr);
+    WifiMacHeader hdr(WIFI_MAC_MGT_ACTION);
+    hdr.SetAddr1(Mac48Address("00:00:00:00:00:01"));
+    hdr.SetAddr2(Mac48Address("00:00:00:00:00:02"));
+    hdr.SetAddr3(Mac48Address("00:00:00:00:00:02"));
+    packet->AddHeader(hdr);
+    return packet;
+}
+
+Ptr<Packet>
+FtmClassifyFrameTest::Truncate(Ptr<const Packet> packet, uint32_t size) const
+{
+    std::vector<uint8_t> buffer(packet->GetSize());
+    packet->CopyData(buffer.data(), buffer.size());
+    return Create<Packet>(buffer.data(), size);
+}
+
+FtmManager::FrameClass
+FtmClassifyFrameTest::Classify(Ptr<const Packet> packet) const
+{
+    WifiMacHeader hdr;
+    return FtmManager::ClassifyFrame(packet, hdr);
+}
+
+void
+FtmClassifyFrameTest::DoRun()
+{
+    Ptr<Packet> response = CreateFtmFrame(WifiActionHeader::FTM_RESPONSE);
+    WifiMacHeader hdr;
+    NS_TEST_EXPECT_MSG_EQ(FtmManager::ClassifyFrame(response, hdr),
+                          FtmManager::FTM_RESPONSE_FRAME,
+                          "FTM response not recognized");
+    NS_TEST_EXPECT_MSG_EQ(hdr.GetAddr2(),
+                          Mac48Address("00:00:00:00:00:02"),
+                          "MAC header not filled in");
+    NS_TEST_EXPECT_MSG_EQ(Classify(CreateFtmFrame(WifiActionHeader::FTM_REQUEST)),
+                          FtmManager::OTHER_FRAME,
+                          "FTM request classified as a response");
+
+    // an action frame of another category
+    Ptr<Packet> blockAck = Create<Packet>(10);
+    WifiActionHeader actionHdr;
+    WifiActionHeader::ActionValue value;
+    value.blockAck = WifiActionHeader::BLOCK_ACK_ADDBA_REQUEST;
+    actionHdr.SetAction(WifiActionHeader::BLOCK_ACK, value);
+    blockAck->AddHeader(actionHdr);
+    blockAck->AddHeader(WifiMacHeader(WIFI_MAC_MGT_ACTION));
+    NS_TEST_EXPECT_MSG_EQ(Classify(blockAck), FtmManager::OTHER_FRAME, "non FTM action frame");
+
+    // non action frames
+    Ptr<Packet> data = Create<Packet>(100);
+    data->AddHeader(WifiMacHeader(WIFI_MAC_QOSDATA));
+    NS_TEST_EXPECT_MSG_EQ(Classify(data), FtmManager::OTHER_FRAME, "data frame");
+    Ptr<Packet> beacon = Create<Packet>(100);
+    beacon->AddHeader(WifiMacHeader(WIFI_MAC_MGT_BEACON));
+    NS_TEST_EXPECT_MSG_EQ(Classify(beacon), FtmManager::OTHER_FRAME, "beacon frame");
+
+    Ptr<Packet> ack = Create<Packet>();
+    ack->AddHeader(WifiMacHeader(WIFI_MAC_CTL_ACK));
+    NS_TEST_EXPECT_MSG_EQ(Classify(ack), FtmManager::ACK_FRAME, "Ack not recognized");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(ack, ack->GetSize() - 1)),
+                          FtmManager::OTHER_FRAME,
+                          "truncated Ack");
+
+    // too short frames, down to nothing
+    WifiMacHeader mgtHdr(WIFI_MAC_MGT_ACTION);
+    uint32_t hdrSize = mgtHdr.GetSerializedSize();
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, hdrSize + 2)),
+                          FtmManager::FTM_RESPONSE_FRAME,
+                          "category and action are enough to recognize a response");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, hdrSize + 1)),
+                          FtmManager::OTHER_FRAME,
+                          "frame without action field");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, hdrSize - 1)),
+                          FtmManager::OTHER_FRAME,
+                          "frame shorter than its MAC header");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, 1)), FtmManager::OTHER_FRAME, "1 byte");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Create<Packet>()), FtmManager::OTHER_FRAME, "empty frame");
+
+    // frames up to, at and beyond the bytes peeked by the classifier
+    const uint32_t peeked = 40 + 2; // WIFI_MAC_HEADER_MAX_SIZE + category + action
+    NS_TEST_ASSERT_MSG_GT(response->GetSize(), peeked, "response too short for the test");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, peeked - 1)),
+                          FtmManager::FTM_RESPONSE_FRAME,
+                          "response shorter than the peeked bytes");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, peeked)),
+                          FtmManager::FTM_RESPONSE_FRAME,
+                          "response as long as the peeked bytes");
+    NS_TEST_EXPECT_MSG_EQ(Classify(Truncate(response, peeked + 1)),
+                          FtmManager::FTM_RESPONSE_FRAME,
+                          "response longer than the peeked bytes");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief FTM Test Suite
+ */
+class FtmTestSuite : public TestSuite
+{
+  public:
+    FtmTestSuite();
+};
+
+FtmTestSuite::FtmTestSuite()
+    : TestSuite("wifi-ftm", UNIT)
+{
+    AddTestCase(new FtmMapTest, TestCase::QUICK);
+    AddTestCase(new FtmClassifyFrameTest, TestCase::QUICK);
+}
+
+static FtmTestSuite g_ftmTestSuite; ///< the test suite
@@ -19,6 +19,8 @@
 
 #include "ns3/core-module.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <cmath> // sqrt
 #include <fstream>
 #include <iomanip>
@@ -53,7 +55,8 @@ int g_fwidth = 6;
  *  The run is controlled by the event population size and
  *  total number of events, which are set at construction.
  *
- *  The event distribution in time is set by SetRandomStream()
+ *  The event distribution in time is set by SetRandomStream(),
+ *  or replayed from a trace of a real run with SetReplay().
  */
 class Bench
 {
@@ -81,6 +84,28 @@ class Bench
         m_rand = stream;
     }
 
+    /** An event scheduled by a real run. */
+    struct Record
+    {
+        uint64_t now; /**< Time step at which the event was scheduled. */
+        uint64_t ts;  /**< Time step at which the event expires. */
+    };
+
+    /**
+     * Replay the events scheduled by a real run instead of keeping
+     * a constant population.
+     *
+     * Each event executed schedules the recorded events which were scheduled
+     * up to its time stamp, so that the bursts of events with equal time
+     * stamps and the far-future timers of the run are reproduced.
+     *
+     * \param [in] records The recorded events, in increasing \c now order.
+     */
+    void SetReplay(const std::vector<Record>* records)
+    {
+        m_records = records;
+    }
+
     /**
      * Set the number of events to populate the scheduler with.
      * Each event executed schedules a new event, maintaining the population.
@@ -123,16 +148,43 @@ class Bench
      */
     void Cb();
 
-    Ptr<RandomVariableStream> m_rand; /**< Stream for event delays. */
-    uint64_t m_population;            /**< Event population size. */
-    uint64_t m_total;                 /**< Total number of events to execute. */
-    uint64_t m_count;                 /**< Count of events executed so far. */
+    /**
+     *  Replay event function. This schedules the recorded events
+     *  scheduled up to the current time.
+     */
+    void ReplayCb();
+
+    /**
+     *  Schedule the recorded events scheduled up to a time.
+     *
+     * \param [in] now The time step up to which the events are scheduled.
+     */
+    void ScheduleRecords(uint64_t now);
+
+    /**
+     *  Run the replay of the recorded events.
+     *
+     * \returns The Result.
+     */
+    Result RunReplay();
+
+    Ptr<RandomVariableStream> m_rand;              /**< Stream for event delays. */
+    const std::vector<Record>* m_records{nullptr}; /**< Recorded events to replay. */
+    std::size_t m_next{0};                         /**< Next recorded event to schedule. */
+    uint64_t m_population;                         /**< Event population size. */
+    uint64_t m_total;                              /**< Total number of events to execute. */
+    uint64_t m_count;                              /**< Count of events executed so far. */
 
 }; // class Bench
 
 Bench::Result
 Bench::Run()
 {
+    if (m_records)
+    {
+        return RunReplay();
+    }
+
     SystemWallClockMs timer;
     double init;
     double simu;
@@ -175,6 +227,63 @@ Bench::Cb()
     ++m_count;
 }
 
+Bench::Result
+Bench::RunReplay()
+{
+    SystemWallClockMs timer;
+    double init;
+    double simu = 0;
+
+    DEB("initializing replay");
+    m_count = 0;
+    m_next = 0;
+
+    timer.Start();
+    ScheduleRecords(m_records->front().now);
+    uint64_t pop = m_next;
+    init = timer.End() / 1000.0;
+    DEB("initialization took " << init << "s");
+
+    // events scheduled from outside of the simulation,
+    // or after the last event, are scheduled once the queue is empty
+    while (true)
+    {
+        DEB("running");
+        timer.Start();
+        Simulator::Run();
+        simu += timer.End() / 1000.0;
+        if (m_next == m_records->size())
+        {
+            break;
+        }
+        ScheduleRecords((*m_records)[m_next].now);
+    }
+    DEB("run took " << simu << "s");
+
+    Simulator::Destroy();
+
+    return Result{init, simu, pop, m_count};
+}
+
+void
+Bench::ReplayCb()
+{
+    ++m_count;
+    ScheduleRecords(Simulator::Now().GetTimeStep());
+}
+
+void
+Bench::ScheduleRecords(uint64_t now)
+{
+    uint64_t current = Simulator::Now().GetTimeStep();
+    while (m_next < m_records->size() && (*m_records)[m_next].now <= now)
+    {
+        uint64_t ts = std::max((*m_records)[m_next].ts, current);
+        Simulator::Schedule(TimeStep(ts - current), &Bench::ReplayCb, this);
+        ++m_next;
+    }
+}
+
 /** Benchmark which performs an ensemble of runs. */
 class BenchSuite
 {
@@ -193,13 +302,15 @@ class BenchSuite
      * \param [in] runs The number of replications.
      * \param [in] eventStream The random stream of event delays.
      * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+     * \param [in] records The recorded events to replay, if not empty.
      */
     BenchSuite(ObjectFactory& factory,
                uint64_t pop,
                uint64_t total,
                uint64_t runs,
                Ptr<RandomVariableStream> eventStream,
-               bool calRev);
+               bool calRev,
+               const std::vector<Bench::Record>& records);
 
     /** Write the results to \c LOG() */
     void Log() const;
@@ -269,7 +380,8 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
                        uint64_t total,
                        uint64_t runs,
                        Ptr<RandomVariableStream> eventStream,
-                       bool calRev)
+                       bool calRev,
+                       const std::vector<Bench::Record>& records)
 {
     Simulator::SetScheduler(factory);
 
@@ -287,6 +399,10 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     bench.SetRandomStream(eventStream);
     bench.SetPopulation(pop);
     bench.SetTotal(total);
+    if (!records.empty())
+    {
+        bench.SetReplay(&records);
+    }
 
     m_results.reserve(runs);
     Header();
@@ -451,12 +567,67 @@ GetRandomStream(std::string filename)
     return stream;
 }
 
+/**
+ *  Read the events scheduled by a real run, to be replayed.
+ *
+ *  The input is the JSON file written by DesMetrics, in a build
+ *  configured with `--enable-des-metrics`: each event is recorded as
+ *  `["<send context>","<now>","<receive context>","<time stamp>"]`,
+ *  with times in time steps.
+ *
+ *  \param [in] filename The DesMetrics file name.
+ *  \returns The recorded events, sorted by the time at which they were scheduled.
+ */
+std::vector<Bench::Record>
+GetReplay(std::string filename)
+{
+    std::vector<Bench::Record> records;
+    if (filename.empty())
+    {
+        return records;
+    }
+
+    LOG("  Event time distribution:      replayed from " << filename);
+    std::ifstream input(filename);
+    if (!input)
+    {
+        NS_FATAL_ERROR("Unable to open " << filename);
+    }
+    std::string line;
+    while (std::getline(input, line))
+    {
+        int send;
+        int recv;
+        Bench::Record record;
+        if (sscanf(line.c_str(),
+                   " [\"%d\",\"%" SCNu64 "\",\"%d\",\"%" SCNu64 "\"]",
+                   &send,
+                   &record.now,
+                   &recv,
+                   &record.ts) == 4)
+        {
+            records.push_back(record);
+        }
+    }
+    // events scheduled by different threads may be interleaved
+    std::stable_sort(records.begin(),
+                     records.end(),
+                     [](const Bench::Record& a, const Bench::Record& b) { return a.now < b.now; });
+    LOG("    Found " << records.size() << " events");
+    if (records.empty())
+    {
+        NS_FATAL_ERROR("No events found in " << filename);
+    }
+    return records;
+}
+
 int
 main(int argc, char* argv[])
 {
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -465,6 +636,7 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    std::string replay = "";
     bool calRev = false;
 
     CommandLine cmd(__FILE__);
@@ -477,11 +649,16 @@ main(int argc, char* argv[])
               "In the case of either --file form, the input is expected\n"
               "to be ascii, giving the relative event times in ns.\n"
               "\n"
+              "Alternatively, the events scheduled by a real run can be\n"
+              "replayed from a DesMetrics trace, given by the\n"
+              "--replay=\"<filename>\" argument; --pop and --total are then ignored.\n"
+              "\n"
               "If no scheduler is specified the MapScheduler will be run.");
     cmd.AddValue("all", "use all schedulers", allSched);
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -490,6 +667,7 @@ main(int argc, char* argv[])
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
+    cmd.AddValue("replay", "DesMetrics trace of the events to replay", replay);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
 
@@ -505,32 +683,38 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    std::vector<Bench::Record> records = GetReplay(replay);
+    auto eventStream = records.empty() ? GetRandomStream(filename) : nullptr;
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
     {
         factory.SetTypeId("ns3::CalendarScheduler");
         factory.Set("Reverse", BooleanValue(calRev));
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, records).Log();
         if (allSched)
         {
             factory.Set("Reverse", BooleanValue(!calRev));
-            BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
+            BenchSuite(factory, pop, total, runs, eventStream, !calRev, records).Log();
         }
     }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, records).Log();
+    }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, records).Log();
     }
     if (schedList)
     {
@@ -541,17 +725,17 @@ main(int argc, char* argv[])
             LOG("Running List scheduler with 1/10 total events");
             listTotal /= 10;
         }
-        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev).Log();
+        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev, records).Log();
     }
     if (schedMap)
     {
         factory.SetTypeId("ns3::MapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, records).Log();
     }
     if (schedPQ)
     {
         factory.SetTypeId("ns3::PriorityQueueScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, records).Log();
     }
 
     return 0;